@@ -11,5 +11,8 @@ public class ProjectTarget : TargetRules
 		DefaultBuildSettings = BuildSettingsVersion.V5;
 		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_6;
 		ExtraModuleNames.Add("Project");
+
+		bUseIris = true;
+		bWithPushModel = true;
 	}
 }
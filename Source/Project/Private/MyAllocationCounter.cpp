@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyAllocationCounter.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformMisc.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DelayedAutoRegister.h"
+#include "Misc/OutputDevice.h"
+#include "Misc/Parse.h"
+
+/* Open counting scopes and counted allocations of the current thread. */
+static thread_local int32 GMyAllocationCountDepth = 0;
+static thread_local uint64 GMyAllocationCount = 0;
+
+static bool GMyAllocationCounterInstalled = false;
+
+/** Forwards everything to the allocator it wraps and counts allocations inside FMyAllocationCounter scopes. */
+class FMyCountingMalloc final : public FMalloc
+{
+public:
+	explicit FMyCountingMalloc(FMalloc* InInner)
+		: Inner(InInner)
+	{
+	}
+
+	virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+	{
+		CountAllocation();
+		return Inner->Malloc(Count, Alignment);
+	}
+
+	virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+	{
+		CountAllocation();
+		return Inner->TryMalloc(Count, Alignment);
+	}
+
+	virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+	{
+		// Shrinking to zero frees.
+		if (Count > 0) { CountAllocation(); }
+		return Inner->Realloc(Original, Count, Alignment);
+	}
+
+	virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+	{
+		if (Count > 0) { CountAllocation(); }
+		return Inner->TryRealloc(Original, Count, Alignment);
+	}
+
+	virtual void Free(void* Original) override { Inner->Free(Original); }
+	virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+	virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+	virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+	virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+	virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+	virtual void InitializeStatsMetadata() override { Inner->InitializeStatsMetadata(); }
+	virtual void UpdateStats() override { Inner->UpdateStats(); }
+	virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+	virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+	virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+	virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+	virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+private:
+	static void CountAllocation()
+	{
+		if (GMyAllocationCountDepth > 0)
+		{
+			++GMyAllocationCount;
+		}
+	}
+
+	FMalloc* Inner;
+};
+
+namespace MyAllocationCounter
+{
+	/*
+	 * Like the engine's own proxies, the counter is chosen on the command line and wraps GMalloc once at startup.
+	 * FileSystemReady is the first phase with a command line; in monolithic builds the task graph has no workers yet
+	 * then, in modular builds this runs when the module loads. A thread that read GMalloc before the swap keeps
+	 * allocating through the allocator underneath, which hands out and frees the same blocks, it just isn't counted.
+	 * The proxy is never removed: blocks it handed out may be freed until exit.
+	 */
+	static FDelayedAutoRegisterHelper RegisterProxy(EDelayedRegisterRunPhase::FileSystemReady, []()
+	{
+		if (GMyAllocationCounterInstalled || !FParse::Param(FCommandLine::Get(), TEXT("MyCountAllocations"))) { return; }
+
+		FMalloc* Proxy = new FMyCountingMalloc(GMalloc);
+		// Publish the proxy only once it is fully constructed.
+		FPlatformMisc::MemoryBarrier();
+		GMalloc = Proxy;
+		GMyAllocationCounterInstalled = true;
+	});
+}
+
+bool FMyAllocationCounter::IsInstalled()
+{
+	return GMyAllocationCounterInstalled;
+}
+
+uint64 FMyAllocationCounter::GetThreadAllocations()
+{
+	return GMyAllocationCount;
+}
+
+FMyAllocationCounter::FScope::FScope()
+{
+	++GMyAllocationCountDepth;
+}
+
+FMyAllocationCounter::FScope::~FScope()
+{
+	--GMyAllocationCountDepth;
+}
+
+FMyAllocationCounter::FPause::FPause()
+	: SavedDepth(GMyAllocationCountDepth)
+{
+	GMyAllocationCountDepth = 0;
+}
+
+FMyAllocationCounter::FPause::~FPause()
+{
+	GMyAllocationCountDepth = SavedDepth;
+}
@@ -0,0 +1,231 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyAnimBenchmarkSubsystem.h"
+#include "Project.h"
+#include "MyBaseCharacter.h"
+#include "MyBudgetedMeshComponent.h"
+#include "IAnimationBudgetAllocator.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+/* Distance between spawned characters. */
+static constexpr float MyAnimBenchSpacing = 200.0f;
+
+/* Time given to spawned characters to land and settle before measuring. */
+static constexpr double MyAnimBenchWarmupSeconds = 2.0;
+
+void UMyAnimBenchmarkSubsystem::Deinitialize()
+{
+	if (IsRunning())
+	{
+		SetParallelAnimation(true);
+	}
+
+	Super::Deinitialize();
+}
+
+void UMyAnimBenchmarkSubsystem::StartBenchmark(int32 Count, float InPhaseSeconds, FOutputDevice& Ar)
+{
+	if (IsRunning())
+	{
+		Ar.Logf(TEXT("AnimBench: already running"));
+		return;
+	}
+
+	UWorld* World = GetWorld();
+	if (!World || World->GetNetMode() == NM_Client)
+	{
+		Ar.Logf(TEXT("AnimBench: needs a standalone game or a server"));
+		return;
+	}
+
+	UClass* CharacterClass = StaticLoadClass(AMyBaseCharacter::StaticClass(), nullptr, TEXT("/Game/ThirdPerson/Blueprints/BP_BaseCharacter.BP_BaseCharacter_C"));
+	if (!CharacterClass)
+	{
+		CharacterClass = AMyBaseCharacter::StaticClass();
+	}
+
+	FVector Origin = FVector::ZeroVector;
+	if (const APlayerController* PC = World->GetFirstPlayerController())
+	{
+		if (const APawn* Pawn = PC->GetPawn())
+		{
+			Origin = Pawn->GetActorLocation() + Pawn->GetActorForwardVector() * 500.0f;
+		}
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	// Square grid in front of the player.
+	const int32 Columns = FMath::Max(FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count))), 1);
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const FVector Location = Origin + FVector((Index / Columns) * MyAnimBenchSpacing, (Index % Columns - Columns / 2) * MyAnimBenchSpacing, 0.0f);
+
+		AMyBaseCharacter* Character = World->SpawnActor<AMyBaseCharacter>(CharacterClass, Location, FRotator::ZeroRotator, SpawnParams);
+		if (!Character) { continue; }
+
+		// Keep animating under -nullrhi; the budget allocator still decides how often.
+		Character->GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+		if (UMyBudgetedMeshComponent* BudgetedMesh = Cast<UMyBudgetedMeshComponent>(Character->GetMesh()))
+		{
+			BudgetedMesh->bTickEvenIfNotRendered = true;
+		}
+
+		SpawnedCharacters.Add(Character);
+	}
+
+	IConsoleManager& ConsoleManager = IConsoleManager::Get();
+	SavedParallelEvaluation = ConsoleManager.FindConsoleVariable(TEXT("a.ParallelAnimEvaluation"))->GetInt();
+	SavedParallelUpdate = ConsoleManager.FindConsoleVariable(TEXT("a.ParallelAnimUpdate"))->GetInt();
+
+	PhaseSeconds = FMath::Max(InPhaseSeconds, 1.0f);
+
+	Ar.Logf(TEXT("AnimBench: spawned %d %s, measuring %.0fs parallel and %.0fs serial"), SpawnedCharacters.Num(), *CharacterClass->GetName(), PhaseSeconds, PhaseSeconds);
+
+	EnterPhase(EPhase::Warmup);
+}
+
+void UMyAnimBenchmarkSubsystem::Tick(float DeltaTime)
+{
+	if (!IsRunning()) { return; }
+
+	++PhaseFrames;
+	PhaseFrameSeconds += DeltaTime;
+
+	const double Elapsed = FPlatformTime::Seconds() - PhaseStartTime;
+
+	switch (Phase)
+	{
+	case EPhase::Warmup:
+		if (Elapsed >= MyAnimBenchWarmupSeconds)
+		{
+			EnterPhase(EPhase::Parallel);
+		}
+		break;
+
+	case EPhase::Parallel:
+		if (Elapsed >= PhaseSeconds)
+		{
+			FinishPhase();
+			EnterPhase(EPhase::Serial);
+		}
+		break;
+
+	case EPhase::Serial:
+		if (Elapsed >= PhaseSeconds)
+		{
+			FinishPhase();
+			Finish();
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+TStatId UMyAnimBenchmarkSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMyAnimBenchmarkSubsystem, STATGROUP_Tickables);
+}
+
+void UMyAnimBenchmarkSubsystem::EnterPhase(EPhase NewPhase)
+{
+	Phase = NewPhase;
+	PhaseStartTime = FPlatformTime::Seconds();
+	PhaseFrames = 0;
+	PhaseFrameSeconds = 0.0;
+
+	MeshTickSeconds = 0.0;
+	NumMeshTicks = 0;
+
+	SetParallelAnimation(NewPhase != EPhase::Serial);
+}
+
+void UMyAnimBenchmarkSubsystem::FinishPhase()
+{
+	const double Frames = static_cast<double>(FMath::Max<int64>(PhaseFrames, 1));
+	const double GameThreadMs = (MeshTickSeconds / Frames) * 1000.0;
+	const double FrameMs = (PhaseFrameSeconds / Frames) * 1000.0;
+
+	if (Phase == EPhase::Parallel)
+	{
+		ParallelGameThreadMs = GameThreadMs;
+		ParallelFrameMs = FrameMs;
+		ParallelTicksPerFrame = NumMeshTicks / Frames;
+	}
+	else
+	{
+		SerialGameThreadMs = GameThreadMs;
+		SerialFrameMs = FrameMs;
+		SerialTicksPerFrame = NumMeshTicks / Frames;
+	}
+}
+
+void UMyAnimBenchmarkSubsystem::Finish()
+{
+	SetParallelAnimation(true);
+
+	const IAnimationBudgetAllocator* Allocator = IAnimationBudgetAllocator::Get(GetWorld());
+	const bool bBudgetEnabled = Allocator && Allocator->GetEnabled();
+	const float BudgetMs = IConsoleManager::Get().FindConsoleVariable(TEXT("a.Budget.BudgetMs"))->GetFloat();
+
+	// In the serial phase the worker part runs inside the mesh tick, so the difference per tick is what the workers do.
+	// The budget runs fewer of the heavier serial ticks, so compare per tick and scale to the parallel tick count.
+	const double ParallelTickMs = ParallelTicksPerFrame > 0.0 ? ParallelGameThreadMs / ParallelTicksPerFrame : 0.0;
+	const double SerialTickMs = SerialTicksPerFrame > 0.0 ? SerialGameThreadMs / SerialTicksPerFrame : 0.0;
+	const double WorkerTickMs = FMath::Max(SerialTickMs - ParallelTickMs, 0.0);
+	const double WorkerMs = WorkerTickMs * ParallelTicksPerFrame;
+	const int32 Count = SpawnedCharacters.Num();
+
+	UE_LOG(LogProject, Display, TEXT("AnimBench: %d characters, budget %s (%.2f ms)"), Count, bBudgetEnabled ? TEXT("on") : TEXT("off"), BudgetMs);
+	UE_LOG(LogProject, Display, TEXT("  game thread  %.3f ms/frame  %.4f ms/tick  (%.1f mesh ticks/frame, frame %.2f ms)"), ParallelGameThreadMs, ParallelTickMs, ParallelTicksPerFrame, ParallelFrameMs);
+	UE_LOG(LogProject, Display, TEXT("  worker       %.3f ms/frame  %.4f ms/tick  (serial %.4f ms/tick over %.1f mesh ticks/frame, frame %.2f ms)"), WorkerMs, WorkerTickMs, SerialTickMs, SerialTicksPerFrame, SerialFrameMs);
+
+	const FString FilePath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("AnimBench.csv"));
+	FString Csv;
+	if (!IFileManager::Get().FileExists(*FilePath))
+	{
+		Csv = TEXT("Characters,Budget,BudgetMs,GameThreadMs,WorkerMs,MeshTicksPerFrame,GameThreadTickMs,WorkerTickMs,SerialMeshTicksPerFrame,ParallelFrameMs,SerialFrameMs\n");
+	}
+	Csv += FString::Printf(TEXT("%d,%d,%.2f,%.4f,%.4f,%.1f,%.5f,%.5f,%.1f,%.3f,%.3f\n"),
+		Count, bBudgetEnabled ? 1 : 0, BudgetMs, ParallelGameThreadMs, WorkerMs, ParallelTicksPerFrame, ParallelTickMs, WorkerTickMs, SerialTicksPerFrame, ParallelFrameMs, SerialFrameMs);
+	FFileHelper::SaveStringToFile(Csv, *FilePath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	for (const TWeakObjectPtr<AMyBaseCharacter>& Character : SpawnedCharacters)
+	{
+		if (Character.IsValid())
+		{
+			Character->Destroy();
+		}
+	}
+	SpawnedCharacters.Reset();
+
+	Phase = EPhase::Idle;
+}
+
+void UMyAnimBenchmarkSubsystem::SetParallelAnimation(bool bParallel)
+{
+	IConsoleManager& ConsoleManager = IConsoleManager::Get();
+	ConsoleManager.FindConsoleVariable(TEXT("a.ParallelAnimEvaluation"))->Set(bParallel ? SavedParallelEvaluation : 0, ECVF_SetByCode);
+	ConsoleManager.FindConsoleVariable(TEXT("a.ParallelAnimUpdate"))->Set(bParallel ? SavedParallelUpdate : 0, ECVF_SetByCode);
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyAnimBench(
+	TEXT("Project.Anim.Bench"),
+	TEXT("Spawns characters and measures game thread and worker animation cost. Arguments: <Count> [SecondsPerPhase]."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UMyAnimBenchmarkSubsystem* Bench = World ? World->GetSubsystem<UMyAnimBenchmarkSubsystem>() : nullptr)
+		{
+			const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 50;
+			const float Seconds = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 10.0f;
+			Bench->StartBenchmark(FMath::Max(Count, 1), Seconds, Ar);
+		}
+	}));
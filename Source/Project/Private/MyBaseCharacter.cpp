@@ -6,9 +6,13 @@
 #include "Camera/CameraComponent.h"
 #include "InteractiveInterface.h"
 #include "MyBaseMovementComponent.h"
-#include <MyBaseWidget.h>
 #include "MyHealthComponent.h"
 #include "MyStaminaComponent.h"
+#include "MyNetStatsSubsystem.h"
+#include "MySignificanceManager.h"
+#include "MyBudgetedMeshComponent.h"
+#include "MyMemoryTags.h"
+#include "Components/SkeletalMeshComponent.h"
 
 /**
  * Constructor for AMyBaseCharacter
@@ -22,7 +26,9 @@
  *
  * Many of these settings can be adjusted in Blueprints for faster iteration.
  */
-AMyBaseCharacter::AMyBaseCharacter(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer.SetDefaultSubobjectClass<UMyBaseMovementComponent>(ACharacter::CharacterMovementComponentName))
+AMyBaseCharacter::AMyBaseCharacter(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer
+    .SetDefaultSubobjectClass<UMyBaseMovementComponent>(ACharacter::CharacterMovementComponentName)
+    .SetDefaultSubobjectClass<UMyBudgetedMeshComponent>(ACharacter::MeshComponentName))
 {
     /** Enable Tick() for this character so it updates every frame */
     PrimaryActorTick.bCanEverTick = true;
@@ -98,61 +104,33 @@ AMyBaseCharacter::AMyBaseCharacter(const FObjectInitializer& ObjectInitializer)
 
 void AMyBaseCharacter::BeginPlay()
 {
+	LLM_SCOPE_BYTAG(Project_Characters);
+
 	Super::BeginPlay();
 
 	MyMovement = Cast<UMyBaseMovementComponent>(GetCharacterMovement());
 
-	// Only do UI on the owning client
-	if (!IsLocallyControlled())
-		return;
+	DefaultNetUpdateFrequency = GetNetUpdateFrequency();
+	DefaultVisibilityBasedAnimTickOption = GetMesh()->VisibilityBasedAnimTickOption;
+	bDefaultCastShadow = GetMesh()->CastShadow;
 
-	// Check if the health component exists and is valid
-	if (!IsValid(MyHealthComponent))
+	// Throttle ticking, animation and net updates by distance and view
+	if (UMySignificanceManager* SignificanceManager = USignificanceManager::Get<UMySignificanceManager>(GetWorld()))
 	{
-		return; // Exit early because we can't update the UI without a health component
+		SignificanceManager->RegisterCharacter(this);
 	}
 
-	// Check if the Stamina component exists and is valid
-	if (!IsValid(MyStaminaComponent))
-	{
-		return; // Exit early because we can't update the UI without a Stamina component
-	}
+	// The HUD belongs to AMyBasePlayerController and picks up this character's health and stamina on possession
+}
 
-	// Check if the widget class is valid (must be assigned in the Blueprint or code)
-	if (!IsValid(WidgetClass))
+void AMyBaseCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UMySignificanceManager* SignificanceManager = USignificanceManager::Get<UMySignificanceManager>(GetWorld()))
 	{
-		return; // Exit early because we can't create a widget without a valid class
+		SignificanceManager->UnregisterCharacter(this);
 	}
 
-	// Get the player controller that owns this character
-	if (APlayerController* PC = Cast<APlayerController>(GetController()))
-	{
-		// Create the actual widget instance from the class
-		WidgetInstance = CreateWidget<UMyBaseWidget>(PC, WidgetClass);
-
-		if (WidgetInstance) // If widget creation succeeded
-		{
-			// Add the widget to the viewport so the player can see it
-			WidgetInstance->AddToViewport();
-
-			// Initialize the health bar fill based on the current health percentage
-			WidgetInstance->UpdateHealthBar(MyHealthComponent->GetHealthPercentage());
-
-			// Initialize the Stamina bar fill based on the current stamina percentage
-			WidgetInstance->UpdateStaminaBar(MyStaminaComponent->GetStaminaPercentage());
-
-			// Make sure the widget is visible
-			WidgetInstance->SetVisibility(ESlateVisibility::Visible);
-
-			// Bind the widget's handler to the health component's OnHealthChanged delegate
-			// This ensures that the health bar updates automatically whenever the character's health changes
-			MyHealthComponent->OnHealthChanged.AddDynamic(WidgetInstance, &UMyBaseWidget::OnHealthChangedHandler);
-
-			// Bind the widget's handler to the Stamin component's OnStaminaChanged delegate
-			// This ensures that the Stamina Bar updates automatically whenever the character's Stamina changes
-			MyStaminaComponent->OnStaminaChanged.AddDynamic(WidgetInstance, &UMyBaseWidget::OnStaminaChangedHandler);
-		}
-	}
+	Super::EndPlay(EndPlayReason);
 }
 
 /* 
@@ -163,6 +141,8 @@ void AMyBaseCharacter::BeginPlay()
 */
 void AMyBaseCharacter::Tick(float DeltaTime)
 {
+	LLM_SCOPE_BYTAG(Project_Characters);
+
 	Super::Tick(DeltaTime);
 }
 
@@ -203,11 +183,75 @@ void AMyBaseCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCom
 	}
 }
 
+void AMyBaseCharacter::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	UMyNetStatsSubsystem::RecordReplicatedProperties(this);
+}
+
+bool AMyBaseCharacter::CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack)
+{
+	UMyNetStatsSubsystem::RecordRemoteFunction(this, Function, Parameters);
+
+	return Super::CallRemoteFunction(Function, Parameters, OutParms, Stack);
+}
+
 UMyBaseMovementComponent* AMyBaseCharacter::GetMyBaseMovementComponent()
 {
 	return MyMovement;
 }
 
+/*
+ * Throttles this character to a significance level.
+ *
+ * Actor tick and skeletal mesh (animation) tick intervals follow the level. While the animation budget
+ * allocator is enabled it owns the mesh tick, so the mesh only gets the significance score instead.
+ * Movement is only throttled on simulated proxies; the server and the owning client need every move.
+ * Net update frequency is only changed on the server, cosmetic settings are never changed on a dedicated server.
+ */
+void AMyBaseCharacter::ApplySignificance(EMySignificanceLevel Level, const FMySignificanceLevelSettings& Settings)
+{
+	SignificanceLevel = Level;
+
+	SetActorTickInterval(Settings.TickInterval);
+
+	const UMyBudgetedMeshComponent* BudgetedMesh = Cast<UMyBudgetedMeshComponent>(GetMesh());
+	const bool bAnimationBudgeted = BudgetedMesh && BudgetedMesh->IsBudgeted();
+
+	if (!bAnimationBudgeted)
+	{
+		GetMesh()->SetComponentTickInterval(Settings.AnimTickInterval);
+	}
+
+	if (GetLocalRole() == ROLE_SimulatedProxy)
+	{
+		GetCharacterMovement()->SetComponentTickInterval(Settings.TickInterval);
+	}
+
+	if (HasAuthority())
+	{
+		SetNetUpdateFrequency(FMath::Max(DefaultNetUpdateFrequency * Settings.NetUpdateFrequencyScale, GetMinNetUpdateFrequency()));
+	}
+
+	if (!IsNetMode(NM_DedicatedServer))
+	{
+		if (!bAnimationBudgeted)
+		{
+			GetMesh()->VisibilityBasedAnimTickOption = Settings.bCosmetics ? DefaultVisibilityBasedAnimTickOption : EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+		}
+		GetMesh()->SetCastShadow(Settings.bCosmetics && bDefaultCastShadow);
+	}
+}
+
+void AMyBaseCharacter::SetAnimationSignificance(float Significance)
+{
+	if (UMyBudgetedMeshComponent* BudgetedMesh = Cast<UMyBudgetedMeshComponent>(GetMesh()))
+	{
+		BudgetedMesh->SetBudgetSignificance(Significance, IsLocallyControlled());
+	}
+}
+
 /*
  * Handles character movement input.
  *
@@ -366,6 +410,8 @@ void AMyBaseCharacter::OnChangePerspective()
 
 void AMyBaseCharacter::Server_Interact_Implementation(AActor* TargetActor)
 {
+	LLM_SCOPE_BYTAG(Project_Interaction);
+
 	// Server authority: This function only runs on the server
 	// after the client calls the RPC `Server_Interact(TargetActor)`.
 
@@ -380,6 +426,8 @@ void AMyBaseCharacter::Server_Interact_Implementation(AActor* TargetActor)
 
 void AMyBaseCharacter::OnInteract()
 {
+	LLM_SCOPE_BYTAG(Project_Interaction);
+
 	// Only allow the *locally controlled* player (the one holding the controller) 
 	// to run interaction logic. Prevents remote clients from firing traces.
 	if (!IsLocallyControlled()) return;
@@ -1,8 +1,11 @@
 #include "MyBaseDoor.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 #include "Engine/World.h"
-#include "TimerManager.h"
+#include "MyTimerSubsystem.h"
 #include "DrawDebugHelpers.h"
+#include "MyNetStatsSubsystem.h"
+#include "MyMemoryTags.h"
 
 /**
  * Constructor
@@ -51,6 +54,10 @@ AMyBaseDoor::AMyBaseDoor()
 
     /* Enable replication so this actor's state can be seen on client and server. */
     bReplicates = true;
+
+    /* Doors only change when someone interacts with them, so keep them dormant
+    until ToggleDoor() flushes them. Clients start from the state saved in the level. */
+    NetDormancy = DORM_Initial;
 }
 
 
@@ -61,6 +68,8 @@ AMyBaseDoor::AMyBaseDoor()
  */
 void AMyBaseDoor::BeginPlay()
 {
+    LLM_SCOPE_BYTAG(Project_Doors);
+
     Super::BeginPlay();
     DoorMesh->SetWorldRotation(bIsOpen ? OpenRotation : ClosedRotation);
 }
@@ -74,6 +83,28 @@ void AMyBaseDoor::Tick(float DeltaTime)
     Super::Tick(DeltaTime);
 }
 
+/**
+ * Called before the door is considered for replication
+ * Records which replicated properties changed since the last update.
+ */
+void AMyBaseDoor::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+    Super::PreReplication(ChangedPropertyTracker);
+
+    UMyNetStatsSubsystem::RecordReplicatedProperties(this);
+}
+
+/**
+ * Called when one of the door's RPCs is sent
+ * Records the RPC and its parameter size before it is sent.
+ */
+bool AMyBaseDoor::CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack)
+{
+    UMyNetStatsSubsystem::RecordRemoteFunction(this, Function, Parameters);
+
+    return Super::CallRemoteFunction(Function, Parameters, OutParms, Stack);
+}
+
 /**
  * Interact implementation from the interface
  * Called when a player interacts with the door
@@ -90,10 +121,16 @@ void AMyBaseDoor::Interact_Implementation(AActor* Interactor)
  */
 void AMyBaseDoor::ToggleDoor()
 {
+    LLM_SCOPE_BYTAG(Project_Doors);
+
     if (HasAuthority())
     {
+        // Wake the door up so the new state is sent once, then it goes back to sleep
+        FlushNetDormancy();
+
         // Flip the open state
         bIsOpen = !bIsOpen;
+        MARK_PROPERTY_DIRTY_FROM_NAME(AMyBaseDoor, bIsOpen, this);
 
         // Trigger rotation update on server (and replicated to clients)
         OnRep_IsOpen();
@@ -120,8 +157,14 @@ void AMyBaseDoor::Server_ToggleDoor_Implementation()
  */
 void AMyBaseDoor::OnRep_IsOpen()
 {
+    LLM_SCOPE_BYTAG(Project_Doors);
+
     // Start a timer that repeatedly calls UpdateDoorRotation
-    GetWorldTimerManager().SetTimer(DoorTimerHandle, this, &AMyBaseDoor::UpdateDoorRotation, 0.01f, true);
+    // The wheel calls a looping timer at most once per frame, which is all the frame-rate based interpolation needs
+    if (FMyTimerWheel* Timers = UMyTimerSubsystem::GetTimerWheel(this))
+    {
+        Timers->SetTimer<&AMyBaseDoor::UpdateDoorRotation>(DoorTimerHandle, this, 0.01f, true);
+    }
 }
 
 /**
@@ -138,8 +181,37 @@ void AMyBaseDoor::UpdateDoorRotation()
     // Stop timer when rotation is within 0.1 degrees of target
     if (DoorMesh->GetRelativeRotation().Equals(TargetRot, 0.1f))
     {
-        GetWorldTimerManager().ClearTimer(DoorTimerHandle);
+        if (FMyTimerWheel* Timers = UMyTimerSubsystem::GetTimerWheel(this))
+        {
+            Timers->ClearTimer(DoorTimerHandle);
+        }
+    }
+}
+
+FRotator AMyBaseDoor::GetDoorRotation() const
+{
+    return DoorMesh->GetRelativeRotation();
+}
+
+/**
+ * Restores a saved door state
+ * Sets the replicated open state and the mesh rotation directly, then lets the rotation timer finish a saved swing
+ */
+void AMyBaseDoor::RestoreState(bool bOpen, const FRotator& DoorRotation)
+{
+    if (!HasAuthority()) { return; }
+
+    if (bIsOpen != bOpen)
+    {
+        FlushNetDormancy();
+        bIsOpen = bOpen;
+        MARK_PROPERTY_DIRTY_FROM_NAME(AMyBaseDoor, bIsOpen, this);
     }
+
+    DoorMesh->SetRelativeRotation(DoorRotation);
+
+    // Clears itself straight away if the door is already at its target
+    OnRep_IsOpen();
 }
 
 /**
@@ -150,6 +222,8 @@ void AMyBaseDoor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifet
 {
     Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-    // Replicate door open state
-    DOREPLIFETIME(AMyBaseDoor, bIsOpen);
+    // Replicate door open state, only compared when ToggleDoor() marks it dirty
+    FDoRepLifetimeParams Params;
+    Params.bIsPushBased = true;
+    DOREPLIFETIME_WITH_PARAMS_FAST(AMyBaseDoor, bIsOpen, Params);
 }
\ No newline at end of file
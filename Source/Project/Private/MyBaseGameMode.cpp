@@ -1,11 +1,25 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "MyBaseGameMode.h"
+#include "Project.h"
 #include "GameFramework/PlayerStart.h" 
 #include <Kismet/GameplayStatics.h>
 #include "MyBasePlayerController.h"
 #include "MyBasePlayerState.h"
 #include "MyBaseGameState.h"
+#include "MyMoverCharacter.h"
+#include "MyWorldSnapshotSubsystem.h"
+#include "MyMemoryTags.h"
+#include "GameFramework/PlayerState.h"
+#include "Hash/CityHash.h"
+#include "HAL/IConsoleManager.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+static int32 GMyMoverPlayerPawn = 0;
+static FAutoConsoleVariableRef CVarMyMoverPlayerPawn(
+    TEXT("Project.Mover.PlayerPawn"),
+    GMyMoverPlayerPawn,
+    TEXT("1 spawns players as AMyMoverCharacter (Mover backend) instead of BP_BaseCharacter. Applies on the next respawn."));
 
 AMyBaseGameMode::AMyBaseGameMode()
 {
@@ -22,7 +36,20 @@ AMyBaseGameMode::AMyBaseGameMode()
     PlayerStateClass = AMyBasePlayerState::StaticClass();
 }
 
-FTransform AMyBaseGameMode::GetSpawnPoint()
+void AMyBaseGameMode::Logout(AController* Exiting)
+{
+    /* Free the leaving player's start for others. */
+    const uint64 PlayerId = GetPersistentPlayerId(Exiting);
+    for (auto It = SpawnOccupants.CreateIterator(); It; ++It)
+    {
+        if (It.Value() == PlayerId) { It.RemoveCurrent(); }
+    }
+    RestoredSpawns.Remove(PlayerId);
+
+    Super::Logout(Exiting);
+}
+
+FTransform AMyBaseGameMode::GetSpawnPoint(APlayerController* PlayerController)
 {
     /* Store an array of the PlayerStarts. */
     TArray<AActor*> PlayerStarts;
@@ -30,12 +57,29 @@ FTransform AMyBaseGameMode::GetSpawnPoint()
     /* Get all of the actors that exist in the world that are PlayerStarts. */
     UGameplayStatics::GetAllActorsOfClass(GetWorld(), APlayerStart::StaticClass(), PlayerStarts);
 
+    const uint64 PlayerId = GetPersistentPlayerId(PlayerController);
+
+    /* A player coming back after a snapshot restore starts once where they last spawned. */
+    if (PlayerId != 0 && RestoredSpawns.Remove(PlayerId) > 0)
+    {
+        for (const TPair<TWeakObjectPtr<AActor>, uint64>& Occupant : SpawnOccupants)
+        {
+            if (Occupant.Value == PlayerId && Occupant.Key.IsValid())
+            {
+                return Occupant.Key->GetTransform();
+            }
+        }
+    }
+
     /* If the PlayerStarts that exist in the world is greater than 0. */
     if (PlayerStarts.Num() > 0)
     {
         /* Then we get a random PlayerStart in the array. */
         int32 RandomIndex = FMath::RandRange(0, PlayerStarts.Num() - 1);
 
+        /* Remember who spawned there last, for world snapshots. */
+        if (PlayerId != 0) { SetSpawnOccupant(PlayerStarts[RandomIndex], PlayerId); }
+
         /* And we return that PlayerStart Transform. */
         return PlayerStarts[RandomIndex]->GetTransform();
     }
@@ -49,6 +93,9 @@ void AMyBaseGameMode::RespawnActor(APlayerController* PlayerController)
     /* Return early if the PlayerController is invalid. */
     if (!PlayerController) { return; }
 
+    /* Loading the pawn class and spawning the pawn are the usual hitches, so they show in hitch dumps. */
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(AMyBaseGameMode::RespawnActor, ProjectChannel);
+
     /* Get the pawn currently controlled by this PlayerController. */
     APawn* CurrentPawn = PlayerController->GetPawn();
 
@@ -59,10 +106,10 @@ void AMyBaseGameMode::RespawnActor(APlayerController* PlayerController)
     }
 
     /* Determine the spawn location and rotation for the new pawn. */
-    FTransform SpawnTransform = GetSpawnPoint();
+    FTransform SpawnTransform = GetSpawnPoint(PlayerController);
 
-    /* Load the Blueprint class for the PlayerPawn. */
-    UClass* PlayerPawnBPClass = StaticLoadClass(
+    /* Load the Blueprint class for the PlayerPawn, or use the Mover backend pawn when asked to. */
+    UClass* PlayerPawnBPClass = GMyMoverPlayerPawn ? AMyMoverCharacter::StaticClass() : StaticLoadClass(
         APawn::StaticClass(),
         nullptr,
         TEXT("/Game/ThirdPerson/Blueprints/BP_BaseCharacter.BP_BaseCharacter_C")
@@ -70,7 +117,8 @@ void AMyBaseGameMode::RespawnActor(APlayerController* PlayerController)
 
     /* Warn if the Blueprint class couldn't be loaded. */
     if (PlayerPawnBPClass) {
-        /* Spawn a new pawn at the specified spawn point. */
+        /* Spawn a new pawn at the specified spawn point, counting its memory under the characters tag. */
+        LLM_SCOPE_BYTAG(Project_Characters);
         APawn* NewCharacter = GetWorld()->SpawnActor<APawn>(
             PlayerPawnBPClass,
             SpawnTransform.GetLocation(),
@@ -83,6 +131,39 @@ void AMyBaseGameMode::RespawnActor(APlayerController* PlayerController)
 
             /* Possess the newly spawned pawn with the PlayerController. */
             PlayerController->Possess(NewCharacter);
+
+            /* Give the player back their health and stamina if a restored snapshot has them. */
+            if (UMyWorldSnapshotSubsystem* Snapshots = GetWorld()->GetSubsystem<UMyWorldSnapshotSubsystem>())
+            {
+                Snapshots->ApplyPendingPlayerState(PlayerController);
+            }
         }
     }
-}
\ No newline at end of file
+}
+
+void AMyBaseGameMode::SetSpawnOccupant(AActor* PlayerStart, uint64 PlayerId)
+{
+    for (auto It = SpawnOccupants.CreateIterator(); It; ++It)
+    {
+        if (It.Value() == PlayerId) { It.RemoveCurrent(); }
+    }
+    SpawnOccupants.Add(PlayerStart, PlayerId);
+}
+
+void AMyBaseGameMode::RestoreSpawnOccupant(AActor* PlayerStart, uint64 PlayerId, bool bSpawnThere)
+{
+    SetSpawnOccupant(PlayerStart, PlayerId);
+    if (bSpawnThere) { RestoredSpawns.Add(PlayerId); }
+}
+
+uint64 AMyBaseGameMode::GetPersistentPlayerId(const AController* Controller)
+{
+    const APlayerState* PlayerState = Controller ? Controller->GetPlayerState<APlayerState>() : nullptr;
+    if (!PlayerState) { return 0; }
+
+    const FString Id = PlayerState->GetUniqueId().IsValid() ? PlayerState->GetUniqueId().ToString() : PlayerState->GetPlayerName();
+    const uint64 Hash = CityHash64(reinterpret_cast<const char*>(*Id), Id.Len() * sizeof(TCHAR));
+
+    /* 0 means "no player". */
+    return Hash != 0 ? Hash : 1;
+}
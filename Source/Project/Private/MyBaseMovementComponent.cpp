@@ -1,5 +1,91 @@
 #include "MyBaseMovementComponent.h"
 #include "GameFramework/Character.h"
+#include "GameFramework/PlayerController.h"
+#include "MyNetStatsSubsystem.h"
+#include "MyBatchedMovementSubsystem.h"
+#include "MyMovementTelemetrySubsystem.h"
+#include "MyMovementAllocTestSubsystem.h"
+#include "MyAllocationCounter.h"
+#include "MyMemoryTags.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/PhysicsVolume.h"
+#include "Serialization/BitWriter.h"
+#include "Serialization/BitReader.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+int64 UMyBaseMovementComponent::NumClientCorrections = 0;
+int64 UMyBaseMovementComponent::NumHeapAllocatedMoves = 0;
+
+// Helpers for the move data sent to the server, see FCharacterNetworkMoveData_MyData.
+namespace MyNetworkMove
+{
+    /* Upper bound of the input bit count written before the inputs; four bits. */
+    static constexpr uint32 MaxInputs = 16;
+    static_assert(static_cast<uint32>(EMyMoveInput::Num) < MaxInputs, "Too many move inputs for the input bit count");
+
+    /* Horizontal acceleration is sent as its size in steps of the max acceleration and its direction in steps of a full turn. */
+    static constexpr uint32 AccelSizeSteps = 255;
+    static constexpr uint32 AccelYawSteps = 1024;
+
+    static uint16 InputBit(EMyMoveInput Input)
+    {
+        return static_cast<uint16>(1 << static_cast<uint8>(Input));
+    }
+
+    static uint32 FloatToBits(float Value)
+    {
+        uint32 Bits;
+        FMemory::Memcpy(&Bits, &Value, sizeof(Bits));
+        return Bits;
+    }
+
+    static float BitsToFloat(uint32 Bits)
+    {
+        float Value;
+        FMemory::Memcpy(&Value, &Bits, sizeof(Value));
+        return Value;
+    }
+
+    /* Maps small negative and positive differences to small unsigned values for SerializeIntPacked. */
+    static uint32 ZigZag(int32 Value)
+    {
+        return (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31);
+    }
+
+    static int32 UnZigZag(uint32 Value)
+    {
+        return static_cast<int32>(Value >> 1) ^ -static_cast<int32>(Value & 1);
+    }
+
+    /* Whether Accel can be sent as size and direction: horizontal and no larger than MaxAccel. */
+    static bool CanQuantizeAcceleration(const FVector& Accel, float MaxAccel)
+    {
+        return MaxAccel > 0.0f && Accel.Z == 0.0 && Accel.SizeSquared2D() <= FMath::Square(MaxAccel * 1.001);
+    }
+
+    static void QuantizeAcceleration(const FVector& Accel, float MaxAccel, uint32& OutSize, uint32& OutYaw)
+    {
+        OutSize = FMath::Min(static_cast<uint32>(FMath::RoundToInt(Accel.Size2D() / MaxAccel * AccelSizeSteps)), AccelSizeSteps);
+        OutYaw = OutSize > 0 ? static_cast<uint32>(FMath::RoundToInt(FMath::Atan2(Accel.Y, Accel.X) / UE_DOUBLE_TWO_PI * AccelYawSteps)) & (AccelYawSteps - 1) : 0;
+    }
+
+    static FVector DequantizeAcceleration(uint32 Size, uint32 Yaw, float MaxAccel)
+    {
+        const double Length = static_cast<double>(Size) / AccelSizeSteps * MaxAccel;
+        const double Angle = static_cast<double>(Yaw) / AccelYawSteps * UE_DOUBLE_TWO_PI;
+        return FVector(Length * FMath::Cos(Angle), Length * FMath::Sin(Angle), 0.0);
+    }
+
+    /* Whether two rotations are the same after FRotator::SerializeCompressedShort. */
+    static bool IsSameCompressedRotation(const FRotator& A, const FRotator& B)
+    {
+        return FRotator::CompressAxisToShort(A.Pitch) == FRotator::CompressAxisToShort(B.Pitch)
+            && FRotator::CompressAxisToShort(A.Yaw) == FRotator::CompressAxisToShort(B.Yaw)
+            && FRotator::CompressAxisToShort(A.Roll) == FRotator::CompressAxisToShort(B.Roll);
+    }
+}
 
 UMyBaseMovementComponent::UMyBaseMovementComponent()
 {
@@ -16,19 +102,47 @@ UMyBaseMovementComponent::UMyBaseMovementComponent()
     // Initialized to false so the character begins walking by default.
     Safe_bWantsToSprint = false;
 
-    // Movement speed when sprinting.
-    SprintSpeed = 500.0f;
+    // Moved by its own tick until UMyBatchedMovementSubsystem takes over.
+    bBatchedMovement = false;
 
-    // Movement speed when walking normally (not sprinting).
-    WalkSpeed = 250.0f;
+    // Walk, sprint and crouch speeds; instances copy the tuning from their archetype.
+    if (HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+    {
+        Tuning = UMyCharacterTuning::LoadDefault();
+    }
 
     //  Movement speed when crouch walking
-    MaxWalkSpeedCrouched = 250.0f;
+    MaxWalkSpeedCrouched = GetTuning().CrouchSpeed;
+
+    // Send and receive moves with our compact move data instead of the engine's.
+    SetNetworkMoveDataContainer(MyNetworkMoveDataContainer);
+}
+
+void UMyBaseMovementComponent::BeginPlay()
+{
+    Super::BeginPlay();
+
+    if (UMyBatchedMovementSubsystem* BatchedMovement = GetWorld()->GetSubsystem<UMyBatchedMovementSubsystem>())
+    {
+        BatchedMovement->Register(this);
+    }
+}
+
+void UMyBaseMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UMyBatchedMovementSubsystem* BatchedMovement = GetWorld()->GetSubsystem<UMyBatchedMovementSubsystem>())
+    {
+        BatchedMovement->Unregister(this);
+    }
+
+    Super::EndPlay(EndPlayReason);
 }
 
 
 FNetworkPredictionData_Client* UMyBaseMovementComponent::GetPredictionData_Client() const
 {
+    LLM_SCOPE_BYTAG(Project_Movement);
+
     // Ensure the movement component has a valid owning pawn.
     // Prediction data is always tied to a specific character/pawn,
     // so this must not be null at this point.
@@ -51,6 +165,7 @@ FNetworkPredictionData_Client* UMyBaseMovementComponent::GetPredictionData_Clien
         // - MaxSmoothNetUpdateDist: maximum distance the character can be corrected smoothly.
         //   Beyond this, the correction will cause a hard snap.
         // - NoSmoothNetUpdateDist: distance beyond which no smoothing is attempted at all.
+        //   On clients SmoothCorrection replaces these with the adaptive values of the connection.
         MutableThis->ClientPredictionData->MaxSmoothNetUpdateDist = 92.f;
         MutableThis->ClientPredictionData->NoSmoothNetUpdateDist = 140.f;
     }
@@ -60,14 +175,126 @@ FNetworkPredictionData_Client* UMyBaseMovementComponent::GetPredictionData_Clien
 }
 
 
-void UMyBaseMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+void UMyBaseMovementComponent::ClientAdjustPosition_Implementation(float TimeStamp, FVector NewLoc, FVector NewVel, UPrimitiveComponent* NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode, TOptional<FRotator> OptionalRotation)
+{
+    // Counted for the backend comparison in Project.Mover.Bench.
+    ++NumClientCorrections;
+
+    if (UMyMovementTelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UMyMovementTelemetrySubsystem>())
+    {
+        // The new location may be relative to the movement base.
+        FVector WorldLocation = NewLoc;
+        if (bBaseRelativePosition)
+        {
+            MovementBaseUtility::TransformLocationToWorld(NewBase, NewBaseBoneName, NewLoc, WorldLocation);
+        }
+        Telemetry->RecordCorrection(Cast<APlayerController>(CharacterOwner->GetController()), FVector::Dist(UpdatedComponent->GetComponentLocation(), WorldLocation));
+    }
+
+    Super::ClientAdjustPosition_Implementation(TimeStamp, NewLoc, NewVel, NewBase, NewBaseBoneName, bHasBase, bBaseRelativePosition, ServerMovementMode, OptionalRotation);
+}
+
+void UMyBaseMovementComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    LLM_SCOPE_BYTAG(Project_Movement);
+
+    // Only a locally controlled character on a client saves and sends moves here.
+    const bool bClientMove = CharacterOwner && CharacterOwner->GetLocalRole() == ROLE_AutonomousProxy;
+    UMyMovementAllocTestSubsystem::FScope AllocScope(this, bClientMove ? EMyMovementAllocPath::ClientMove : EMyMovementAllocPath::Num);
+
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+}
+
+void UMyBaseMovementComponent::ServerMovePacked_ClientSend(const FCharacterServerMovePackedBits& PackedBits)
+{
+    // Bunches and packets belong to the net driver, not to the movement path.
+    FMyAllocationCounter::FPause AllocPause;
+
+    Super::ServerMovePacked_ClientSend(PackedBits);
+}
+
+void UMyBaseMovementComponent::ServerMovePacked_ServerReceive(const FCharacterServerMovePackedBits& PackedBits)
+{
+    LLM_SCOPE_BYTAG(Project_Movement);
+
+    UMyMovementAllocTestSubsystem::FScope AllocScope(this, EMyMovementAllocPath::ServerMove);
+
+    Super::ServerMovePacked_ServerReceive(PackedBits);
+}
+
+void UMyBaseMovementComponent::MoveResponsePacked_ClientReceive(const FCharacterMoveResponsePackedBits& PackedBits)
+{
+    UMyMovementAllocTestSubsystem::FScope AllocScope(this, EMyMovementAllocPath::ClientAck);
+
+    Super::MoveResponsePacked_ClientReceive(PackedBits);
+}
+
+bool UMyBaseMovementComponent::ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientWorldLocation, const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode)
 {
-    // First, call the base implementation to handle built-in flags.
-    Super::UpdateFromCompressedFlags(Flags);
+    const bool bNeedsCorrection = Super::ServerCheckClientError(ClientTimeStamp, DeltaTime, Accel, ClientWorldLocation, RelativeClientLocation, ClientMovementBase, ClientBaseBoneName, ClientMovementMode);
+
+    // Replayed moves (ReplayRecordedMove) have no player and are not counted.
+    if (bNeedsCorrection)
+    {
+        if (UMyMovementTelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UMyMovementTelemetrySubsystem>())
+        {
+            Telemetry->RecordCorrection(Cast<APlayerController>(CharacterOwner->GetController()), FVector::Dist(UpdatedComponent->GetComponentLocation(), ClientWorldLocation));
+        }
+    }
 
-    // Our custom sprint flag is stored in FLAG_Custom_0.
-    // Safe_bWantsToSprint is updated from the replicated bit.
-    Safe_bWantsToSprint = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+    return bNeedsCorrection;
+}
+
+void UMyBaseMovementComponent::SmoothCorrection(const FVector& OldLocation, const FQuat& OldRotation, const FVector& NewLocation, const FQuat& NewRotation)
+{
+    // Listen servers smooth with their own data; only simulated proxies on clients use the client prediction data.
+    if (GetNetMode() == NM_Client && NetworkSmoothingMode != ENetworkSmoothingMode::Disabled && HasValidData())
+    {
+        if (UMyMovementTelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UMyMovementTelemetrySubsystem>())
+        {
+            const FMyAdaptiveMoveSettings& Settings = Telemetry->GetAdaptiveSettings();
+
+            FNetworkPredictionData_Client_Character* ClientData = GetPredictionData_Client_Character();
+            ClientData->MaxSmoothNetUpdateDist = Settings.MaxSmoothNetUpdateDist;
+            ClientData->NoSmoothNetUpdateDist = Settings.NoSmoothNetUpdateDist;
+
+            Telemetry->RecordSmoothing(FVector::Dist(OldLocation, NewLocation), Settings.MaxSmoothNetUpdateDist, Settings.NoSmoothNetUpdateDist);
+        }
+    }
+
+    Super::SmoothCorrection(OldLocation, OldRotation, NewLocation, NewRotation);
+}
+
+float UMyBaseMovementComponent::GetClientNetSendDeltaTime(const APlayerController* PC, const FNetworkPredictionData_Client_Character* ClientData, const FSavedMovePtr& NewMove) const
+{
+    const float NetSendDeltaTime = Super::GetClientNetSendDeltaTime(PC, ClientData, NewMove);
+
+    const UMyMovementTelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UMyMovementTelemetrySubsystem>();
+    if (!Telemetry)
+    {
+        return NetSendDeltaTime;
+    }
+
+    // Moves waiting to be sent are combined, so this means fewer and larger ServerMoves.
+    // ReplicateMoveToServer still clamps the result to at most 1/5 s.
+    return NetSendDeltaTime * Telemetry->GetAdaptiveSettings().SendDeltaTimeScale;
+}
+
+// Keeps client and server acceleration identical: the server decodes exactly what this returns.
+FVector UMyBaseMovementComponent::RoundAcceleration(FVector InAccel) const
+{
+    const FVector Rounded = Super::RoundAcceleration(InAccel);
+
+    const float MaxAccel = GetMaxAcceleration();
+    if (!MyNetworkMove::CanQuantizeAcceleration(Rounded, MaxAccel))
+    {
+        return Rounded;
+    }
+
+    uint32 Size = 0;
+    uint32 Yaw = 0;
+    MyNetworkMove::QuantizeAcceleration(Rounded, MaxAccel, Size, Yaw);
+    return MyNetworkMove::DequantizeAcceleration(Size, Yaw, MaxAccel);
 }
 
 void UMyBaseMovementComponent::OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity)
@@ -78,23 +305,56 @@ void UMyBaseMovementComponent::OnMovementUpdated(float DeltaSeconds, const FVect
     // floor detection, or collision handling.
     Super::OnMovementUpdated(DeltaSeconds, OldLocation, OldVelocity);
 
+    // The engine reads the crouch speed itself; keep it in step with the tuning.
+    MaxWalkSpeedCrouched = GetTuning().CrouchSpeed;
+
     // Only apply sprinting/walking logic when the character is in the Walking movement mode.
     if (MovementMode == MOVE_Walking)
     {
         // If the character has flagged that it wants to sprint,
-        // raise the maximum walking speed to the SprintSpeed value.
+        // raise the maximum walking speed to the tuning's SprintSpeed value.
+        // The tuning is read every update, so changes to it apply to running characters.
         if (Safe_bWantsToSprint)
         {
-            MaxWalkSpeed = SprintSpeed;
+            MaxWalkSpeed = GetTuning().SprintSpeed;
         }
         // Otherwise, default to the standard walking speed.
         else
         {
-            MaxWalkSpeed = WalkSpeed;
+            MaxWalkSpeed = GetTuning().WalkSpeed;
         }
     }
 }
 
+void UMyBaseMovementComponent::ServerMove_PerformMovement(const FCharacterNetworkMoveData& MoveData)
+{
+    // Moves arrive through MyNetworkMoveDataContainer, so they are always our move data.
+    const FCharacterNetworkMoveData_MyData& MyMoveData = static_cast<const FCharacterNetworkMoveData_MyData&>(MoveData);
+
+    // The engine applies jump and crouch from the compressed flags in MoveAutonomous; sprint is ours.
+    Safe_bWantsToSprint = MyMoveData.HasInput(EMyMoveInput::Sprint);
+
+    // Only pay for the size estimate when accounting is enabled.
+    if (UMyNetStatsSubsystem::GetIfEnabled(this))
+    {
+        // Serialize a copy without the movement base, which would need the connection's package map.
+        // The base reference is added back as an estimated NetGUID.
+        // Pending and old moves are measured on their own, without the savings of being relative to the new move.
+        FCharacterNetworkMoveData_MyData MoveCopy = MyMoveData;
+        MoveCopy.MovementBase = nullptr;
+
+        FNetBitWriter Writer(nullptr, 256);
+        MoveCopy.Serialize(*this, Writer, nullptr, MoveData.NetworkMoveType);
+
+        const int64 PayloadBits = Writer.GetNumBits() + (MoveData.MovementBase ? 32 : 0);
+        const bool bSprinting = MyMoveData.HasInput(EMyMoveInput::Sprint);
+
+        UMyNetStatsSubsystem::RecordServerMove(this, bSprinting ? FName(TEXT("ServerMove_Sprint")) : FName(TEXT("ServerMove")), PayloadBits);
+    }
+
+    Super::ServerMove_PerformMovement(MoveData);
+}
+
 bool UMyBaseMovementComponent::FSavedMove_MyMove::CanCombineWith(const FSavedMovePtr& NewMove,ACharacter* InCharacter, float MaxDelta) const
 {
     // Cast the generic FSavedMovePtr into our custom FSavedMove_MyMove type
@@ -120,19 +380,19 @@ void UMyBaseMovementComponent::FSavedMove_MyMove::Clear()
 {
     FSavedMove_Character::Clear();
 
-    /* Reset the flag. */
+    /* Reset the flags. */
     Saved_bWantsToSprint = 0;
+    Saved_bStartCrouched = 0;
 }
 
-// Packs our sprint state into the compressed flag byte.
-uint8 UMyBaseMovementComponent::FSavedMove_MyMove::GetCompressedFlags() const
+// Collects the inputs FCharacterNetworkMoveData_MyData sends for this move.
+uint16 UMyBaseMovementComponent::FSavedMove_MyMove::GetInputs() const
 {
-    uint8 Result = Super::GetCompressedFlags();
+    uint16 Result = 0;
 
-    // If we are sprinting
-    if (Saved_bWantsToSprint)
-        // Use the first custom flag slot
-        Result |= FLAG_Custom_0;
+    if (bPressedJump) { Result |= MyNetworkMove::InputBit(EMyMoveInput::Jump); }
+    if (bWantsToCrouch) { Result |= MyNetworkMove::InputBit(EMyMoveInput::Crouch); }
+    if (Saved_bWantsToSprint) { Result |= MyNetworkMove::InputBit(EMyMoveInput::Sprint); }
 
     return Result;
 }
@@ -148,6 +408,9 @@ void UMyBaseMovementComponent::FSavedMove_MyMove::SetMoveFor(ACharacter* C, floa
 
     // Save whether sprinting was active for this move.
     Saved_bWantsToSprint = CharacterMovement->Safe_bWantsToSprint;
+
+    // Save the crouch state the move starts from, for the move recorder.
+    Saved_bStartCrouched = C->bIsCrouched;
 }
 
 // Applies this saved move back onto the character (used during replay/resimulation).
@@ -162,20 +425,274 @@ void UMyBaseMovementComponent::FSavedMove_MyMove::PrepMoveFor(ACharacter* C)
     CharacterMovement->Safe_bWantsToSprint = Saved_bWantsToSprint;
 }
 
+// Records the move once it has been performed for the first time.
+void UMyBaseMovementComponent::FSavedMove_MyMove::PostUpdate(ACharacter* C, EPostUpdateMode PostUpdateMode)
+{
+    Super::PostUpdate(C, PostUpdateMode);
+
+    /* Replays after a correction are not new input. */
+    if (PostUpdateMode != PostUpdate_Record) { return; }
+
+    UMyBaseMovementComponent* CharacterMovement = Cast<UMyBaseMovementComponent>(C->GetCharacterMovement());
+
+    if (CharacterMovement->MoveRecording)
+    {
+        CharacterMovement->RecordMove(*this);
+    }
+}
+
+// A combined move replaces the older move, which was already recorded.
+void UMyBaseMovementComponent::FSavedMove_MyMove::CombineWith(const FSavedMove_Character* OldMove, ACharacter* InCharacter, APlayerController* PC, const FVector& OldStartLocation)
+{
+    Super::CombineWith(OldMove, InCharacter, PC, OldStartLocation);
+
+    UMyBaseMovementComponent* CharacterMovement = Cast<UMyBaseMovementComponent>(InCharacter->GetCharacterMovement());
+
+    if (CharacterMovement->MoveRecording)
+    {
+        CharacterMovement->DropRecordedMove(OldMove->TimeStamp);
+    }
+}
+
 // Constructor  just forwards to parent class.
 UMyBaseMovementComponent::FNetworkPredictionData_Client_MyData::FNetworkPredictionData_Client_MyData(const UCharacterMovementComponent& ClientMovement)
     : Super(ClientMovement)
 {
 }
 
+// The base class would release these after MovePool is gone.
+UMyBaseMovementComponent::FNetworkPredictionData_Client_MyData::~FNetworkPredictionData_Client_MyData()
+{
+    SavedMoves.Empty();
+    FreeMoves.Empty();
+    PendingMove.Reset();
+    LastAckedMove.Reset();
+}
+
 // Allocate a new instance of our custom saved move class.
 // This is used by the network prediction system to record
 // and replay client movement input for reconciliation.
+// Simulated proxies also have prediction data but never save moves, so the pool is only made for the first move.
 FSavedMovePtr UMyBaseMovementComponent::FNetworkPredictionData_Client_MyData::AllocateNewMove()
 {
+    if (!MovePool)
+    {
+        // A full SavedMoves list plus the pending, last acked and newest move.
+        const int32 MovePoolSize = MaxSavedMoveCount + 3;
+        MovePool = MakeUnique<FSavedMove_MyMove[]>(MovePoolSize);
+
+        // FreeMove() drops moves once FreeMoves holds MaxFreeMoveCount; pooled moves must always go back.
+        MaxFreeMoveCount = FMath::Max(MaxFreeMoveCount, MovePoolSize);
+        FreeMoves.Reserve(MaxFreeMoveCount);
+        SavedMoves.Reserve(MaxSavedMoveCount);
+
+        // The pool owns the moves; the shared pointers only pass them around and never delete them.
+        // Their reference counts are allocated here too, so handing moves out later allocates nothing.
+        for (int32 Index = MovePoolSize - 1; Index > 0; --Index)
+        {
+            FreeMoves.Push(FSavedMovePtr(&MovePool[Index], [](FSavedMove_Character*) {}));
+        }
+        return FSavedMovePtr(&MovePool[0], [](FSavedMove_Character*) {});
+    }
+
+    // Every pooled move is in use, e.g. after a long stall without acks.
+    ++NumHeapAllocatedMoves;
     return FSavedMovePtr(new FSavedMove_MyMove);
 }
 
+bool UMyBaseMovementComponent::FCharacterNetworkMoveData_MyData::HasInput(EMyMoveInput Input) const
+{
+    return (Inputs & MyNetworkMove::InputBit(Input)) != 0;
+}
+
+void UMyBaseMovementComponent::FCharacterNetworkMoveData_MyData::ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType)
+{
+    Super::ClientFillNetworkMoveData(ClientMove, MoveType);
+
+    // Our prediction data only allocates FSavedMove_MyMove.
+    Inputs = static_cast<const FSavedMove_MyMove&>(ClientMove).GetInputs();
+}
+
+bool UMyBaseMovementComponent::FCharacterNetworkMoveData_MyData::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType)
+{
+    return SerializeRelative(CharacterMovement, Ar, PackageMap, MoveType, nullptr);
+}
+
+// Layout, with Reference-only fields in brackets:
+//   time stamp       32 bits, [or the packed difference of its bit pattern to the reference's]
+//   acceleration     [1 bit same], 1 bit quantized, then 8 bit size + 10 bit direction or FVector_NetQuantize10
+//   control rotation [1 bit same], FRotator compressed shorts
+//   inputs           [1 bit same], 4 bit count, one bit per EMyMoveInput
+//   new move only    location, movement base, bone name and movement mode, as the engine writes them
+bool UMyBaseMovementComponent::FCharacterNetworkMoveData_MyData::SerializeRelative(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType, const FCharacterNetworkMoveData_MyData* Reference)
+{
+    NetworkMoveType = MoveType;
+
+    bool bLocalSuccess = true;
+    const bool bIsSaving = Ar.IsSaving();
+
+    // The client looks up acknowledged moves by time stamp, so it has to arrive exactly.
+    // Moves of one packet are a few frames apart, which keeps the difference of the float bits small.
+    if (Reference)
+    {
+        const uint32 ReferenceBits = MyNetworkMove::FloatToBits(Reference->TimeStamp);
+
+        uint32 Delta = bIsSaving ? MyNetworkMove::ZigZag(static_cast<int32>(ReferenceBits - MyNetworkMove::FloatToBits(TimeStamp))) : 0;
+        Ar.SerializeIntPacked(Delta);
+
+        if (!bIsSaving)
+        {
+            TimeStamp = MyNetworkMove::BitsToFloat(ReferenceBits - static_cast<uint32>(MyNetworkMove::UnZigZag(Delta)));
+        }
+    }
+    else
+    {
+        Ar << TimeStamp;
+    }
+
+    uint8 bSameAcceleration = (bIsSaving && Reference && Acceleration == Reference->Acceleration) ? 1 : 0;
+    if (Reference)
+    {
+        Ar.SerializeBits(&bSameAcceleration, 1);
+    }
+
+    if (bSameAcceleration)
+    {
+        Acceleration = Reference->Acceleration;
+    }
+    else
+    {
+        // Horizontal acceleration within the max acceleration was rounded to these steps by RoundAcceleration().
+        const float MaxAccel = CharacterMovement.GetMaxAcceleration();
+
+        uint8 bQuantized = (bIsSaving && MyNetworkMove::CanQuantizeAcceleration(Acceleration, MaxAccel)) ? 1 : 0;
+        Ar.SerializeBits(&bQuantized, 1);
+
+        if (bQuantized)
+        {
+            uint32 Size = 0;
+            uint32 Yaw = 0;
+            if (bIsSaving)
+            {
+                MyNetworkMove::QuantizeAcceleration(Acceleration, MaxAccel, Size, Yaw);
+            }
+
+            Ar.SerializeInt(Size, MyNetworkMove::AccelSizeSteps + 1);
+            if (Size > 0)
+            {
+                Ar.SerializeInt(Yaw, MyNetworkMove::AccelYawSteps);
+            }
+
+            if (!bIsSaving)
+            {
+                Acceleration = MyNetworkMove::DequantizeAcceleration(Size, Yaw, MaxAccel);
+            }
+        }
+        else
+        {
+            Acceleration.NetSerialize(Ar, PackageMap, bLocalSuccess);
+        }
+    }
+
+    uint8 bSameRotation = (bIsSaving && Reference && MyNetworkMove::IsSameCompressedRotation(ControlRotation, Reference->ControlRotation)) ? 1 : 0;
+    if (Reference)
+    {
+        Ar.SerializeBits(&bSameRotation, 1);
+    }
+
+    if (bSameRotation)
+    {
+        ControlRotation = Reference->ControlRotation;
+    }
+    else
+    {
+        ControlRotation.SerializeCompressedShort(Ar);
+    }
+
+    uint8 bSameInputs = (bIsSaving && Reference && Inputs == Reference->Inputs) ? 1 : 0;
+    if (Reference)
+    {
+        Ar.SerializeBits(&bSameInputs, 1);
+    }
+
+    if (bSameInputs)
+    {
+        Inputs = Reference->Inputs;
+    }
+    else
+    {
+        // The count comes first so moves from builds with more or fewer inputs can still be read:
+        // inputs this build doesn't know are dropped, inputs the sender didn't know read as not pressed.
+        uint32 NumInputs = static_cast<uint32>(EMyMoveInput::Num);
+        Ar.SerializeInt(NumInputs, MyNetworkMove::MaxInputs);
+
+        uint32 InputBits = Inputs;
+        Ar.SerializeBits(&InputBits, NumInputs);
+
+        if (!bIsSaving)
+        {
+            Inputs = static_cast<uint16>(InputBits & ((1u << static_cast<uint32>(EMyMoveInput::Num)) - 1));
+        }
+    }
+
+    // MoveAutonomous still applies jump and crouch from the compressed flags.
+    if (!bIsSaving)
+    {
+        CompressedMoveFlags = static_cast<uint8>((HasInput(EMyMoveInput::Jump) ? FSavedMove_Character::FLAG_JumpPressed : 0)
+            | (HasInput(EMyMoveInput::Crouch) ? FSavedMove_Character::FLAG_WantsToCrouch : 0));
+    }
+
+    if (MoveType == ENetworkMoveType::NewMove)
+    {
+        // Location, relative movement base, and ending movement mode are only used for error checking, so only the final move has them.
+        Location.NetSerialize(Ar, PackageMap, bLocalSuccess);
+        SerializeOptionalValue<UPrimitiveComponent*>(bIsSaving, Ar, MovementBase, nullptr);
+        SerializeOptionalValue<FName>(bIsSaving, Ar, MovementBaseBoneName, NAME_None);
+        SerializeOptionalValue<uint8>(bIsSaving, Ar, MovementMode, MOVE_Walking);
+    }
+
+    return !Ar.IsError();
+}
+
+UMyBaseMovementComponent::FCharacterNetworkMoveDataContainer_MyData::FCharacterNetworkMoveDataContainer_MyData()
+{
+    SetNetworkMoveDataReferences(MyMoveData[0], MyMoveData[1], MyMoveData[2]);
+}
+
+bool UMyBaseMovementComponent::FCharacterNetworkMoveDataContainer_MyData::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap)
+{
+    FCharacterNetworkMoveData_MyData& NewMove = MyMoveData[0];
+    if (!NewMove.SerializeRelative(CharacterMovement, Ar, PackageMap, FCharacterNetworkMoveData::ENetworkMoveType::NewMove, nullptr))
+    {
+        return false;
+    }
+
+    // Optional pending dual move
+    Ar.SerializeBits(&bHasPendingMove, 1);
+    if (bHasPendingMove)
+    {
+        Ar.SerializeBits(&bIsDualHybridRootMotionMove, 1);
+        if (!MyMoveData[1].SerializeRelative(CharacterMovement, Ar, PackageMap, FCharacterNetworkMoveData::ENetworkMoveType::PendingMove, &NewMove))
+        {
+            return false;
+        }
+    }
+
+    // Optional old move
+    Ar.SerializeBits(&bHasOldMove, 1);
+    if (bHasOldMove)
+    {
+        if (!MyMoveData[2].SerializeRelative(CharacterMovement, Ar, PackageMap, FCharacterNetworkMoveData::ENetworkMoveType::OldMove, &NewMove))
+        {
+            return false;
+        }
+    }
+
+    Ar.SerializeBits(&bDisableCombinedScopedMove, 1);
+
+    return !Ar.IsError();
+}
+
 // Called when the player starts sprinting.
 // Sets the sprint flag so that our movement code knows to apply sprint speed.
 // Also forces crouching off, since sprinting and crouching are mutually exclusive.
@@ -223,4 +740,416 @@ void UMyBaseMovementComponent::StopCrouching()
     if (!bWantsToCrouch) { return; }
 
     bWantsToCrouch = false;
-}
\ No newline at end of file
+}
+
+// Batched movement is only used where nothing else depends on this component's own tick:
+// no player (no saved moves or corrections), no root motion, no jump to process and no moving base to follow.
+bool UMyBaseMovementComponent::CanUseBatchedMovement() const
+{
+    if (!HasValidData() || !IsActive() || CharacterOwner->GetLocalRole() != ROLE_Authority) { return false; }
+
+    if (CharacterOwner->IsPlayerControlled() || CharacterOwner->bPressedJump) { return false; }
+
+    if (MovementMode != MOVE_Walking && MovementMode != MOVE_Falling) { return false; }
+
+    if (HasAnimRootMotion() || CurrentRootMotion.HasActiveRootMotionSources()) { return false; }
+
+    return !MovementBaseUtility::IsDynamicBase(GetMovementBase());
+}
+
+// The batch moves the character, so our own tick is turned off while batched.
+// Otherwise it would be moved twice per frame.
+void UMyBaseMovementComponent::SetBatchedMovement(bool bEnable)
+{
+    if (bBatchedMovement == bEnable) { return; }
+
+    bBatchedMovement = bEnable;
+    SetComponentTickEnabled(!bEnable);
+}
+
+// Returns whether UMyBatchedMovementSubsystem currently moves this component.
+bool UMyBaseMovementComponent::IsBatchedMovement() const
+{
+    return bBatchedMovement;
+}
+
+// Runs on the game thread before the batch.
+// Does what PerformMovement does before moving, then copies the state the move needs.
+void UMyBaseMovementComponent::GatherBatchedMove(float DeltaTime, FMyBatchedMoveInput& OutInput)
+{
+    /* Crouch and uncrouch resize the capsule, so they happen before the location is copied. */
+    UpdateCharacterStateBeforeMovement(DeltaTime);
+
+    Acceleration = ScaleInputAcceleration(ConstrainInputAcceleration(ConsumeInputVector()));
+    AnalogInputModifier = ComputeAnalogInputModifier();
+
+    float CapsuleRadius = 0.0f;
+    float CapsuleHalfHeight = 0.0f;
+    CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleSize(CapsuleRadius, CapsuleHalfHeight);
+
+    OutInput.DeltaTime = DeltaTime;
+    OutInput.Location = UpdatedComponent->GetComponentLocation();
+    OutInput.Velocity = Velocity;
+    OutInput.Acceleration = Acceleration;
+    OutInput.bFalling = IsFalling();
+
+    OutInput.RequestedVelocity = RequestedVelocity;
+    OutInput.RequestedSpeed = bRequestedMoveWithMaxSpeed ? GetMaxSpeed() : RequestedVelocity.Size();
+    OutInput.bHasRequestedVelocity = bHasRequestedVelocity;
+
+    /* MaxWalkSpeed was set from the sprint flag by the last OnMovementUpdated, as in the normal path. */
+    OutInput.MaxSpeed = GetMaxSpeed();
+    OutInput.MaxAcceleration = GetMaxAcceleration();
+    OutInput.BrakingDeceleration = GetMaxBrakingDeceleration();
+    OutInput.GroundFriction = GroundFriction;
+    OutInput.BrakingFriction = FMath::Max(0.0f, (bUseSeparateBrakingFriction ? BrakingFriction : GroundFriction) * BrakingFrictionFactor);
+    OutInput.AirControl = AirControl;
+    OutInput.GravityZ = GetGravityZ();
+    OutInput.TerminalVelocity = GetPhysicsVolume()->TerminalVelocity;
+    OutInput.MaxStepHeight = MaxStepHeight;
+    OutInput.WalkableFloorZ = GetWalkableFloorZ();
+
+    OutInput.CapsuleRadius = CapsuleRadius;
+    OutInput.CapsuleHalfHeight = CapsuleHalfHeight;
+    OutInput.CollisionChannel = UpdatedComponent->GetCollisionObjectType();
+    OutInput.QueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(MyBatchedMove), false, CharacterOwner);
+    OutInput.ResponseParams = FCollisionResponseParams();
+    UpdatedPrimitive->InitSweepCollisionParams(OutInput.QueryParams, OutInput.ResponseParams);
+}
+
+// Runs on the game thread after the batch.
+// Does what PerformMovement does after moving, including our OnMovementUpdated.
+void UMyBaseMovementComponent::ApplyBatchedMove(const FMyBatchedMoveInput& Input, const FMyBatchedMoveResult& Result)
+{
+    const float DeltaTime = Input.DeltaTime;
+
+    /* The sweeps were done by the batch, so the capsule is placed without sweeping again. */
+    UpdatedComponent->SetWorldLocation(Result.Location, false, nullptr, ETeleportType::None);
+    Velocity = Result.Velocity;
+
+    if (Result.bWalkableFloor)
+    {
+        CurrentFloor.SetFromSweep(Result.FloorHit, Result.FloorDistance, true);
+    }
+    else
+    {
+        CurrentFloor.Clear();
+    }
+
+    /* Landing goes through ProcessLanded so the character gets its Landed() event. No time is left to simulate. */
+    if (Result.bLanded)
+    {
+        ProcessLanded(Result.FloorHit, 0.0f, 0);
+    }
+    else if (Result.bFalling && !IsFalling())
+    {
+        SetMovementMode(MOVE_Falling);
+    }
+
+    if (IsMovingOnGround())
+    {
+        SetBaseFromFloor(CurrentFloor);
+    }
+
+    PhysicsRotation(DeltaTime);
+
+    UpdateCharacterStateAfterMovement(DeltaTime);
+
+    /* Sprint speed is applied here, the same as after a normal move. */
+    OnMovementUpdated(DeltaTime, Input.Location, Input.Velocity);
+    CallMovementUpdateDelegate(DeltaTime, Input.Location, Input.Velocity);
+
+    SaveBaseLocation();
+    UpdateComponentVelocity();
+
+    /* Path following asks again every frame. */
+    bHasRequestedVelocity = false;
+
+    LastUpdateLocation = UpdatedComponent->GetComponentLocation();
+    LastUpdateRotation = UpdatedComponent->GetComponentQuat();
+    LastUpdateVelocity = Velocity;
+}
+
+// Runs on the game thread between gather and apply.
+// GatherBatchedMove already did what ControlledCharacterMove does before PerformMovement, so this is the stock move.
+void UMyBaseMovementComponent::RunReferenceMove(const FMyBatchedMoveInput& Input, FMyBatchedMoveResult& OutResult)
+{
+    /* Everything PerformMovement may change that the batched move and apply rely on. */
+    const FVector SavedLocation = UpdatedComponent->GetComponentLocation();
+    const FQuat SavedRotation = UpdatedComponent->GetComponentQuat();
+    const FVector SavedVelocity = Velocity;
+    const FVector SavedAcceleration = Acceleration;
+    const FVector SavedRequestedVelocity = RequestedVelocity;
+    const bool bSavedHasRequestedVelocity = bHasRequestedVelocity;
+    const TEnumAsByte<EMovementMode> SavedMovementMode = MovementMode;
+    const FFindFloorResult SavedFloor = CurrentFloor;
+    const float SavedMaxWalkSpeed = MaxWalkSpeed;
+    const FVector SavedLastUpdateLocation = LastUpdateLocation;
+    const FQuat SavedLastUpdateRotation = LastUpdateRotation;
+    const FVector SavedLastUpdateVelocity = LastUpdateVelocity;
+
+    PerformMovement(Input.DeltaTime);
+
+    OutResult.Location = UpdatedComponent->GetComponentLocation();
+    OutResult.Velocity = Velocity;
+    OutResult.bFalling = IsFalling();
+    OutResult.bLanded = Input.bFalling && !OutResult.bFalling;
+    OutResult.bWalkableFloor = CurrentFloor.IsWalkableFloor();
+    OutResult.FloorDistance = CurrentFloor.FloorDist;
+    OutResult.FloorHit = CurrentFloor.HitResult;
+
+    /* Back to the gathered state; ApplyBatchedMove then moves the character as if this never ran. */
+    UpdatedComponent->SetWorldLocationAndRotation(SavedLocation, SavedRotation, false, nullptr, ETeleportType::TeleportPhysics);
+    if (MovementMode != SavedMovementMode)
+    {
+        SetMovementMode(SavedMovementMode);
+    }
+    Velocity = SavedVelocity;
+    Acceleration = SavedAcceleration;
+    RequestedVelocity = SavedRequestedVelocity;
+    bHasRequestedVelocity = bSavedHasRequestedVelocity;
+    CurrentFloor = SavedFloor;
+    MaxWalkSpeed = SavedMaxWalkSpeed;
+    LastUpdateLocation = SavedLastUpdateLocation;
+    LastUpdateRotation = SavedLastUpdateRotation;
+    LastUpdateVelocity = SavedLastUpdateVelocity;
+    UpdateComponentVelocity();
+}
+
+// Starts a new recording, dropping any previous one.
+void UMyBaseMovementComponent::StartRecording()
+{
+    LLM_SCOPE_BYTAG(Project_Movement);
+
+    MoveRecording = MakeUnique<FMyMoveRecording>();
+    MoveRecording->MapName = GetWorld()->GetMapName();
+    MoveRecording->CharacterClassPath = CharacterOwner->GetClass()->GetPathName();
+
+    CombinedMoveStart.Reset();
+}
+
+// Writes the recording to disk and stops recording.
+int32 UMyBaseMovementComponent::StopRecording(const FString& FilePath)
+{
+    if (!MoveRecording) { return -1; }
+
+    const TUniquePtr<FMyMoveRecording> Recording = MoveTemp(MoveRecording);
+    CombinedMoveStart.Reset();
+
+    return Recording->SaveToFile(FilePath) ? Recording->Moves.Num() : -1;
+}
+
+// Returns whether moves are being recorded.
+bool UMyBaseMovementComponent::IsRecording() const
+{
+    return MoveRecording.IsValid();
+}
+
+// Copies what ServerMove would receive, plus the client's start and end state.
+void UMyBaseMovementComponent::RecordMove(const FSavedMove_MyMove& Move)
+{
+    LLM_SCOPE_BYTAG(Project_Movement);
+
+    FMyRecordedMove& Recorded = MoveRecording->Moves.AddDefaulted_GetRef();
+
+    Recorded.TimeStamp = Move.TimeStamp;
+    Recorded.DeltaTime = Move.DeltaTime;
+    Recorded.Acceleration = FVector3f(Move.Acceleration);
+    Recorded.CompressedFlags = Move.GetCompressedFlags();
+    Recorded.Inputs = Move.GetInputs();
+    Recorded.bStartCrouched = Move.Saved_bStartCrouched;
+    Recorded.StartMovementMode = Move.StartPackedMovementMode;
+    Recorded.EndMovementMode = Move.EndPackedMovementMode;
+    Recorded.StartLocation = FVector3f(Move.StartLocation);
+    Recorded.StartVelocity = FVector3f(Move.StartVelocity);
+    Recorded.StartRotation = FRotator3f(Move.StartRotation);
+    Recorded.ControlRotation = FRotator3f(Move.SavedControlRotation);
+    Recorded.EndLocation = FVector3f(Move.SavedLocation);
+    Recorded.EndVelocity = FVector3f(Move.SavedVelocity);
+
+    /* A combined move starts where the move it replaced started. */
+    if (CombinedMoveStart.IsSet())
+    {
+        const FMyRecordedMove& Start = CombinedMoveStart.GetValue();
+        Recorded.bStartCrouched = Start.bStartCrouched;
+        Recorded.StartMovementMode = Start.StartMovementMode;
+        Recorded.StartLocation = Start.StartLocation;
+        Recorded.StartVelocity = Start.StartVelocity;
+        Recorded.StartRotation = Start.StartRotation;
+
+        CombinedMoveStart.Reset();
+    }
+}
+
+// Called when an already recorded pending move is combined into a new one.
+void UMyBaseMovementComponent::DropRecordedMove(float TimeStamp)
+{
+    TArray<FMyRecordedMove>& Moves = MoveRecording->Moves;
+
+    if (Moves.Num() > 0 && Moves.Last().TimeStamp == TimeStamp)
+    {
+        CombinedMoveStart = Moves.Pop(EAllowShrinking::No);
+    }
+}
+
+// Same steps as ServerMove_PerformMovement, without the network and time stamp checks.
+bool UMyBaseMovementComponent::ReplayRecordedMove(const FMyRecordedMove& Move, bool bResync, float& OutDivergence, uint64& OutCycles)
+{
+    if (bResync)
+    {
+        UpdatedComponent->SetWorldLocationAndRotation(FVector(Move.StartLocation), FRotator(Move.StartRotation), false, nullptr, ETeleportType::TeleportPhysics);
+        Velocity = FVector(Move.StartVelocity);
+        ApplyNetworkMovementMode(Move.StartMovementMode);
+
+        if (Move.bStartCrouched != CharacterOwner->bIsCrouched)
+        {
+            if (Move.bStartCrouched) { Crouch(); } else { UnCrouch(); }
+        }
+    }
+
+    if (AController* Controller = CharacterOwner->GetController())
+    {
+        Controller->SetControlRotation(FRotator(Move.ControlRotation));
+    }
+
+    // As ServerMove_PerformMovement does from the move data.
+    Safe_bWantsToSprint = (Move.Inputs & MyNetworkMove::InputBit(EMyMoveInput::Sprint)) != 0;
+
+    const uint64 StartCycles = FPlatformTime::Cycles64();
+    MoveAutonomous(Move.TimeStamp, Move.DeltaTime, Move.CompressedFlags, FVector(Move.Acceleration));
+    OutCycles = FPlatformTime::Cycles64() - StartCycles;
+
+    const FVector ClientLocation(Move.EndLocation);
+    OutDivergence = FVector::Dist(UpdatedComponent->GetComponentLocation(), ClientLocation);
+
+    return ServerCheckClientError(Move.TimeStamp, Move.DeltaTime, FVector(Move.Acceleration), ClientLocation, ClientLocation, nullptr, NAME_None, Move.EndMovementMode);
+}
+
+// Both containers get the same moves. The engine's sees acceleration rounded the engine's way and sprint in
+// FLAG_Custom_0, as before FCharacterNetworkMoveData_MyData; ours sees what RoundAcceleration() and GetInputs() give.
+void UMyBaseMovementComponent::MeasureMoveBandwidth(const TArray<FMyRecordedMove>& Moves, const FString& Label, FOutputDevice& Ar)
+{
+    if (Moves.Num() < 2)
+    {
+        Ar.Logf(TEXT("MoveBandwidth: needs at least two moves"));
+        return;
+    }
+
+    UMyBaseMovementComponent* Movement = GetMutableDefault<UMyBaseMovementComponent>();
+
+    FCharacterNetworkMoveDataContainer EngineContainer;
+    FCharacterNetworkMoveDataContainer_MyData MyContainer;
+    FCharacterNetworkMoveDataContainer_MyData ReadContainer;
+
+    auto FillMove = [Movement](FCharacterNetworkMoveData& Data, const FMyRecordedMove& Move, bool bMyData)
+    {
+        const FVector Acceleration(Move.Acceleration);
+        const bool bSprint = (Move.Inputs & MyNetworkMove::InputBit(EMyMoveInput::Sprint)) != 0;
+
+        Data.TimeStamp = Move.TimeStamp;
+        Data.Acceleration = bMyData ? Movement->RoundAcceleration(Acceleration) : Movement->UCharacterMovementComponent::RoundAcceleration(Acceleration);
+        Data.Location = FVector(Move.EndLocation);
+        Data.ControlRotation = FRotator(Move.ControlRotation);
+        Data.CompressedMoveFlags = static_cast<uint8>(Move.CompressedFlags | ((!bMyData && bSprint) ? FSavedMove_Character::FLAG_Custom_0 : 0));
+        Data.MovementMode = Move.EndMovementMode;
+        Data.MovementBase = nullptr;
+        Data.MovementBaseBoneName = NAME_None;
+
+        if (bMyData)
+        {
+            static_cast<FCharacterNetworkMoveData_MyData&>(Data).Inputs = Move.Inputs;
+        }
+    };
+
+    // What the server has to get exactly; location is quantized the same way by both containers.
+    auto IsSameMove = [](const FCharacterNetworkMoveData_MyData& A, const FCharacterNetworkMoveData_MyData& B)
+    {
+        return MyNetworkMove::FloatToBits(A.TimeStamp) == MyNetworkMove::FloatToBits(B.TimeStamp)
+            && A.Acceleration == B.Acceleration
+            && MyNetworkMove::IsSameCompressedRotation(A.ControlRotation, B.ControlRotation)
+            && A.Inputs == B.Inputs
+            && A.MovementMode == B.MovementMode
+            && A.Location.Equals(B.Location, 0.01);
+    };
+
+    static const TCHAR* ShapeNames[] = { TEXT("single move"), TEXT("new + pending") };
+    int64 EngineBits[2] = {};
+    int64 MyBits[2] = {};
+    int32 NumPackets[2] = {};
+    int32 NumMismatches = 0;
+
+    for (int32 Shape = 0; Shape < 2; ++Shape)
+    {
+        // Two moves per packet is what 60 Hz input looks like when the client sends at 30 Hz or can't combine moves.
+        const bool bDual = Shape == 1;
+
+        for (int32 Index = bDual ? 1 : 0; Index < Moves.Num(); Index += bDual ? 2 : 1)
+        {
+            for (FCharacterNetworkMoveDataContainer* Container : { static_cast<FCharacterNetworkMoveDataContainer*>(&EngineContainer), static_cast<FCharacterNetworkMoveDataContainer*>(&MyContainer) })
+            {
+                const bool bMyData = Container == &MyContainer;
+
+                Container->bHasPendingMove = bDual;
+                Container->bIsDualHybridRootMotionMove = false;
+                Container->bHasOldMove = false;
+                Container->bDisableCombinedScopedMove = false;
+
+                FillMove(*Container->GetNewMoveData(), Moves[Index], bMyData);
+                if (bDual)
+                {
+                    FillMove(*Container->GetPendingMoveData(), Moves[Index - 1], bMyData);
+                }
+            }
+
+            FNetBitWriter EngineWriter(nullptr, 1024);
+            EngineContainer.Serialize(*Movement, EngineWriter, nullptr);
+
+            FNetBitWriter MyWriter(nullptr, 1024);
+            MyContainer.Serialize(*Movement, MyWriter, nullptr);
+
+            ++NumPackets[Shape];
+            EngineBits[Shape] += EngineWriter.GetNumBits();
+            MyBits[Shape] += MyWriter.GetNumBits();
+
+            FNetBitReader Reader(nullptr, MyWriter.GetData(), MyWriter.GetNumBits());
+            const bool bRead = ReadContainer.Serialize(*Movement, Reader, nullptr);
+
+            const auto& Written = static_cast<const FCharacterNetworkMoveData_MyData&>(*MyContainer.GetNewMoveData());
+            const auto& Read = static_cast<const FCharacterNetworkMoveData_MyData&>(*ReadContainer.GetNewMoveData());
+            const auto& WrittenPending = static_cast<const FCharacterNetworkMoveData_MyData&>(*MyContainer.GetPendingMoveData());
+            const auto& ReadPending = static_cast<const FCharacterNetworkMoveData_MyData&>(*ReadContainer.GetPendingMoveData());
+
+            if (!bRead || !IsSameMove(Written, Read) || ReadContainer.bHasPendingMove != bDual || (bDual && !IsSameMove(WrittenPending, ReadPending)))
+            {
+                ++NumMismatches;
+            }
+        }
+    }
+
+    Ar.Logf(TEXT("MoveBandwidth: %s, %d moves"), *Label, Moves.Num());
+
+    const FString CsvPath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("MoveBandwidth.csv"));
+    FString Csv;
+    if (!IFileManager::Get().FileExists(*CsvPath))
+    {
+        Csv = TEXT("Label,Packet,Moves,EngineBytes,Bytes,EngineBytesPerSecond,BytesPerSecond,Mismatches\n");
+    }
+
+    for (int32 Shape = 0; Shape < 2; ++Shape)
+    {
+        // Payload only; RPC and packet headers are the same for both.
+        const double EngineBytes = EngineBits[Shape] / 8.0 / FMath::Max(NumPackets[Shape], 1);
+        const double MyBytes = MyBits[Shape] / 8.0 / FMath::Max(NumPackets[Shape], 1);
+        const double PacketsPerSecond = Shape == 0 ? 60.0 : 30.0;
+
+        Ar.Logf(TEXT("  %-14s engine %6.2f bytes  ours %6.2f bytes  (%+.0f%%)  at 60 Hz input %5.0f -> %5.0f bytes/s"),
+            ShapeNames[Shape], EngineBytes, MyBytes, 100.0 * (MyBytes - EngineBytes) / FMath::Max(EngineBytes, 1.0), EngineBytes * PacketsPerSecond, MyBytes * PacketsPerSecond);
+
+        Csv += FString::Printf(TEXT("%s,%s,%d,%.3f,%.3f,%.1f,%.1f,%d\n"),
+            *Label, ShapeNames[Shape], Moves.Num(), EngineBytes, MyBytes, EngineBytes * PacketsPerSecond, MyBytes * PacketsPerSecond, NumMismatches);
+    }
+
+    Ar.Logf(TEXT("  read back mismatches %d"), NumMismatches);
+
+    FFileHelper::SaveStringToFile(Csv, *CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+}
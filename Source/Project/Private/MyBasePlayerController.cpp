@@ -1,9 +1,14 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "MyBasePlayerController.h"
+#include "Project.h"
 #include "MyCameraManager.h"
 #include "InputMappingContext.h"
 #include <MyBaseGameMode.h>
+#include "MyNetStatsSubsystem.h"
+#include "MyBaseWidget.h"
+#include "MyMemoryTags.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 
 AMyBasePlayerController::AMyBasePlayerController()
 {
@@ -16,6 +21,8 @@ AMyBasePlayerController::AMyBasePlayerController()
     {
         DefaultMappingContexts.Add(Default_IMC);
     }
+
+    HUDWidgetClass = StaticLoadClass(UMyBaseWidget::StaticClass(), nullptr, TEXT("/Game/ThirdPerson/Blueprints/BP_BaseWidget.BP_BaseWidget_C"));
 }
 
 void AMyBasePlayerController::BeginPlay()
@@ -25,11 +32,43 @@ void AMyBasePlayerController::BeginPlay()
     /* Return early if not local. */
     if (IsLocalController()) 
     { 
+        /* The HUD is made once per local player, before the first pawn arrives. */
+        CreateHUDWidget();
+
         /* If we are local then ask the Server to spawn the player. */
         ServerSpawnPlayer(this); 
     }
 }
 
+void AMyBasePlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    /* Take the HUD off the viewport with its controller. */
+    if (HUDWidget)
+    {
+        HUDWidget->RemoveFromParent();
+        HUDWidget = nullptr;
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void AMyBasePlayerController::CreateHUDWidget()
+{
+    LLM_SCOPE_BYTAG(Project_UI);
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(AMyBasePlayerController::CreateHUDWidget, ProjectChannel);
+
+    /* Return early if there is no class to create or the HUD already exists. */
+    if (HUDWidget || !HUDWidgetClass) { return; }
+
+    HUDWidget = CreateWidget<UMyBaseWidget>(this, HUDWidgetClass);
+    if (HUDWidget)
+    {
+        /* The view-model follows our pawn from here on, including respawns. */
+        HUDWidget->AddToViewport();
+        HUDWidget->SetVisibility(ESlateVisibility::Visible);
+    }
+}
+
 void AMyBasePlayerController::ServerSpawnPlayer_Implementation(APlayerController* PlayerController)
 {
     /* Store a reference of the GameMode. */
@@ -47,6 +86,13 @@ void AMyBasePlayerController::ServerSpawnPlayer_Implementation(APlayerController
     }
 }
 
+bool AMyBasePlayerController::CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack)
+{
+    UMyNetStatsSubsystem::RecordRemoteFunction(this, Function, Parameters);
+
+    return Super::CallRemoteFunction(Function, Parameters, OutParms, Stack);
+}
+
 void AMyBasePlayerController::SetupInputComponent()
 {
     Super::SetupInputComponent();
@@ -3,82 +3,112 @@
 #include "MyBaseWidget.h"
 #include "Components/CanvasPanel.h"
 #include "Components/CanvasPanelSlot.h"
-#include <MyHealthComponent.h>
-#include <MyStaminaComponent.h>
+#include "MyHUDViewModel.h"
+#include "MyMemoryTags.h"
 
-/**
- * UpdateHealthBar
- *
- * Updates the progress bar's fill and color based on the player's health percentage.
- *
- * @param Percent - The current health percentage (0.0 to 1.0)
- */
-void UMyBaseWidget::UpdateHealthBar(float Percent)
+/* Bars are updated when their fill moves by at least 1/MyHUDPercentSteps, finer than a pixel on any bar we have. */
+static constexpr float MyHUDPercentSteps = 1000.0f;
+
+/* Health bar colors from critical to high health. */
+static const FLinearColor MyHUDHealthBandColors[] =
 {
-    // Set the progress bar's fill amount to match the current health
-    HealthBar->SetPercent(Percent);
+    FLinearColor::Red,                       // Red indicates critical health
+    FLinearColor(1.0f, 0.65f, 0.0f, 1.0f),   // Orange color for low health
+    FLinearColor::Yellow,                    // Yellow color for medium health
+    FLinearColor::Green                      // Default color = green (high health)
+};
+
+/* Returns the index into MyHUDHealthBandColors for a health percentage. */
+static int32 GetHealthColorBand(float Percent)
+{
+    if (Percent <= 0.25f) { return 0; } // If health is very low
+    if (Percent <= 0.50f) { return 1; } // If health is low but not critical
+    if (Percent <= 0.7f) { return 2; }  // If health is moderately low
+    return 3;
+}
+
+void UMyBaseWidget::NativeConstruct()
+{
+    LLM_SCOPE_BYTAG(Project_UI);
 
-    // Determine the color of the health bar based on health thresholds
-    FLinearColor NewColor = FLinearColor::Green; // Default color = green (high health)
+    Super::NativeConstruct();
 
-    if (Percent <= 0.25f) // If health is very low
+    // The view-model follows the owning player's pawn, including respawns
+    if (!ViewModel)
     {
-        NewColor = FLinearColor::Red; // Red indicates critical health
+        ViewModel = NewObject<UMyHUDViewModel>(this);
     }
-    else if (Percent <= 0.50f) // If health is low but not critical
+    ViewModel->Initialize(GetOwningPlayer());
+}
+
+void UMyBaseWidget::NativeDestruct()
+{
+    if (ViewModel)
+    {
+        ViewModel->Deinitialize();
+    }
+
+    Super::NativeDestruct();
+}
+
+void UMyBaseWidget::NativeTick(const FGeometry& MyGeometry, float InDeltaTime)
+{
+    LLM_SCOPE_BYTAG(Project_UI);
+
+    Super::NativeTick(MyGeometry, InDeltaTime);
+
+    if (!ViewModel) return;
+
+    // However many changes arrived this frame, each bar gets at most one update with the latest value
+    float Percent = 0.0f;
+    if (ViewModel->ConsumeHealth(Percent))
     {
-        NewColor = FLinearColor(1.0f, 0.65f, 0.0f, 1.0f); // Orange color for low health
+        UpdateHealthBar(Percent);
     }
-    else if (Percent <= 0.7f) // If health is moderately low
+    if (ViewModel->ConsumeStamina(Percent))
     {
-        NewColor = FLinearColor::Yellow; // Yellow color for medium health
+        UpdateStaminaBar(Percent);
     }
-
-    // Apply the new color to the progress bar's fill
-    HealthBar->SetFillColorAndOpacity(NewColor);
 }
 
-void UMyBaseWidget::OnHealthChangedHandler()
+/**
+ * UpdateHealthBar
+ *
+ * Updates the progress bar's fill and color based on the player's health percentage.
+ * Skips whatever would not visibly change.
+ *
+ * @param Percent - The current health percentage (0.0 to 1.0)
+ */
+void UMyBaseWidget::UpdateHealthBar(float Percent)
 {
     // Make sure the HealthBar is valid before attempting to modify it
     if (!IsValid(HealthBar)) return;
 
-    // Get the owning player of this widget
-    if (APlayerController* PC = GetOwningPlayer())
+    // Set the progress bar's fill amount to match the current health
+    const int32 Steps = FMath::RoundToInt(Percent * MyHUDPercentSteps);
+    if (Steps != ShownHealthSteps)
     {
-        // Get the pawn (character) controlled by this player
-        if (APawn* Pawn = PC->GetPawn())
-        {
-            // Find the health component attached to the pawn
-            if (UMyHealthComponent* HealthComp = Pawn->FindComponentByClass<UMyHealthComponent>())
-            {
-                // Get the current health percentage and update the health bar
-                float Percent = HealthComp->GetHealthPercentage();
-                UpdateHealthBar(Percent);
-            }
-        }
+        ShownHealthSteps = Steps;
+        HealthBar->SetPercent(Percent);
     }
-}
 
-void UMyBaseWidget::UpdateStaminaBar(float Percent)
-{
-    StaminaBar->SetPercent(Percent);
+    // Determine the color of the health bar based on health thresholds, and apply it when the band changes
+    const int32 Band = GetHealthColorBand(Percent);
+    if (Band != ShownHealthBand)
+    {
+        ShownHealthBand = Band;
+        HealthBar->SetFillColorAndOpacity(MyHUDHealthBandColors[Band]);
+    }
 }
 
-void UMyBaseWidget::OnStaminaChangedHandler()
+void UMyBaseWidget::UpdateStaminaBar(float Percent)
 {
     if (!IsValid(StaminaBar)) return;
 
-    if (APlayerController* PC = GetOwningPlayer()) 
+    const int32 Steps = FMath::RoundToInt(Percent * MyHUDPercentSteps);
+    if (Steps != ShownStaminaSteps)
     {
-        if (APawn* Pawn = PC->GetPawn())
-        {
-            if (UMyStaminaComponent* StaminaComp = Pawn->FindComponentByClass<UMyStaminaComponent>())
-            {
-                float Percent = StaminaComp->GetStaminaPercentage();
-                UpdateStaminaBar(Percent);
-                UE_LOG(LogTemp, Log, TEXT("StaminaBar was updated."));
-            }
-        }
+        ShownStaminaSteps = Steps;
+        StaminaBar->SetPercent(Percent);
     }
-}
\ No newline at end of file
+}
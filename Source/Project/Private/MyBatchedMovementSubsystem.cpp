@@ -0,0 +1,458 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyBatchedMovementSubsystem.h"
+#include "Project.h"
+#include "MyBaseMovementComponent.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static int32 GMyBatchedMovementEnabled = 0;
+static FAutoConsoleVariableRef CVarMyBatchedMovementEnabled(
+	TEXT("Project.Movement.Batch.Enabled"),
+	GMyBatchedMovementEnabled,
+	TEXT("Move non player controlled characters in one parallel batch instead of one tick each. ")
+	TEXT("Off by default; check the moves with Project.Movement.Batch.Verify before turning it on."));
+
+static int32 GMyBatchedMovementParallel = 1;
+static FAutoConsoleVariableRef CVarMyBatchedMovementParallel(
+	TEXT("Project.Movement.Batch.Parallel"),
+	GMyBatchedMovementParallel,
+	TEXT("0 runs the batch on the game thread, to compare timings."));
+
+static float GMyBatchedMovementVerifyTolerance = 1.0f;
+static FAutoConsoleVariableRef CVarMyBatchedMovementVerifyTolerance(
+	TEXT("Project.Movement.Batch.VerifyTolerance"),
+	GMyBatchedMovementVerifyTolerance,
+	TEXT("Distance in cm a batched move may end from the stock move before Project.Movement.Batch.Verify counts it as a mismatch."));
+
+static int32 GMyBatchedMovementMinBatchSize = 8;
+static FAutoConsoleVariableRef CVarMyBatchedMovementMinBatchSize(
+	TEXT("Project.Movement.Batch.MinBatchSize"),
+	GMyBatchedMovementMinBatchSize,
+	TEXT("Fewest moves given to one worker task."));
+
+/* Floor distances kept while walking, same as UCharacterMovementComponent. */
+static constexpr float MyBatchMinFloorDist = 1.9f;
+static constexpr float MyBatchMaxFloorDist = 2.4f;
+
+/* Braking is integrated in steps of at most this long, same as the default BrakingSubStepTime. */
+static constexpr float MyBatchBrakingSubStepTime = 1.0f / 33.0f;
+
+namespace MyBatchedMovement
+{
+	/* Capsule sweep from Start to End. Returns true on a blocking hit. */
+	static bool Sweep(const UWorld& World, const FMyBatchedMoveInput& Input, const FCollisionShape& Shape, const FVector& Start, const FVector& End, FHitResult& OutHit)
+	{
+		return World.SweepSingleByChannel(OutHit, Start, End, FQuat::Identity, Input.CollisionChannel, Shape, Input.QueryParams, Input.ResponseParams);
+	}
+
+	/* Sweeps from Location by Delta and moves Location as far as it got. */
+	static bool SafeMove(const UWorld& World, const FMyBatchedMoveInput& Input, const FCollisionShape& Shape, FVector& Location, const FVector& Delta, FHitResult& OutHit)
+	{
+		if (!Sweep(World, Input, Shape, Location, Location + Delta, OutHit))
+		{
+			Location += Delta;
+			return false;
+		}
+
+		// Already overlapping something, usually another character. Push out and try once more.
+		if (OutHit.bStartPenetrating)
+		{
+			Location += OutHit.Normal * (OutHit.PenetrationDepth + 0.125f);
+			if (!Sweep(World, Input, Shape, Location, Location + Delta, OutHit) || OutHit.bStartPenetrating)
+			{
+				Location += OutHit.bStartPenetrating ? FVector::ZeroVector : Delta;
+				return OutHit.bStartPenetrating;
+			}
+		}
+
+		Location = OutHit.Location;
+		return true;
+	}
+
+	/* Velocity braking, as UCharacterMovementComponent::ApplyVelocityBraking. */
+	static void ApplyBraking(FVector& Velocity, float DeltaTime, float Friction, float BrakingDeceleration)
+	{
+		if (Velocity.IsZero() || (Friction == 0.0f && BrakingDeceleration == 0.0f)) { return; }
+
+		const FVector OldVelocity = Velocity;
+		const FVector ReverseAcceleration = -BrakingDeceleration * Velocity.GetSafeNormal();
+
+		float RemainingTime = DeltaTime;
+		while (RemainingTime >= UCharacterMovementComponent::MIN_TICK_TIME)
+		{
+			const float StepTime = FMath::Min(RemainingTime, MyBatchBrakingSubStepTime);
+			RemainingTime -= StepTime;
+
+			Velocity = Velocity + (-Friction * Velocity + ReverseAcceleration) * StepTime;
+
+			// Braking never reverses direction.
+			if ((Velocity | OldVelocity) <= 0.0f)
+			{
+				Velocity = FVector::ZeroVector;
+				return;
+			}
+		}
+
+		if (Velocity.IsNearlyZero(UE_KINDA_SMALL_NUMBER))
+		{
+			Velocity = FVector::ZeroVector;
+		}
+	}
+
+	/* Ground velocity, as UCharacterMovementComponent::CalcVelocity. */
+	static void CalcGroundVelocity(FVector& Velocity, FVector Acceleration, float MaxSpeed, const FMyBatchedMoveInput& Input)
+	{
+		Acceleration = Acceleration.GetClampedToMaxSize(Input.MaxAcceleration);
+
+		const bool bZeroAcceleration = Acceleration.IsZero();
+		const bool bOverMaxSpeed = Velocity.SizeSquared() > FMath::Square(MaxSpeed) * 1.01f;
+
+		if (bZeroAcceleration || bOverMaxSpeed)
+		{
+			const FVector OldVelocity = Velocity;
+			ApplyBraking(Velocity, Input.DeltaTime, Input.BrakingFriction, Input.BrakingDeceleration);
+
+			// Don't brake below max speed while still accelerating the same way.
+			if (bOverMaxSpeed && Velocity.SizeSquared() < FMath::Square(MaxSpeed) && (Acceleration | OldVelocity) > 0.0f)
+			{
+				Velocity = OldVelocity.GetSafeNormal() * MaxSpeed;
+			}
+		}
+		else
+		{
+			// Friction turns the velocity towards the acceleration.
+			const float Speed = Velocity.Size();
+			Velocity = Velocity - (Velocity - Acceleration.GetSafeNormal() * Speed) * FMath::Min(Input.DeltaTime * Input.GroundFriction, 1.0f);
+		}
+
+		if (!bZeroAcceleration)
+		{
+			const float NewMaxSpeed = bOverMaxSpeed ? Velocity.Size() : MaxSpeed;
+			Velocity += Acceleration * Input.DeltaTime;
+			Velocity = Velocity.GetClampedToMaxSize(NewMaxSpeed);
+		}
+	}
+
+	/* Tries to walk up onto a ledge of at most MaxStepHeight. Moves Location and returns true on success. */
+	static bool StepUp(const UWorld& World, const FMyBatchedMoveInput& Input, const FCollisionShape& Shape, FVector& Location, const FVector& Delta)
+	{
+		FHitResult Hit;
+		FVector StepLocation = Location;
+
+		SafeMove(World, Input, Shape, StepLocation, FVector(0.0f, 0.0f, Input.MaxStepHeight), Hit);
+		const float StepHeight = StepLocation.Z - Location.Z;
+		if (StepHeight <= UE_KINDA_SMALL_NUMBER) { return false; }
+
+		// Blocked at step height as well, this is a wall.
+		if (SafeMove(World, Input, Shape, StepLocation, Delta, Hit) && Hit.Time == 0.0f) { return false; }
+
+		if (!SafeMove(World, Input, Shape, StepLocation, FVector(0.0f, 0.0f, -(StepHeight + MyBatchMaxFloorDist)), Hit)) { return false; }
+		if (Hit.bStartPenetrating || Hit.ImpactNormal.Z < Input.WalkableFloorZ) { return false; }
+
+		Location = StepLocation;
+		return true;
+	}
+}
+
+bool UMyBatchedMovementSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return Super::ShouldCreateSubsystem(Outer) && World && World->IsGameWorld();
+}
+
+void UMyBatchedMovementSubsystem::Deinitialize()
+{
+	Components.Reset();
+
+	Super::Deinitialize();
+}
+
+void UMyBatchedMovementSubsystem::Register(UMyBaseMovementComponent* Component)
+{
+	Components.AddUnique(Component);
+}
+
+void UMyBatchedMovementSubsystem::Unregister(UMyBaseMovementComponent* Component)
+{
+	Components.RemoveSwap(Component);
+}
+
+void UMyBatchedMovementSubsystem::Tick(float DeltaTime)
+{
+	const UWorld* World = GetWorld();
+	if (World->GetNetMode() == NM_Client || DeltaTime < UCharacterMovementComponent::MIN_TICK_TIME) { return; }
+
+	double StartTime = FPlatformTime::Seconds();
+
+	// Gather. Components that just became eligible already ticked this frame and join the batch next frame.
+	BatchComponents.Reset();
+	BatchInputs.Reset();
+
+	for (int32 Index = Components.Num() - 1; Index >= 0; --Index)
+	{
+		UMyBaseMovementComponent* Component = Components[Index].Get();
+		if (!Component)
+		{
+			Components.RemoveAtSwap(Index);
+			continue;
+		}
+
+		if (!GMyBatchedMovementEnabled || !Component->CanUseBatchedMovement())
+		{
+			Component->SetBatchedMovement(false);
+			continue;
+		}
+
+		if (!Component->IsBatchedMovement())
+		{
+			Component->SetBatchedMovement(true);
+			continue;
+		}
+
+		BatchComponents.Add(Component);
+		Component->GatherBatchedMove(DeltaTime, BatchInputs.AddDefaulted_GetRef());
+	}
+
+	NumBatched = BatchComponents.Num();
+	BatchResults.SetNum(NumBatched, EAllowShrinking::No);
+
+	LastGatherSeconds = FPlatformTime::Seconds() - StartTime;
+	StartTime = FPlatformTime::Seconds();
+
+	// Simulate. Nothing writes to the world until every move is done.
+	ParallelFor(TEXT("MyBatchedMovement"), NumBatched, GMyBatchedMovementMinBatchSize, [this, World](int32 Index)
+	{
+		SimulateMove(*World, BatchInputs[Index], BatchResults[Index]);
+	}, GMyBatchedMovementParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+	LastSimulateSeconds = FPlatformTime::Seconds() - StartTime;
+
+	// Before anything is applied, so every stock move sees the other characters where the batch saw them.
+	if (VerifyFramesLeft > 0)
+	{
+		VerifyResults.SetNum(NumBatched, EAllowShrinking::No);
+		for (int32 Index = 0; Index < NumBatched; ++Index)
+		{
+			BatchComponents[Index]->RunReferenceMove(BatchInputs[Index], VerifyResults[Index]);
+
+			const FMyBatchedMoveResult& Expected = VerifyResults[Index];
+			const FMyBatchedMoveResult& Batched = BatchResults[Index];
+			const double Error = FVector::Dist(Expected.Location, Batched.Location);
+			VerifySumError += Error;
+			VerifyMaxError = FMath::Max(VerifyMaxError, Error);
+			VerifyMaxVelocityError = FMath::Max(VerifyMaxVelocityError, FVector::Dist(Expected.Velocity, Batched.Velocity));
+			if (Error > GMyBatchedMovementVerifyTolerance || Expected.bFalling != Batched.bFalling)
+			{
+				++VerifyMismatches;
+			}
+		}
+
+		VerifyMoves += NumBatched;
+		if (--VerifyFramesLeft == 0)
+		{
+			FinishVerify();
+		}
+	}
+
+	StartTime = FPlatformTime::Seconds();
+
+	// Apply, on the game thread.
+	for (int32 Index = 0; Index < NumBatched; ++Index)
+	{
+		BatchComponents[Index]->ApplyBatchedMove(BatchInputs[Index], BatchResults[Index]);
+	}
+
+	LastApplySeconds = FPlatformTime::Seconds() - StartTime;
+}
+
+TStatId UMyBatchedMovementSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMyBatchedMovementSubsystem, STATGROUP_Tickables);
+}
+
+void UMyBatchedMovementSubsystem::SimulateMove(const UWorld& World, const FMyBatchedMoveInput& Input, FMyBatchedMoveResult& OutResult)
+{
+	using namespace MyBatchedMovement;
+
+	const FCollisionShape Shape = FCollisionShape::MakeCapsule(Input.CapsuleRadius, Input.CapsuleHalfHeight);
+	const float DeltaTime = Input.DeltaTime;
+
+	FVector Location = Input.Location;
+	FVector Velocity = Input.Velocity;
+	FVector Acceleration = Input.Acceleration;
+	float MaxSpeed = Input.MaxSpeed;
+	bool bFalling = Input.bFalling;
+
+	OutResult.bLanded = false;
+	OutResult.bWalkableFloor = false;
+	OutResult.FloorDistance = 0.0f;
+	OutResult.FloorHit.Reset(1.0f, false);
+
+	// Path following asks for a velocity; accelerate towards it at full rate.
+	if (Input.bHasRequestedVelocity)
+	{
+		MaxSpeed = FMath::Min(MaxSpeed, Input.RequestedSpeed);
+		Acceleration = Input.RequestedVelocity.GetSafeNormal() * Input.MaxAcceleration;
+	}
+
+	// Velocity.
+	if (!bFalling)
+	{
+		Velocity.Z = 0.0f;
+		Acceleration.Z = 0.0f;
+		CalcGroundVelocity(Velocity, Acceleration, MaxSpeed, Input);
+	}
+	else
+	{
+		const FVector LateralAcceleration = FVector(Acceleration.X, Acceleration.Y, 0.0f).GetClampedToMaxSize(Input.MaxAcceleration) * Input.AirControl;
+		const float LateralSpeed = FVector(Velocity.X, Velocity.Y, 0.0f).Size();
+
+		FVector Lateral = FVector(Velocity.X, Velocity.Y, 0.0f) + LateralAcceleration * DeltaTime;
+		Lateral = Lateral.GetClampedToMaxSize(FMath::Max(LateralSpeed, MaxSpeed));
+
+		Velocity = FVector(Lateral.X, Lateral.Y, FMath::Max(Velocity.Z + Input.GravityZ * DeltaTime, -Input.TerminalVelocity));
+	}
+
+	// Move, stepping up small ledges and sliding along the first blocking surface.
+	const FVector Delta = Velocity * DeltaTime;
+	FHitResult Hit;
+
+	if (!Delta.IsNearlyZero() && SafeMove(World, Input, Shape, Location, Delta, Hit))
+	{
+		const FVector Remaining = Delta * (1.0f - Hit.Time);
+		const bool bWalkableHit = Hit.ImpactNormal.Z >= Input.WalkableFloorZ;
+
+		bool bStepped = false;
+		if (!bFalling && !bWalkableHit && Input.MaxStepHeight > 0.0f)
+		{
+			const float HitHeight = Hit.ImpactPoint.Z - (Location.Z - Input.CapsuleHalfHeight);
+			if (HitHeight <= Input.MaxStepHeight)
+			{
+				bStepped = StepUp(World, Input, Shape, Location, Remaining);
+			}
+		}
+
+		if (!bStepped)
+		{
+			// Walking characters slide along walls horizontally; ramps and falling use the full normal.
+			FVector SlideNormal = Hit.Normal;
+			if (!bFalling && !bWalkableHit)
+			{
+				SlideNormal = Hit.Normal.GetSafeNormal2D();
+			}
+
+			Velocity = FVector::VectorPlaneProject(Velocity, SlideNormal);
+			if (!bFalling)
+			{
+				Velocity.Z = 0.0f;
+			}
+
+			FHitResult SlideHit;
+			SafeMove(World, Input, Shape, Location, FVector::VectorPlaneProject(Remaining, SlideNormal), SlideHit);
+		}
+	}
+
+	// Floor. Walking characters look down a step height; falling ones only land when moving down onto it.
+	if (!bFalling || Velocity.Z <= 0.0f)
+	{
+		const float SweepDistance = bFalling ? MyBatchMaxFloorDist : Input.MaxStepHeight + MyBatchMaxFloorDist;
+		const FCollisionShape FloorShape = FCollisionShape::MakeCapsule(Input.CapsuleRadius * 0.9f, Input.CapsuleHalfHeight);
+
+		FHitResult FloorHit;
+		const bool bHit = Sweep(World, Input, FloorShape, Location, Location - FVector(0.0f, 0.0f, SweepDistance), FloorHit);
+
+		if (bHit && !FloorHit.bStartPenetrating && FloorHit.ImpactNormal.Z >= Input.WalkableFloorZ)
+		{
+			float FloorDistance = FloorHit.Time * SweepDistance;
+
+			// Keep the capsule hovering just above the floor.
+			if (FloorDistance < MyBatchMinFloorDist || FloorDistance > MyBatchMaxFloorDist)
+			{
+				const float TargetDistance = 0.5f * (MyBatchMinFloorDist + MyBatchMaxFloorDist);
+				Location.Z -= FloorDistance - TargetDistance;
+				FloorDistance = TargetDistance;
+			}
+
+			if (bFalling)
+			{
+				OutResult.bLanded = true;
+				bFalling = false;
+			}
+			Velocity.Z = 0.0f;
+
+			OutResult.bWalkableFloor = true;
+			OutResult.FloorDistance = FloorDistance;
+			OutResult.FloorHit = FloorHit;
+		}
+		else if (!bFalling)
+		{
+			// Walked off a ledge.
+			bFalling = true;
+		}
+	}
+
+	OutResult.Location = Location;
+	OutResult.Velocity = Velocity;
+	OutResult.bFalling = bFalling;
+}
+
+void UMyBatchedMovementSubsystem::StartVerify(int32 Frames)
+{
+	VerifyFramesLeft = FMath::Max(Frames, 1);
+	VerifyMoves = 0;
+	VerifyMismatches = 0;
+	VerifySumError = 0.0;
+	VerifyMaxError = 0.0;
+	VerifyMaxVelocityError = 0.0;
+}
+
+void UMyBatchedMovementSubsystem::FinishVerify()
+{
+	const double AverageError = VerifyMoves > 0 ? VerifySumError / VerifyMoves : 0.0;
+	if (VerifyMismatches == 0)
+	{
+		UE_LOG(LogProject, Display, TEXT("BatchedMovement: verify passed, %lld moves within %.2f cm of the stock movement (average %.4f, max %.4f cm, max velocity error %.3f cm/s)"),
+			VerifyMoves, GMyBatchedMovementVerifyTolerance, AverageError, VerifyMaxError, VerifyMaxVelocityError);
+	}
+	else
+	{
+		UE_LOG(LogProject, Error, TEXT("BatchedMovement: verify FAILED, %lld of %lld moves differ from the stock movement by more than %.2f cm or in falling (average %.4f, max %.4f cm, max velocity error %.3f cm/s)"),
+			VerifyMismatches, VerifyMoves, GMyBatchedMovementVerifyTolerance, AverageError, VerifyMaxError, VerifyMaxVelocityError);
+	}
+}
+
+void UMyBatchedMovementSubsystem::DumpStats(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("BatchedMovement: %d of %d characters batched (%s)"), NumBatched, Components.Num(), GMyBatchedMovementParallel ? TEXT("parallel") : TEXT("serial"));
+	Ar.Logf(TEXT("BatchedMovement: gather %.3f ms, simulate %.3f ms, apply %.3f ms"), LastGatherSeconds * 1000.0, LastSimulateSeconds * 1000.0, LastApplySeconds * 1000.0);
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyBatchedMovementStats(
+	TEXT("Project.Movement.Batch.Stats"),
+	TEXT("Prints how many characters are moved in the batch and last frame's cost."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (const UMyBatchedMovementSubsystem* Batch = World ? World->GetSubsystem<UMyBatchedMovementSubsystem>() : nullptr)
+		{
+			Batch->DumpStats(Ar);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyBatchedMovementVerify(
+	TEXT("Project.Movement.Batch.Verify"),
+	TEXT("Runs the stock character movement for every batched move of the next frames from the same state and compares where they end. Arguments: [Frames]."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UMyBatchedMovementSubsystem* Batch = World ? World->GetSubsystem<UMyBatchedMovementSubsystem>() : nullptr)
+		{
+			const int32 Frames = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 300;
+			Batch->StartVerify(Frames);
+			Ar.Logf(TEXT("BatchedMovement: verifying the next %d frames"), FMath::Max(Frames, 1));
+			if (!GMyBatchedMovementEnabled)
+			{
+				Ar.Logf(ELogVerbosity::Warning, TEXT("BatchedMovement: Project.Movement.Batch.Enabled is 0, nothing is batched to verify"));
+			}
+		}
+	}));
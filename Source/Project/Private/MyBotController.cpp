@@ -0,0 +1,265 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyBotController.h"
+#include "MyBotSubsystem.h"
+#include "MyBotTasks.h"
+#include "MyBaseCharacter.h"
+#include "MyStaminaComponent.h"
+#include "Project.h"
+#include "Components/StateTreeAIComponent.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "StateTree.h"
+#include "Engine/World.h"
+
+/* Tuning of the built-in behaviour, matching the defaults of the Project|Bot tasks. */
+namespace MyBotBehaviour
+{
+	static constexpr float WanderRadius = 2000.0f;
+	static constexpr float DoorSearchRadius = 1500.0f;
+	static constexpr float DoorReach = 200.0f;
+	static constexpr float AcceptanceRadius = 50.0f;
+	static constexpr float StartSprintStamina = 0.6f;
+	static constexpr float StopSprintStamina = 0.2f;
+	static constexpr float DoorChance = 0.25f;
+	static constexpr float CrouchChance = 0.15f;
+	static constexpr float MinCrouchSeconds = 1.0f;
+	static constexpr float MaxCrouchSeconds = 3.0f;
+
+	/* Gives up on a move that takes longer than this, e.g. when pushed off the path. */
+	static constexpr float MaxMoveSeconds = 30.0f;
+}
+
+AMyBotController::AMyBotController(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	StateTreeComponent = CreateDefaultSubobject<UStateTreeAIComponent>(TEXT("StateTreeComponent"));
+	StateTreeComponent->SetStartLogicAutomatically(false);
+
+	// UMyBotSubsystem ticks the tree inside the bot budget.
+	StateTreeComponent->PrimaryComponentTick.bCanEverTick = false;
+	BrainComponent = StateTreeComponent;
+
+	BotStateTree = TSoftObjectPtr<UStateTree>(FSoftObjectPath(TEXT("/Game/AI/ST_Bot.ST_Bot")));
+
+	bWantsPlayerState = false;
+}
+
+void AMyBotController::OnPossess(APawn* InPawn)
+{
+	Super::OnPossess(InPawn);
+
+	UMyBotSubsystem* Bots = GetWorld()->GetSubsystem<UMyBotSubsystem>();
+	UStateTree* StateTree = Bots ? Bots->GetStateTree(this) : nullptr;
+	bBuiltInBehaviour = StateTree == nullptr;
+	Activity = EActivity::Idle;
+	if (StateTree)
+	{
+		StateTreeComponent->SetStateTree(StateTree);
+		StateTreeComponent->StartLogic();
+	}
+
+	if (Bots)
+	{
+		Bots->RegisterBot(this);
+	}
+}
+
+void AMyBotController::OnUnPossess()
+{
+	if (UMyBotSubsystem* Bots = GetWorld()->GetSubsystem<UMyBotSubsystem>())
+	{
+		Bots->UnregisterBot(this);
+	}
+	if (StateTreeComponent->IsRunning())
+	{
+		StateTreeComponent->StopLogic(TEXT("Unpossessed"));
+	}
+	StopBuiltInBehaviour();
+	bBuiltInBehaviour = false;
+
+	Super::OnUnPossess();
+}
+
+void AMyBotController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UMyBotSubsystem* Bots = GetWorld()->GetSubsystem<UMyBotSubsystem>())
+	{
+		Bots->UnregisterBot(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AMyBotController::TickBehaviour(float DeltaTime)
+{
+	if (bBuiltInBehaviour)
+	{
+		TickBuiltInBehaviour(DeltaTime);
+		return;
+	}
+
+	// The component's tick function is never registered, so this is the only place the tree runs.
+	StateTreeComponent->TickComponent(DeltaTime, LEVELTICK_All, nullptr);
+}
+
+bool AMyBotController::IsBehaviourRunning() const
+{
+	return bBuiltInBehaviour ? GetPawn() != nullptr : StateTreeComponent->IsRunning();
+}
+
+void AMyBotController::TickBuiltInBehaviour(float DeltaTime)
+{
+	using namespace MyBotBehaviour;
+
+	AMyBaseCharacter* Character = Cast<AMyBaseCharacter>(GetPawn());
+	if (!Character) { return; }
+
+	ActivityTime += DeltaTime;
+
+	switch (Activity)
+	{
+	case EActivity::Idle:
+	{
+		const float Roll = FMath::FRand();
+		AActor* Door = Roll < DoorChance ? MyBot::FindInteractable(Character, DoorSearchRadius, true) : nullptr;
+		FVector Location;
+		if (Door && StartMoveTo(Door->GetActorLocation()))
+		{
+			DoorTarget = Door;
+			Activity = EActivity::OpenDoor;
+		}
+		else if (Roll < DoorChance + CrouchChance)
+		{
+			Character->StartCrouching();
+			bCrouching = true;
+			ActivityDuration = FMath::FRandRange(MinCrouchSeconds, MaxCrouchSeconds);
+			Activity = EActivity::Crouch;
+		}
+		else if (MyBot::GetRandomLocation(Character, WanderRadius, Location) && StartMoveTo(Location))
+		{
+			Activity = EActivity::Wander;
+		}
+		ActivityTime = 0.0f;
+		break;
+	}
+
+	case EActivity::Wander:
+	case EActivity::OpenDoor:
+	{
+		bool bArrived = false;
+		if (!UpdateMoveTo(bArrived) && ActivityTime < MaxMoveSeconds) { break; }
+
+		// The path ends in front of the door, so the reach check decides whether it opens.
+		if (Activity == EActivity::OpenDoor)
+		{
+			MyBot::Interact(Character, DoorTarget.Get(), DoorReach + Character->GetSimpleCollisionRadius());
+		}
+		StopBuiltInBehaviour();
+		Activity = EActivity::Idle;
+		break;
+	}
+
+	case EActivity::Crouch:
+		if (ActivityTime >= ActivityDuration)
+		{
+			StopBuiltInBehaviour();
+			Activity = EActivity::Idle;
+		}
+		break;
+	}
+
+	UpdateSprint(Character);
+}
+
+bool AMyBotController::StartMoveTo(const FVector& Destination)
+{
+	const APawn* MyPawn = GetPawn();
+	UMyNavQuerySubsystem* NavQueries = UMyNavQuerySubsystem::Get(this);
+	if (!MyPawn || !NavQueries) { return false; }
+
+	MoveDestination = Destination;
+	PathQuery = NavQueries->RequestPath(MyPawn, MyPawn->GetNavAgentLocation(), Destination);
+	return PathQuery.IsValid();
+}
+
+bool AMyBotController::UpdateMoveTo(bool& bOutArrived)
+{
+	bOutArrived = false;
+	const APawn* MyPawn = GetPawn();
+	if (!MyPawn) { return true; }
+
+	// Same steps as the Bot Move To task.
+	if (PathQuery.IsValid())
+	{
+		UMyNavQuerySubsystem* NavQueries = UMyNavQuerySubsystem::Get(this);
+		FNavPathSharedPtr Path;
+		const EMyNavQueryStatus Status = NavQueries ? NavQueries->GetPathResult(PathQuery, Path) : EMyNavQueryStatus::Invalid;
+		if (Status == EMyNavQueryStatus::Pending) { return false; }
+
+		PathQuery.Invalidate();
+		if (Status != EMyNavQueryStatus::Succeeded || !Path.IsValid()) { return true; }
+
+		FAIMoveRequest MoveRequest(MoveDestination);
+		MoveRequest.SetAcceptanceRadius(MyBotBehaviour::AcceptanceRadius);
+		bMoving = RequestMove(MoveRequest, Path).IsValid();
+		return !bMoving;
+	}
+
+	if (GetMoveStatus() != EPathFollowingStatus::Idle) { return false; }
+
+	bMoving = false;
+	bOutArrived = FVector::Dist2D(MyPawn->GetActorLocation(), MoveDestination) <= MyBotBehaviour::AcceptanceRadius + MyPawn->GetSimpleCollisionRadius();
+	return true;
+}
+
+void AMyBotController::UpdateSprint(AMyBaseCharacter* Character)
+{
+	const UMyStaminaComponent* Stamina = Character->FindComponentByClass<UMyStaminaComponent>();
+	if (!Stamina) { return; }
+
+	const float StaminaPercent = Stamina->GetStaminaPercentage();
+	const bool bWantsToSprint = bMoving && !bCrouching && Stamina->HasStamina()
+		&& StaminaPercent > (bSprinting ? MyBotBehaviour::StopSprintStamina : MyBotBehaviour::StartSprintStamina);
+	if (bWantsToSprint != bSprinting)
+	{
+		bSprinting = bWantsToSprint;
+		if (bSprinting)
+		{
+			Character->StartSprinting();
+		}
+		else
+		{
+			Character->StopSprinting();
+		}
+	}
+}
+
+void AMyBotController::StopBuiltInBehaviour()
+{
+	if (PathQuery.IsValid())
+	{
+		if (UMyNavQuerySubsystem* NavQueries = UMyNavQuerySubsystem::Get(this))
+		{
+			NavQueries->CancelQuery(PathQuery);
+		}
+		PathQuery.Invalidate();
+	}
+	if (bMoving)
+	{
+		StopMovement();
+		bMoving = false;
+	}
+
+	AMyBaseCharacter* Character = Cast<AMyBaseCharacter>(GetPawn());
+	if (Character && bSprinting)
+	{
+		Character->StopSprinting();
+	}
+	if (Character && bCrouching)
+	{
+		Character->StopCrouching();
+	}
+	bSprinting = false;
+	bCrouching = false;
+	DoorTarget.Reset();
+}
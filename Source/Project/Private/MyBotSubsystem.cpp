@@ -0,0 +1,265 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyBotSubsystem.h"
+#include "MyBotController.h"
+#include "MyMemoryTags.h"
+#include "MyBaseCharacter.h"
+#include "NavigationSystem.h"
+#include "StateTree.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+static float GMyBotBudgetMs = 1.0f;
+static FAutoConsoleVariableRef CVarMyBotBudgetMs(
+	TEXT("Project.Bots.BudgetMs"),
+	GMyBotBudgetMs,
+	TEXT("Milliseconds per frame all bots together may spend evaluating their StateTrees."));
+
+/* Priority weight of each significance level, indexed by EMySignificanceLevel. */
+static constexpr float MyBotLevelWeights[] = { 1.0f, 0.5f, 0.25f, 0.1f };
+static_assert(UE_ARRAY_COUNT(MyBotLevelWeights) == static_cast<int32>(EMySignificanceLevel::MAX), "One weight per significance level");
+
+bool UMyBotSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return Super::ShouldCreateSubsystem(Outer) && World && World->IsGameWorld();
+}
+
+void UMyBotSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	GetStateTree(GetDefault<AMyBotController>());
+}
+
+void UMyBotSubsystem::RegisterBot(AMyBotController* Bot)
+{
+	if (!Bot || Bots.ContainsByPredicate([Bot](const FBot& Entry) { return Entry.Controller == Bot; })) { return; }
+
+	FBot& Entry = Bots.AddDefaulted_GetRef();
+	Entry.Controller = Bot;
+}
+
+void UMyBotSubsystem::UnregisterBot(AMyBotController* Bot)
+{
+	// Only cleared here; Tick() compacts the array so evaluation can unregister bots.
+	for (FBot& Entry : Bots)
+	{
+		if (Entry.Controller == Bot)
+		{
+			Entry.Controller.Reset();
+		}
+	}
+}
+
+UStateTree* UMyBotSubsystem::GetStateTree(const AMyBotController* Bot)
+{
+	const TSoftObjectPtr<UStateTree>& Asset = Bot->GetBotStateTree();
+	if (Asset.IsNull()) { return nullptr; }
+
+	if (const TObjectPtr<UStateTree>* Found = StateTrees.Find(Asset.ToSoftObjectPath()))
+	{
+		return *Found;
+	}
+
+	UStateTree* StateTree = Asset.LoadSynchronous();
+	StateTrees.Add(Asset.ToSoftObjectPath(), StateTree);
+	return StateTree;
+}
+
+void UMyBotSubsystem::Tick(float DeltaTime)
+{
+	LastNumEvaluated = 0;
+	LastEvaluateSeconds = 0.0;
+	if (Bots.Num() == 0) { return; }
+
+	for (int32 Index = Bots.Num() - 1; Index >= 0; --Index)
+	{
+		FBot& Bot = Bots[Index];
+		const AMyBotController* Controller = Bot.Controller.Get();
+		if (!Controller)
+		{
+			Bots.RemoveAtSwap(Index, EAllowShrinking::No);
+			continue;
+		}
+
+		const AMyBaseCharacter* Character = Cast<AMyBaseCharacter>(Controller->GetPawn());
+		Bot.Level = Character ? Character->GetSignificanceLevel() : EMySignificanceLevel::Lowest;
+		Bot.WaitTime += DeltaTime;
+		Bot.Priority = Bot.WaitTime * MyBotLevelWeights[static_cast<int32>(Bot.Level)];
+	}
+
+	Bots.Sort([](const FBot& A, const FBot& B) { return A.Priority > B.Priority; });
+
+	const double BudgetSeconds = GMyBotBudgetMs / 1000.0;
+	const double StartTime = FPlatformTime::Seconds();
+	double Elapsed = 0.0;
+
+	// Bots registered during evaluation wait for the next frame.
+	const int32 NumBots = Bots.Num();
+	for (int32 Index = 0; Index < NumBots; ++Index)
+	{
+		if (LastNumEvaluated > 0 && Elapsed >= BudgetSeconds) { break; }
+
+		FBot& Bot = Bots[Index];
+		AMyBotController* Controller = Bot.Controller.Get();
+		if (!Controller || !Controller->IsBehaviourRunning()) { continue; }
+
+		// Copied first, the tree may unregister this bot.
+		const float WaitTime = Bot.WaitTime;
+		const int32 Level = static_cast<int32>(Bot.Level);
+		Bot.WaitTime = 0.0f;
+
+		Controller->TickBehaviour(WaitTime);
+
+		++LastNumEvaluated;
+		++LevelEvaluations[Level];
+		LevelWaitTime[Level] += WaitTime;
+		Elapsed = FPlatformTime::Seconds() - StartTime;
+	}
+
+	LastEvaluateSeconds = Elapsed;
+	MaxEvaluateSeconds = FMath::Max(MaxEvaluateSeconds, Elapsed);
+}
+
+TStatId UMyBotSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMyBotSubsystem, STATGROUP_Tickables);
+}
+
+bool UMyBotSubsystem::SpawnBots(int32 Count, const FVector& Center, float Radius, FOutputDevice& Ar)
+{
+	// Every behaviour moves on the navmesh, so without one the bots would only stand there.
+	const UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (!NavSystem || !NavSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate))
+	{
+		Ar.Logf(ELogVerbosity::Error, TEXT("Bots: %s has no navmesh, add a NavMeshBoundsVolume and build paths"), *GetWorld()->GetMapName());
+		return false;
+	}
+
+	if (!GetStateTree(GetDefault<AMyBotController>()))
+	{
+		Ar.Logf(ELogVerbosity::Warning, TEXT("Bots: no bot StateTree asset, the bots run the built-in behaviour"));
+	}
+
+	UClass* Class = GetCharacterClass();
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+
+	LLM_SCOPE_BYTAG(Project_Characters);
+	int32 NumSpawned = 0;
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		FVector Location = Center + FVector(FMath::RandPointInCircle(Radius), 100.0f);
+		FNavLocation NavLocation;
+		if (NavSystem && NavSystem->GetRandomReachablePointInRadius(Center, Radius, NavLocation))
+		{
+			Location = NavLocation.Location + FVector(0.0f, 0.0f, 100.0f);
+		}
+
+		AMyBaseCharacter* Character = GetWorld()->SpawnActor<AMyBaseCharacter>(Class, Location, FRotator(0.0f, FMath::FRandRange(-180.0f, 180.0f), 0.0f), SpawnParams);
+		if (!Character) { continue; }
+
+		Character->AIControllerClass = AMyBotController::StaticClass();
+		Character->SpawnDefaultController();
+		SpawnedBots.Add(Character);
+		++NumSpawned;
+	}
+
+	Ar.Logf(TEXT("Bots: spawned %d of %d"), NumSpawned, Count);
+	return NumSpawned == Count;
+}
+
+void UMyBotSubsystem::ClearBots()
+{
+	for (const TWeakObjectPtr<AMyBaseCharacter>& Bot : SpawnedBots)
+	{
+		if (AMyBaseCharacter* Character = Bot.Get())
+		{
+			if (AController* Controller = Character->GetController())
+			{
+				Controller->Destroy();
+			}
+			Character->Destroy();
+		}
+	}
+	SpawnedBots.Reset();
+}
+
+void UMyBotSubsystem::DumpStats(FOutputDevice& Ar)
+{
+	Ar.Logf(TEXT("Bots: %d bots, budget %.2f ms"), Bots.Num(), GMyBotBudgetMs);
+	Ar.Logf(TEXT("Bots: last frame %d evaluated in %.3f ms, max %.3f ms"), LastNumEvaluated, LastEvaluateSeconds * 1000.0, MaxEvaluateSeconds * 1000.0);
+
+	for (int32 Level = 0; Level < static_cast<int32>(EMySignificanceLevel::MAX); ++Level)
+	{
+		const double AverageWaitMs = LevelEvaluations[Level] > 0 ? LevelWaitTime[Level] / LevelEvaluations[Level] * 1000.0 : 0.0;
+		Ar.Logf(TEXT("  %-7s %8lld evaluations, every %.1f ms"), *UEnum::GetDisplayValueAsText(static_cast<EMySignificanceLevel>(Level)).ToString(), LevelEvaluations[Level], AverageWaitMs);
+		LevelEvaluations[Level] = 0;
+		LevelWaitTime[Level] = 0.0;
+	}
+	MaxEvaluateSeconds = 0.0;
+}
+
+UClass* UMyBotSubsystem::GetCharacterClass()
+{
+	if (!CharacterClass)
+	{
+		CharacterClass = StaticLoadClass(AMyBaseCharacter::StaticClass(), nullptr, TEXT("/Game/ThirdPerson/Blueprints/BP_BaseCharacter.BP_BaseCharacter_C"));
+		if (!CharacterClass)
+		{
+			CharacterClass = AMyBaseCharacter::StaticClass();
+		}
+	}
+	return CharacterClass;
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyBotsSpawn(
+	TEXT("Project.Bots.Spawn"),
+	TEXT("Spawns StateTree bots around the first player. Arguments: <Count> [Radius]."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		UMyBotSubsystem* Bots = World ? World->GetSubsystem<UMyBotSubsystem>() : nullptr;
+		if (!Bots || World->GetNetMode() == NM_Client)
+		{
+			Ar.Logf(TEXT("Bots: needs a standalone game or a server"));
+			return;
+		}
+
+		FVector Center = FVector::ZeroVector;
+		if (const APlayerController* PC = World->GetFirstPlayerController())
+		{
+			if (const APawn* Pawn = PC->GetPawn())
+			{
+				Center = Pawn->GetActorLocation();
+			}
+		}
+
+		const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 16;
+		const float Radius = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 3000.0f;
+		Bots->SpawnBots(FMath::Max(Count, 0), Center, Radius, Ar);
+	}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyBotsClear(
+	TEXT("Project.Bots.Clear"),
+	TEXT("Destroys every bot spawned with Project.Bots.Spawn."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UMyBotSubsystem* Bots = World ? World->GetSubsystem<UMyBotSubsystem>() : nullptr)
+		{
+			Bots->ClearBots();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyBotsStats(
+	TEXT("Project.Bots.Stats"),
+	TEXT("Prints the bot count, the evaluation cost and how often bots of each significance level are evaluated."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UMyBotSubsystem* Bots = World ? World->GetSubsystem<UMyBotSubsystem>() : nullptr)
+		{
+			Bots->DumpStats(Ar);
+		}
+	}));
@@ -0,0 +1,227 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyBotTasks.h"
+#include "MyBaseCharacter.h"
+#include "MyBaseDoor.h"
+#include "MyStaminaComponent.h"
+#include "InteractiveInterface.h"
+#include "StateTreeExecutionContext.h"
+#include "AIController.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "NavigationSystem.h"
+#include "Engine/World.h"
+#include "Engine/OverlapResult.h"
+
+AActor* MyBot::FindInteractable(const AMyBaseCharacter* Character, float Radius, bool bOnlyClosedDoors)
+{
+	if (!Character) { return nullptr; }
+
+	const FVector Origin = Character->GetActorLocation();
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldStatic);
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(MyBotFindInteractable), false, Character);
+
+	TArray<FOverlapResult> Overlaps;
+	Character->GetWorld()->OverlapMultiByObjectType(Overlaps, Origin, FQuat::Identity, ObjectParams, FCollisionShape::MakeSphere(Radius), QueryParams);
+
+	AActor* Best = nullptr;
+	double BestDistanceSquared = TNumericLimits<double>::Max();
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		AActor* Actor = Overlap.GetActor();
+		if (!Actor || !Actor->Implements<UInteractiveInterface>()) { continue; }
+
+		const AMyBaseDoor* Door = Cast<AMyBaseDoor>(Actor);
+		if (Door && Door->bIsOpen && bOnlyClosedDoors) { continue; }
+
+		const double DistanceSquared = FVector::DistSquared(Origin, Actor->GetActorLocation());
+		if (DistanceSquared < BestDistanceSquared)
+		{
+			BestDistanceSquared = DistanceSquared;
+			Best = Actor;
+		}
+	}
+	return Best;
+}
+
+bool MyBot::Interact(AMyBaseCharacter* Character, AActor* Target, float MaxDistance)
+{
+	if (!Character || !Target || !Target->Implements<UInteractiveInterface>()) { return false; }
+	if (FVector::Dist2D(Character->GetActorLocation(), Target->GetActorLocation()) > MaxDistance) { return false; }
+
+	IInteractiveInterface::Execute_Interact(Target, Character);
+	return true;
+}
+
+bool MyBot::GetRandomLocation(const AMyBaseCharacter* Character, float Radius, FVector& OutLocation)
+{
+	const UNavigationSystemV1* NavSystem = Character ? FNavigationSystem::GetCurrent<UNavigationSystemV1>(Character->GetWorld()) : nullptr;
+	FNavLocation NavLocation;
+	if (!NavSystem || !NavSystem->GetRandomReachablePointInRadius(Character->GetActorLocation(), Radius, NavLocation)) { return false; }
+
+	OutLocation = NavLocation.Location;
+	return true;
+}
+
+EStateTreeRunStatus FMyBotSprintTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+	if (!InstanceData.Character) { return EStateTreeRunStatus::Failed; }
+
+	InstanceData.Stamina = InstanceData.Character->FindComponentByClass<UMyStaminaComponent>();
+	if (!InstanceData.Stamina || InstanceData.Stamina->GetStaminaPercentage() < InstanceData.StartStaminaPercent)
+	{
+		return EStateTreeRunStatus::Failed;
+	}
+
+	InstanceData.Character->StartSprinting();
+	return EStateTreeRunStatus::Running;
+}
+
+EStateTreeRunStatus FMyBotSprintTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
+{
+	const FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+	if (!InstanceData.Character || !InstanceData.Stamina) { return EStateTreeRunStatus::Failed; }
+
+	// Sprinting drains stamina on its own timer, so the check only has to happen when the bot is evaluated.
+	if (!InstanceData.Stamina->HasStamina() || InstanceData.Stamina->GetStaminaPercentage() <= InstanceData.StopStaminaPercent)
+	{
+		return EStateTreeRunStatus::Succeeded;
+	}
+	return EStateTreeRunStatus::Running;
+}
+
+void FMyBotSprintTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	if (AMyBaseCharacter* Character = Context.GetInstanceData(*this).Character)
+	{
+		Character->StopSprinting();
+	}
+}
+
+EStateTreeRunStatus FMyBotCrouchTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+	if (!InstanceData.Character) { return EStateTreeRunStatus::Failed; }
+
+	InstanceData.ElapsedTime = 0.0f;
+	InstanceData.Character->StartCrouching();
+	return EStateTreeRunStatus::Running;
+}
+
+EStateTreeRunStatus FMyBotCrouchTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
+{
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+	if (InstanceData.Duration <= 0.0f) { return EStateTreeRunStatus::Running; }
+
+	InstanceData.ElapsedTime += DeltaTime;
+	return InstanceData.ElapsedTime >= InstanceData.Duration ? EStateTreeRunStatus::Succeeded : EStateTreeRunStatus::Running;
+}
+
+void FMyBotCrouchTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	if (AMyBaseCharacter* Character = Context.GetInstanceData(*this).Character)
+	{
+		Character->StopCrouching();
+	}
+}
+
+EStateTreeRunStatus FMyBotFindInteractableTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+	InstanceData.Target = MyBot::FindInteractable(InstanceData.Character, InstanceData.SearchRadius, InstanceData.bOnlyClosedDoors);
+	if (!InstanceData.Target) { return EStateTreeRunStatus::Failed; }
+
+	InstanceData.TargetLocation = InstanceData.Target->GetActorLocation();
+	return EStateTreeRunStatus::Succeeded;
+}
+
+EStateTreeRunStatus FMyBotInteractTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	const FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+	return MyBot::Interact(InstanceData.Character, InstanceData.Target, InstanceData.MaxDistance) ? EStateTreeRunStatus::Succeeded : EStateTreeRunStatus::Failed;
+}
+
+EStateTreeRunStatus FMyBotRandomLocationTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+	return MyBot::GetRandomLocation(InstanceData.Character, InstanceData.Radius, InstanceData.Location) ? EStateTreeRunStatus::Succeeded : EStateTreeRunStatus::Failed;
+}
+
+EStateTreeRunStatus FMyBotMoveToTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+	InstanceData.bMoving = false;
+
+	const APawn* Pawn = InstanceData.AIController ? InstanceData.AIController->GetPawn() : nullptr;
+	UMyNavQuerySubsystem* NavQueries = UMyNavQuerySubsystem::Get(Pawn);
+	if (!Pawn || !NavQueries) { return EStateTreeRunStatus::Failed; }
+
+	if (FVector::Dist2D(Pawn->GetActorLocation(), InstanceData.Destination) <= InstanceData.AcceptanceRadius)
+	{
+		return EStateTreeRunStatus::Succeeded;
+	}
+
+	InstanceData.PathQuery = NavQueries->RequestPath(Pawn, Pawn->GetNavAgentLocation(), InstanceData.Destination);
+	return EStateTreeRunStatus::Running;
+}
+
+EStateTreeRunStatus FMyBotMoveToTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
+{
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+	AAIController* AIController = InstanceData.AIController;
+	const APawn* Pawn = AIController ? AIController->GetPawn() : nullptr;
+	if (!Pawn) { return EStateTreeRunStatus::Failed; }
+
+	if (InstanceData.PathQuery.IsValid())
+	{
+		UMyNavQuerySubsystem* NavQueries = UMyNavQuerySubsystem::Get(Pawn);
+		FNavPathSharedPtr Path;
+		const EMyNavQueryStatus Status = NavQueries ? NavQueries->GetPathResult(InstanceData.PathQuery, Path) : EMyNavQueryStatus::Invalid;
+		if (Status == EMyNavQueryStatus::Pending) { return EStateTreeRunStatus::Running; }
+
+		InstanceData.PathQuery.Invalidate();
+		if (Status != EMyNavQueryStatus::Succeeded || !Path.IsValid()) { return EStateTreeRunStatus::Failed; }
+
+		FAIMoveRequest MoveRequest(InstanceData.Destination);
+		MoveRequest.SetAcceptanceRadius(InstanceData.AcceptanceRadius);
+		if (!AIController->RequestMove(MoveRequest, Path).IsValid()) { return EStateTreeRunStatus::Failed; }
+
+		InstanceData.bMoving = true;
+		return EStateTreeRunStatus::Running;
+	}
+
+	if (AIController->GetMoveStatus() != EPathFollowingStatus::Idle) { return EStateTreeRunStatus::Running; }
+
+	InstanceData.bMoving = false;
+	const float ArriveDistance = InstanceData.AcceptanceRadius + Pawn->GetSimpleCollisionRadius();
+	return FVector::Dist2D(Pawn->GetActorLocation(), InstanceData.Destination) <= ArriveDistance ? EStateTreeRunStatus::Succeeded : EStateTreeRunStatus::Failed;
+}
+
+void FMyBotMoveToTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+	if (InstanceData.PathQuery.IsValid())
+	{
+		if (UMyNavQuerySubsystem* NavQueries = UMyNavQuerySubsystem::Get(InstanceData.AIController))
+		{
+			NavQueries->CancelQuery(InstanceData.PathQuery);
+		}
+		InstanceData.PathQuery.Invalidate();
+	}
+
+	if (InstanceData.bMoving && InstanceData.AIController)
+	{
+		InstanceData.AIController->StopMovement();
+	}
+	InstanceData.bMoving = false;
+}
+
+bool FMyBotStaminaCondition::TestCondition(FStateTreeExecutionContext& Context) const
+{
+	const FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+	const UMyStaminaComponent* Stamina = InstanceData.Character ? InstanceData.Character->FindComponentByClass<UMyStaminaComponent>() : nullptr;
+	const bool bHasStamina = Stamina && Stamina->GetStaminaPercentage() >= InstanceData.MinStaminaPercent;
+	return bHasStamina ^ bInvert;
+}
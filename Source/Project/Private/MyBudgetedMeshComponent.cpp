@@ -0,0 +1,224 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyBudgetedMeshComponent.h"
+#include "MyAnimBenchmarkSubsystem.h"
+#include "IAnimationBudgetAllocator.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+
+static int32 GMyServerStalePoses = 1;
+static FAutoConsoleVariableRef CVarMyServerStalePoses(
+	TEXT("Project.Anim.ServerStalePoses"),
+	GMyServerStalePoses,
+	TEXT("On a dedicated server, character meshes don't tick and only evaluate their pose on demand (0 = off, 1 = on). Applies to meshes that begin play afterwards."));
+
+/* Longest animation step taken when a stale pose is brought up to date. */
+static constexpr float MyMaxPoseCatchUpSeconds = 0.25f;
+
+UMyBudgetedMeshComponent::UMyBudgetedMeshComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	// Significance comes from UMySignificanceManager.
+	SetAutoCalculateSignificance(false);
+}
+
+void UMyBudgetedMeshComponent::BeginPlay()
+{
+	bStalePoses = IsNetMode(NM_DedicatedServer) && GMyServerStalePoses != 0;
+
+	if (bStalePoses)
+	{
+		// Nothing renders on a dedicated server. Stay out of the budget allocator and don't tick;
+		// root motion montages are still ticked by the movement component.
+		SetAutoRegisterWithBudgetAllocator(false);
+		VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+		SetComponentTickEnabled(false);
+	}
+
+	Super::BeginPlay();
+}
+
+void UMyBudgetedMeshComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	UMyAnimBenchmarkSubsystem* Benchmark = GetWorld()->GetSubsystem<UMyAnimBenchmarkSubsystem>();
+	if (!Benchmark || !Benchmark->IsRecordingMeshTicks())
+	{
+		Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	Benchmark->RecordMeshTick(FPlatformTime::Seconds() - StartTime);
+}
+
+void UMyBudgetedMeshComponent::SetBudgetSignificance(float Significance, bool bLocallyControlled)
+{
+	IAnimationBudgetAllocator* Allocator = GetWorld() ? IAnimationBudgetAllocator::Get(GetWorld()) : nullptr;
+	if (!Allocator || !Allocator->GetEnabled() || bStalePoses || !HasBegunPlay()) { return; }
+
+	// The local player's mesh is not budgeted at all: it would still count against the budget and take time from
+	// everyone else even if never skipped. Possession can change, so it goes back in when someone else drives it.
+	const bool bRegistered = GetAnimationBudgetHandle() != INDEX_NONE;
+	if (bLocallyControlled)
+	{
+		if (bRegistered) { Allocator->UnregisterComponent(this); }
+		return;
+	}
+	if (!bRegistered)
+	{
+		Allocator->RegisterComponent(this);
+	}
+
+	Allocator->SetComponentSignificance(this, Significance, /*bNeverSkip*/ false, bTickEvenIfNotRendered, /*bAllowReducedWork*/ true);
+}
+
+bool UMyBudgetedMeshComponent::IsBudgeted() const
+{
+	const IAnimationBudgetAllocator* Allocator = GetWorld() ? IAnimationBudgetAllocator::Get(GetWorld()) : nullptr;
+	return Allocator && Allocator->GetEnabled() && GetAnimationBudgetHandle() != INDEX_NONE;
+}
+
+void UMyBudgetedMeshComponent::EnsurePoseEvaluated()
+{
+	if (!bStalePoses || LastPoseFrame == GFrameCounter) { return; }
+
+	const UWorld* World = GetWorld();
+	if (!World) { return; }
+
+	const double Now = World->GetTimeSeconds();
+	const float DeltaTime = LastPoseTime > 0.0 ? static_cast<float>(FMath::Min(Now - LastPoseTime, static_cast<double>(MyMaxPoseCatchUpSeconds))) : 0.0f;
+
+	LastPoseFrame = GFrameCounter;
+	LastPoseTime = Now;
+
+	// Evaluate synchronously as if the mesh was rendered, then go back to sleep.
+	const EVisibilityBasedAnimTickOption SavedTickOption = VisibilityBasedAnimTickOption;
+	VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+
+	TickAnimation(DeltaTime, false);
+	RefreshBoneTransforms();
+
+	VisibilityBasedAnimTickOption = SavedTickOption;
+
+	++NumOnDemandEvaluations;
+}
+
+FTransform UMyBudgetedMeshComponent::GetSocketTransformOnRewoundComponent(FName SocketName, double Timestamp)
+{
+	EnsurePoseEvaluated();
+
+	return GetSocketTransform(SocketName, RTS_Component) * GetComponentTransformAtTime(Timestamp);
+}
+
+FTransform UMyBudgetedMeshComponent::GetComponentTransformAtTime(double Timestamp) const
+{
+	if (TransformHistoryNum == 0)
+	{
+		return GetComponentTransform();
+	}
+
+	// Walk from the newest sample back until we pass Timestamp.
+	const int32 NewestIndex = (TransformHistoryHead + MaxTransformSamples - 1) % MaxTransformSamples;
+	const FTransformSample* Newer = &TransformHistory[NewestIndex];
+
+	if (Timestamp >= Newer->Time)
+	{
+		return GetComponentTransform();
+	}
+
+	for (int32 Offset = 1; Offset < TransformHistoryNum; ++Offset)
+	{
+		const FTransformSample* Older = &TransformHistory[(NewestIndex + MaxTransformSamples - Offset) % MaxTransformSamples];
+
+		if (Timestamp >= Older->Time)
+		{
+			const double Span = Newer->Time - Older->Time;
+			const float Alpha = Span > UE_SMALL_NUMBER ? static_cast<float>((Timestamp - Older->Time) / Span) : 1.0f;
+
+			FTransform Result;
+			Result.Blend(Older->Transform, Newer->Transform, Alpha);
+			return Result;
+		}
+
+		Newer = Older;
+	}
+
+	// Older than the history; use the oldest sample we have.
+	return Newer->Transform;
+}
+
+void UMyBudgetedMeshComponent::OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	Super::OnUpdateTransform(UpdateTransformFlags, Teleport);
+
+	if (!bStalePoses) { return; }
+
+	const UWorld* World = GetWorld();
+	const double Now = World ? World->GetTimeSeconds() : 0.0;
+
+	// Several moves in one frame only keep the last transform.
+	const int32 NewestIndex = (TransformHistoryHead + MaxTransformSamples - 1) % MaxTransformSamples;
+	if (TransformHistoryNum > 0 && TransformHistory[NewestIndex].Time == Now)
+	{
+		TransformHistory[NewestIndex].Transform = GetComponentTransform();
+		return;
+	}
+
+	TransformHistory[TransformHistoryHead].Time = Now;
+	TransformHistory[TransformHistoryHead].Transform = GetComponentTransform();
+	TransformHistoryHead = (TransformHistoryHead + 1) % MaxTransformSamples;
+	TransformHistoryNum = FMath::Min(TransformHistoryNum + 1, MaxTransformSamples);
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyServerPoseStats(
+	TEXT("Project.Anim.ServerPoseStats"),
+	TEXT("Prints how many character meshes of the world use stale poses and how many on demand pose evaluations they did."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		int32 NumMeshes = 0;
+		int32 NumStale = 0;
+		int64 NumEvaluations = 0;
+		for (TObjectIterator<UMyBudgetedMeshComponent> It; It; ++It)
+		{
+			if (It->GetWorld() == World && !It->IsTemplate())
+			{
+				++NumMeshes;
+				NumStale += It->UsesStalePoses() ? 1 : 0;
+				NumEvaluations += It->GetNumOnDemandEvaluations();
+			}
+		}
+
+		Ar.Logf(TEXT("ServerPoses: %d of %d mesh(es) use stale poses, %lld on demand evaluation(s) by these meshes"), NumStale, NumMeshes, NumEvaluations);
+	}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyRewindSockets(
+	TEXT("Project.Anim.RewindSockets"),
+	TEXT("Prints, for every character mesh with a transform history, how far a socket moves when the component is rewound. Arguments: [SecondsAgo=0.1] [Socket=head]."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (!World) { return; }
+
+		const double SecondsAgo = Args.Num() > 0 ? FCString::Atod(*Args[0]) : 0.1;
+		const FName SocketName = Args.Num() > 1 ? FName(*Args[1]) : FName(TEXT("head"));
+		const double Timestamp = World->GetTimeSeconds() - SecondsAgo;
+
+		int32 NumMeshes = 0;
+		for (TObjectIterator<UMyBudgetedMeshComponent> It; It; ++It)
+		{
+			UMyBudgetedMeshComponent* Mesh = *It;
+			if (Mesh->GetWorld() != World || Mesh->IsTemplate() || !Mesh->UsesStalePoses() || !Cast<ACharacter>(Mesh->GetOwner())) { continue; }
+
+			const FVector Now = Mesh->GetSocketTransformOnRewoundComponent(SocketName, World->GetTimeSeconds()).GetLocation();
+			const FVector Then = Mesh->GetSocketTransformOnRewoundComponent(SocketName, Timestamp).GetLocation();
+			Ar.Logf(TEXT("RewindSockets: %s %s %.1f cm (%s -> %s)"), *GetNameSafe(Mesh->GetOwner()), *SocketName.ToString(),
+				FVector::Dist(Now, Then), *Then.ToCompactString(), *Now.ToCompactString());
+			++NumMeshes;
+		}
+
+		Ar.Logf(TEXT("RewindSockets: %d mesh(es) rewound %.3f s, only meshes with stale poses keep a history"), NumMeshes, SecondsAgo);
+	}));
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyCharacterTuning.h"
+#include "Project.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+
+const FMyCharacterTuningValues FMyCharacterTuningValues::Default;
+
+UMyCharacterTuning* UMyCharacterTuning::LoadDefault()
+{
+	return Cast<UMyCharacterTuning>(StaticLoadObject(UMyCharacterTuning::StaticClass(), nullptr, TEXT("/Game/ThirdPerson/DA_CharacterTuning.DA_CharacterTuning")));
+}
+
+#if !UE_BUILD_SHIPPING
+FMyOnCharacterTuningChanged UMyCharacterTuning::OnTuningChanged;
+#endif
+
+#if WITH_EDITOR
+void UMyCharacterTuning::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	OnTuningChanged.Broadcast(this);
+}
+#endif
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithOutputDevice CmdMyTuningDump(
+	TEXT("Project.Tuning.Dump"),
+	TEXT("Lists the loaded character tuning assets and their values."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+	{
+		int32 Count = 0;
+		for (TObjectIterator<UMyCharacterTuning> It; It; ++It)
+		{
+			const FMyCharacterTuningValues& Values = It->Values;
+			Ar.Logf(TEXT("Tuning: %-32s walk %.1f sprint %.1f crouch %.1f regen time %.2f drain %.2f fill %.2f"),
+				*It->GetName(), Values.WalkSpeed, Values.SprintSpeed, Values.CrouchSpeed, Values.RegenTime, Values.DrainAmount, Values.FillAmount);
+			++Count;
+		}
+		Ar.Logf(TEXT("Tuning: %d assets loaded, %d bytes of values each"), Count, static_cast<int32>(sizeof(FMyCharacterTuningValues)));
+	}));
+
+static FAutoConsoleCommandWithArgsAndOutputDevice CmdMyTuningSet(
+	TEXT("Project.Tuning.Set"),
+	TEXT("Changes a value of a loaded character tuning asset for this session. Arguments: <Asset> <Field> <Value>."),
+	FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, FOutputDevice& Ar)
+	{
+		if (Args.Num() < 3)
+		{
+			Ar.Logf(TEXT("Tuning: usage Project.Tuning.Set <Asset> <Field> <Value>"));
+			return;
+		}
+
+		const FProperty* Property = FindFProperty<FProperty>(FMyCharacterTuningValues::StaticStruct(), FName(*Args[1]));
+		if (!Property)
+		{
+			Ar.Logf(TEXT("Tuning: no field %s"), *Args[1]);
+			return;
+		}
+
+		for (TObjectIterator<UMyCharacterTuning> It; It; ++It)
+		{
+			if (It->GetName() != Args[0]) { continue; }
+
+			if (!Property->ImportText_InContainer(*Args[2], &It->Values, *It, PPF_None))
+			{
+				Ar.Logf(TEXT("Tuning: %s is not a valid %s"), *Args[2], *Args[1]);
+				return;
+			}
+			UMyCharacterTuning::OnTuningChanged.Broadcast(*It);
+			UE_LOG(LogProject, Display, TEXT("Tuning: %s.%s = %s"), *It->GetName(), *Args[1], *Args[2]);
+			return;
+		}
+		Ar.Logf(TEXT("Tuning: no loaded tuning asset %s"), *Args[0]);
+	}));
+#endif
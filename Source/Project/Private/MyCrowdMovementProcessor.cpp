@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyCrowdMovementProcessor.h"
+#include "MyCrowdFragments.h"
+#include "MassExecutionContext.h"
+
+UMyCrowdMovementProcessor::UMyCrowdMovementProcessor()
+	: EntityQuery(*this)
+{
+	// Run by UMyCrowdSubsystem, not by the Mass processing phases.
+	bAutoRegisterWithProcessingPhases = false;
+}
+
+void UMyCrowdMovementProcessor::ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager)
+{
+	EntityQuery.AddRequirement<FMyCrowdTransformFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FMyCrowdVelocityFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FMyCrowdWanderFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FMyCrowdVitalsFragment>(EMassFragmentAccess::ReadWrite);
+}
+
+void UMyCrowdMovementProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	EntitiesToSwapIn.Reset();
+
+	const float DeltaTime = Context.GetDeltaTimeSeconds();
+	const float SwapInDistanceSquared = FMath::Square(SwapInDistance);
+
+	EntityQuery.ParallelForEachEntityChunk(Context, [this, DeltaTime, SwapInDistanceSquared](FMassExecutionContext& ChunkContext)
+	{
+		const TArrayView<FMyCrowdTransformFragment> Transforms = ChunkContext.GetMutableFragmentView<FMyCrowdTransformFragment>();
+		const TArrayView<FMyCrowdVelocityFragment> Velocities = ChunkContext.GetMutableFragmentView<FMyCrowdVelocityFragment>();
+		const TConstArrayView<FMyCrowdWanderFragment> Wanders = ChunkContext.GetFragmentView<FMyCrowdWanderFragment>();
+		const TArrayView<FMyCrowdVitalsFragment> Vitals = ChunkContext.GetMutableFragmentView<FMyCrowdVitalsFragment>();
+
+		TArray<FMassEntityHandle, TInlineAllocator<16>> ChunkSwapIns;
+
+		for (int32 Index = 0; Index < ChunkContext.GetNumEntities(); ++Index)
+		{
+			FVector& Location = Transforms[Index].Location;
+			FVector& Velocity = Velocities[Index].Velocity;
+			const FMyCrowdWanderFragment& Wander = Wanders[Index];
+
+			Location += Velocity * DeltaTime;
+
+			// Turn back towards home once outside the wander area.
+			const FVector FromHome = Location - Wander.Home;
+			if (FromHome.SizeSquared2D() > FMath::Square(Wander.Radius) && FVector::DotProduct(FromHome, Velocity) > 0.0f)
+			{
+				Velocity = (-FromHome).GetSafeNormal2D() * Velocity.Size2D();
+			}
+
+			if (!Velocity.IsNearlyZero())
+			{
+				Transforms[Index].Yaw = Velocity.Rotation().Yaw;
+			}
+
+			FMyCrowdVitalsFragment& EntityVitals = Vitals[Index];
+			EntityVitals.Stamina = FMath::Min(EntityVitals.Stamina + StaminaRegenPerSecond * DeltaTime, EntityVitals.MaximumStamina);
+
+			// In 2D: an entity's height is only where it was created, not the terrain under it now.
+			for (const FVector& Viewer : ViewerLocations)
+			{
+				if (FVector::DistSquared2D(Viewer, Location) < SwapInDistanceSquared)
+				{
+					ChunkSwapIns.Add(ChunkContext.GetEntity(Index));
+					break;
+				}
+			}
+		}
+
+		if (ChunkSwapIns.Num() > 0)
+		{
+			FScopeLock Lock(&SwapInLock);
+			EntitiesToSwapIn.Append(ChunkSwapIns);
+		}
+	});
+}
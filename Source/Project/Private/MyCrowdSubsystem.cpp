@@ -0,0 +1,440 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyCrowdSubsystem.h"
+#include "MyCrowdFragments.h"
+#include "MyCrowdMovementProcessor.h"
+#include "MyBaseCharacter.h"
+#include "MyHealthComponent.h"
+#include "MyStaminaComponent.h"
+#include "MyMemoryTags.h"
+#include "MassEntitySubsystem.h"
+#include "MassEntityManager.h"
+#include "MassExecutor.h"
+#include "MassProcessingContext.h"
+#include "MassEntityUtils.h"
+#include "AIController.h"
+#include "NavigationSystem.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+static float GMyCrowdSwapInDistance = 3000.0f;
+static FAutoConsoleVariableRef CVarMyCrowdSwapInDistance(
+	TEXT("Project.Crowd.SwapInDistance"),
+	GMyCrowdSwapInDistance,
+	TEXT("Crowd entities closer than this to a player become full characters."));
+
+static float GMyCrowdSwapOutDistance = 4000.0f;
+static FAutoConsoleVariableRef CVarMyCrowdSwapOutDistance(
+	TEXT("Project.Crowd.SwapOutDistance"),
+	GMyCrowdSwapOutDistance,
+	TEXT("Crowd characters further than this from every player go back to being entities. Keep it above SwapInDistance."));
+
+static int32 GMyCrowdMaxSwapsPerFrame = 8;
+static FAutoConsoleVariableRef CVarMyCrowdMaxSwapsPerFrame(
+	TEXT("Project.Crowd.MaxSwapsPerFrame"),
+	GMyCrowdMaxSwapsPerFrame,
+	TEXT("Maximum number of entity to actor swaps (each way) per frame."));
+
+/* A swapped in character stays an actor at least this long, so players on the boundary don't cause churn. */
+static constexpr double MyCrowdMinActorSeconds = 2.0;
+
+/* Walking speed range of crowd entities. */
+static constexpr float MyCrowdMinSpeed = 100.0f;
+static constexpr float MyCrowdMaxSpeed = 250.0f;
+
+/* How far above and below an entity the ground is looked for. Entities walk flat, terrain can be steep. */
+static constexpr float MyCrowdGroundSearchHeight = 5000.0f;
+
+bool UMyCrowdSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return Super::ShouldCreateSubsystem(Outer) && World && World->IsGameWorld();
+}
+
+void UMyCrowdSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	FMassEntityManager& EntityManager = GetEntityManager();
+
+	CrowdArchetype = EntityManager.CreateArchetype({
+		FMyCrowdTransformFragment::StaticStruct(),
+		FMyCrowdVelocityFragment::StaticStruct(),
+		FMyCrowdWanderFragment::StaticStruct(),
+		FMyCrowdVitalsFragment::StaticStruct()
+	});
+
+	MovementProcessor = NewObject<UMyCrowdMovementProcessor>(this);
+	MovementProcessor->CallInitialize(this, EntityManager.AsShared());
+}
+
+void UMyCrowdSubsystem::Deinitialize()
+{
+	CrowdActors.Reset();
+	MovementProcessor = nullptr;
+
+	Super::Deinitialize();
+}
+
+void UMyCrowdSubsystem::Tick(float DeltaTime)
+{
+	UWorld* World = GetWorld();
+	if (!MovementProcessor || World->GetNetMode() == NM_Client) { return; }
+	if (NumEntities == 0 && CrowdActors.Num() == 0) { return; }
+
+	// Player pawns are what entities swap in around.
+	TArray<FVector>& Viewers = MovementProcessor->ViewerLocations;
+	Viewers.Reset();
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APawn* Pawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+		{
+			Viewers.Add(Pawn->GetActorLocation());
+		}
+	}
+
+	double StartTime = FPlatformTime::Seconds();
+
+	if (NumEntities > 0)
+	{
+		MovementProcessor->SwapInDistance = GMyCrowdSwapInDistance;
+
+		FMassProcessingContext ProcessingContext(GetEntityManager(), DeltaTime);
+		UE::Mass::Executor::Run(*MovementProcessor, ProcessingContext);
+	}
+
+	LastProcessSeconds = FPlatformTime::Seconds() - StartTime;
+	StartTime = FPlatformTime::Seconds();
+
+	// Entities near a player become characters. Anything over the cap is reported again next frame.
+	const TArray<FMassEntityHandle> ToSwapIn = MoveTemp(MovementProcessor->EntitiesToSwapIn);
+	for (int32 Index = 0; Index < FMath::Min(ToSwapIn.Num(), GMyCrowdMaxSwapsPerFrame); ++Index)
+	{
+		SwapIn(ToSwapIn[Index]);
+	}
+
+	// Characters far from every player go back to being entities.
+	const double Now = FPlatformTime::Seconds();
+	const float SwapOutDistanceSquared = FMath::Square(FMath::Max(GMyCrowdSwapOutDistance, GMyCrowdSwapInDistance));
+	int32 NumSwappedOut = 0;
+
+	for (int32 Index = CrowdActors.Num() - 1; Index >= 0 && NumSwappedOut < GMyCrowdMaxSwapsPerFrame; --Index)
+	{
+		const FCrowdActor& CrowdActor = CrowdActors[Index];
+		const AMyBaseCharacter* Character = CrowdActor.Character.Get();
+
+		// Destroyed or taken over by a player; no longer ours.
+		if (!Character || Character->IsPlayerControlled())
+		{
+			CrowdActors.RemoveAtSwap(Index);
+			continue;
+		}
+
+		if (Now - CrowdActor.SwapInTime < MyCrowdMinActorSeconds)
+		{
+			Wander(CrowdActor);
+			continue;
+		}
+
+		bool bNearViewer = false;
+		for (const FVector& Viewer : Viewers)
+		{
+			// In 2D like swapping in, or a character on a slope could swap out and straight back in.
+			if (FVector::DistSquared2D(Viewer, Character->GetActorLocation()) < SwapOutDistanceSquared)
+			{
+				bNearViewer = true;
+				break;
+			}
+		}
+
+		if (!bNearViewer)
+		{
+			SwapOut(CrowdActor);
+			CrowdActors.RemoveAtSwap(Index);
+			++NumSwappedOut;
+		}
+		else
+		{
+			Wander(CrowdActor);
+		}
+	}
+
+	LastSwapSeconds = FPlatformTime::Seconds() - StartTime;
+}
+
+TStatId UMyCrowdSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMyCrowdSubsystem, STATGROUP_Tickables);
+}
+
+void UMyCrowdSubsystem::SpawnCrowd(int32 Count, const FVector& Center, float Radius)
+{
+	FRandomStream Random(Count);
+
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		FVector Location = Center + FVector(Random.VRand().GetSafeNormal2D() * Random.FRandRange(0.0f, Radius));
+		ProjectToGround(Location);
+		const float Yaw = Random.FRandRange(-180.0f, 180.0f);
+		const FVector Velocity = FRotator(0.0f, Yaw, 0.0f).Vector() * Random.FRandRange(MyCrowdMinSpeed, MyCrowdMaxSpeed);
+
+		CreateEntity(Location, Yaw, Velocity, Center, Radius, 100.0f, 100.0f, 100.0f, 100.0f);
+	}
+}
+
+void UMyCrowdSubsystem::ClearCrowd()
+{
+	for (const FCrowdActor& CrowdActor : CrowdActors)
+	{
+		if (AMyBaseCharacter* Character = CrowdActor.Character.Get())
+		{
+			if (AController* Controller = Character->GetController())
+			{
+				Controller->Destroy();
+			}
+			Character->Destroy();
+		}
+	}
+	CrowdActors.Reset();
+
+	FMassEntityManager& EntityManager = GetEntityManager();
+
+	TArray<FMassArchetypeEntityCollection> Collections;
+	UE::Mass::Utils::CreateEntityCollections(EntityManager, EntityManager.GetEntitiesOfArchetype(CrowdArchetype), FMassArchetypeEntityCollection::NoDuplicates, Collections);
+	EntityManager.BatchDestroyEntityChunks(Collections);
+
+	NumEntities = 0;
+}
+
+void UMyCrowdSubsystem::DumpStats(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("Crowd: %d entities, %d actors"), NumEntities, CrowdActors.Num());
+	Ar.Logf(TEXT("Crowd: last frame %.3f ms processing, %.3f ms swapping"), LastProcessSeconds * 1000.0, LastSwapSeconds * 1000.0);
+}
+
+FMassEntityManager& UMyCrowdSubsystem::GetEntityManager() const
+{
+	return GetWorld()->GetSubsystem<UMassEntitySubsystem>()->GetMutableEntityManager();
+}
+
+void UMyCrowdSubsystem::SwapIn(FMassEntityHandle Entity)
+{
+	FMassEntityManager& EntityManager = GetEntityManager();
+	if (!EntityManager.IsEntityValid(Entity)) { return; }
+
+	UClass* Class = GetCharacterClass();
+
+	const FMyCrowdTransformFragment& Transform = EntityManager.GetFragmentDataChecked<FMyCrowdTransformFragment>(Entity);
+	const FMyCrowdVelocityFragment& Velocity = EntityManager.GetFragmentDataChecked<FMyCrowdVelocityFragment>(Entity);
+	const FMyCrowdWanderFragment& Wander = EntityManager.GetFragmentDataChecked<FMyCrowdWanderFragment>(Entity);
+	const FMyCrowdVitalsFragment& Vitals = EntityManager.GetFragmentDataChecked<FMyCrowdVitalsFragment>(Entity);
+
+	// Entities only keep the height they were created at; stand the character on the ground below them.
+	FVector Location = Transform.Location;
+	ProjectToGround(Location);
+	const ACharacter* DefaultCharacter = Class->GetDefaultObject<ACharacter>();
+	Location.Z += DefaultCharacter->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+
+	LLM_SCOPE_BYTAG(Project_Characters);
+	AMyBaseCharacter* Character = GetWorld()->SpawnActor<AMyBaseCharacter>(Class, Location, FRotator(0.0f, Transform.Yaw, 0.0f), SpawnParams);
+
+	// Blocked; stay an entity and try again next frame.
+	if (!Character) { return; }
+
+	// Characters only move with a controller; a plain AI controller walks them around their wander area.
+	Character->AIControllerClass = AAIController::StaticClass();
+	Character->SpawnDefaultController();
+
+	// Maximum first, the current value is clamped against it.
+	if (UMyHealthComponent* Health = Character->FindComponentByClass<UMyHealthComponent>())
+	{
+		Health->ServerSetCurrentMaximumHealth(Vitals.MaximumHealth);
+		Health->ServerSetCurrentHealth(Vitals.Health);
+	}
+
+	if (UMyStaminaComponent* Stamina = Character->FindComponentByClass<UMyStaminaComponent>())
+	{
+		Stamina->ServerSetMaximumStamina(Vitals.MaximumStamina);
+		Stamina->ServerSetCurrentStamina(Vitals.Stamina);
+	}
+
+	Character->GetCharacterMovement()->Velocity = Velocity.Velocity;
+
+	FCrowdActor& CrowdActor = CrowdActors.AddDefaulted_GetRef();
+	CrowdActor.Character = Character;
+	CrowdActor.Home = Wander.Home;
+	CrowdActor.Radius = Wander.Radius;
+	CrowdActor.SwapInTime = FPlatformTime::Seconds();
+	Wander(CrowdActor);
+
+	EntityManager.DestroyEntity(Entity);
+	--NumEntities;
+}
+
+void UMyCrowdSubsystem::Wander(const FCrowdActor& CrowdActor) const
+{
+	AAIController* Controller = CrowdActor.Character.IsValid() ? Cast<AAIController>(CrowdActor.Character->GetController()) : nullptr;
+	if (!Controller || Controller->GetMoveStatus() != EPathFollowingStatus::Idle) { return; }
+
+	const UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	FNavLocation Destination;
+	if (NavSystem && NavSystem->GetRandomReachablePointInRadius(CrowdActor.Home, CrowdActor.Radius, Destination))
+	{
+		Controller->MoveToLocation(Destination.Location);
+	}
+}
+
+bool UMyCrowdSubsystem::ProjectToGround(FVector& InOutLocation) const
+{
+	if (const UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		FNavLocation NavLocation;
+		if (NavSystem->ProjectPointToNavigation(InOutLocation, NavLocation, FVector(100.0f, 100.0f, MyCrowdGroundSearchHeight)))
+		{
+			InOutLocation = NavLocation.Location;
+			return true;
+		}
+	}
+
+	// Off the navmesh, or there is none: the first thing below.
+	FHitResult Hit;
+	const FVector Up(0.0f, 0.0f, MyCrowdGroundSearchHeight);
+	if (GetWorld()->LineTraceSingleByChannel(Hit, InOutLocation + Up, InOutLocation - Up, ECC_Visibility))
+	{
+		InOutLocation = Hit.ImpactPoint;
+		return true;
+	}
+	return false;
+}
+
+void UMyCrowdSubsystem::SwapOut(const FCrowdActor& CrowdActor)
+{
+	AMyBaseCharacter* Character = CrowdActor.Character.Get();
+	if (!Character) { return; }
+
+	float Health = 100.0f;
+	float MaximumHealth = 100.0f;
+	if (const UMyHealthComponent* HealthComponent = Character->FindComponentByClass<UMyHealthComponent>())
+	{
+		Health = HealthComponent->GetCurrentHealth();
+		MaximumHealth = HealthComponent->GetCurrentMaximumHealth();
+	}
+
+	float Stamina = 100.0f;
+	float MaximumStamina = 100.0f;
+	if (const UMyStaminaComponent* StaminaComponent = Character->FindComponentByClass<UMyStaminaComponent>())
+	{
+		Stamina = StaminaComponent->GetCurrentStamina();
+		MaximumStamina = StaminaComponent->GetMaximumStamina();
+	}
+
+	// Keep walking the way the character was going, at crowd speed.
+	FVector Velocity = Character->GetVelocity().GetSafeNormal2D();
+	if (Velocity.IsNearlyZero())
+	{
+		Velocity = Character->GetActorForwardVector().GetSafeNormal2D();
+	}
+	Velocity *= MyCrowdMinSpeed;
+
+	CreateEntity(Character->GetNavAgentLocation(), Character->GetActorRotation().Yaw, Velocity, CrowdActor.Home, CrowdActor.Radius, Health, MaximumHealth, Stamina, MaximumStamina);
+
+	if (AController* Controller = Character->GetController())
+	{
+		Controller->Destroy();
+	}
+	Character->Destroy();
+}
+
+FMassEntityHandle UMyCrowdSubsystem::CreateEntity(const FVector& Location, float Yaw, const FVector& Velocity, const FVector& Home, float Radius, float Health, float MaximumHealth, float Stamina, float MaximumStamina)
+{
+	FMassEntityManager& EntityManager = GetEntityManager();
+	const FMassEntityHandle Entity = EntityManager.CreateEntity(CrowdArchetype);
+
+	FMyCrowdTransformFragment& Transform = EntityManager.GetFragmentDataChecked<FMyCrowdTransformFragment>(Entity);
+	Transform.Location = Location;
+	Transform.Yaw = Yaw;
+
+	EntityManager.GetFragmentDataChecked<FMyCrowdVelocityFragment>(Entity).Velocity = Velocity;
+
+	FMyCrowdWanderFragment& Wander = EntityManager.GetFragmentDataChecked<FMyCrowdWanderFragment>(Entity);
+	Wander.Home = Home;
+	Wander.Radius = Radius;
+
+	FMyCrowdVitalsFragment& Vitals = EntityManager.GetFragmentDataChecked<FMyCrowdVitalsFragment>(Entity);
+	Vitals.Health = Health;
+	Vitals.MaximumHealth = MaximumHealth;
+	Vitals.Stamina = Stamina;
+	Vitals.MaximumStamina = MaximumStamina;
+
+	++NumEntities;
+	return Entity;
+}
+
+UClass* UMyCrowdSubsystem::GetCharacterClass()
+{
+	if (!CharacterClass)
+	{
+		CharacterClass = StaticLoadClass(AMyBaseCharacter::StaticClass(), nullptr, TEXT("/Game/ThirdPerson/Blueprints/BP_BaseCharacter.BP_BaseCharacter_C"));
+		if (!CharacterClass)
+		{
+			CharacterClass = AMyBaseCharacter::StaticClass();
+		}
+	}
+	return CharacterClass;
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyCrowdSpawn(
+	TEXT("Project.Crowd.Spawn"),
+	TEXT("Spawns ambient crowd entities around the first player. Arguments: <Count> [Radius]."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		UMyCrowdSubsystem* Crowd = World ? World->GetSubsystem<UMyCrowdSubsystem>() : nullptr;
+		if (!Crowd || World->GetNetMode() == NM_Client)
+		{
+			Ar.Logf(TEXT("Crowd: needs a standalone game or a server"));
+			return;
+		}
+
+		FVector Center = FVector::ZeroVector;
+		if (const APlayerController* PC = World->GetFirstPlayerController())
+		{
+			if (const APawn* Pawn = PC->GetPawn())
+			{
+				Center = Pawn->GetActorLocation();
+			}
+		}
+
+		const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000;
+		const float Radius = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 20000.0f;
+		Crowd->SpawnCrowd(FMath::Max(Count, 0), Center, Radius);
+		Crowd->DumpStats(Ar);
+	}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyCrowdClear(
+	TEXT("Project.Crowd.Clear"),
+	TEXT("Destroys every crowd entity and crowd character."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UMyCrowdSubsystem* Crowd = World ? World->GetSubsystem<UMyCrowdSubsystem>() : nullptr)
+		{
+			Crowd->ClearCrowd();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyCrowdStats(
+	TEXT("Project.Crowd.Stats"),
+	TEXT("Prints crowd entity and actor counts and last frame's cost."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (const UMyCrowdSubsystem* Crowd = World ? World->GetSubsystem<UMyCrowdSubsystem>() : nullptr)
+		{
+			Crowd->DumpStats(Ar);
+		}
+	}));
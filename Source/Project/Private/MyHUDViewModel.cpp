@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyHUDViewModel.h"
+#include "MyHealthComponent.h"
+#include "MyStaminaComponent.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "MyMemoryTags.h"
+
+void UMyHUDViewModel::Initialize(APlayerController* InPlayerController)
+{
+	LLM_SCOPE_BYTAG(Project_UI);
+
+	Deinitialize();
+
+	PlayerController = InPlayerController;
+	if (!InPlayerController) { return; }
+
+	// Broadcast by SetPawn() on the server and on clients alike, for possession, respawn and unpossession.
+	NewPawnHandle = InPlayerController->GetOnNewPawnNotifier().AddUObject(this, &UMyHUDViewModel::OnNewPawn);
+	BindPawn(InPlayerController->GetPawn());
+}
+
+void UMyHUDViewModel::Deinitialize()
+{
+	UnbindPawn();
+
+	if (APlayerController* PC = PlayerController.Get())
+	{
+		PC->GetOnNewPawnNotifier().Remove(NewPawnHandle);
+	}
+	NewPawnHandle.Reset();
+	PlayerController.Reset();
+}
+
+bool UMyHUDViewModel::ConsumeHealth(float& OutPercent)
+{
+	OutPercent = HealthPercent;
+	return Exchange(bHealthChanged, false);
+}
+
+bool UMyHUDViewModel::ConsumeStamina(float& OutPercent)
+{
+	OutPercent = StaminaPercent;
+	return Exchange(bStaminaChanged, false);
+}
+
+void UMyHUDViewModel::BindPawn(APawn* Pawn)
+{
+	LLM_SCOPE_BYTAG(Project_UI);
+
+	UnbindPawn();
+	if (!Pawn) { return; }
+
+	if (UMyHealthComponent* Health = Pawn->FindComponentByClass<UMyHealthComponent>())
+	{
+		HealthComponent = Health;
+		HealthChangedHandle = Health->OnHealthChangedNative.AddUObject(this, &UMyHUDViewModel::OnHealthChanged);
+		HealthPercent = Health->GetHealthPercentage();
+		bHealthChanged = true;
+	}
+
+	if (UMyStaminaComponent* Stamina = Pawn->FindComponentByClass<UMyStaminaComponent>())
+	{
+		StaminaComponent = Stamina;
+		StaminaChangedHandle = Stamina->OnStaminaChangedNative.AddUObject(this, &UMyHUDViewModel::OnStaminaChanged);
+		StaminaPercent = Stamina->GetStaminaPercentage();
+		bStaminaChanged = true;
+	}
+}
+
+void UMyHUDViewModel::UnbindPawn()
+{
+	if (UMyHealthComponent* Health = HealthComponent.Get())
+	{
+		Health->OnHealthChangedNative.Remove(HealthChangedHandle);
+	}
+	if (UMyStaminaComponent* Stamina = StaminaComponent.Get())
+	{
+		Stamina->OnStaminaChangedNative.Remove(StaminaChangedHandle);
+	}
+
+	HealthComponent.Reset();
+	StaminaComponent.Reset();
+	HealthChangedHandle.Reset();
+	StaminaChangedHandle.Reset();
+}
+
+void UMyHUDViewModel::OnNewPawn(APawn* Pawn)
+{
+	BindPawn(Pawn);
+}
+
+void UMyHUDViewModel::OnHealthChanged(const FMyStatChange& Change)
+{
+	HealthPercent = Change.GetPercentage();
+	bHealthChanged = true;
+}
+
+void UMyHUDViewModel::OnStaminaChanged(const FMyStatChange& Change)
+{
+	StaminaPercent = Change.GetPercentage();
+	bStaminaChanged = true;
+}
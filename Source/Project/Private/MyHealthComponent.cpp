@@ -2,7 +2,10 @@
 
 #include "MyHealthComponent.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 #include "GameFramework/Actor.h"
+#include "MyNetStatsSubsystem.h"
+#include "MyMemoryTags.h"
 
 // Sets default values for this component's properties
 UMyHealthComponent::UMyHealthComponent()
@@ -15,11 +18,26 @@ UMyHealthComponent::UMyHealthComponent()
 	CurrentMaximumHealth = 100.0f;
 	bIsActorDead = false;
 	bIsActorHealable = true;
+	NotifiedHealth = CurrentHealth;
+}
+
+void UMyHealthComponent::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	UMyNetStatsSubsystem::RecordReplicatedProperties(this);
+}
+
+bool UMyHealthComponent::CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack)
+{
+	UMyNetStatsSubsystem::RecordRemoteFunction(this, Function, Parameters);
+
+	return Super::CallRemoteFunction(Function, Parameters, OutParms, Stack);
 }
 
 void UMyHealthComponent::OnRep_CurrentHealth()
 {
-	UpdateHealthStatus();
+	UpdateHealthStatus(EMyStatChangeCause::Replicated);
 }
 
 float UMyHealthComponent::GetBaseCurrentHealth() const
@@ -78,6 +96,8 @@ void UMyHealthComponent::ServerIsActorHealable_Implementation(bool bHealable)
 	if (bIsActorHealable == bHealable) { return; }
 
 	bIsActorHealable = bHealable;
+
+	MarkReplicatedStateDirty();
 }
 
 void UMyHealthComponent::ServerSetActorDead_Implementation(bool bDead)
@@ -88,7 +108,7 @@ void UMyHealthComponent::ServerSetActorDead_Implementation(bool bDead)
 
 	if (bDead) { CurrentHealth = 0.0f; }
 
-	UpdateHealthStatus();
+	UpdateHealthStatus(EMyStatChangeCause::Set);
 }
 
 void UMyHealthComponent::ServerIncreaseBaseCurrentHealth_Implementation(float Amount)
@@ -101,14 +121,14 @@ void UMyHealthComponent::ServerIncreaseBaseCurrentHealth_Implementation(float Am
 		CurrentMaximumHealth = BaseCurrentHealth;
 	}
 
-	UpdateHealthStatus();
+	UpdateHealthStatus(EMyStatChangeCause::Maximum);
 }
 
 void UMyHealthComponent::ServerDecreaseBaseCurrentHealth_Implementation(float Amount)
 {
 	BaseCurrentHealth = FMath::Max(BaseCurrentHealth - Amount, 0.0f);
 
-	UpdateHealthStatus();
+	UpdateHealthStatus(EMyStatChangeCause::Maximum);
 }
 
 void UMyHealthComponent::ServerSetBaseCurrentHealth_Implementation(float Amount)
@@ -117,27 +137,27 @@ void UMyHealthComponent::ServerSetBaseCurrentHealth_Implementation(float Amount)
 
 	BaseCurrentHealth = Amount;
 
-	UpdateHealthStatus();
+	UpdateHealthStatus(EMyStatChangeCause::Maximum);
 }
 
 void UMyHealthComponent::ServerIncreaseCurrentHealth_Implementation(float Amount)
 {
 	if (!bIsActorHealable) { return; }
 
-	CurrentHealth = FMath::Clamp(CurrentHealth + Amount, 0.0f, CurrentMaximumHealth);
-	UpdateHealthStatus();
+	CurrentHealth = FMath::Clamp(CurrentHealth + Amount, 0.0f, CurrentMaximumHealth.Get());
+	UpdateHealthStatus(EMyStatChangeCause::Heal);
 }
 
 void UMyHealthComponent::ServerDecreaseCurrentHealth_Implementation(float Amount)
 {
-	CurrentHealth = FMath::Clamp(CurrentHealth - Amount, 0.0f, CurrentMaximumHealth);
-	UpdateHealthStatus();
+	CurrentHealth = FMath::Clamp(CurrentHealth - Amount, 0.0f, CurrentMaximumHealth.Get());
+	UpdateHealthStatus(EMyStatChangeCause::Damage);
 }
 
 void UMyHealthComponent::ServerSetCurrentHealth_Implementation(float Amount)
 {
-	CurrentHealth = FMath::Clamp(Amount, 0.0f, CurrentMaximumHealth);
-	UpdateHealthStatus();
+	CurrentHealth = FMath::Clamp(Amount, 0.0f, CurrentMaximumHealth.Get());
+	UpdateHealthStatus(EMyStatChangeCause::Set);
 }
 
 void UMyHealthComponent::ServerIncreaseCurrentMaximumHealth_Implementation(float Amount)
@@ -145,7 +165,7 @@ void UMyHealthComponent::ServerIncreaseCurrentMaximumHealth_Implementation(float
 	if (!bIsActorHealable) { return; }
 
 	CurrentMaximumHealth += Amount;
-	UpdateHealthStatus();
+	UpdateHealthStatus(EMyStatChangeCause::Maximum);
 }
 
 void UMyHealthComponent::ServerDecreaseCurrentMaximumHealth_Implementation(float Amount)
@@ -153,7 +173,7 @@ void UMyHealthComponent::ServerDecreaseCurrentMaximumHealth_Implementation(float
 	CurrentMaximumHealth = FMath::Max(0.0f, CurrentMaximumHealth - Amount);
 	CurrentHealth = FMath::Min(CurrentHealth, CurrentMaximumHealth);
 
-	UpdateHealthStatus();
+	UpdateHealthStatus(EMyStatChangeCause::Maximum);
 }
 
 void UMyHealthComponent::ServerSetCurrentMaximumHealth_Implementation(float Amount)
@@ -161,14 +181,36 @@ void UMyHealthComponent::ServerSetCurrentMaximumHealth_Implementation(float Amou
 	CurrentMaximumHealth = Amount;
 	CurrentHealth = FMath::Min(CurrentHealth, CurrentMaximumHealth);
 
-	UpdateHealthStatus();
+	UpdateHealthStatus(EMyStatChangeCause::Maximum);
 }
 
-void UMyHealthComponent::UpdateHealthStatus()
+void UMyHealthComponent::UpdateHealthStatus(EMyStatChangeCause Cause)
 {
+	LLM_SCOPE_BYTAG(Project_Stats);
+
 	bIsActorDead = IsActorDead();
 
-	OnHealthChanged.Broadcast();
+	MarkReplicatedStateDirty();
+
+	const FMyStatChange Change(NotifiedHealth, CurrentHealth, CurrentMaximumHealth, Cause);
+	NotifiedHealth = CurrentHealth;
+
+	OnHealthChangedNative.Broadcast(Change);
+
+	// Dynamic delegates copy the event into a parameter frame per listener; skip that when no Blueprint listens.
+	if (OnHealthChanged.IsBound())
+	{
+		OnHealthChanged.Broadcast(Change);
+	}
+}
+
+void UMyHealthComponent::MarkReplicatedStateDirty()
+{
+	MARK_PROPERTY_DIRTY_FROM_NAME(UMyHealthComponent, BaseCurrentHealth, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(UMyHealthComponent, CurrentHealth, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(UMyHealthComponent, CurrentMaximumHealth, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(UMyHealthComponent, bIsActorDead, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(UMyHealthComponent, bIsActorHealable, this);
 }
 
 float UMyHealthComponent::GetHealthPercentage() const
@@ -181,34 +223,34 @@ float UMyHealthComponent::GetHealthPercentage() const
 FText UMyHealthComponent::GetBaseCurrentHealthText(bool bRound) const
 {
 	if (bRound) {
-		return FText::AsNumber(FMath::RoundToInt(BaseCurrentHealth));
+		return FText::AsNumber(FMath::RoundToInt(BaseCurrentHealth.Get()));
 	}
 
-	return FText::AsNumber(BaseCurrentHealth);
+	return FText::AsNumber(BaseCurrentHealth.Get());
 }
 
 FText UMyHealthComponent::GetCurrentHealthText(bool bRound) const
 {
 	if (bRound) {
-		return FText::AsNumber(FMath::RoundToInt(CurrentHealth));
+		return FText::AsNumber(FMath::RoundToInt(CurrentHealth.Get()));
 	}
 
-	return FText::AsNumber(CurrentHealth);
+	return FText::AsNumber(CurrentHealth.Get());
 }
 
 FText UMyHealthComponent::GetCurrentMaximumHealthText(bool bRound) const
 {
 	if (bRound) {
-		return FText::AsNumber(FMath::RoundToInt(CurrentMaximumHealth));
+		return FText::AsNumber(FMath::RoundToInt(CurrentMaximumHealth.Get()));
 	}
 
-	return FText::AsNumber(CurrentMaximumHealth);
+	return FText::AsNumber(CurrentMaximumHealth.Get());
 }
 
 FText UMyHealthComponent::GetHealthFractionText(bool bRound) const
 {
-	FText CurrentText = bRound ? FText::AsNumber(FMath::RoundToInt(CurrentHealth)) : FText::AsNumber(CurrentHealth);
-	FText MaxText = bRound ? FText::AsNumber(FMath::RoundToInt(CurrentMaximumHealth)) : FText::AsNumber(CurrentMaximumHealth);
+	FText CurrentText = bRound ? FText::AsNumber(FMath::RoundToInt(CurrentHealth.Get())) : FText::AsNumber(CurrentHealth.Get());
+	FText MaxText = bRound ? FText::AsNumber(FMath::RoundToInt(CurrentMaximumHealth.Get())) : FText::AsNumber(CurrentMaximumHealth.Get());
 
 	return FText::Format(NSLOCTEXT("Health", "HealthFraction", "{0} / {1}"), CurrentText, MaxText);
 }
@@ -217,9 +259,13 @@ void UMyHealthComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& O
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(UMyHealthComponent, BaseCurrentHealth);
-	DOREPLIFETIME(UMyHealthComponent, CurrentHealth);
-	DOREPLIFETIME(UMyHealthComponent, CurrentMaximumHealth);
-	DOREPLIFETIME(UMyHealthComponent, bIsActorDead);
-	DOREPLIFETIME(UMyHealthComponent, bIsActorHealable);
+	// Health only changes through the modifiers above, which mark it dirty.
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(UMyHealthComponent, BaseCurrentHealth, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UMyHealthComponent, CurrentHealth, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UMyHealthComponent, CurrentMaximumHealth, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UMyHealthComponent, bIsActorDead, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UMyHealthComponent, bIsActorHealable, Params);
 }
\ No newline at end of file
@@ -0,0 +1,199 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyHitchDetector.h"
+#include "Project.h"
+#include "MyBaseCharacter.h"
+#include "MyBaseMovementComponent.h"
+#include "MyMovementTelemetrySubsystem.h"
+#include "MyTimerSubsystem.h"
+#include "EngineUtils.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/DelayedAutoRegister.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/MiscTrace.h"
+#include "ProfilingDebugging/TraceAuxiliary.h"
+#include "Trace/Trace.h"
+#include "UObject/UObjectArray.h"
+
+static int32 GMyHitchEnabled = 1;
+static FAutoConsoleVariableRef CVarMyHitchEnabled(
+	TEXT("Project.Hitch.Enabled"),
+	GMyHitchEnabled,
+	TEXT("1 writes a trace dump when a frame takes longer than Project.Hitch.ThresholdMs."));
+
+static float GMyHitchThresholdMs = 100.0f;
+static FAutoConsoleVariableRef CVarMyHitchThresholdMs(
+	TEXT("Project.Hitch.ThresholdMs"),
+	GMyHitchThresholdMs,
+	TEXT("Frames longer than this many milliseconds are hitches."));
+
+static float GMyHitchCooldownSeconds = 10.0f;
+static FAutoConsoleVariableRef CVarMyHitchCooldownSeconds(
+	TEXT("Project.Hitch.CooldownSeconds"),
+	GMyHitchCooldownSeconds,
+	TEXT("Least seconds between two hitch dumps."));
+
+static int32 GMyHitchMaxDumps = 20;
+static FAutoConsoleVariableRef CVarMyHitchMaxDumps(
+	TEXT("Project.Hitch.MaxDumps"),
+	GMyHitchMaxDumps,
+	TEXT("Hitch dumps written per run at most."));
+
+static FString GMyHitchChannels = TEXT("frame,bookmark,project");
+static FAutoConsoleVariableRef CVarMyHitchChannels(
+	TEXT("Project.Hitch.Channels"),
+	GMyHitchChannels,
+	TEXT("Trace channels switched on at startup for the hitch dumps, separated by commas. The project channel holds the ")
+	TEXT("project's own scopes; add cpu to record them, at the cost of tracing every engine CPU scope of every frame. Set in an ini or with ")
+	TEXT("-ini:Engine:[ConsoleVariables]:Project.Hitch.Channels=...; changing it later has no effect."));
+
+static TUniquePtr<FMyHitchDetector> GMyHitchDetector;
+
+void FMyHitchDetector::Start()
+{
+	check(IsInGameThread());
+	// The editor hitches by design (asset loads, compiles) and must not pay for the channels.
+	if (GMyHitchDetector || GIsEditor) { return; }
+
+#if UE_TRACE_ENABLED
+	TArray<FString> Channels;
+	GMyHitchChannels.ParseIntoArray(Channels, TEXT(","));
+	for (const FString& Channel : Channels)
+	{
+		if (!UE::Trace::ToggleChannel(*Channel.TrimStartAndEnd(), true))
+		{
+			UE_LOG(LogProject, Warning, TEXT("Hitch: unknown trace channel '%s'"), *Channel);
+		}
+	}
+#endif
+
+	GMyHitchDetector = MakeUnique<FMyHitchDetector>();
+	FCoreDelegates::OnBeginFrame.AddRaw(GMyHitchDetector.Get(), &FMyHitchDetector::OnBeginFrame);
+}
+
+void FMyHitchDetector::OnBeginFrame()
+{
+	const double Now = FPlatformTime::Seconds();
+	const double FrameSeconds = Now - FrameStartTime;
+	const bool bFirstFrame = FrameStartTime == 0.0;
+	FrameStartTime = Now;
+
+	if (bFirstFrame || !GMyHitchEnabled || FrameSeconds * 1000.0 < GMyHitchThresholdMs) { return; }
+	if (NumDumps >= GMyHitchMaxDumps || Now - LastDumpTime < GMyHitchCooldownSeconds) { return; }
+	if (!HasGameWorld()) { return; }
+
+	if (Dump(TEXT("Hitch"), FrameSeconds, *GLog))
+	{
+		++NumDumps;
+		LastDumpTime = Now;
+	}
+
+	// The dump's own time is not the next frame's.
+	FrameStartTime = FPlatformTime::Seconds();
+}
+
+bool FMyHitchDetector::HasGameWorld()
+{
+	if (!GEngine) { return false; }
+	for (const FWorldContext& Context : GEngine->GetWorldContexts())
+	{
+		const UWorld* World = Context.World();
+		// Map loads without seamless travel run with no world at all and are slow on purpose.
+		if (World && World->IsGameWorld() && World->HasBegunPlay()) { return true; }
+	}
+	return false;
+}
+
+bool FMyHitchDetector::Dump(const TCHAR* Reason, double FrameSeconds, FOutputDevice& Ar)
+{
+#if UE_TRACE_ENABLED
+	TRACE_BOOKMARK(TEXT("%s %.1f ms"), Reason, FrameSeconds * 1000.0);
+
+	const FString Directory = FPaths::Combine(FPaths::ProfilingDir(), TEXT("Hitches"));
+	const FString Name = FString::Printf(TEXT("Hitch_%s"), *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S-%s")));
+	const FString TracePath = FPaths::Combine(Directory, Name + TEXT(".utrace"));
+	IFileManager::Get().MakeDirectory(*Directory, true);
+
+	const double StartTime = FPlatformTime::Seconds();
+	if (!FTraceAuxiliary::WriteSnapshot(*TracePath))
+	{
+		Ar.Logf(ELogVerbosity::Warning, TEXT("Hitch: could not write %s"), *TracePath);
+		return false;
+	}
+
+	FString Counters = FString::Printf(TEXT("Reason: %s\nFrameMs: %.2f\n"), Reason, FrameSeconds * 1000.0);
+	GetCounters(Counters);
+	FFileHelper::SaveStringToFile(Counters, *FPaths::Combine(Directory, Name + TEXT(".txt")));
+
+	const FString CsvPath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("Hitches.csv"));
+	FString Csv;
+	if (!IFileManager::Get().FileExists(*CsvPath))
+	{
+		Csv = TEXT("Name,Reason,FrameMs,GameThreadMs,RenderThreadMs,AsyncLoading\n");
+	}
+	Csv += FString::Printf(TEXT("%s,%s,%.2f,%.2f,%.2f,%d\n"), *Name, Reason, FrameSeconds * 1000.0,
+		FPlatformTime::ToMilliseconds(GGameThreadTime), FPlatformTime::ToMilliseconds(GRenderThreadTime), IsAsyncLoading() ? 1 : 0);
+	FFileHelper::SaveStringToFile(Csv, *CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	Ar.Logf(ELogVerbosity::Warning, TEXT("Hitch: %.1f ms frame, wrote %s in %.1f ms"), FrameSeconds * 1000.0, *TracePath,
+		(FPlatformTime::Seconds() - StartTime) * 1000.0);
+	return true;
+#else
+	Ar.Logf(TEXT("Hitch: trace is compiled out of this build"));
+	return false;
+#endif
+}
+
+void FMyHitchDetector::GetCounters(FString& Out)
+{
+	// GGameThreadTime and GRenderThreadTime are of the frame before the hitch, the hitch itself isn't done yet.
+	Out += FString::Printf(TEXT("GameThreadMs: %.2f\n"), FPlatformTime::ToMilliseconds(GGameThreadTime));
+	Out += FString::Printf(TEXT("RenderThreadMs: %.2f\n"), FPlatformTime::ToMilliseconds(GRenderThreadTime));
+	Out += FString::Printf(TEXT("AsyncLoading: %d\n"), IsAsyncLoading() ? 1 : 0);
+	Out += FString::Printf(TEXT("UObjects: %d\n"), GUObjectArray.GetObjectArrayNumMinusAvailable());
+	Out += FString::Printf(TEXT("UsedPhysicalMB: %.1f\n"), FPlatformMemory::GetStats().UsedPhysical / 1048576.0);
+	Out += FString::Printf(TEXT("ClientCorrections: %lld\n"), UMyBaseMovementComponent::NumClientCorrections);
+	Out += FString::Printf(TEXT("HeapAllocatedMoves: %lld\n"), UMyBaseMovementComponent::NumHeapAllocatedMoves);
+
+	if (!GEngine) { return; }
+	for (const FWorldContext& Context : GEngine->GetWorldContexts())
+	{
+		UWorld* World = Context.World();
+		if (!World || !World->IsGameWorld()) { continue; }
+
+		int32 NumCharacters = 0;
+		for (TActorIterator<AMyBaseCharacter> It(World); It; ++It)
+		{
+			++NumCharacters;
+		}
+		UMyTimerSubsystem* Timers = World->GetSubsystem<UMyTimerSubsystem>();
+		const UMyMovementTelemetrySubsystem* Telemetry = World->GetSubsystem<UMyMovementTelemetrySubsystem>();
+
+		Out += FString::Printf(TEXT("World %s:\n"), *World->GetMapName());
+		Out += FString::Printf(TEXT("  Players: %d\n"), World->GetNumPlayerControllers());
+		Out += FString::Printf(TEXT("  Characters: %d\n"), NumCharacters);
+		Out += FString::Printf(TEXT("  Timers: %d\n"), Timers ? Timers->GetWheel().Num() : 0);
+		Out += FString::Printf(TEXT("  MovementCorrections: %lld\n"), Telemetry ? Telemetry->GetTotalCorrections() : 0);
+	}
+}
+
+namespace MyHitchDetector
+{
+	static FDelayedAutoRegisterHelper RegisterDetector(EDelayedRegisterRunPhase::EndOfEngineInit, []()
+	{
+		FMyHitchDetector::Start();
+	});
+}
+
+static FAutoConsoleCommandWithOutputDevice CmdMyHitchDump(
+	TEXT("Project.Hitch.Dump"),
+	TEXT("Writes the trace tail and the project counters to Saved/Profiling/Hitches now, as a hitch would."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+	{
+		FMyHitchDetector::Dump(TEXT("Manual"), 0.0, Ar);
+	}));
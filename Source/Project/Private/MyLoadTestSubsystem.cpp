@@ -0,0 +1,365 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyLoadTestSubsystem.h"
+#include "Project.h"
+#include "MyBaseCharacter.h"
+#include "MyBasePlayerController.h"
+#include "MyMovementTelemetrySubsystem.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+static FString GMyLoadTestClientExecutable;
+static FAutoConsoleVariableRef CVarMyLoadTestClientExecutable(
+	TEXT("Project.LoadTest.ClientExecutable"),
+	GMyLoadTestClientExecutable,
+	TEXT("Executable launched for load test clients. Empty uses this executable, which has to be able to run as a client (not a server-only target)."));
+
+/* Steps whose clients don't all connect within this time are measured with the clients that did. */
+static constexpr double MyLoadTestConnectTimeout = 30.0;
+
+/* Scripted client input: seconds per full circle, sprint and crouch periods, interaction and respawn intervals. */
+static constexpr double MyLoadTestCircleSeconds = 8.0;
+static constexpr double MyLoadTestSprintSeconds = 2.0;
+static constexpr double MyLoadTestCrouchSeconds = 5.0;
+static constexpr double MyLoadTestInteractSeconds = 3.0;
+static constexpr double MyLoadTestRespawnSeconds = 30.0;
+
+namespace MyLoadTest
+{
+	/** Packet lag and jitter in ms and loss in percent, applied to outgoing packets on both ends. */
+	struct FNetProfile
+	{
+		const TCHAR* Name;
+		int32 LagMs;
+		int32 JitterMs;
+		int32 LossPercent;
+	};
+
+	static const FNetProfile Profiles[] =
+	{
+		{ TEXT("None"), 0, 0, 0 },
+		{ TEXT("Good"), 20, 5, 0 },
+		{ TEXT("Average"), 60, 15, 1 },
+		{ TEXT("Bad"), 150, 50, 5 },
+	};
+
+	static int32 FindProfile(const FString& Name)
+	{
+		for (int32 Index = 0; Index < static_cast<int32>(UE_ARRAY_COUNT(Profiles)); ++Index)
+		{
+			if (Name.Equals(Profiles[Index].Name, ESearchCase::IgnoreCase))
+			{
+				return Index;
+			}
+		}
+		return INDEX_NONE;
+	}
+}
+
+bool UMyLoadTestSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return Super::ShouldCreateSubsystem(Outer) && World && World->IsGameWorld();
+}
+
+void UMyLoadTestSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	bScriptedClient = FParse::Param(FCommandLine::Get(), TEXT("MyLoadTestClient"));
+	if (bScriptedClient)
+	{
+		// Spread the clients' schedules so they don't all sprint, interact and respawn in the same frame.
+		int32 Seed = 0;
+		FParse::Value(FCommandLine::Get(), TEXT("MyLoadTestSeed="), Seed);
+		ClientTime = Seed * 0.37;
+		NextInteractTime = ClientTime + FMath::Fmod(Seed * 0.71, MyLoadTestInteractSeconds);
+		NextRespawnTime = ClientTime + MyLoadTestRespawnSeconds + FMath::Fmod(Seed * 1.3, MyLoadTestRespawnSeconds);
+	}
+}
+
+void UMyLoadTestSubsystem::Deinitialize()
+{
+	Stop();
+
+	Super::Deinitialize();
+}
+
+void UMyLoadTestSubsystem::StartLoadTest(int32 InMaxClients, int32 InStepClients, float InStepSeconds, const FString& ProfileName, FOutputDevice& Ar)
+{
+	if (IsRunning())
+	{
+		Ar.Logf(TEXT("LoadTest: already running"));
+		return;
+	}
+
+	const ENetMode NetMode = GetWorld()->GetNetMode();
+	if ((NetMode != NM_DedicatedServer && NetMode != NM_ListenServer) || !GetWorld()->GetNetDriver())
+	{
+		Ar.Logf(TEXT("LoadTest: needs a dedicated or listen server"));
+		return;
+	}
+
+	const int32 InProfileIndex = MyLoadTest::FindProfile(ProfileName);
+	if (InProfileIndex == INDEX_NONE)
+	{
+		Ar.Logf(TEXT("LoadTest: unknown profile '%s', use None, Good, Average or Bad"), *ProfileName);
+		return;
+	}
+
+	MaxClients = InMaxClients;
+	StepClients = FMath::Clamp(InStepClients, 1, MaxClients);
+	StepSeconds = FMath::Max(InStepSeconds, 1.0f);
+	ApplyServerProfile(InProfileIndex);
+	bRunning = true;
+
+	const MyLoadTest::FNetProfile& Profile = MyLoadTest::Profiles[ProfileIndex];
+	Ar.Logf(TEXT("LoadTest: up to %d clients, %d per step, %.0fs per step, profile %s (lag %d ms, jitter %d ms, loss %d%%)"),
+		MaxClients, StepClients, StepSeconds, Profile.Name, Profile.LagMs, Profile.JitterMs, Profile.LossPercent);
+
+	LaunchClients(StepClients);
+}
+
+void UMyLoadTestSubsystem::Stop()
+{
+	for (FProcHandle& Process : ClientProcesses)
+	{
+		if (Process.IsValid())
+		{
+			FPlatformProcess::TerminateProc(Process, true);
+			FPlatformProcess::CloseProc(Process);
+		}
+	}
+	ClientProcesses.Reset();
+
+	if (bRunning)
+	{
+		ApplyServerProfile(0);
+		bRunning = false;
+	}
+}
+
+void UMyLoadTestSubsystem::LaunchClients(int32 Count)
+{
+	const FString Executable = GMyLoadTestClientExecutable.IsEmpty() ? FString(FPlatformProcess::ExecutablePath()) : GMyLoadTestClientExecutable;
+	const MyLoadTest::FNetProfile& Profile = MyLoadTest::Profiles[ProfileIndex];
+
+	// Uncooked builds (the editor executable) need the project to run it as a game.
+	FString ProjectArgument;
+	if (!FPlatformProperties::RequiresCookedData())
+	{
+		ProjectArgument = FString::Printf(TEXT("\"%s\" "), *FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath()));
+	}
+
+	for (int32 Launched = 0; Launched < Count && ClientProcesses.Num() < MaxClients; ++Launched)
+	{
+		const int32 Index = ClientProcesses.Num();
+		const FString Arguments = FString::Printf(
+			TEXT("%s127.0.0.1:%d -game -nullrhi -nosound -nosplash -unattended -MyLoadTestClient -MyLoadTestSeed=%d -PktLag=%d -PktLagVariance=%d -PktLoss=%d -log=LoadTestClient%d.log"),
+			*ProjectArgument, GetWorld()->URL.Port, Index, Profile.LagMs, Profile.JitterMs, Profile.LossPercent, Index);
+
+		FProcHandle Process = FPlatformProcess::CreateProc(*Executable, *Arguments, true, true, true, nullptr, 0, nullptr, nullptr);
+		if (!Process.IsValid())
+		{
+			UE_LOG(LogProject, Error, TEXT("LoadTest: failed to launch %s %s"), *Executable, *Arguments);
+			Stop();
+			return;
+		}
+		ClientProcesses.Add(Process);
+	}
+
+	StepPhase = EStepPhase::Connecting;
+	PhaseStartTime = FPlatformTime::Seconds();
+}
+
+void UMyLoadTestSubsystem::BeginMeasuring()
+{
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	const UMyMovementTelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UMyMovementTelemetrySubsystem>();
+
+	StepPhase = EStepPhase::Measuring;
+	PhaseStartTime = FPlatformTime::Seconds();
+	LastFrameTime = PhaseStartTime;
+	StepFrames = 0;
+	StepTickSeconds = 0.0;
+	MaxTickSeconds = 0.0;
+	StepStartInBytes = NetDriver ? NetDriver->InTotalBytes : 0;
+	StepStartOutBytes = NetDriver ? NetDriver->OutTotalBytes : 0;
+	StepStartCorrections = Telemetry ? Telemetry->GetTotalCorrections() : 0;
+}
+
+void UMyLoadTestSubsystem::Tick(float DeltaTime)
+{
+	if (bScriptedClient && GetWorld()->GetNetMode() == NM_Client)
+	{
+		DriveClient(DeltaTime);
+	}
+
+	if (!IsRunning()) { return; }
+
+	const double Now = FPlatformTime::Seconds();
+	const double Elapsed = Now - PhaseStartTime;
+
+	if (StepPhase == EStepPhase::Connecting)
+	{
+		if (GetNumConnections() >= ClientProcesses.Num() || Elapsed >= MyLoadTestConnectTimeout)
+		{
+			BeginMeasuring();
+		}
+		return;
+	}
+
+	// The idle time is the wait for the next tick at the server's tick rate, not work.
+	const double TickSeconds = FMath::Max(Now - LastFrameTime - FApp::GetIdleTime(), 0.0);
+	LastFrameTime = Now;
+	++StepFrames;
+	StepTickSeconds += TickSeconds;
+	MaxTickSeconds = FMath::Max(MaxTickSeconds, TickSeconds);
+
+	if (Elapsed < StepSeconds) { return; }
+
+	ReportStep();
+	if (ClientProcesses.Num() >= MaxClients)
+	{
+		UE_LOG(LogProject, Display, TEXT("LoadTest: finished"));
+		Stop();
+	}
+	else
+	{
+		LaunchClients(StepClients);
+	}
+}
+
+TStatId UMyLoadTestSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMyLoadTestSubsystem, STATGROUP_Tickables);
+}
+
+void UMyLoadTestSubsystem::ReportStep()
+{
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	const UMyMovementTelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UMyMovementTelemetrySubsystem>();
+
+	const double Seconds = FMath::Max(FPlatformTime::Seconds() - PhaseStartTime, UE_DOUBLE_SMALL_NUMBER);
+	const int32 Connections = GetNumConnections();
+	const double PerConnection = 1.0 / (Seconds * FMath::Max(Connections, 1));
+
+	const double TickMs = StepTickSeconds / FMath::Max<int64>(StepFrames, 1) * 1000.0;
+	const double MaxTickMs = MaxTickSeconds * 1000.0;
+	const double InBytesPerConnection = (NetDriver ? NetDriver->InTotalBytes - StepStartInBytes : 0) * PerConnection;
+	const double OutBytesPerConnection = (NetDriver ? NetDriver->OutTotalBytes - StepStartOutBytes : 0) * PerConnection;
+	const int64 Corrections = (Telemetry ? Telemetry->GetTotalCorrections() : 0) - StepStartCorrections;
+	const double CorrectionsPerMinute = Corrections * PerConnection * 60.0;
+
+	const TCHAR* ProfileName = MyLoadTest::Profiles[ProfileIndex].Name;
+	UE_LOG(LogProject, Display, TEXT("LoadTest: %d/%d clients [%s]  tick %.2f ms (max %.2f)  per connection in %.0f B/s out %.0f B/s  corrections %.1f/min"),
+		Connections, ClientProcesses.Num(), ProfileName, TickMs, MaxTickMs, InBytesPerConnection, OutBytesPerConnection, CorrectionsPerMinute);
+
+	const FString FilePath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("LoadTest.csv"));
+	FString Csv;
+	if (!IFileManager::Get().FileExists(*FilePath))
+	{
+		Csv = TEXT("Profile,Clients,Connected,TickMs,MaxTickMs,InBytesPerSecondPerConnection,OutBytesPerSecondPerConnection,CorrectionsPerMinutePerConnection\n");
+	}
+	Csv += FString::Printf(TEXT("%s,%d,%d,%.3f,%.3f,%.0f,%.0f,%.2f\n"), ProfileName, ClientProcesses.Num(), Connections,
+		TickMs, MaxTickMs, InBytesPerConnection, OutBytesPerConnection, CorrectionsPerMinute);
+	FFileHelper::SaveStringToFile(Csv, *FilePath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+}
+
+void UMyLoadTestSubsystem::ApplyServerProfile(int32 InProfileIndex)
+{
+	ProfileIndex = InProfileIndex;
+
+#if DO_ENABLE_NET_TEST
+	if (UNetDriver* NetDriver = GetWorld() ? GetWorld()->GetNetDriver() : nullptr)
+	{
+		const MyLoadTest::FNetProfile& Profile = MyLoadTest::Profiles[ProfileIndex];
+		FPacketSimulationSettings Settings;
+		Settings.PktLag = Profile.LagMs;
+		Settings.PktLagVariance = Profile.JitterMs;
+		Settings.PktLoss = Profile.LossPercent;
+		NetDriver->SetPacketSimulationSettings(Settings);
+	}
+#endif
+}
+
+int32 UMyLoadTestSubsystem::GetNumConnections() const
+{
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	return NetDriver ? NetDriver->ClientConnections.Num() : 0;
+}
+
+void UMyLoadTestSubsystem::DriveClient(float DeltaTime)
+{
+	AMyBasePlayerController* PlayerController = Cast<AMyBasePlayerController>(GetWorld()->GetFirstPlayerController());
+	AMyBaseCharacter* Character = PlayerController ? Cast<AMyBaseCharacter>(PlayerController->GetPawn()) : nullptr;
+	if (!Character) { return; }
+
+	ClientTime += DeltaTime;
+
+	// Walk a circle, looking where we go so interaction traces hit what is in front.
+	const double Angle = (ClientTime / MyLoadTestCircleSeconds) * UE_DOUBLE_TWO_PI;
+	const FVector Direction(FMath::Cos(Angle), FMath::Sin(Angle), 0.0);
+	PlayerController->SetControlRotation(Direction.Rotation());
+	Character->AddMovementInput(Direction);
+
+	const bool bSprint = FMath::FloorToInt(ClientTime / MyLoadTestSprintSeconds) % 2 == 1;
+	const bool bCrouch = !bSprint && FMath::FloorToInt(ClientTime / MyLoadTestCrouchSeconds) % 2 == 1;
+	if (bSprint != bClientSprinting)
+	{
+		if (bSprint) { Character->StartSprinting(); } else { Character->StopSprinting(); }
+		bClientSprinting = bSprint;
+	}
+	if (bCrouch != bClientCrouching)
+	{
+		if (bCrouch) { Character->StartCrouching(); } else { Character->StopCrouching(); }
+		bClientCrouching = bCrouch;
+	}
+
+	if (ClientTime >= NextInteractTime)
+	{
+		Character->OnInteract();
+		NextInteractTime = ClientTime + MyLoadTestInteractSeconds;
+	}
+
+	if (ClientTime >= NextRespawnTime)
+	{
+		// The new pawn starts standing and walking.
+		PlayerController->ServerSpawnPlayer(PlayerController);
+		bClientSprinting = bClientCrouching = false;
+		NextRespawnTime = ClientTime + MyLoadTestRespawnSeconds;
+	}
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyLoadTestStart(
+	TEXT("Project.LoadTest.Start"),
+	TEXT("Ramps up headless load test clients connected to this server. Arguments: [Clients=32] [StepClients=4] [StepSeconds=30] [Profile=None|Good|Average|Bad]."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UMyLoadTestSubsystem* LoadTest = World ? World->GetSubsystem<UMyLoadTestSubsystem>() : nullptr)
+		{
+			const int32 Clients = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 32;
+			const int32 StepClients = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 4;
+			const float StepSeconds = Args.Num() > 2 ? FCString::Atof(*Args[2]) : 30.0f;
+			const FString Profile = Args.Num() > 3 ? Args[3] : TEXT("None");
+			LoadTest->StartLoadTest(FMath::Max(Clients, 1), StepClients, StepSeconds, Profile, Ar);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyLoadTestStop(
+	TEXT("Project.LoadTest.Stop"),
+	TEXT("Ends the load test and closes its client processes."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UMyLoadTestSubsystem* LoadTest = World ? World->GetSubsystem<UMyLoadTestSubsystem>() : nullptr)
+		{
+			LoadTest->Stop();
+		}
+	}));
@@ -0,0 +1,154 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyMemoryTags.h"
+#include "Project.h"
+#include "Algo/Find.h"
+#include "Containers/Ticker.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DelayedAutoRegister.h"
+
+LLM_DEFINE_TAG(Project);
+LLM_DEFINE_TAG(Project_Characters, TEXT("Characters"), TEXT("Project"));
+LLM_DEFINE_TAG(Project_Movement, TEXT("Movement"), TEXT("Project"));
+LLM_DEFINE_TAG(Project_Stats, TEXT("Stats"), TEXT("Project"));
+LLM_DEFINE_TAG(Project_Doors, TEXT("Doors"), TEXT("Project"));
+LLM_DEFINE_TAG(Project_Interaction, TEXT("Interaction"), TEXT("Project"));
+LLM_DEFINE_TAG(Project_UI, TEXT("UI"), TEXT("Project"));
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+
+static FString GMyMemoryBudgets;
+static FAutoConsoleVariableRef CVarMyMemoryBudgets(
+	TEXT("Project.Memory.Budgets"),
+	GMyMemoryBudgets,
+	TEXT("Memory budgets of the project LLM tags in MB, as Tag=MB pairs separated by commas, e.g. \"Characters=64,UI=8\". ")
+	TEXT("A tag going over its budget logs a warning. Needs -LLM."));
+
+static float GMyMemorySampleSeconds = 1.0f;
+static FAutoConsoleVariableRef CVarMyMemorySampleSeconds(
+	TEXT("Project.Memory.SampleSeconds"),
+	GMyMemorySampleSeconds,
+	TEXT("Seconds between samples of the project LLM tags for their peaks and budgets."));
+
+namespace MyMemoryTags
+{
+	struct FTag
+	{
+		const TCHAR* Name;
+		FName TagName;
+		int64 Peak = 0;
+		int64 Budget = 0;
+		bool bOverBudget = false;
+	};
+
+	/* Tag names are the declaration names with '/' for '_'. */
+	static FTag Tags[] =
+	{
+		{ TEXT("Project"), TEXT("Project") },
+		{ TEXT("Characters"), TEXT("Project/Characters") },
+		{ TEXT("Movement"), TEXT("Project/Movement") },
+		{ TEXT("Stats"), TEXT("Project/Stats") },
+		{ TEXT("Doors"), TEXT("Project/Doors") },
+		{ TEXT("Interaction"), TEXT("Project/Interaction") },
+		{ TEXT("UI"), TEXT("Project/UI") },
+	};
+
+	static FString ParsedBudgets;
+	static double LastSampleTime = 0.0;
+
+	static int64 GetAmount(const FTag& Tag)
+	{
+		return FLowLevelMemTracker::Get().GetTagAmountForTracker(ELLMTracker::Default, Tag.TagName, ELLMTagSet::None);
+	}
+
+	static void ParseBudgets()
+	{
+		ParsedBudgets = GMyMemoryBudgets;
+		for (FTag& Tag : Tags)
+		{
+			Tag.Budget = 0;
+			Tag.bOverBudget = false;
+		}
+
+		TArray<FString> Entries;
+		GMyMemoryBudgets.ParseIntoArray(Entries, TEXT(","));
+		for (const FString& Entry : Entries)
+		{
+			FString Name;
+			FString Megabytes;
+			if (!Entry.Split(TEXT("="), &Name, &Megabytes))
+			{
+				UE_LOG(LogProject, Warning, TEXT("Memory: ignoring budget '%s', expected Tag=MB"), *Entry);
+				continue;
+			}
+
+			FTag* Tag = Algo::FindByPredicate(Tags, [&Name](const FTag& Candidate) { return Name.TrimStartAndEnd() == Candidate.Name; });
+			if (!Tag)
+			{
+				UE_LOG(LogProject, Warning, TEXT("Memory: ignoring budget for unknown tag '%s'"), *Name);
+				continue;
+			}
+			Tag->Budget = static_cast<int64>(FCString::Atod(*Megabytes) * 1024.0 * 1024.0);
+		}
+	}
+
+	/* Updates the peaks and checks the budgets, at most every Project.Memory.SampleSeconds. */
+	static bool Sample(float DeltaTime)
+	{
+		if (!FLowLevelMemTracker::IsEnabled()) { return true; }
+
+		const double Now = FPlatformTime::Seconds();
+		if (Now - LastSampleTime < GMyMemorySampleSeconds) { return true; }
+		LastSampleTime = Now;
+
+		if (ParsedBudgets != GMyMemoryBudgets)
+		{
+			ParseBudgets();
+		}
+
+		for (FTag& Tag : Tags)
+		{
+			const int64 Amount = GetAmount(Tag);
+			Tag.Peak = FMath::Max(Tag.Peak, Amount);
+
+			const bool bOverBudget = Tag.Budget > 0 && Amount > Tag.Budget;
+			if (bOverBudget && !Tag.bOverBudget)
+			{
+				UE_LOG(LogProject, Warning, TEXT("Memory: %s is over budget, %.2f MB of %.2f MB"), Tag.Name, Amount / 1048576.0, Tag.Budget / 1048576.0);
+			}
+			Tag.bOverBudget = bOverBudget;
+		}
+		return true;
+	}
+
+	static FDelayedAutoRegisterHelper RegisterSampler(EDelayedRegisterRunPhase::EndOfEngineInit, []()
+	{
+		FTSTicker::GetCoreTicker().AddTicker(TEXT("MyMemoryTags"), 0.0f, &Sample);
+	});
+}
+
+static FAutoConsoleCommandWithOutputDevice CmdMyMemoryTags(
+	TEXT("Project.Memory.Tags"),
+	TEXT("Prints the current size, peak and budget of the project's LLM tags. Needs -LLM."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+	{
+		if (!FLowLevelMemTracker::IsEnabled())
+		{
+			Ar.Logf(TEXT("Memory: LLM is off, start with -LLM"));
+			return;
+		}
+
+		// Counts an allocation made just now in the peak too.
+		MyMemoryTags::LastSampleTime = 0.0;
+		MyMemoryTags::Sample(0.0f);
+
+		Ar.Logf(TEXT("  %-12s %10s %10s %10s"), TEXT("Tag"), TEXT("MB"), TEXT("Peak MB"), TEXT("Budget MB"));
+		for (const MyMemoryTags::FTag& Tag : MyMemoryTags::Tags)
+		{
+			const FString Budget = Tag.Budget > 0 ? FString::Printf(TEXT("%.2f"), Tag.Budget / 1048576.0) : FString(TEXT("-"));
+			Ar.Logf(TEXT("  %-12s %10.2f %10.2f %10s%s"), Tag.Name, MyMemoryTags::GetAmount(Tag) / 1048576.0, Tag.Peak / 1048576.0,
+				*Budget, Tag.bOverBudget ? TEXT("  OVER") : TEXT(""));
+		}
+	}));
+
+#endif // ENABLE_LOW_LEVEL_MEM_TRACKER
@@ -0,0 +1,340 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyMoveRecording.h"
+#include "Project.h"
+#include "MyBaseCharacter.h"
+#include "MyBaseMovementComponent.h"
+#include "MyBatchedMovementSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+FArchive& operator<<(FArchive& Ar, FMyRecordedMove& Move)
+{
+	Ar << Move.TimeStamp;
+	Ar << Move.DeltaTime;
+	Ar << Move.Acceleration;
+	Ar << Move.CompressedFlags;
+	Ar << Move.Inputs;
+
+	// One byte instead of the four a bool takes in an archive.
+	uint8 bStartCrouched = Move.bStartCrouched ? 1 : 0;
+	Ar << bStartCrouched;
+	Move.bStartCrouched = bStartCrouched != 0;
+
+	Ar << Move.StartMovementMode;
+	Ar << Move.EndMovementMode;
+	Ar << Move.StartLocation;
+	Ar << Move.StartVelocity;
+	Ar << Move.StartRotation;
+	Ar << Move.ControlRotation;
+	Ar << Move.EndLocation;
+	Ar << Move.EndVelocity;
+	return Ar;
+}
+
+FString FMyMoveRecording::GetDirectory()
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MoveRecordings"));
+}
+
+bool FMyMoveRecording::SaveToFile(const FString& FilePath) const
+{
+	TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!Ar) { return false; }
+
+	uint32 FileMagic = Magic;
+	uint32 FileVersion = Version;
+	FString FileMapName = MapName;
+	FString FileCharacterClassPath = CharacterClassPath;
+	int32 NumMoves = Moves.Num();
+
+	*Ar << FileMagic << FileVersion << FileMapName << FileCharacterClassPath << NumMoves;
+
+	for (FMyRecordedMove Move : Moves)
+	{
+		*Ar << Move;
+	}
+
+	return Ar->Close();
+}
+
+bool FMyMoveRecording::LoadFromFile(const FString& FilePath)
+{
+	TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileReader(*FilePath));
+	if (!Ar) { return false; }
+
+	uint32 FileMagic = 0;
+	uint32 FileVersion = 0;
+	*Ar << FileMagic << FileVersion;
+
+	if (FileMagic != Magic || FileVersion != Version)
+	{
+		UE_LOG(LogProject, Warning, TEXT("MoveRecording: %s is not a version %u move recording"), *FilePath, Version);
+		return false;
+	}
+
+	int32 NumMoves = 0;
+	*Ar << MapName << CharacterClassPath << NumMoves;
+
+	// Each move is at least this big; guards against a corrupt count.
+	constexpr int64 MinMoveSize = 64;
+	if (NumMoves < 0 || NumMoves * MinMoveSize > Ar->TotalSize() - Ar->Tell())
+	{
+		return false;
+	}
+
+	Moves.SetNum(NumMoves);
+	for (FMyRecordedMove& Move : Moves)
+	{
+		*Ar << Move;
+	}
+
+	return !Ar->IsError();
+}
+
+/* Returns the movement component of the first local player's character. */
+static UMyBaseMovementComponent* GetLocalMovementComponent(UWorld* World)
+{
+	const APlayerController* PC = World ? World->GetFirstPlayerController() : nullptr;
+	const AMyBaseCharacter* Character = PC ? Cast<AMyBaseCharacter>(PC->GetPawn()) : nullptr;
+	return Character ? Cast<UMyBaseMovementComponent>(Character->GetCharacterMovement()) : nullptr;
+}
+
+/* Turns a bare file name into a path in the recordings directory. */
+static FString GetRecordingPath(const FString& FileName)
+{
+	return FPaths::IsRelative(FileName) ? FPaths::Combine(FMyMoveRecording::GetDirectory(), FileName) : FileName;
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyMoveRecordStart(
+	TEXT("Project.Movement.Record.Start"),
+	TEXT("Starts recording the moves the local player sends to the server."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		UMyBaseMovementComponent* Movement = GetLocalMovementComponent(World);
+		if (!Movement || !Movement->GetPawnOwner()->IsLocallyControlled())
+		{
+			Ar.Logf(TEXT("MoveRecording: no locally controlled character"));
+			return;
+		}
+
+		Movement->StartRecording();
+		Ar.Logf(TEXT("MoveRecording: recording"));
+	}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyMoveRecordStop(
+	TEXT("Project.Movement.Record.Stop"),
+	TEXT("Stops recording and saves the moves. Arguments: [FileName], saved to Saved/MoveRecordings."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		UMyBaseMovementComponent* Movement = GetLocalMovementComponent(World);
+		if (!Movement || !Movement->IsRecording())
+		{
+			Ar.Logf(TEXT("MoveRecording: not recording"));
+			return;
+		}
+
+		const FString FileName = Args.Num() > 0 ? Args[0] : FString::Printf(TEXT("Moves-%s.mymoves"), *FDateTime::Now().ToString());
+		const FString FilePath = GetRecordingPath(FileName);
+
+		const int32 NumMoves = Movement->StopRecording(FilePath);
+		if (NumMoves < 0)
+		{
+			Ar.Logf(TEXT("MoveRecording: could not write %s"), *FilePath);
+			return;
+		}
+
+		Ar.Logf(TEXT("MoveRecording: wrote %d moves to %s (%lld bytes)"), NumMoves, *FilePath, IFileManager::Get().FileSize(*FilePath));
+	}));
+
+/*
+ * Replays a recording through the server movement path on a freshly spawned character.
+ * Run it in the map it was recorded in, headless if wanted: -nullrhi -ExecCmds="Project.Movement.Replay <File>".
+ */
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyMoveReplay(
+	TEXT("Project.Movement.Replay"),
+	TEXT("Runs a move recording through the server movement path and reports divergence, corrections and CPU per move. Arguments: <FileName> [Free]. Free lets the server simulation run on from the first move instead of starting every move from the client's state."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (!World || World->GetNetMode() == NM_Client || Args.Num() == 0)
+		{
+			Ar.Logf(TEXT("MoveReplay: needs a file name and a standalone game or a server"));
+			return;
+		}
+
+		const FString FilePath = GetRecordingPath(Args[0]);
+		const bool bResync = !(Args.Num() > 1 && Args[1].Equals(TEXT("Free"), ESearchCase::IgnoreCase));
+
+		FMyMoveRecording Recording;
+		if (!Recording.LoadFromFile(FilePath) || Recording.Moves.Num() == 0)
+		{
+			Ar.Logf(TEXT("MoveReplay: could not load %s"), *FilePath);
+			return;
+		}
+
+		if (Recording.MapName != World->GetMapName())
+		{
+			Ar.Logf(TEXT("MoveReplay: recorded in %s, replaying in %s"), *Recording.MapName, *World->GetMapName());
+		}
+
+		UClass* CharacterClass = StaticLoadClass(AMyBaseCharacter::StaticClass(), nullptr, *Recording.CharacterClassPath);
+		if (!CharacterClass)
+		{
+			CharacterClass = AMyBaseCharacter::StaticClass();
+		}
+
+		const FMyRecordedMove& FirstMove = Recording.Moves[0];
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		AMyBaseCharacter* Character = World->SpawnActor<AMyBaseCharacter>(CharacterClass, FVector(FirstMove.StartLocation), FRotator(FirstMove.StartRotation), SpawnParams);
+		if (!Character)
+		{
+			Ar.Logf(TEXT("MoveReplay: could not spawn %s"), *CharacterClass->GetName());
+			return;
+		}
+
+		Character->SpawnDefaultController();
+
+		// Only the replay moves this character.
+		UMyBaseMovementComponent* Movement = Character->GetMyBaseMovementComponent();
+		Movement->SetComponentTickEnabled(false);
+		if (UMyBatchedMovementSubsystem* BatchedMovement = World->GetSubsystem<UMyBatchedMovementSubsystem>())
+		{
+			BatchedMovement->Unregister(Movement);
+		}
+
+		int32 NumCorrections = 0;
+		double TotalDivergence = 0.0;
+		float MaxDivergence = 0.0f;
+		TArray<uint64> MoveCycles;
+		MoveCycles.Reserve(Recording.Moves.Num());
+
+		for (int32 Index = 0; Index < Recording.Moves.Num(); ++Index)
+		{
+			float Divergence = 0.0f;
+			uint64 Cycles = 0;
+
+			// Without resync the first move still has to start from the client's state.
+			if (Movement->ReplayRecordedMove(Recording.Moves[Index], bResync || Index == 0, Divergence, Cycles))
+			{
+				++NumCorrections;
+			}
+
+			TotalDivergence += Divergence;
+			MaxDivergence = FMath::Max(MaxDivergence, Divergence);
+			MoveCycles.Add(Cycles);
+		}
+
+		if (AController* Controller = Character->GetController())
+		{
+			Controller->Destroy();
+		}
+		Character->Destroy();
+
+		MoveCycles.Sort();
+		uint64 TotalCycles = 0;
+		for (const uint64 Cycles : MoveCycles)
+		{
+			TotalCycles += Cycles;
+		}
+
+		const int32 NumMoves = Recording.Moves.Num();
+		const double AverageMicros = FPlatformTime::ToMilliseconds64(TotalCycles) * 1000.0 / NumMoves;
+		const double MedianMicros = FPlatformTime::ToMilliseconds64(MoveCycles[NumMoves / 2]) * 1000.0;
+		const double P99Micros = FPlatformTime::ToMilliseconds64(MoveCycles[FMath::Min(NumMoves * 99 / 100, NumMoves - 1)]) * 1000.0;
+		const double AverageDivergence = TotalDivergence / NumMoves;
+		const TCHAR* Mode = bResync ? TEXT("Resync") : TEXT("Free");
+
+		Ar.Logf(TEXT("MoveReplay: %s, %d moves (%s)"), *FPaths::GetCleanFilename(FilePath), NumMoves, Mode);
+		Ar.Logf(TEXT("  corrections  %d (%.2f%%)"), NumCorrections, 100.0 * NumCorrections / NumMoves);
+		Ar.Logf(TEXT("  divergence   avg %.3f  max %.3f"), AverageDivergence, MaxDivergence);
+		Ar.Logf(TEXT("  cpu per move avg %.2f us  median %.2f us  p99 %.2f us"), AverageMicros, MedianMicros, P99Micros);
+
+		const FString CsvPath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("MoveReplay.csv"));
+		FString Csv;
+		if (!IFileManager::Get().FileExists(*CsvPath))
+		{
+			Csv = TEXT("File,Mode,Moves,Corrections,AvgDivergence,MaxDivergence,AvgMicros,MedianMicros,P99Micros\n");
+		}
+		Csv += FString::Printf(TEXT("%s,%s,%d,%d,%.4f,%.4f,%.3f,%.3f,%.3f\n"),
+			*FPaths::GetCleanFilename(FilePath), Mode, NumMoves, NumCorrections, AverageDivergence, MaxDivergence, AverageMicros, MedianMicros, P99Micros);
+		FFileHelper::SaveStringToFile(Csv, *CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+	}));
+
+/* Ten seconds of 60 Hz input for Project.Movement.MoveBandwidth: walking in a circle, sprint every 2s, crouch every 5s, a jump every 3s. */
+static void MakeScriptedMoves(TArray<FMyRecordedMove>& OutMoves)
+{
+	constexpr int32 NumMoves = 600;
+	constexpr float DeltaTime = 1.0f / 60.0f;
+
+	const float MaxAcceleration = GetDefault<UMyBaseMovementComponent>()->GetMaxAcceleration();
+
+	// Mid session; client time stamps reset every few minutes.
+	float TimeStamp = 100.0f;
+	FVector Location(0.0, 0.0, 90.0);
+
+	for (int32 Index = 0; Index < NumMoves; ++Index)
+	{
+		const double Time = Index * DeltaTime;
+		const double Angle = Time / 8.0 * UE_DOUBLE_TWO_PI;
+		const bool bSprint = FMath::FloorToInt(Time / 2.0) % 2 == 1;
+		const bool bCrouch = !bSprint && FMath::FloorToInt(Time / 5.0) % 2 == 1;
+		const bool bJump = Index % 180 == 0;
+		const FVector Direction(FMath::Cos(Angle), FMath::Sin(Angle), 0.0);
+		const FVector Velocity = Direction * (bSprint ? 500.0 : 250.0);
+
+		TimeStamp += DeltaTime;
+
+		FMyRecordedMove& Move = OutMoves.AddDefaulted_GetRef();
+		Move.TimeStamp = TimeStamp;
+		Move.DeltaTime = DeltaTime;
+		Move.Acceleration = FVector3f(Direction * MaxAcceleration);
+		Move.CompressedFlags = static_cast<uint8>((bJump ? FSavedMove_Character::FLAG_JumpPressed : 0) | (bCrouch ? FSavedMove_Character::FLAG_WantsToCrouch : 0));
+		Move.Inputs = static_cast<uint16>((bJump ? 1 << static_cast<uint8>(EMyMoveInput::Jump) : 0)
+			| (bCrouch ? 1 << static_cast<uint8>(EMyMoveInput::Crouch) : 0)
+			| (bSprint ? 1 << static_cast<uint8>(EMyMoveInput::Sprint) : 0));
+		Move.StartMovementMode = MOVE_Walking;
+		Move.EndMovementMode = MOVE_Walking;
+		Move.StartLocation = FVector3f(Location);
+		Move.StartVelocity = FVector3f(Velocity);
+
+		// The camera trails the movement direction a little.
+		Move.ControlRotation = FRotator3f(-15.0f, static_cast<float>(FMath::RadiansToDegrees(Angle) - 20.0), 0.0f);
+
+		Location += Velocity * DeltaTime;
+		Move.EndLocation = FVector3f(Location);
+		Move.EndVelocity = FVector3f(Velocity);
+	}
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyMoveBandwidth(
+	TEXT("Project.Movement.MoveBandwidth"),
+	TEXT("Compares bytes per ServerMove of the engine's move data and UMyBaseMovementComponent's. Arguments: [FileName], a move recording to use instead of ten seconds of scripted 60 Hz input."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (Args.Num() == 0)
+		{
+			TArray<FMyRecordedMove> Moves;
+			MakeScriptedMoves(Moves);
+			UMyBaseMovementComponent::MeasureMoveBandwidth(Moves, TEXT("Scripted"), Ar);
+			return;
+		}
+
+		const FString FilePath = GetRecordingPath(Args[0]);
+
+		FMyMoveRecording Recording;
+		if (!Recording.LoadFromFile(FilePath))
+		{
+			Ar.Logf(TEXT("MoveBandwidth: could not load %s"), *FilePath);
+			return;
+		}
+
+		UMyBaseMovementComponent::MeasureMoveBandwidth(Recording.Moves, FPaths::GetCleanFilename(FilePath), Ar);
+	}));
@@ -0,0 +1,228 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyMovementAllocTestSubsystem.h"
+#include "Project.h"
+#include "MyBaseCharacter.h"
+#include "MyBaseMovementComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+/* Scripted input: seconds per full circle, and how often sprint and crouch toggle. */
+static constexpr double MyAllocTestCircleSeconds = 8.0;
+static constexpr double MyAllocTestSprintSeconds = 2.0;
+static constexpr double MyAllocTestCrouchSeconds = 5.0;
+
+static const TCHAR* MyAllocTestPathNames[] = { TEXT("ClientMove"), TEXT("ClientAck"), TEXT("ServerMove") };
+static_assert(UE_ARRAY_COUNT(MyAllocTestPathNames) == static_cast<int32>(EMyMovementAllocPath::Num), "One name per EMyMovementAllocPath.");
+
+int32 UMyMovementAllocTestSubsystem::NumRunning = 0;
+
+UMyMovementAllocTestSubsystem::FScope::FScope(const UObject* WorldContextObject, EMyMovementAllocPath InPath)
+{
+	if (NumRunning == 0 || InPath == EMyMovementAllocPath::Num) { return; }
+
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	UMyMovementAllocTestSubsystem* Subsystem = World ? World->GetSubsystem<UMyMovementAllocTestSubsystem>() : nullptr;
+	if (!Subsystem || Subsystem->Phase != EPhase::Measure) { return; }
+
+	Test = Subsystem;
+	Path = InPath;
+	++Test->Paths[static_cast<int32>(Path)].Calls;
+
+	StartAllocations = FMyAllocationCounter::GetThreadAllocations();
+	CounterScope.Emplace();
+}
+
+UMyMovementAllocTestSubsystem::FScope::~FScope()
+{
+	if (!Test) { return; }
+
+	CounterScope.Reset();
+	Test->Paths[static_cast<int32>(Path)].FrameAllocations += FMyAllocationCounter::GetThreadAllocations() - StartAllocations;
+}
+
+bool UMyMovementAllocTestSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return Super::ShouldCreateSubsystem(Outer) && World && World->IsGameWorld();
+}
+
+void UMyMovementAllocTestSubsystem::Deinitialize()
+{
+	Stop();
+
+	Super::Deinitialize();
+}
+
+void UMyMovementAllocTestSubsystem::StartTest(int32 InFrames, int32 InWarmupFrames, FOutputDevice& Ar)
+{
+	if (IsRunning())
+	{
+		Ar.Logf(TEXT("MovementAllocTest: already running"));
+		return;
+	}
+
+	if (!FMyAllocationCounter::IsInstalled())
+	{
+		Ar.Logf(ELogVerbosity::Error, TEXT("MovementAllocTest: counting allocations needs -MyCountAllocations on the command line"));
+		return;
+	}
+
+	Frames = FMath::Max(InFrames, 1);
+	WarmupFrames = FMath::Max(InWarmupFrames, 0);
+	PhaseFrames = 0;
+	StartTime = FPlatformTime::Seconds();
+	for (FPathStats& Stats : Paths)
+	{
+		Stats = FPathStats();
+	}
+
+	Phase = EPhase::Warmup;
+	++NumRunning;
+
+	Ar.Logf(TEXT("MovementAllocTest: %d warmup frames, then counting allocations for %d frames"), WarmupFrames, Frames);
+}
+
+void UMyMovementAllocTestSubsystem::Tick(float DeltaTime)
+{
+	if (!IsRunning()) { return; }
+
+	// Movement and net receives of this frame have run by now, world subsystems tick after the actors.
+	if (Phase == EPhase::Warmup)
+	{
+		if (++PhaseFrames >= WarmupFrames)
+		{
+			Phase = EPhase::Measure;
+			PhaseFrames = 0;
+			StartHeapAllocatedMoves = UMyBaseMovementComponent::NumHeapAllocatedMoves;
+		}
+	}
+	else
+	{
+		EndFrame();
+		if (++PhaseFrames >= Frames)
+		{
+			Report();
+			Stop();
+			return;
+		}
+	}
+
+	DriveScriptedInput();
+}
+
+TStatId UMyMovementAllocTestSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMyMovementAllocTestSubsystem, STATGROUP_Tickables);
+}
+
+void UMyMovementAllocTestSubsystem::DriveScriptedInput()
+{
+	const APlayerController* PC = GetWorld()->GetFirstPlayerController();
+	AMyBaseCharacter* Character = PC ? Cast<AMyBaseCharacter>(PC->GetPawn()) : nullptr;
+	if (!Character || !Character->IsLocallyControlled()) { return; }
+
+	const double Time = FPlatformTime::Seconds() - StartTime;
+	const bool bSprint = FMath::FloorToInt(Time / MyAllocTestSprintSeconds) % 2 == 1;
+	const bool bCrouch = !bSprint && FMath::FloorToInt(Time / MyAllocTestCrouchSeconds) % 2 == 1;
+
+	const double Angle = (Time / MyAllocTestCircleSeconds) * UE_DOUBLE_TWO_PI;
+	Character->AddMovementInput(FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0));
+
+	UMyBaseMovementComponent* Movement = Character->GetMyBaseMovementComponent();
+	if (bSprint) { Movement->StartSprinting(); } else { Movement->StopSprinting(); }
+	if (bCrouch) { Movement->StartCrouching(); } else { Movement->StopCrouching(); }
+}
+
+void UMyMovementAllocTestSubsystem::EndFrame()
+{
+	for (FPathStats& Stats : Paths)
+	{
+		Stats.Allocations += Stats.FrameAllocations;
+		Stats.MaxFrameAllocations = FMath::Max(Stats.MaxFrameAllocations, Stats.FrameAllocations);
+		if (Stats.FrameAllocations > 0)
+		{
+			++Stats.FramesWithAllocations;
+		}
+		Stats.FrameAllocations = 0;
+	}
+}
+
+void UMyMovementAllocTestSubsystem::Stop()
+{
+	if (!IsRunning()) { return; }
+
+	Phase = EPhase::Idle;
+	--NumRunning;
+}
+
+void UMyMovementAllocTestSubsystem::Report()
+{
+	const ENetMode NetMode = GetWorld()->GetNetMode();
+	const TCHAR* NetModeName = NetMode == NM_Client ? TEXT("Client") : NetMode == NM_Standalone ? TEXT("Standalone") : TEXT("Server");
+	const int64 HeapAllocatedMoves = UMyBaseMovementComponent::NumHeapAllocatedMoves - StartHeapAllocatedMoves;
+
+	UE_LOG(LogProject, Display, TEXT("MovementAllocTest: %s, %d frames"), NetModeName, Frames);
+
+	const FString FilePath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("MovementAllocTest.csv"));
+	FString Csv;
+	if (!IFileManager::Get().FileExists(*FilePath))
+	{
+		Csv = TEXT("NetMode,Path,Frames,Calls,Allocations,MaxPerFrame,FramesWithAllocations\n");
+	}
+
+	bool bPassed = HeapAllocatedMoves == 0;
+	int32 PathsRun = 0;
+	for (int32 Index = 0; Index < UE_ARRAY_COUNT(Paths); ++Index)
+	{
+		const FPathStats& Stats = Paths[Index];
+		if (Stats.Calls == 0)
+		{
+			UE_LOG(LogProject, Display, TEXT("  %-10s not run"), MyAllocTestPathNames[Index]);
+			continue;
+		}
+
+		++PathsRun;
+		bPassed &= Stats.Allocations == 0;
+
+		UE_LOG(LogProject, Display, TEXT("  %-10s calls %lld  allocations %llu (%.2f per frame, max %llu, in %d frames)"),
+			MyAllocTestPathNames[Index], Stats.Calls, Stats.Allocations, static_cast<double>(Stats.Allocations) / Frames,
+			Stats.MaxFrameAllocations, Stats.FramesWithAllocations);
+
+		Csv += FString::Printf(TEXT("%s,%s,%d,%lld,%llu,%llu,%d\n"), NetModeName, MyAllocTestPathNames[Index], Frames, Stats.Calls,
+			Stats.Allocations, Stats.MaxFrameAllocations, Stats.FramesWithAllocations);
+	}
+	FFileHelper::SaveStringToFile(Csv, *FilePath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	UE_LOG(LogProject, Display, TEXT("  saved moves from the heap: %lld"), HeapAllocatedMoves);
+
+	if (PathsRun == 0)
+	{
+		UE_LOG(LogProject, Warning, TEXT("MovementAllocTest: no networked movement ran; use a client, or a server with moving clients"));
+	}
+	else if (bPassed)
+	{
+		UE_LOG(LogProject, Display, TEXT("MovementAllocTest: PASSED, no allocations in the movement path"));
+	}
+	else
+	{
+		UE_LOG(LogProject, Error, TEXT("MovementAllocTest: FAILED, the movement path allocated after warmup"));
+	}
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyMovementAllocTest(
+	TEXT("Project.Movement.AllocTest"),
+	TEXT("Counts heap allocations of the networked movement path per frame and fails if there are any after warmup. Arguments: [Frames] [WarmupFrames]."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UMyMovementAllocTestSubsystem* Test = World ? World->GetSubsystem<UMyMovementAllocTestSubsystem>() : nullptr)
+		{
+			const int32 Frames = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 600;
+			const int32 WarmupFrames = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 120;
+			Test->StartTest(Frames, WarmupFrames, Ar);
+		}
+	}));
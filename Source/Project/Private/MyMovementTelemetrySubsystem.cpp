@@ -0,0 +1,251 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyMovementTelemetrySubsystem.h"
+#include "Project.h"
+#include "Engine/World.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/IConsoleManager.h"
+
+static int32 GMyMovementAdaptive = 0;
+static FAutoConsoleVariableRef CVarMyMovementAdaptive(
+	TEXT("Project.Movement.Adaptive"),
+	GMyMovementAdaptive,
+	TEXT("Tunes smoothing distances and the move send rate on clients from the round trip time and jitter of their connection (0 = off, 1 = on). ")
+	TEXT("Off by default: it changes how often clients send moves and how corrections look, so turn it on per test."));
+
+static float GMyMovementAdaptivePoorRoundTripMs = 250.0f;
+static FAutoConsoleVariableRef CVarMyMovementAdaptivePoorRoundTrip(
+	TEXT("Project.Movement.Adaptive.PoorRoundTripMs"),
+	GMyMovementAdaptivePoorRoundTripMs,
+	TEXT("Round trip time in ms at which the adaptive settings reach their widest values."));
+
+static float GMyMovementAdaptivePoorJitterMs = 40.0f;
+static FAutoConsoleVariableRef CVarMyMovementAdaptivePoorJitter(
+	TEXT("Project.Movement.Adaptive.PoorJitterMs"),
+	GMyMovementAdaptivePoorJitterMs,
+	TEXT("Jitter in ms at which the adaptive settings reach their widest values."));
+
+static float GMyMovementAdaptiveMaxSendScale = 2.0f;
+static FAutoConsoleVariableRef CVarMyMovementAdaptiveMaxSendScale(
+	TEXT("Project.Movement.Adaptive.MaxSendScale"),
+	GMyMovementAdaptiveMaxSendScale,
+	TEXT("Largest multiplier for the interval between moves a client sends on a poor connection."));
+
+/* Round trip time up to which a connection counts as good and the defaults are used. */
+static constexpr float MyMovementGoodRoundTripMs = 60.0f;
+
+/* Smoothing distances on the poorest connection; the defaults come from FMyAdaptiveMoveSettings. */
+static constexpr float MyMovementPoorMaxSmoothNetUpdateDist = 192.0f;
+static constexpr float MyMovementPoorNoSmoothNetUpdateDist = 320.0f;
+
+/* Round trip times are averaged by the net connection once a second, so sampling faster only repeats values. */
+static constexpr double MyMovementSampleSeconds = 1.0;
+
+void FMyCorrectionHistogram::Add(float Magnitude)
+{
+	int32 Bucket = 0;
+	while (Bucket < NumBuckets - 1 && Magnitude > BucketLimits[Bucket])
+	{
+		++Bucket;
+	}
+	++Buckets[Bucket];
+}
+
+FString FMyCorrectionHistogram::ToString() const
+{
+	FString Result;
+	for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+	{
+		if (Bucket < NumBuckets - 1)
+		{
+			Result += FString::Printf(TEXT("<%.0f:%lld "), BucketLimits[Bucket], Buckets[Bucket]);
+		}
+		else
+		{
+			Result += FString::Printf(TEXT(">%.0f:%lld"), BucketLimits[Bucket - 1], Buckets[Bucket]);
+		}
+	}
+	return Result;
+}
+
+bool UMyMovementTelemetrySubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return Super::ShouldCreateSubsystem(Outer) && World && World->IsGameWorld();
+}
+
+void UMyMovementTelemetrySubsystem::Tick(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+	if (Now - LastSampleTime < MyMovementSampleSeconds) { return; }
+
+	LastSampleTime = Now;
+	SampleConnections();
+}
+
+TStatId UMyMovementTelemetrySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMyMovementTelemetrySubsystem, STATGROUP_Tickables);
+}
+
+void UMyMovementTelemetrySubsystem::RecordCorrection(const APlayerController* PlayerController, float Magnitude)
+{
+	if (!PlayerController) { return; }
+
+	FMyConnectionTelemetry& Connection = FindOrAddConnection(PlayerController);
+	++Connection.Corrections;
+	Connection.MaxCorrection = FMath::Max(Connection.MaxCorrection, Magnitude);
+	Connection.Histogram.Add(Magnitude);
+}
+
+void UMyMovementTelemetrySubsystem::RecordRollback(const APlayerController* PlayerController)
+{
+	if (!PlayerController) { return; }
+
+	++FindOrAddConnection(PlayerController).Rollbacks;
+}
+
+void UMyMovementTelemetrySubsystem::RecordSmoothing(float Distance, float MaxSmoothNetUpdateDist, float NoSmoothNetUpdateDist)
+{
+	if (Distance <= MaxSmoothNetUpdateDist) { return; }
+
+	FMyConnectionTelemetry& Connection = FindOrAddConnection(GetWorld()->GetFirstPlayerController());
+	if (Distance > NoSmoothNetUpdateDist)
+	{
+		++Connection.SmoothingSnaps;
+	}
+	else
+	{
+		++Connection.SmoothingClamps;
+	}
+}
+
+int64 UMyMovementTelemetrySubsystem::GetTotalCorrections() const
+{
+	int64 Total = 0;
+	for (const FMyConnectionTelemetry& Connection : Connections)
+	{
+		Total += Connection.Corrections + Connection.Rollbacks;
+	}
+	return Total;
+}
+
+void UMyMovementTelemetrySubsystem::Reset()
+{
+	// Keep the measured network conditions, they are not counters.
+	for (FMyConnectionTelemetry& Connection : Connections)
+	{
+		Connection.Corrections = 0;
+		Connection.MaxCorrection = 0.0f;
+		Connection.Histogram = FMyCorrectionHistogram();
+		Connection.Rollbacks = 0;
+		Connection.SmoothingClamps = 0;
+		Connection.SmoothingSnaps = 0;
+	}
+}
+
+void UMyMovementTelemetrySubsystem::Dump(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("MovementTelemetry: adaptive %s  max smooth %.0f  no smooth %.0f  send interval x%.2f"),
+		GMyMovementAdaptive ? TEXT("on") : TEXT("off"), AdaptiveSettings.MaxSmoothNetUpdateDist, AdaptiveSettings.NoSmoothNetUpdateDist, AdaptiveSettings.SendDeltaTimeScale);
+
+	for (const FMyConnectionTelemetry& Connection : Connections)
+	{
+		Ar.Logf(TEXT("  %-20s%s rtt %.0f ms  jitter %.1f ms  corrections %lld (max %.1f cm)  rollbacks %lld  smoothing clamps %lld  snaps %lld"),
+			*Connection.Name, Connection.PlayerController.IsValid() ? TEXT("") : TEXT(" (gone)"),
+			FMath::Max(Connection.RoundTripMs, 0.0f), Connection.JitterMs, Connection.Corrections, Connection.MaxCorrection,
+			Connection.Rollbacks, Connection.SmoothingClamps, Connection.SmoothingSnaps);
+		Ar.Logf(TEXT("    %s"), *Connection.Histogram.ToString());
+	}
+}
+
+FMyConnectionTelemetry& UMyMovementTelemetrySubsystem::FindOrAddConnection(const APlayerController* PlayerController)
+{
+	for (FMyConnectionTelemetry& Connection : Connections)
+	{
+		if (Connection.PlayerController == PlayerController)
+		{
+			return Connection;
+		}
+	}
+
+	FMyConnectionTelemetry& Connection = Connections.AddDefaulted_GetRef();
+	Connection.PlayerController = PlayerController;
+	Connection.Name = (PlayerController && PlayerController->PlayerState) ? PlayerController->PlayerState->GetPlayerName() : GetNameSafe(PlayerController);
+	return Connection;
+}
+
+void UMyMovementTelemetrySubsystem::SampleConnections()
+{
+	UWorld* World = GetWorld();
+	const bool bIsClient = World->GetNetMode() == NM_Client;
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+
+		// The server measures its clients, a client its own connection to the server.
+		const UNetConnection* NetConnection = PlayerController ? PlayerController->GetNetConnection() : nullptr;
+		if (!NetConnection || PlayerController->IsLocalController() != bIsClient) { continue; }
+
+		FMyConnectionTelemetry& Connection = FindOrAddConnection(PlayerController);
+
+		// Smoothed like RFC 3550 interarrival jitter.
+		const float LagMs = NetConnection->AvgLag * 1000.0f;
+		if (Connection.LastLagMs >= 0.0f)
+		{
+			Connection.JitterMs += (FMath::Abs(LagMs - Connection.LastLagMs) - Connection.JitterMs) / 16.0f;
+			Connection.RoundTripMs += (LagMs - Connection.RoundTripMs) / 8.0f;
+		}
+		else
+		{
+			Connection.RoundTripMs = LagMs;
+		}
+		Connection.LastLagMs = LagMs;
+
+		if (bIsClient)
+		{
+			UpdateAdaptiveSettings(Connection);
+		}
+	}
+}
+
+void UMyMovementTelemetrySubsystem::UpdateAdaptiveSettings(const FMyConnectionTelemetry& Connection)
+{
+	AdaptiveSettings = FMyAdaptiveMoveSettings();
+	if (!GMyMovementAdaptive) { return; }
+
+	// 0 on a good connection, 1 on a poor one, whichever of round trip time and jitter is worse.
+	const float RoundTripAlpha = FMath::GetRangePct(MyMovementGoodRoundTripMs, FMath::Max(GMyMovementAdaptivePoorRoundTripMs, MyMovementGoodRoundTripMs + 1.0f), Connection.RoundTripMs);
+	const float JitterAlpha = Connection.JitterMs / FMath::Max(GMyMovementAdaptivePoorJitterMs, 1.0f);
+	const float Alpha = FMath::Clamp(FMath::Max(RoundTripAlpha, JitterAlpha), 0.0f, 1.0f);
+
+	// Other characters drift further from their last update the later and less regular updates arrive.
+	AdaptiveSettings.MaxSmoothNetUpdateDist = FMath::Lerp(AdaptiveSettings.MaxSmoothNetUpdateDist, MyMovementPoorMaxSmoothNetUpdateDist, Alpha);
+	AdaptiveSettings.NoSmoothNetUpdateDist = FMath::Lerp(AdaptiveSettings.NoSmoothNetUpdateDist, MyMovementPoorNoSmoothNetUpdateDist, Alpha);
+	AdaptiveSettings.SendDeltaTimeScale = FMath::Lerp(1.0f, FMath::Max(GMyMovementAdaptiveMaxSendScale, 1.0f), Alpha);
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyMovementTelemetryDump(
+	TEXT("Project.Movement.Telemetry.Dump"),
+	TEXT("Logs movement corrections per connection with their sizes, smoothing snaps, round trip time, jitter and the adaptive settings in use."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (const UMyMovementTelemetrySubsystem* Telemetry = World ? World->GetSubsystem<UMyMovementTelemetrySubsystem>() : nullptr)
+		{
+			Telemetry->Dump(Ar);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyMovementTelemetryReset(
+	TEXT("Project.Movement.Telemetry.Reset"),
+	TEXT("Clears the movement correction and smoothing counters."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UMyMovementTelemetrySubsystem* Telemetry = World ? World->GetSubsystem<UMyMovementTelemetrySubsystem>() : nullptr)
+		{
+			Telemetry->Reset();
+		}
+	}));
@@ -0,0 +1,235 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyMoverBenchmarkSubsystem.h"
+#include "Project.h"
+#include "MyBaseCharacter.h"
+#include "MyBaseMovementComponent.h"
+#include "MyMoverCharacter.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+/* Distance between spawned pawns. */
+static constexpr float MyMoverBenchSpacing = 300.0f;
+
+/* Time given to spawned pawns to land and get going before measuring. */
+static constexpr double MyMoverBenchWarmupSeconds = 2.0;
+
+/* Scripted input: seconds per full circle, and how often sprint and crouch toggle. */
+static constexpr double MyMoverBenchCircleSeconds = 8.0;
+static constexpr double MyMoverBenchSprintSeconds = 2.0;
+static constexpr double MyMoverBenchCrouchSeconds = 5.0;
+
+void UMyMoverBenchmarkSubsystem::Deinitialize()
+{
+	SpawnedPawns.Reset();
+	Phase = EPhase::Idle;
+
+	Super::Deinitialize();
+}
+
+void UMyMoverBenchmarkSubsystem::StartBenchmark(int32 InCount, float InPhaseSeconds, FOutputDevice& Ar)
+{
+	if (IsRunning())
+	{
+		Ar.Logf(TEXT("MoverBench: already running"));
+		return;
+	}
+
+	UWorld* World = GetWorld();
+	if (!World || World->GetNetMode() == NM_Client)
+	{
+		Ar.Logf(TEXT("MoverBench: needs a standalone game or a server"));
+		return;
+	}
+
+	Origin = FVector::ZeroVector;
+	if (const APlayerController* PC = World->GetFirstPlayerController())
+	{
+		if (const APawn* Pawn = PC->GetPawn())
+		{
+			Origin = Pawn->GetActorLocation() + Pawn->GetActorForwardVector() * 500.0f;
+		}
+	}
+
+	Count = InCount;
+	PhaseSeconds = FMath::Max(InPhaseSeconds, 1.0f);
+
+	Ar.Logf(TEXT("MoverBench: %d pawns per backend, measuring %.0fs each"), Count, PhaseSeconds);
+
+	EnterPhase(EPhase::CharacterWarmup);
+}
+
+void UMyMoverBenchmarkSubsystem::Tick(float DeltaTime)
+{
+	if (!IsRunning()) { return; }
+
+	DriveScriptedInput();
+
+	const double Now = FPlatformTime::Seconds();
+	++PhaseFrames;
+	PhaseFrameSeconds += Now - LastFrameTime;
+	LastFrameTime = Now;
+
+	const double Elapsed = Now - PhaseStartTime;
+
+	switch (Phase)
+	{
+	case EPhase::CharacterWarmup:
+		if (Elapsed >= MyMoverBenchWarmupSeconds)
+		{
+			EnterPhase(EPhase::Character);
+		}
+		break;
+
+	case EPhase::Character:
+		if (Elapsed >= PhaseSeconds)
+		{
+			ReportPhase(TEXT("Character"));
+			DestroyPawns();
+			EnterPhase(EPhase::MoverWarmup);
+		}
+		break;
+
+	case EPhase::MoverWarmup:
+		if (Elapsed >= MyMoverBenchWarmupSeconds)
+		{
+			EnterPhase(EPhase::Mover);
+		}
+		break;
+
+	case EPhase::Mover:
+		if (Elapsed >= PhaseSeconds)
+		{
+			ReportPhase(TEXT("Mover"));
+			DestroyPawns();
+			Phase = EPhase::Idle;
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+TStatId UMyMoverBenchmarkSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMyMoverBenchmarkSubsystem, STATGROUP_Tickables);
+}
+
+void UMyMoverBenchmarkSubsystem::EnterPhase(EPhase NewPhase)
+{
+	if (NewPhase == EPhase::CharacterWarmup)
+	{
+		UClass* CharacterClass = StaticLoadClass(AMyBaseCharacter::StaticClass(), nullptr, TEXT("/Game/ThirdPerson/Blueprints/BP_BaseCharacter.BP_BaseCharacter_C"));
+		SpawnPawns(CharacterClass ? CharacterClass : AMyBaseCharacter::StaticClass());
+	}
+	else if (NewPhase == EPhase::MoverWarmup)
+	{
+		SpawnPawns(AMyMoverCharacter::StaticClass());
+	}
+
+	Phase = NewPhase;
+	PhaseStartTime = FPlatformTime::Seconds();
+	LastFrameTime = PhaseStartTime;
+	PhaseFrames = 0;
+	PhaseFrameSeconds = 0.0;
+}
+
+void UMyMoverBenchmarkSubsystem::SpawnPawns(UClass* PawnClass)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	// Square grid in front of the player.
+	const int32 Columns = FMath::Max(FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count))), 1);
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const FVector Location = Origin + FVector((Index / Columns) * MyMoverBenchSpacing, (Index % Columns - Columns / 2) * MyMoverBenchSpacing, 100.0f);
+
+		APawn* Pawn = GetWorld()->SpawnActor<APawn>(PawnClass, Location, FRotator::ZeroRotator, SpawnParams);
+		if (!Pawn) { continue; }
+
+		// Both backends only simulate controlled pawns.
+		Pawn->SpawnDefaultController();
+		SpawnedPawns.Add(Pawn);
+	}
+}
+
+void UMyMoverBenchmarkSubsystem::DestroyPawns()
+{
+	for (const TWeakObjectPtr<APawn>& Pawn : SpawnedPawns)
+	{
+		if (Pawn.IsValid())
+		{
+			if (AController* Controller = Pawn->GetController())
+			{
+				Controller->Destroy();
+			}
+			Pawn->Destroy();
+		}
+	}
+	SpawnedPawns.Reset();
+}
+
+void UMyMoverBenchmarkSubsystem::DriveScriptedInput()
+{
+	const double Time = FPlatformTime::Seconds() - PhaseStartTime;
+	const bool bSprint = FMath::FloorToInt(Time / MyMoverBenchSprintSeconds) % 2 == 1;
+	const bool bCrouch = !bSprint && FMath::FloorToInt(Time / MyMoverBenchCrouchSeconds) % 2 == 1;
+
+	for (int32 Index = 0; Index < SpawnedPawns.Num(); ++Index)
+	{
+		APawn* Pawn = SpawnedPawns[Index].Get();
+		if (!Pawn) { continue; }
+
+		// Every pawn walks its own circle, offset so they don't all turn at once.
+		const double Angle = (Time / MyMoverBenchCircleSeconds + Index * 0.1) * UE_DOUBLE_TWO_PI;
+		Pawn->AddMovementInput(FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0));
+
+		if (AMyMoverCharacter* MoverCharacter = Cast<AMyMoverCharacter>(Pawn))
+		{
+			if (bSprint) { MoverCharacter->StartSprinting(); } else { MoverCharacter->StopSprinting(); }
+			if (bCrouch) { MoverCharacter->StartCrouching(); } else { MoverCharacter->StopCrouching(); }
+		}
+		else if (AMyBaseCharacter* Character = Cast<AMyBaseCharacter>(Pawn))
+		{
+			UMyBaseMovementComponent* Movement = Character->GetMyBaseMovementComponent();
+			if (bSprint) { Movement->StartSprinting(); } else { Movement->StopSprinting(); }
+			if (bCrouch) { Movement->StartCrouching(); } else { Movement->StopCrouching(); }
+		}
+	}
+}
+
+void UMyMoverBenchmarkSubsystem::ReportPhase(const TCHAR* Backend)
+{
+	const double Frames = static_cast<double>(FMath::Max<int64>(PhaseFrames, 1));
+	const double FrameMs = (PhaseFrameSeconds / Frames) * 1000.0;
+
+	UE_LOG(LogProject, Display, TEXT("MoverBench: %-9s %d pawns  frame %.3f ms"), Backend, SpawnedPawns.Num(), FrameMs);
+
+	const FString FilePath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("MoverBench.csv"));
+	FString Csv;
+	if (!IFileManager::Get().FileExists(*FilePath))
+	{
+		Csv = TEXT("Backend,Pawns,FrameMs\n");
+	}
+	Csv += FString::Printf(TEXT("%s,%d,%.4f\n"), Backend, SpawnedPawns.Num(), FrameMs);
+	FFileHelper::SaveStringToFile(Csv, *FilePath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyMoverBench(
+	TEXT("Project.Mover.Bench"),
+	TEXT("Runs the same scripted pawns on the character and Mover backends and compares frame time. Arguments: <Count> [SecondsPerBackend]."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UMyMoverBenchmarkSubsystem* Bench = World ? World->GetSubsystem<UMyMoverBenchmarkSubsystem>() : nullptr)
+		{
+			const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 50;
+			const float Seconds = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 10.0f;
+			Bench->StartBenchmark(FMath::Max(Count, 1), Seconds, Ar);
+		}
+	}));
@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyMoverCharacter.h"
+#include "MyMoverComponent.h"
+#include "MyMoverTypes.h"
+#include "MoverDataModelTypes.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/SpringArmComponent.h"
+#include "Camera/CameraComponent.h"
+#include "Animation/AnimInstance.h"
+#include "Engine/SkeletalMesh.h"
+#include "EnhancedInputComponent.h"
+#include "InputAction.h"
+#include "UObject/ConstructorHelpers.h"
+
+AMyMoverCharacter::AMyMoverCharacter()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	// Same capsule as ACharacter.
+	CapsuleComponent = CreateDefaultSubobject<UCapsuleComponent>(TEXT("CollisionCylinder"));
+	CapsuleComponent->InitCapsuleSize(34.0f, 88.0f);
+	CapsuleComponent->SetCollisionProfileName(UCollisionProfile::Pawn_ProfileName);
+	RootComponent = CapsuleComponent;
+
+	Mesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("CharacterMesh0"));
+	Mesh->SetupAttachment(CapsuleComponent);
+	Mesh->SetCollisionProfileName(TEXT("CharacterMesh"));
+	Mesh->SetRelativeLocationAndRotation(FVector(0.0f, 0.0f, -88.0f), FRotator(0.0f, -90.0f, 0.0f));
+
+	/* There is no Blueprint of this pawn, so it uses the same mannequin and input actions as BP_BaseCharacter. */
+	ConstructorHelpers::FObjectFinder<USkeletalMesh> MeshAsset(TEXT("/Game/Characters/Mannequins/Meshes/SK_Mannequin.SK_Mannequin"));
+	ConstructorHelpers::FClassFinder<UAnimInstance> AnimClass(TEXT("/Game/Characters/Mannequins/Anims/Unarmed/ABP_Unarmed"));
+	if (MeshAsset.Succeeded()) { Mesh->SetSkeletalMesh(MeshAsset.Object); }
+	if (AnimClass.Succeeded()) { Mesh->SetAnimInstanceClass(AnimClass.Class); }
+
+	ConstructorHelpers::FObjectFinder<UInputAction> MoveActionAsset(TEXT("/Game/Input/Actions/IA_Move.IA_Move"));
+	ConstructorHelpers::FObjectFinder<UInputAction> LookActionAsset(TEXT("/Game/Input/Actions/IA_Look.IA_Look"));
+	ConstructorHelpers::FObjectFinder<UInputAction> SprintActionAsset(TEXT("/Game/Input/Actions/IA_Sprint.IA_Sprint"));
+	ConstructorHelpers::FObjectFinder<UInputAction> CrouchActionAsset(TEXT("/Game/Input/Actions/IA_Crouch.IA_Crouch"));
+	MoveAction = MoveActionAsset.Object;
+	LookAction = LookActionAsset.Object;
+	SprintAction = SprintActionAsset.Object;
+	CrouchAction = CrouchActionAsset.Object;
+
+	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
+	CameraBoom->SetupAttachment(CapsuleComponent);
+	CameraBoom->TargetArmLength = 400.0f;
+	CameraBoom->bUsePawnControlRotation = true;
+
+	FollowCamera = CreateDefaultSubobject<UCameraComponent>(TEXT("FollowCamera"));
+	FollowCamera->SetupAttachment(CameraBoom, USpringArmComponent::SocketName);
+	FollowCamera->bUsePawnControlRotation = false;
+
+	MoverComponent = CreateDefaultSubobject<UMyMoverComponent>(TEXT("MoverComponent"));
+
+	// Rotation follows movement, as on AMyBaseCharacter in third person.
+	bUseControllerRotationYaw = false;
+
+	// Network Prediction replicates the movement state.
+	bReplicates = true;
+	SetReplicatingMovement(false);
+}
+
+void AMyMoverCharacter::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	CachedMoveInput = ConsumeMovementInputVector();
+}
+
+void AMyMoverCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
+{
+	Super::SetupPlayerInputComponent(PlayerInputComponent);
+
+	if (UEnhancedInputComponent* EnhancedInputComponent = Cast<UEnhancedInputComponent>(PlayerInputComponent))
+	{
+		EnhancedInputComponent->BindAction(MoveAction, ETriggerEvent::Triggered, this, &AMyMoverCharacter::Move);
+
+		EnhancedInputComponent->BindAction(LookAction, ETriggerEvent::Triggered, this, &AMyMoverCharacter::Look);
+
+		EnhancedInputComponent->BindAction(SprintAction, ETriggerEvent::Started, this, &AMyMoverCharacter::StartSprinting);
+		EnhancedInputComponent->BindAction(SprintAction, ETriggerEvent::Completed, this, &AMyMoverCharacter::StopSprinting);
+
+		EnhancedInputComponent->BindAction(CrouchAction, ETriggerEvent::Started, this, &AMyMoverCharacter::StartCrouching);
+		EnhancedInputComponent->BindAction(CrouchAction, ETriggerEvent::Completed, this, &AMyMoverCharacter::StopCrouching);
+	}
+}
+
+void AMyMoverCharacter::ProduceInput_Implementation(int32 SimTimeMs, FMoverInputCmdContext& InputCmdResult)
+{
+	FCharacterDefaultInputs& CharacterInputs = InputCmdResult.InputCollection.FindOrAddMutableDataByType<FCharacterDefaultInputs>();
+
+	CharacterInputs.SetMoveInput(EMoveInputType::DirectionalIntent, CachedMoveInput.GetClampedToMaxSize(1.0f));
+	CharacterInputs.ControlRotation = GetControlRotation();
+
+	// Face the way we move; keep facing the same way when standing still.
+	CharacterInputs.OrientationIntent = CachedMoveInput.IsNearlyZero() ? GetActorForwardVector() : CachedMoveInput.GetSafeNormal2D();
+
+	FMyMoverInputs& MyInputs = InputCmdResult.InputCollection.FindOrAddMutableDataByType<FMyMoverInputs>();
+	MyInputs.bWantsToSprint = bWantsToSprint;
+	MyInputs.bWantsToCrouch = bWantsToCrouch;
+}
+
+void AMyMoverCharacter::Move(const FInputActionValue& Value)
+{
+	if (GetController() == nullptr) return;
+
+	const FVector2D MovementVector = Value.Get<FVector2D>();
+	const FRotator YawRotation(0, GetController()->GetControlRotation().Yaw, 0);
+
+	AddMovementInput(FRotationMatrix(YawRotation).GetUnitAxis(EAxis::X), MovementVector.Y);
+	AddMovementInput(FRotationMatrix(YawRotation).GetUnitAxis(EAxis::Y), MovementVector.X);
+}
+
+void AMyMoverCharacter::Look(const FInputActionValue& Value)
+{
+	const FVector2D LookAxisVector = Value.Get<FVector2D>();
+
+	AddControllerYawInput(LookAxisVector.X);
+	AddControllerPitchInput(LookAxisVector.Y);
+}
+
+void AMyMoverCharacter::StartSprinting()
+{
+	bWantsToSprint = true;
+
+	/* Cancel crouch state when sprinting begins. */
+	bWantsToCrouch = false;
+}
+
+void AMyMoverCharacter::StopSprinting()
+{
+	bWantsToSprint = false;
+}
+
+void AMyMoverCharacter::StartCrouching()
+{
+	bWantsToCrouch = true;
+
+	/* Cancel sprint state when crouching begins. */
+	bWantsToSprint = false;
+}
+
+void AMyMoverCharacter::StopCrouching()
+{
+	bWantsToCrouch = false;
+}
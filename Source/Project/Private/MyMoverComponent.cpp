@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyMoverComponent.h"
+#include "MyMoverTypes.h"
+#include "MyMoverWalkingMode.h"
+#include "MyMovementTelemetrySubsystem.h"
+#include "DefaultMovementSet/Modes/FallingMode.h"
+#include "DefaultMovementSet/Settings/CommonLegacyMovementSettings.h"
+#include "GameFramework/PlayerController.h"
+
+UMyMoverComponent::UMyMoverComponent()
+{
+	MovementModes.Add(DefaultModeNames::Walking, CreateDefaultSubobject<UMyMoverWalkingMode>(TEXT("WalkingMode")));
+	MovementModes.Add(DefaultModeNames::Falling, CreateDefaultSubobject<UFallingMode>(TEXT("FallingMode")));
+	StartingMovementMode = DefaultModeNames::Walking;
+
+	// Sprint and crouch carry over between frames instead of resetting to defaults.
+	PersistentSyncStateDataTypes.Add(FMoverDataPersistence(FMyMoverSpeedState::StaticStruct(), true));
+}
+
+void UMyMoverComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	UpdateMaxSpeed();
+
+	OnPostSimulationRollback.AddDynamic(this, &UMyMoverComponent::OnRollback);
+
+#if !UE_BUILD_SHIPPING
+	TuningChangedHandle = UMyCharacterTuning::OnTuningChanged.AddUObject(this, &UMyMoverComponent::OnTuningChanged);
+#endif
+}
+
+void UMyMoverComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+#if !UE_BUILD_SHIPPING
+	UMyCharacterTuning::OnTuningChanged.Remove(TuningChangedHandle);
+#endif
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UMyMoverComponent::UpdateMaxSpeed()
+{
+	// The walking mode limits speed per stance, so the shared limit has to allow the fastest one.
+	if (const UMyMoverWalkingMode* WalkingMode = Cast<UMyMoverWalkingMode>(MovementModes.FindRef(DefaultModeNames::Walking)))
+	{
+		if (UCommonLegacyMovementSettings* Settings = FindSharedSettings_Mutable<UCommonLegacyMovementSettings>())
+		{
+			Settings->MaxSpeed = WalkingMode->GetMaxStanceSpeed();
+		}
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+void UMyMoverComponent::OnTuningChanged(const UMyCharacterTuning* ChangedTuning)
+{
+	const UMyMoverWalkingMode* WalkingMode = Cast<UMyMoverWalkingMode>(MovementModes.FindRef(DefaultModeNames::Walking));
+	if (WalkingMode && WalkingMode->Tuning == ChangedTuning)
+	{
+		UpdateMaxSpeed();
+	}
+}
+#endif
+
+void UMyMoverComponent::OnRollback(const FMoverTimeStep& CurrentTimeStep, const FMoverTimeStep& PreviousTimeStep)
+{
+	const APawn* PawnOwner = Cast<APawn>(GetOwner());
+	if (!PawnOwner || !PawnOwner->IsLocallyControlled() || PawnOwner->HasAuthority()) { return; }
+
+	if (UMyMovementTelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UMyMovementTelemetrySubsystem>())
+	{
+		Telemetry->RecordRollback(Cast<APlayerController>(PawnOwner->GetController()));
+	}
+}
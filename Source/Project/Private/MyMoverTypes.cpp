@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyMoverTypes.h"
+
+FMoverDataStructBase* FMyMoverInputs::Clone() const
+{
+	return new FMyMoverInputs(*this);
+}
+
+bool FMyMoverInputs::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Super::NetSerialize(Ar, Map, bOutSuccess);
+
+	// Two bits per input command.
+	uint8 Flags = (bWantsToSprint ? 1 : 0) | (bWantsToCrouch ? 2 : 0);
+	Ar.SerializeBits(&Flags, 2);
+
+	bWantsToSprint = (Flags & 1) != 0;
+	bWantsToCrouch = (Flags & 2) != 0;
+
+	bOutSuccess = true;
+	return true;
+}
+
+void FMyMoverInputs::ToString(FAnsiStringBuilderBase& Out) const
+{
+	Super::ToString(Out);
+
+	Out.Appendf("bWantsToSprint: %i\n", bWantsToSprint ? 1 : 0);
+	Out.Appendf("bWantsToCrouch: %i\n", bWantsToCrouch ? 1 : 0);
+}
+
+FMoverDataStructBase* FMyMoverSpeedState::Clone() const
+{
+	return new FMyMoverSpeedState(*this);
+}
+
+bool FMyMoverSpeedState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Super::NetSerialize(Ar, Map, bOutSuccess);
+
+	uint8 Flags = (bIsSprinting ? 1 : 0) | (bIsCrouching ? 2 : 0);
+	Ar.SerializeBits(&Flags, 2);
+
+	bIsSprinting = (Flags & 1) != 0;
+	bIsCrouching = (Flags & 2) != 0;
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+void FMyMoverSpeedState::ToString(FAnsiStringBuilderBase& Out) const
+{
+	Super::ToString(Out);
+
+	Out.Appendf("bIsSprinting: %i\n", bIsSprinting ? 1 : 0);
+	Out.Appendf("bIsCrouching: %i\n", bIsCrouching ? 1 : 0);
+}
+
+bool FMyMoverSpeedState::ShouldReconcile(const FMoverDataStructBase& AuthorityState) const
+{
+	const FMyMoverSpeedState& Authority = static_cast<const FMyMoverSpeedState&>(AuthorityState);
+
+	return bIsSprinting != Authority.bIsSprinting
+		|| bIsCrouching != Authority.bIsCrouching;
+}
+
+void FMyMoverSpeedState::Interpolate(const FMoverDataStructBase& From, const FMoverDataStructBase& To, float Pct)
+{
+	// Flags are steps, not curves; take whichever side is closer.
+	*this = static_cast<const FMyMoverSpeedState&>(Pct < 0.5f ? From : To);
+}
@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyMoverWalkingMode.h"
+#include "MyMoverTypes.h"
+#include "MoverDataModelTypes.h"
+
+UMyMoverWalkingMode::UMyMoverWalkingMode(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	// Instances copy the tuning from their archetype
+	if (HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+	{
+		Tuning = UMyCharacterTuning::LoadDefault();
+	}
+}
+
+void UMyMoverWalkingMode::OnGenerateMove(const FMoverTickStartData& StartState, const FMoverTimeStep& TimeStep, FProposedMove& OutProposedMove) const
+{
+	Super::OnGenerateMove(StartState, TimeStep, OutProposedMove);
+
+	const FMyMoverInputs* Inputs = StartState.InputCmd.InputCollection.FindDataByType<FMyMoverInputs>();
+	const FMoverDefaultSyncState* SyncState = StartState.SyncState.SyncStateCollection.FindDataByType<FMoverDefaultSyncState>();
+
+	// Sprint cancels crouch, as in UMyBaseMovementComponent.
+	const bool bSprinting = Inputs && Inputs->bWantsToSprint;
+	const bool bCrouching = Inputs && Inputs->bWantsToCrouch && !bSprinting;
+	const FMyCharacterTuningValues& Speeds = GetTuning();
+	const float TargetSpeed = bSprinting ? Speeds.SprintSpeed : (bCrouching ? Speeds.CrouchSpeed : Speeds.WalkSpeed);
+
+	// Brake down to the stance speed instead of snapping to it.
+	const float DeltaSeconds = TimeStep.StepMs * 0.001f;
+	const float PriorSpeed = SyncState ? SyncState->GetVelocity_WorldSpace().Size2D() : 0.0f;
+	const float MaxSpeed = FMath::Max(TargetSpeed, PriorSpeed - BrakingDeceleration * DeltaSeconds);
+
+	const FVector Velocity = OutProposedMove.LinearVelocity;
+	const FVector Lateral = FVector(Velocity.X, Velocity.Y, 0.0f).GetClampedToMaxSize(MaxSpeed);
+	OutProposedMove.LinearVelocity = FVector(Lateral.X, Lateral.Y, Velocity.Z);
+}
+
+void UMyMoverWalkingMode::OnSimulationTick(const FSimulationTickParams& Params, FMoverTickEndData& OutputState)
+{
+	Super::OnSimulationTick(Params, OutputState);
+
+	const FMyMoverInputs* Inputs = Params.StartState.InputCmd.InputCollection.FindDataByType<FMyMoverInputs>();
+
+	FMyMoverSpeedState& SpeedState = OutputState.SyncState.SyncStateCollection.FindOrAddMutableDataByType<FMyMoverSpeedState>();
+	SpeedState.bIsSprinting = Inputs && Inputs->bWantsToSprint;
+	SpeedState.bIsCrouching = Inputs && Inputs->bWantsToCrouch && !SpeedState.bIsSprinting;
+}
@@ -0,0 +1,453 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyNavQuerySubsystem.h"
+#include "NavigationSystem.h"
+#include "NavMesh/NavMeshPath.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/ParallelFor.h"
+
+static int32 GMyNavMaxPathsPerFrame = 32;
+static FAutoConsoleVariableRef CVarMyNavMaxPathsPerFrame(
+	TEXT("Project.Nav.MaxPathsPerFrame"),
+	GMyNavMaxPathsPerFrame,
+	TEXT("Maximum number of path queries started per frame. Shared requests count once."));
+
+static int32 GMyNavMaxRaycastsPerFrame = 256;
+static FAutoConsoleVariableRef CVarMyNavMaxRaycastsPerFrame(
+	TEXT("Project.Nav.MaxRaycastsPerFrame"),
+	GMyNavMaxRaycastsPerFrame,
+	TEXT("Maximum number of navmesh raycasts started per frame."));
+
+static float GMyNavStartCellSize = 150.0f;
+static FAutoConsoleVariableRef CVarMyNavStartCellSize(
+	TEXT("Project.Nav.StartCellSize"),
+	GMyNavStartCellSize,
+	TEXT("Path requests starting in the same cell of this size (and ending in the same goal cell) share a path."));
+
+static float GMyNavGoalCellSize = 50.0f;
+static FAutoConsoleVariableRef CVarMyNavGoalCellSize(
+	TEXT("Project.Nav.GoalCellSize"),
+	GMyNavGoalCellSize,
+	TEXT("Path requests ending in the same cell of this size (and starting in the same start cell) share a path."));
+
+static float GMyNavCacheSeconds = 1.0f;
+static FAutoConsoleVariableRef CVarMyNavCacheSeconds(
+	TEXT("Project.Nav.CacheSeconds"),
+	GMyNavCacheSeconds,
+	TEXT("How long a found path is handed to new requests with the same start and goal cells. 0 disables the cache."));
+
+/* Results nobody asked for within this time are dropped. */
+static constexpr double MyNavTicketLifetime = 10.0;
+
+bool UMyNavQuerySubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return Super::ShouldCreateSubsystem(Outer) && World && World->IsGameWorld();
+}
+
+void UMyNavQuerySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	WorldTickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &UMyNavQuerySubsystem::OnWorldTickStart);
+}
+
+void UMyNavQuerySubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldTickStart.Remove(WorldTickStartHandle);
+	BatchTask.Wait();
+
+	Tickets.Empty();
+	QueuedPaths.Empty();
+	QueuedPathIndices.Empty();
+	QueuedRaycasts.Empty();
+	BatchPaths.Empty();
+	BatchPathIndices.Empty();
+	BatchRaycasts.Empty();
+	PathCache.Empty();
+
+	Super::Deinitialize();
+}
+
+UMyNavQuerySubsystem* UMyNavQuerySubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UMyNavQuerySubsystem>() : nullptr;
+}
+
+FMyNavQueryHandle UMyNavQuerySubsystem::RequestPath(const AActor* Querier, const FVector& Start, const FVector& End)
+{
+	++NumPathRequests;
+
+	FMyNavQueryHandle Handle;
+	Handle.Id = AddTicket(true);
+	FTicket& Ticket = Tickets.FindChecked(Handle.Id);
+	Ticket.Querier = Querier;
+
+	FNavAgentProperties AgentProperties;
+	const ANavigationData* NavData = FindNavData(Querier, Start, AgentProperties);
+	if (!NavData)
+	{
+		ResolveTicket(Ticket, EMyNavQueryStatus::Failed);
+		return Handle;
+	}
+
+	const FPathKey Key = MakePathKey(NavData, Start, End);
+
+	// A navmesh rebuild since the path was found invalidates it; find a new one rather than hand out a repath.
+	const FCachedPath* Cached = PathCache.Find(Key);
+	if (Cached && Cached->Path->Path->IsUpToDate())
+	{
+		++NumSharedPaths;
+		Ticket.Path = Cached->Path;
+		ResolveTicket(Ticket, EMyNavQueryStatus::Succeeded);
+		return Handle;
+	}
+
+	// Only the ticket list of a running batch is touched here; the worker threads never read it.
+	if (const int32* BatchIndex = BatchPathIndices.Find(Key))
+	{
+		++NumSharedPaths;
+		BatchPaths[*BatchIndex].Tickets.Add(Handle.Id);
+		return Handle;
+	}
+
+	if (const int32* QueuedIndex = QueuedPathIndices.Find(Key))
+	{
+		++NumSharedPaths;
+		QueuedPaths[*QueuedIndex].Tickets.Add(Handle.Id);
+		return Handle;
+	}
+
+	FPathJob& Job = QueuedPaths.AddDefaulted_GetRef();
+	Job.Key = Key;
+	Job.NavData = NavData;
+	Job.Filter = NavData->GetDefaultQueryFilter();
+	Job.AgentProperties = AgentProperties;
+	Job.Start = Start;
+	Job.End = End;
+	Job.Tickets.Add(Handle.Id);
+	QueuedPathIndices.Add(Key, QueuedPaths.Num() - 1);
+
+	return Handle;
+}
+
+FMyNavQueryHandle UMyNavQuerySubsystem::RequestRaycast(const AActor* Querier, const FVector& Start, const FVector& End)
+{
+	++NumRaycastRequests;
+
+	FMyNavQueryHandle Handle;
+	Handle.Id = AddTicket(false);
+
+	FNavAgentProperties AgentProperties;
+	const ANavigationData* NavData = FindNavData(Querier, Start, AgentProperties);
+	if (!NavData)
+	{
+		ResolveTicket(Tickets.FindChecked(Handle.Id), EMyNavQueryStatus::Failed);
+		return Handle;
+	}
+
+	FRaycastJob& Job = QueuedRaycasts.AddDefaulted_GetRef();
+	Job.NavData = NavData;
+	Job.Filter = NavData->GetDefaultQueryFilter();
+	Job.Start = Start;
+	Job.End = End;
+	Job.Ticket = Handle.Id;
+
+	return Handle;
+}
+
+EMyNavQueryStatus UMyNavQuerySubsystem::GetPathResult(FMyNavQueryHandle Handle, FNavPathSharedPtr& OutPath)
+{
+	FTicket* Ticket = Tickets.Find(Handle.Id);
+	if (!Ticket || !Ticket->bPath) { return EMyNavQueryStatus::Invalid; }
+
+	const EMyNavQueryStatus Status = Ticket->Status;
+	if (Status == EMyNavQueryStatus::Pending) { return Status; }
+
+	if (Status == EMyNavQueryStatus::Succeeded && Ticket->Path.IsValid())
+	{
+		// Path following keeps state on the path, so every requester gets its own copy of the path found, of the
+		// same type so the navmesh polygons and nav link flags come along.
+		const FPathResult& Result = *Ticket->Path;
+		FNavPathSharedPtr Path;
+		if (const FNavMeshPath* NavMeshPath = Result.Path->CastPath<FNavMeshPath>())
+		{
+			Path = MakeShared<FNavMeshPath, ESPMode::ThreadSafe>(*NavMeshPath);
+		}
+		else
+		{
+			Path = MakeShared<FNavigationPath, ESPMode::ThreadSafe>(*Result.Path);
+		}
+		Path->SetIsPartial(Result.bPartial);
+
+		FPathFindingQueryData QueryData = Path->GetQueryData();
+		QueryData.Owner = Ticket->Querier;
+		Path->SetQueryData(QueryData);
+
+		// Like paths from ANavigationData::CreatePathInstance(), so navmesh changes invalidate and repath it.
+		if (ANavigationData* NavData = const_cast<ANavigationData*>(Path->GetNavigationDataUsed()))
+		{
+			NavData->RegisterActivePath(Path);
+		}
+		OutPath = Path;
+	}
+
+	Tickets.Remove(Handle.Id);
+	return Status;
+}
+
+EMyNavQueryStatus UMyNavQuerySubsystem::GetRaycastResult(FMyNavQueryHandle Handle, bool& bOutHit, FVector& OutHitLocation)
+{
+	FTicket* Ticket = Tickets.Find(Handle.Id);
+	if (!Ticket || Ticket->bPath) { return EMyNavQueryStatus::Invalid; }
+
+	const EMyNavQueryStatus Status = Ticket->Status;
+	if (Status == EMyNavQueryStatus::Pending) { return Status; }
+
+	bOutHit = Ticket->bHit;
+	OutHitLocation = Ticket->HitLocation;
+	Tickets.Remove(Handle.Id);
+	return Status;
+}
+
+void UMyNavQuerySubsystem::CancelQuery(FMyNavQueryHandle& InOutHandle)
+{
+	// Jobs keep the id; a ticket that no longer exists is skipped when the job finishes.
+	Tickets.Remove(InOutHandle.Id);
+	InOutHandle.Invalidate();
+}
+
+void UMyNavQuerySubsystem::Tick(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+
+	for (auto It = PathCache.CreateIterator(); It; ++It)
+	{
+		if (Now - It.Value().Time > GMyNavCacheSeconds)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (auto It = Tickets.CreateIterator(); It; ++It)
+	{
+		const FTicket& Ticket = It.Value();
+		if (Ticket.Status != EMyNavQueryStatus::Pending && Now - Ticket.ResolveTime > MyNavTicketLifetime)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	LaunchBatch();
+}
+
+TStatId UMyNavQuerySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMyNavQuerySubsystem, STATGROUP_Tickables);
+}
+
+const ANavigationData* UMyNavQuerySubsystem::FindNavData(const AActor* Querier, const FVector& Start, FNavAgentProperties& OutAgentProperties) const
+{
+	const UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (!NavSystem) { return nullptr; }
+
+	if (const APawn* Pawn = Cast<APawn>(Querier))
+	{
+		OutAgentProperties = Pawn->GetNavAgentPropertiesRef();
+		return NavSystem->GetNavDataForProps(OutAgentProperties, Start);
+	}
+
+	OutAgentProperties = FNavAgentProperties::DefaultProperties;
+	return NavSystem->GetDefaultNavDataInstance();
+}
+
+UMyNavQuerySubsystem::FPathKey UMyNavQuerySubsystem::MakePathKey(const ANavigationData* NavData, const FVector& Start, const FVector& End) const
+{
+	const double StartCellSize = FMath::Max(GMyNavStartCellSize, 1.0f);
+	const double GoalCellSize = FMath::Max(GMyNavGoalCellSize, 1.0f);
+
+	FPathKey Key;
+	Key.NavData = NavData;
+	Key.Start = FIntVector(FMath::FloorToInt32(Start.X / StartCellSize), FMath::FloorToInt32(Start.Y / StartCellSize), FMath::FloorToInt32(Start.Z / StartCellSize));
+	Key.End = FIntVector(FMath::FloorToInt32(End.X / GoalCellSize), FMath::FloorToInt32(End.Y / GoalCellSize), FMath::FloorToInt32(End.Z / GoalCellSize));
+	return Key;
+}
+
+uint32 UMyNavQuerySubsystem::AddTicket(bool bPath)
+{
+	const uint32 Id = NextTicketId++;
+	FTicket& Ticket = Tickets.Add(Id);
+	Ticket.bPath = bPath;
+	Ticket.RequestTime = FPlatformTime::Seconds();
+	Ticket.RequestFrame = GFrameCounter;
+	return Id;
+}
+
+void UMyNavQuerySubsystem::ResolveTicket(FTicket& Ticket, EMyNavQueryStatus Status)
+{
+	Ticket.Status = Status;
+	Ticket.ResolveTime = FPlatformTime::Seconds();
+
+	const double Latency = Ticket.ResolveTime - Ticket.RequestTime;
+	const uint64 LatencyFrames = GFrameCounter - Ticket.RequestFrame;
+	++NumResolved;
+	TotalLatency += Latency;
+	MaxLatency = FMath::Max(MaxLatency, Latency);
+	TotalLatencyFrames += LatencyFrames;
+	MaxLatencyFrames = FMath::Max(MaxLatencyFrames, LatencyFrames);
+}
+
+void UMyNavQuerySubsystem::LaunchBatch()
+{
+	// Normally collected in OnWorldTickStart() already.
+	CompleteBatch();
+
+	if (QueuedPaths.Num() == 0 && QueuedRaycasts.Num() == 0) { return; }
+
+	const int32 NumPaths = FMath::Min(QueuedPaths.Num(), FMath::Max(GMyNavMaxPathsPerFrame, 1));
+	const int32 NumRaycasts = FMath::Min(QueuedRaycasts.Num(), FMath::Max(GMyNavMaxRaycastsPerFrame, 1));
+
+	BatchPaths.Reset();
+	BatchPathIndices.Reset();
+	for (int32 Index = 0; Index < NumPaths; ++Index)
+	{
+		BatchPathIndices.Add(QueuedPaths[Index].Key, Index);
+		BatchPaths.Add(MoveTemp(QueuedPaths[Index]));
+	}
+	QueuedPaths.RemoveAt(0, NumPaths, EAllowShrinking::No);
+
+	QueuedPathIndices.Reset();
+	for (int32 Index = 0; Index < QueuedPaths.Num(); ++Index)
+	{
+		QueuedPathIndices.Add(QueuedPaths[Index].Key, Index);
+	}
+
+	BatchRaycasts.Reset();
+	BatchRaycasts.Append(QueuedRaycasts.GetData(), NumRaycasts);
+	QueuedRaycasts.RemoveAt(0, NumRaycasts, EAllowShrinking::No);
+
+	// Navigation data only changes while the navigation system ticks, which waits for this batch in OnWorldTickStart().
+	BatchTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this]()
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		ParallelFor(BatchPaths.Num(), [this](int32 Index)
+		{
+			FPathJob& Job = BatchPaths[Index];
+			const FPathFindingQuery Query(nullptr, *Job.NavData, Job.Start, Job.End, Job.Filter);
+			const FPathFindingResult Result = Job.NavData->FindPath(Job.AgentProperties, Query);
+
+			Job.bSuccess = Result.IsSuccessful() && Result.Path.IsValid();
+			if (Job.bSuccess)
+			{
+				Job.bPartial = Result.IsPartial();
+				Job.Path = Result.Path;
+			}
+		});
+
+		ParallelFor(BatchRaycasts.Num(), [this](int32 Index)
+		{
+			FRaycastJob& Job = BatchRaycasts[Index];
+			Job.bHit = Job.NavData->Raycast(Job.Start, Job.End, Job.HitLocation, Job.Filter, nullptr);
+		});
+
+		BatchSeconds = FPlatformTime::Seconds() - StartTime;
+	});
+}
+
+void UMyNavQuerySubsystem::CompleteBatch()
+{
+	if (BatchPaths.Num() == 0 && BatchRaycasts.Num() == 0) { return; }
+
+	const double WaitStart = FPlatformTime::Seconds();
+	BatchTask.Wait();
+	MaxWaitSeconds = FMath::Max(MaxWaitSeconds, FPlatformTime::Seconds() - WaitStart);
+
+	++NumBatches;
+	TotalBatchSeconds += BatchSeconds;
+	MaxBatchSeconds = FMath::Max(MaxBatchSeconds, BatchSeconds);
+	NumComputedPaths += BatchPaths.Num();
+	NumComputedRaycasts += BatchRaycasts.Num();
+
+	const double Now = FPlatformTime::Seconds();
+	for (FPathJob& Job : BatchPaths)
+	{
+		TSharedPtr<FPathResult> Result;
+		if (Job.bSuccess)
+		{
+			Result = MakeShared<FPathResult>();
+			Result->Path = MoveTemp(Job.Path);
+			Result->bPartial = Job.bPartial;
+
+			if (GMyNavCacheSeconds > 0.0f)
+			{
+				FCachedPath& Cached = PathCache.Add(Job.Key);
+				Cached.Path = Result;
+				Cached.Time = Now;
+			}
+		}
+
+		for (const uint32 Id : Job.Tickets)
+		{
+			if (FTicket* Ticket = Tickets.Find(Id))
+			{
+				Ticket->Path = Result;
+				ResolveTicket(*Ticket, Job.bSuccess ? EMyNavQueryStatus::Succeeded : EMyNavQueryStatus::Failed);
+			}
+		}
+	}
+
+	for (const FRaycastJob& Job : BatchRaycasts)
+	{
+		if (FTicket* Ticket = Tickets.Find(Job.Ticket))
+		{
+			Ticket->bHit = Job.bHit;
+			Ticket->HitLocation = Job.HitLocation;
+			ResolveTicket(*Ticket, EMyNavQueryStatus::Succeeded);
+		}
+	}
+
+	BatchPaths.Reset();
+	BatchPathIndices.Reset();
+	BatchRaycasts.Reset();
+}
+
+void UMyNavQuerySubsystem::OnWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld == GetWorld())
+	{
+		CompleteBatch();
+	}
+}
+
+void UMyNavQuerySubsystem::DumpStats(FOutputDevice& Ar)
+{
+	const double Resolved = static_cast<double>(FMath::Max<int64>(NumResolved, 1));
+	const double Batches = static_cast<double>(FMath::Max<int64>(NumBatches, 1));
+
+	Ar.Logf(TEXT("Nav: queued %d paths, %d raycasts; %d open requests"), QueuedPaths.Num(), QueuedRaycasts.Num(), Tickets.Num());
+	Ar.Logf(TEXT("Nav: %lld path requests (%lld shared, %lld computed), %lld raycasts (%lld computed)"),
+		NumPathRequests, NumSharedPaths, NumComputedPaths, NumRaycastRequests, NumComputedRaycasts);
+	Ar.Logf(TEXT("Nav: latency avg %.2f ms / %.2f frames, max %.2f ms / %llu frames"),
+		TotalLatency / Resolved * 1000.0, TotalLatencyFrames / Resolved, MaxLatency * 1000.0, MaxLatencyFrames);
+	Ar.Logf(TEXT("Nav: %lld batches, worker avg %.3f ms, max %.3f ms; max game thread wait %.3f ms"),
+		NumBatches, TotalBatchSeconds / Batches * 1000.0, MaxBatchSeconds * 1000.0, MaxWaitSeconds * 1000.0);
+
+	NumPathRequests = NumRaycastRequests = NumSharedPaths = NumComputedPaths = NumComputedRaycasts = NumResolved = NumBatches = 0;
+	TotalLatency = MaxLatency = TotalBatchSeconds = MaxBatchSeconds = MaxWaitSeconds = 0.0;
+	TotalLatencyFrames = MaxLatencyFrames = 0;
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyNavStats(
+	TEXT("Project.Nav.Stats"),
+	TEXT("Prints batched navigation query queues, sharing, batch cost and latency since the last call."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UMyNavQuerySubsystem* NavQueries = World ? World->GetSubsystem<UMyNavQuerySubsystem>() : nullptr)
+		{
+			NavQueries->DumpStats(Ar);
+		}
+	}));
@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyNetSerializers.h"
+
+#if UE_WITH_IRIS
+#include "Iris/Serialization/NetBitStreamReader.h"
+#include "Iris/Serialization/NetBitStreamWriter.h"
+#include "Iris/Serialization/NetSerializerDelegates.h"
+#include "Iris/ReplicationState/PropertyNetSerializerInfoRegistry.h"
+#endif
+
+/* Largest magnitude that still fits in 31 bits after zig-zag encoding. */
+static constexpr int32 MyQuantizedFloatLimit = (1 << 29) - 1;
+
+/* Bits used to send the length of the following value. */
+static constexpr uint32 MyQuantizedFloatLengthBits = 5;
+
+uint32 FMyQuantizedFloat::Quantize(float InValue)
+{
+	// Clamped as a float first; rounding NaN or a float beyond int32 to an int is undefined. The limit isn't exact
+	// as a float, so the result is clamped again.
+	const float Scaled = FMath::IsNaN(InValue) ? 0.0f : FMath::Clamp(InValue * Scale, -static_cast<float>(MyQuantizedFloatLimit), static_cast<float>(MyQuantizedFloatLimit));
+	const int32 Fixed = FMath::Clamp(FMath::RoundToInt(Scaled), -MyQuantizedFloatLimit, MyQuantizedFloatLimit);
+
+	// Zig-zag so small negative numbers stay small. Shifted as unsigned, shifting a negative int32 left is undefined.
+	return (static_cast<uint32>(Fixed) << 1) ^ static_cast<uint32>(Fixed >> 31);
+}
+
+float FMyQuantizedFloat::Dequantize(uint32 Quantized)
+{
+	const int32 Fixed = static_cast<int32>(Quantized >> 1) ^ -static_cast<int32>(Quantized & 1);
+	return static_cast<float>(Fixed) / Scale;
+}
+
+bool FMyQuantizedFloat::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint32 Quantized = Ar.IsSaving() ? Quantize(Value) : 0;
+
+	Ar.SerializeIntPacked(Quantized);
+
+	if (Ar.IsLoading())
+	{
+		Value = Dequantize(Quantized);
+	}
+
+	bOutSuccess = true;
+	return true;
+}
+
+#if UE_WITH_IRIS
+
+namespace UE::Net
+{
+
+/**
+ * Iris serializer for FMyQuantizedFloat.
+ * The quantized state is the zig-zag encoded fixed point value. On the wire it is sent
+ * as a 5 bit length followed by that many bits.
+ */
+struct FMyQuantizedFloatNetSerializer
+{
+	static constexpr uint32 Version = 0;
+
+	typedef FMyQuantizedFloat SourceType;
+	typedef uint32 QuantizedType;
+	typedef FMyQuantizedFloatNetSerializerConfig ConfigType;
+
+	static const ConfigType DefaultConfig;
+
+	static void Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args);
+	static void Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args);
+
+	static void Quantize(FNetSerializationContext& Context, const FNetQuantizeArgs& Args);
+	static void Dequantize(FNetSerializationContext& Context, const FNetDequantizeArgs& Args);
+
+	static bool IsEqual(FNetSerializationContext& Context, const FNetIsEqualArgs& Args);
+	static bool Validate(FNetSerializationContext& Context, const FNetValidateArgs& Args);
+
+private:
+	class FNetSerializerRegistryDelegates final : private UE::Net::FNetSerializerRegistryDelegates
+	{
+	public:
+		virtual ~FNetSerializerRegistryDelegates();
+
+	private:
+		virtual void OnPreFreezeNetSerializerRegistry() override;
+	};
+
+	static FMyQuantizedFloatNetSerializer::FNetSerializerRegistryDelegates NetSerializerRegistryDelegates;
+};
+
+UE_NET_IMPLEMENT_SERIALIZER(FMyQuantizedFloatNetSerializer);
+
+const FMyQuantizedFloatNetSerializer::ConfigType FMyQuantizedFloatNetSerializer::DefaultConfig;
+FMyQuantizedFloatNetSerializer::FNetSerializerRegistryDelegates FMyQuantizedFloatNetSerializer::NetSerializerRegistryDelegates;
+
+static const FName PropertyNetSerializerRegistry_NAME_MyQuantizedFloat("MyQuantizedFloat");
+UE_NET_IMPLEMENT_NAMED_STRUCT_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_MyQuantizedFloat, FMyQuantizedFloatNetSerializer);
+
+void FMyQuantizedFloatNetSerializer::Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args)
+{
+	const QuantizedType Value = *reinterpret_cast<const QuantizedType*>(Args.Source);
+	const uint32 NumBits = Value ? (32U - FMath::CountLeadingZeros(Value)) : 0U;
+
+	FNetBitStreamWriter* Writer = Context.GetBitStreamWriter();
+	Writer->WriteBits(NumBits, MyQuantizedFloatLengthBits);
+	if (NumBits > 0)
+	{
+		Writer->WriteBits(Value, NumBits);
+	}
+}
+
+void FMyQuantizedFloatNetSerializer::Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args)
+{
+	FNetBitStreamReader* Reader = Context.GetBitStreamReader();
+
+	const uint32 NumBits = Reader->ReadBits(MyQuantizedFloatLengthBits);
+	QuantizedType& Target = *reinterpret_cast<QuantizedType*>(Args.Target);
+	Target = NumBits > 0 ? Reader->ReadBits(NumBits) : 0U;
+}
+
+void FMyQuantizedFloatNetSerializer::Quantize(FNetSerializationContext& Context, const FNetQuantizeArgs& Args)
+{
+	const SourceType& Source = *reinterpret_cast<const SourceType*>(Args.Source);
+	QuantizedType& Target = *reinterpret_cast<QuantizedType*>(Args.Target);
+	Target = FMyQuantizedFloat::Quantize(Source.Value);
+}
+
+void FMyQuantizedFloatNetSerializer::Dequantize(FNetSerializationContext& Context, const FNetDequantizeArgs& Args)
+{
+	const QuantizedType& Source = *reinterpret_cast<const QuantizedType*>(Args.Source);
+	SourceType& Target = *reinterpret_cast<SourceType*>(Args.Target);
+	Target.Value = FMyQuantizedFloat::Dequantize(Source);
+}
+
+bool FMyQuantizedFloatNetSerializer::IsEqual(FNetSerializationContext& Context, const FNetIsEqualArgs& Args)
+{
+	if (Args.bStateIsQuantized)
+	{
+		return *reinterpret_cast<const QuantizedType*>(Args.Source0) == *reinterpret_cast<const QuantizedType*>(Args.Source1);
+	}
+
+	// Compare what would be sent, so changes below the wire resolution do not dirty the state.
+	const SourceType& Value0 = *reinterpret_cast<const SourceType*>(Args.Source0);
+	const SourceType& Value1 = *reinterpret_cast<const SourceType*>(Args.Source1);
+	return FMyQuantizedFloat::Quantize(Value0.Value) == FMyQuantizedFloat::Quantize(Value1.Value);
+}
+
+bool FMyQuantizedFloatNetSerializer::Validate(FNetSerializationContext& Context, const FNetValidateArgs& Args)
+{
+	const SourceType& Source = *reinterpret_cast<const SourceType*>(Args.Source);
+	return FMath::IsFinite(Source.Value);
+}
+
+FMyQuantizedFloatNetSerializer::FNetSerializerRegistryDelegates::~FNetSerializerRegistryDelegates()
+{
+	UE_NET_UNREGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_MyQuantizedFloat);
+}
+
+void FMyQuantizedFloatNetSerializer::FNetSerializerRegistryDelegates::OnPreFreezeNetSerializerRegistry()
+{
+	UE_NET_REGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_MyQuantizedFloat);
+}
+
+}
+
+#endif // UE_WITH_IRIS
@@ -0,0 +1,694 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyNetStatsSubsystem.h"
+#include "Project.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "Engine/ActorChannel.h"
+#include "Components/ActorComponent.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "Serialization/BitWriter.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "HAL/IConsoleManager.h"
+
+static int32 GMyNetStatsEnabled = 0;
+static FAutoConsoleVariableRef CVarMyNetStatsEnabled(
+	TEXT("Project.Net.Stats.Enable"),
+	GMyNetStatsEnabled,
+	TEXT("Enables per-property and per-RPC network cost accounting (0 = off, 1 = on)."));
+
+static float GMyNetStatsBudgetBytesPerSecond = 8192.0f;
+static FAutoConsoleVariableRef CVarMyNetStatsBudget(
+	TEXT("Project.Net.Stats.BudgetBytesPerSecond"),
+	GMyNetStatsBudgetBytesPerSecond,
+	TEXT("Per-connection server to client payload budget in bytes per second used by Project.Net.Stats.CheckBudget."));
+
+static float GMyNetStatsUpBudgetBytesPerSecond = 8192.0f;
+static FAutoConsoleVariableRef CVarMyNetStatsUpBudget(
+	TEXT("Project.Net.Stats.UpBudgetBytesPerSecond"),
+	GMyNetStatsUpBudgetBytesPerSecond,
+	TEXT("Per-connection client to server budget in bytes per second used by Project.Net.Stats.CheckBudget. ")
+	TEXT("Checked against the bytes the server received on the connection, packet headers and acks included."));
+
+/* Size used for object references; NetGUIDs are packed ints and usually fit in this. */
+static constexpr int64 MyNetStatsObjectReferenceBits = 32;
+
+namespace MyNetStats
+{
+	static const TCHAR* KindToString(EMyNetStatKind Kind)
+	{
+		switch (Kind)
+		{
+		case EMyNetStatKind::Property: return TEXT("Property");
+		case EMyNetStatKind::RPC:      return TEXT("RPC");
+		case EMyNetStatKind::Move:     return TEXT("Move");
+		}
+		return TEXT("Unknown");
+	}
+
+	/* Whether a row is client to server traffic: moves are sampled when the server receives them, RPCs on a client when it sends them to the server. */
+	static bool IsUpstream(EMyNetStatKind Kind, bool bIsClient)
+	{
+		return Kind == EMyNetStatKind::Move || bIsClient;
+	}
+
+	/* Returns the actor that owns the channel Object replicates through. */
+	static const AActor* GetReplicatingActor(const UObject* Object)
+	{
+		if (const AActor* Actor = Cast<AActor>(Object))
+		{
+			return Actor;
+		}
+
+		if (const UActorComponent* Component = Cast<UActorComponent>(Object))
+		{
+			return Component->GetOwner();
+		}
+
+		return nullptr;
+	}
+}
+
+UMyNetStatsSubsystem::FShadowState::~FShadowState()
+{
+	for (const FProperty* Property : Properties)
+	{
+		Property->DestroyValue_InContainer(Buffer.GetData());
+	}
+}
+
+void UMyNetStatsSubsystem::Deinitialize()
+{
+	Reset();
+
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	if (UWorld* World = GetWorld())
+	{
+		World->OnPostTickFlush().Remove(PostTickFlushHandle);
+	}
+
+	Super::Deinitialize();
+}
+
+void UMyNetStatsSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UMyNetStatsSubsystem::OnWorldPostActorTick);
+	PostTickFlushHandle = InWorld.OnPostTickFlush().AddUObject(this, &UMyNetStatsSubsystem::OnPostTickFlush);
+
+	float BudgetSeconds = 0.0f;
+	if (InWorld.GetNetMode() != NM_Client && FParse::Value(FCommandLine::Get(), TEXT("MyNetBudgetCheck="), BudgetSeconds))
+	{
+		CVarMyNetStatsEnabled->Set(1, ECVF_SetByCommandline);
+		BudgetCheckTime = FPlatformTime::Seconds() + FMath::Max(BudgetSeconds, 2.0f);
+		UE_LOG(LogProject, Log, TEXT("NetStats: checking the budget in %.0f seconds, then exiting"), FMath::Max(BudgetSeconds, 2.0f));
+	}
+}
+
+void UMyNetStatsSubsystem::Tick(float DeltaTime)
+{
+	if (GMyNetStatsEnabled == 0) { return; }
+
+	const double Now = FPlatformTime::Seconds();
+
+	if (WindowStartTime <= 0.0)
+	{
+		WindowStartTime = Now;
+		return;
+	}
+
+	if (Now - WindowStartTime >= 1.0)
+	{
+		RollWindow();
+	}
+
+	if (BudgetCheckTime > 0.0 && Now >= BudgetCheckTime)
+	{
+		// Automated runs look at the exit code, not at the log.
+		BudgetCheckTime = 0.0;
+		const bool bWithinBudget = CheckBudget(*GLog);
+		FPlatformMisc::RequestExitWithStatus(false, bWithinBudget ? 0 : 1);
+	}
+}
+
+TStatId UMyNetStatsSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMyNetStatsSubsystem, STATGROUP_Tickables);
+}
+
+UMyNetStatsSubsystem* UMyNetStatsSubsystem::GetIfEnabled(const UObject* WorldContextObject)
+{
+	if (GMyNetStatsEnabled == 0 || !WorldContextObject) { return nullptr; }
+
+	const UWorld* World = WorldContextObject->GetWorld();
+	return World ? World->GetSubsystem<UMyNetStatsSubsystem>() : nullptr;
+}
+
+void UMyNetStatsSubsystem::RecordReplicatedProperties(const UObject* Object)
+{
+	UMyNetStatsSubsystem* Stats = GetIfEnabled(Object);
+	if (!Stats) { return; }
+
+	TArray<UNetConnection*, TInlineAllocator<16>> Connections;
+	Stats->GatherConnections(MyNetStats::GetReplicatingActor(Object), Connections);
+	if (Connections.Num() == 0) { return; }
+
+	const UClass* Class = Object->GetClass();
+
+	TUniquePtr<FShadowState>& Shadow = Stats->Shadows.FindOrAdd(Object);
+	const bool bFirstSample = !Shadow.IsValid();
+
+	if (bFirstSample)
+	{
+		// Build a shadow buffer that only holds the replicated properties of the class.
+		Shadow = MakeUnique<FShadowState>();
+		Shadow->Class = Class;
+		Shadow->Buffer.SetNumZeroed(Class->GetPropertiesSize());
+
+		for (TFieldIterator<FProperty> It(Class); It; ++It)
+		{
+			if (It->HasAnyPropertyFlags(CPF_Net))
+			{
+				It->InitializeValue_InContainer(Shadow->Buffer.GetData());
+				Shadow->Properties.Add(*It);
+			}
+		}
+	}
+
+	for (const FProperty* Property : Shadow->Properties)
+	{
+		for (int32 Index = 0; Index < Property->ArrayDim; ++Index)
+		{
+			const void* Current = Property->ContainerPtrToValuePtr<void>(Object, Index);
+			void* Previous = Property->ContainerPtrToValuePtr<void>(Shadow->Buffer.GetData(), Index);
+
+			// The first sample is the initial bunch; count it so join bursts show up in the totals.
+			if (!bFirstSample && Property->Identical(Current, Previous))
+			{
+				continue;
+			}
+
+			Property->CopySingleValue(Previous, Current);
+
+			FMyNetStatKey Key;
+			Key.ClassName = Class->GetFName();
+			Key.EntryName = Property->GetFName();
+			Key.Kind = EMyNetStatKind::Property;
+
+			const int64 Bits = EstimatePropertyBits(Property, Current);
+			for (UNetConnection* Connection : Connections)
+			{
+				Key.Connection = Connection;
+				Stats->Record(Key, Bits);
+			}
+		}
+	}
+}
+
+void UMyNetStatsSubsystem::RecordRemoteFunction(const UObject* Object, const UFunction* Function, const void* Parameters)
+{
+	UMyNetStatsSubsystem* Stats = GetIfEnabled(Object);
+	if (!Stats || !Function) { return; }
+
+	int64 Bits = 0;
+	if (Parameters)
+	{
+		for (TFieldIterator<FProperty> It(Function); It && (It->PropertyFlags & (CPF_Parm | CPF_ReturnParm)) == CPF_Parm; ++It)
+		{
+			Bits += EstimatePropertyBits(*It, It->ContainerPtrToValuePtr<void>(Parameters));
+		}
+	}
+
+	FMyNetStatKey Key;
+	Key.ClassName = Object->GetClass()->GetFName();
+	Key.EntryName = Function->GetFName();
+	Key.Kind = EMyNetStatKind::RPC;
+
+	if (Function->HasAnyFunctionFlags(FUNC_NetMulticast))
+	{
+		TArray<UNetConnection*, TInlineAllocator<16>> Connections;
+		Stats->GatherConnections(MyNetStats::GetReplicatingActor(Object), Connections);
+
+		for (UNetConnection* Connection : Connections)
+		{
+			Key.Connection = Connection;
+			Stats->Record(Key, Bits);
+		}
+		return;
+	}
+
+	// Server and client RPCs travel on the owning connection.
+	if (const AActor* Actor = MyNetStats::GetReplicatingActor(Object))
+	{
+		Key.Connection = Actor->GetNetConnection();
+		Stats->Record(Key, Bits);
+	}
+}
+
+void UMyNetStatsSubsystem::RecordServerMove(const UCharacterMovementComponent* MovementComponent, FName EntryName, int64 PayloadBits)
+{
+	UMyNetStatsSubsystem* Stats = GetIfEnabled(MovementComponent);
+	if (!Stats) { return; }
+
+	const AActor* Owner = MovementComponent->GetOwner();
+	if (!Owner) { return; }
+
+	FMyNetStatKey Key;
+	Key.ClassName = MovementComponent->GetClass()->GetFName();
+	Key.EntryName = EntryName;
+	Key.Kind = EMyNetStatKind::Move;
+	Key.Connection = Owner->GetNetConnection();
+
+	Stats->Record(Key, PayloadBits);
+}
+
+void UMyNetStatsSubsystem::Record(const FMyNetStatKey& Key, int64 PayloadBits)
+{
+	FMyNetStatEntry& Entry = Entries.FindOrAdd(Key);
+	Entry.TotalBits += PayloadBits;
+	Entry.TotalCount++;
+	Entry.WindowBits += PayloadBits;
+	Entry.WindowCount++;
+
+	if (!ConnectionNames.Contains(Key.Connection))
+	{
+		const UNetConnection* Connection = Key.Connection.ResolveObjectPtr();
+		ConnectionNames.Add(Key.Connection, Connection ? Connection->LowLevelGetRemoteAddress(true) : FString(TEXT("None")));
+	}
+}
+
+void UMyNetStatsSubsystem::Reset()
+{
+	Entries.Reset();
+	Shadows.Reset();
+	ConnectionNames.Reset();
+	ReceivedBytesPerSecond.Reset();
+	WindowStartTime = 0.0;
+}
+
+void UMyNetStatsSubsystem::GatherConnections(const AActor* Actor, TArray<UNetConnection*, TInlineAllocator<16>>& OutConnections) const
+{
+	const UWorld* World = GetWorld();
+	const UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+	if (!NetDriver || !Actor) { return; }
+
+	// Iris has no actor channels and filters inside the replication system, so count every connection.
+	const bool bUsingIris = NetDriver->IsUsingIrisReplication();
+
+	for (UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		if (Connection && (bUsingIris || Connection->FindActorChannelRef(Actor)))
+		{
+			OutConnections.Add(Connection);
+		}
+	}
+}
+
+void UMyNetStatsSubsystem::RollWindow()
+{
+	const double Now = FPlatformTime::Seconds();
+	const double Elapsed = FMath::Max(Now - WindowStartTime, UE_SMALL_NUMBER);
+	WindowStartTime = Now;
+
+	for (TPair<FMyNetStatKey, FMyNetStatEntry>& Pair : Entries)
+	{
+		FMyNetStatEntry& Entry = Pair.Value;
+		Entry.BytesPerSecond = static_cast<float>((Entry.WindowBits / 8.0) / Elapsed);
+		Entry.CountPerSecond = static_cast<float>(Entry.WindowCount / Elapsed);
+		Entry.WindowBits = 0;
+		Entry.WindowCount = 0;
+	}
+
+	// Client RPCs arrive without a hook, so take what the server received on each connection as a whole.
+	ReceivedBytesPerSecond.Reset();
+	const UWorld* World = GetWorld();
+	if (const UNetDriver* NetDriver = World && World->GetNetMode() != NM_Client ? World->GetNetDriver() : nullptr)
+	{
+		for (const UNetConnection* Connection : NetDriver->ClientConnections)
+		{
+			if (!Connection) { continue; }
+
+			ReceivedBytesPerSecond.Add(Connection, static_cast<float>(Connection->InBytesPerSecond));
+			if (!ConnectionNames.Contains(Connection))
+			{
+				ConnectionNames.Add(Connection, Connection->LowLevelGetRemoteAddress(true));
+			}
+		}
+	}
+
+	// Drop shadows of objects that no longer exist.
+	for (auto It = Shadows.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+FString UMyNetStatsSubsystem::GetConnectionName(const TObjectKey<UNetConnection>& Connection) const
+{
+	const FString* Name = ConnectionNames.Find(Connection);
+	return Name ? *Name : FString(TEXT("None"));
+}
+
+void UMyNetStatsSubsystem::Dump(FOutputDevice& Ar) const
+{
+	TArray<TPair<FMyNetStatKey, FMyNetStatEntry>> Sorted = Entries.Array();
+	Sorted.Sort([](const TPair<FMyNetStatKey, FMyNetStatEntry>& A, const TPair<FMyNetStatKey, FMyNetStatEntry>& B)
+	{
+		return A.Value.BytesPerSecond > B.Value.BytesPerSecond;
+	});
+
+	const bool bIsClient = GetWorld()->GetNetMode() == NM_Client;
+
+	Ar.Logf(TEXT("%-10s %-4s %-32s %-40s %-24s %10s %10s %12s %10s"), TEXT("Kind"), TEXT("Dir"), TEXT("Class"), TEXT("Name"), TEXT("Connection"), TEXT("Bytes/s"), TEXT("Count/s"), TEXT("TotalBytes"), TEXT("Total"));
+
+	for (const TPair<FMyNetStatKey, FMyNetStatEntry>& Pair : Sorted)
+	{
+		Ar.Logf(TEXT("%-10s %-4s %-32s %-40s %-24s %10.1f %10.1f %12lld %10lld"),
+			MyNetStats::KindToString(Pair.Key.Kind),
+			MyNetStats::IsUpstream(Pair.Key.Kind, bIsClient) ? TEXT("Up") : TEXT("Down"),
+			*Pair.Key.ClassName.ToString(),
+			*Pair.Key.EntryName.ToString(),
+			*GetConnectionName(Pair.Key.Connection),
+			Pair.Value.BytesPerSecond,
+			Pair.Value.CountPerSecond,
+			Pair.Value.TotalBits / 8,
+			Pair.Value.TotalCount);
+	}
+
+	// Only moves are itemized in the client to server direction; the rest is in the connection totals.
+	for (const TPair<TObjectKey<UNetConnection>, float>& Pair : ReceivedBytesPerSecond)
+	{
+		Ar.Logf(TEXT("%-10s %-4s %-32s %-40s %-24s %10.1f"), TEXT("Received"), TEXT("Up"), TEXT("NetConnection"), TEXT("(all packets)"), *GetConnectionName(Pair.Key), Pair.Value);
+	}
+	Ar.Logf(TEXT("Up rows: moves are payload only, client RPCs other than moves are not itemized; Received rows are everything the server received, headers and acks included."));
+}
+
+FString UMyNetStatsSubsystem::WriteCsv(const FString& Prefix) const
+{
+	const bool bIsClient = GetWorld()->GetNetMode() == NM_Client;
+
+	// Received rows are whole packets per connection; client RPCs other than moves are only in them.
+	FString Csv = TEXT("Kind,Direction,Class,Name,Connection,BytesPerSecond,CountPerSecond,TotalBytes,TotalCount\n");
+
+	for (const TPair<FMyNetStatKey, FMyNetStatEntry>& Pair : Entries)
+	{
+		Csv += FString::Printf(TEXT("%s,%s,%s,%s,%s,%.2f,%.2f,%lld,%lld\n"),
+			MyNetStats::KindToString(Pair.Key.Kind),
+			MyNetStats::IsUpstream(Pair.Key.Kind, bIsClient) ? TEXT("Up") : TEXT("Down"),
+			*Pair.Key.ClassName.ToString(),
+			*Pair.Key.EntryName.ToString(),
+			*GetConnectionName(Pair.Key.Connection),
+			Pair.Value.BytesPerSecond,
+			Pair.Value.CountPerSecond,
+			Pair.Value.TotalBits / 8,
+			Pair.Value.TotalCount);
+	}
+
+	for (const TPair<TObjectKey<UNetConnection>, float>& Pair : ReceivedBytesPerSecond)
+	{
+		Csv += FString::Printf(TEXT("Received,Up,NetConnection,AllPackets,%s,%.2f,,,\n"), *GetConnectionName(Pair.Key), Pair.Value);
+	}
+
+	const FString FilePath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("NetStats"), FString::Printf(TEXT("%s-%s.csv"), *Prefix, *FDateTime::Now().ToString()));
+	FFileHelper::SaveStringToFile(Csv, *FilePath);
+	return FilePath;
+}
+
+bool UMyNetStatsSubsystem::CheckBudget(FOutputDevice& Ar) const
+{
+	const bool bIsClient = GetWorld()->GetNetMode() == NM_Client;
+
+	// Moves are client to server traffic and are part of the received bytes checked below.
+	TMap<TObjectKey<UNetConnection>, float> BytesPerConnection;
+	for (const TPair<FMyNetStatKey, FMyNetStatEntry>& Pair : Entries)
+	{
+		if (!MyNetStats::IsUpstream(Pair.Key.Kind, bIsClient))
+		{
+			BytesPerConnection.FindOrAdd(Pair.Key.Connection) += Pair.Value.BytesPerSecond;
+		}
+	}
+
+	bool bWithinBudget = true;
+	for (const TPair<TObjectKey<UNetConnection>, float>& Pair : BytesPerConnection)
+	{
+		if (Pair.Value > GMyNetStatsBudgetBytesPerSecond)
+		{
+			bWithinBudget = false;
+			Ar.Logf(ELogVerbosity::Error, TEXT("NetStats: connection %s is sent %.1f bytes/s, budget is %.1f bytes/s"), *GetConnectionName(Pair.Key), Pair.Value, GMyNetStatsBudgetBytesPerSecond);
+		}
+	}
+
+	for (const TPair<TObjectKey<UNetConnection>, float>& Pair : ReceivedBytesPerSecond)
+	{
+		if (Pair.Value > GMyNetStatsUpBudgetBytesPerSecond)
+		{
+			bWithinBudget = false;
+			Ar.Logf(ELogVerbosity::Error, TEXT("NetStats: connection %s sends %.1f bytes/s, budget is %.1f bytes/s"), *GetConnectionName(Pair.Key), Pair.Value, GMyNetStatsUpBudgetBytesPerSecond);
+		}
+	}
+
+	// Nothing measured is not a pass: collection was off or no client was connected.
+	if (BytesPerConnection.Num() == 0 && ReceivedBytesPerSecond.Num() == 0)
+	{
+		bWithinBudget = false;
+		Ar.Logf(ELogVerbosity::Error, TEXT("NetStats: no connection was measured, enable Project.Net.Stats.Enable and connect clients"));
+	}
+
+	Ar.Logf(TEXT("NetStats: %d connection(s) checked, budget %s"), FMath::Max(BytesPerConnection.Num(), ReceivedBytesPerSecond.Num()), bWithinBudget ? TEXT("PASSED") : TEXT("FAILED"));
+	return bWithinBudget;
+}
+
+float UMyNetStatsSubsystem::GetConnectionBytesPerSecond(const UNetConnection* Connection) const
+{
+	const TObjectKey<UNetConnection> ConnectionKey(Connection);
+	const bool bIsClient = GetWorld()->GetNetMode() == NM_Client;
+
+	float Total = 0.0f;
+	for (const TPair<FMyNetStatKey, FMyNetStatEntry>& Pair : Entries)
+	{
+		if (Pair.Key.Connection == ConnectionKey && !MyNetStats::IsUpstream(Pair.Key.Kind, bIsClient))
+		{
+			Total += Pair.Value.BytesPerSecond;
+		}
+	}
+	return Total;
+}
+
+void UMyNetStatsSubsystem::StartBenchmark(const FString& Label, float Duration)
+{
+	const UWorld* World = GetWorld();
+	const UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+
+	Bench = FBenchState();
+	Bench.Label = Label;
+	Bench.StartTime = FPlatformTime::Seconds();
+	Bench.Duration = Duration;
+
+	if (NetDriver)
+	{
+		Bench.StartOutBytes = NetDriver->OutTotalBytes;
+		Bench.StartOutPackets = NetDriver->OutTotalPackets;
+	}
+
+	UE_LOG(LogProject, Display, TEXT("NetBench: started '%s' (%s)"), *Label, (NetDriver && NetDriver->IsUsingIrisReplication()) ? TEXT("Iris") : TEXT("Legacy"));
+}
+
+void UMyNetStatsSubsystem::ReportBenchmark(FOutputDevice& Ar)
+{
+	if (!IsBenchmarkRunning())
+	{
+		Ar.Logf(TEXT("NetBench: no benchmark running, use Project.Net.Bench.Run first"));
+		return;
+	}
+
+	const UWorld* World = GetWorld();
+	const UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+
+	const double Elapsed = FMath::Max(FPlatformTime::Seconds() - Bench.StartTime, UE_SMALL_NUMBER);
+	const TCHAR* Mode = (NetDriver && NetDriver->IsUsingIrisReplication()) ? TEXT("Iris") : TEXT("Legacy");
+	const uint64 OutBytes = NetDriver ? NetDriver->OutTotalBytes - Bench.StartOutBytes : 0;
+	const uint64 OutPackets = NetDriver ? NetDriver->OutTotalPackets - Bench.StartOutPackets : 0;
+	const int32 Connections = FMath::Max(Bench.MaxConnections, 1);
+
+	const double AvgFlushMs = Bench.Frames > 0 ? (Bench.TotalFlushSeconds / Bench.Frames) * 1000.0 : 0.0;
+	const double MaxFlushMs = Bench.MaxFlushSeconds * 1000.0;
+	const double BytesPerSecond = OutBytes / Elapsed;
+	const double BytesPerConnection = BytesPerSecond / Connections;
+
+	Ar.Logf(TEXT("NetBench '%s' [%s]: %.1fs, %lld frames, %d connection(s)"), *Bench.Label, Mode, Elapsed, Bench.Frames, Bench.MaxConnections);
+	Ar.Logf(TEXT("  net flush  avg %.3f ms  max %.3f ms"), AvgFlushMs, MaxFlushMs);
+	Ar.Logf(TEXT("  outgoing   %.1f bytes/s total  %.1f bytes/s per connection  %.1f packets/s"), BytesPerSecond, BytesPerConnection, OutPackets / Elapsed);
+
+	// Append so runs with different replication systems end up side by side in one file.
+	const FString FilePath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("NetStats"), TEXT("ReplicationBench.csv"));
+	FString Csv;
+	if (!IFileManager::Get().FileExists(*FilePath))
+	{
+		Csv = TEXT("Label,Mode,Seconds,Frames,Connections,AvgFlushMs,MaxFlushMs,BytesPerSecond,BytesPerSecondPerConnection,PacketsPerSecond\n");
+	}
+	Csv += FString::Printf(TEXT("%s,%s,%.2f,%lld,%d,%.4f,%.4f,%.1f,%.1f,%.1f\n"),
+		*Bench.Label, Mode, Elapsed, Bench.Frames, Bench.MaxConnections, AvgFlushMs, MaxFlushMs, BytesPerSecond, BytesPerConnection, OutPackets / Elapsed);
+	FFileHelper::SaveStringToFile(Csv, *FilePath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	Ar.Logf(TEXT("NetBench written to %s"), *FilePath);
+
+	Bench = FBenchState();
+}
+
+void UMyNetStatsSubsystem::OnWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld == GetWorld() && IsBenchmarkRunning())
+	{
+		Bench.FlushStartTime = FPlatformTime::Seconds();
+	}
+}
+
+void UMyNetStatsSubsystem::OnPostTickFlush()
+{
+	if (!IsBenchmarkRunning() || Bench.FlushStartTime <= 0.0) { return; }
+
+	const double Now = FPlatformTime::Seconds();
+	const double FlushSeconds = Now - Bench.FlushStartTime;
+	Bench.FlushStartTime = 0.0;
+
+	Bench.TotalFlushSeconds += FlushSeconds;
+	Bench.MaxFlushSeconds = FMath::Max(Bench.MaxFlushSeconds, FlushSeconds);
+	++Bench.Frames;
+
+	if (const UNetDriver* NetDriver = GetWorld()->GetNetDriver())
+	{
+		Bench.MaxConnections = FMath::Max(Bench.MaxConnections, NetDriver->ClientConnections.Num());
+	}
+
+	if (Bench.Duration > 0.0 && Now - Bench.StartTime >= Bench.Duration)
+	{
+		ReportBenchmark(*GLog);
+	}
+}
+
+int64 UMyNetStatsSubsystem::EstimatePropertyBits(const FProperty* Property, const void* ValuePtr)
+{
+	if (Property->IsA<FBoolProperty>())
+	{
+		return 1;
+	}
+
+	// Serializing object references needs a package map and may export NetGUIDs, so estimate them instead.
+	if (Property->IsA<FObjectPropertyBase>() || Property->IsA<FInterfaceProperty>())
+	{
+		return MyNetStatsObjectReferenceBits;
+	}
+
+	if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+	{
+		if (!(StructProperty->Struct->StructFlags & STRUCT_NetSerializeNative))
+		{
+			int64 Bits = 0;
+			for (TFieldIterator<FProperty> It(StructProperty->Struct); It; ++It)
+			{
+				if (!It->HasAnyPropertyFlags(CPF_RepSkip))
+				{
+					Bits += EstimatePropertyBits(*It, It->ContainerPtrToValuePtr<void>(ValuePtr));
+				}
+			}
+			return Bits;
+		}
+	}
+
+	if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+	{
+		FScriptArrayHelper Helper(ArrayProperty, ValuePtr);
+
+		// Dynamic arrays send their element count first.
+		int64 Bits = 16;
+		for (int32 Index = 0; Index < Helper.Num(); ++Index)
+		{
+			Bits += EstimatePropertyBits(ArrayProperty->Inner, Helper.GetRawPtr(Index));
+		}
+		return Bits;
+	}
+
+	FNetBitWriter Writer(nullptr, 256);
+	Property->NetSerializeItem(Writer, nullptr, const_cast<void*>(ValuePtr));
+	return Writer.GetNumBits();
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyNetStatsDump(
+	TEXT("Project.Net.Stats.Dump"),
+	TEXT("Prints network cost per class, property, RPC and connection."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UMyNetStatsSubsystem* Stats = World ? World->GetSubsystem<UMyNetStatsSubsystem>() : nullptr)
+		{
+			Stats->Dump(Ar);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyNetStatsCsv(
+	TEXT("Project.Net.Stats.Csv"),
+	TEXT("Writes the network cost table to Saved/Profiling/NetStats. Optional argument: file prefix."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UMyNetStatsSubsystem* Stats = World ? World->GetSubsystem<UMyNetStatsSubsystem>() : nullptr)
+		{
+			const FString FilePath = Stats->WriteCsv(Args.Num() > 0 ? Args[0] : FString(TEXT("NetStats")));
+			Ar.Logf(TEXT("NetStats written to %s"), *FilePath);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyNetStatsReset(
+	TEXT("Project.Net.Stats.Reset"),
+	TEXT("Clears all network cost accounting."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UMyNetStatsSubsystem* Stats = World ? World->GetSubsystem<UMyNetStatsSubsystem>() : nullptr)
+		{
+			Stats->Reset();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyNetStatsCheckBudget(
+	TEXT("Project.Net.Stats.CheckBudget"),
+	TEXT("Checks every connection against Project.Net.Stats.BudgetBytesPerSecond (server to client) and Project.Net.Stats.UpBudgetBytesPerSecond (client to server) and logs an error for each one over budget."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UMyNetStatsSubsystem* Stats = World ? World->GetSubsystem<UMyNetStatsSubsystem>() : nullptr)
+		{
+			Stats->CheckBudget(Ar);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyNetBenchRun(
+	TEXT("Project.Net.Bench.Run"),
+	TEXT("Starts the replication benchmark. Arguments: <Label> [Seconds]. With Seconds the results are reported automatically."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UMyNetStatsSubsystem* Stats = World ? World->GetSubsystem<UMyNetStatsSubsystem>() : nullptr)
+		{
+			const FString Label = Args.Num() > 0 ? Args[0] : FString(TEXT("Bench"));
+			const float Duration = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 0.0f;
+			Stats->StartBenchmark(Label, Duration);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyNetBenchReport(
+	TEXT("Project.Net.Bench.Report"),
+	TEXT("Reports and stops the running replication benchmark."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UMyNetStatsSubsystem* Stats = World ? World->GetSubsystem<UMyNetStatsSubsystem>() : nullptr)
+		{
+			Stats->ReportBenchmark(Ar);
+		}
+	}));
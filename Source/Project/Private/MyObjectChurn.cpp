@@ -0,0 +1,230 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyObjectChurn.h"
+#include "Project.h"
+#include "MyBaseCharacter.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectIterator.h"
+
+static TUniquePtr<FMyObjectChurn> GMyObjectChurn;
+
+void FMyObjectChurn::Start()
+{
+	check(IsInGameThread());
+	Stop();
+
+	GMyObjectChurn = MakeUnique<FMyObjectChurn>();
+	FMyObjectChurn& Churn = *GMyObjectChurn;
+
+	// Listen first, so objects created by the loading thread while the table is filled are not missed.
+	// Not under our lock: the array calls the listeners holding its own.
+	GUObjectArray.AddUObjectCreateListener(&Churn);
+	GUObjectArray.AddUObjectDeleteListener(&Churn);
+	{
+		FScopeLock ScopeLock(&Churn.Lock);
+		Churn.ClassByIndex.SetNum(FMath::Max(Churn.ClassByIndex.Num(), GUObjectArray.GetObjectArrayNum()));
+		for (int32 Index = 0; Index < GUObjectArray.GetObjectArrayNum(); ++Index)
+		{
+			const FUObjectItem* Item = GUObjectArray.IndexToObject(Index);
+			const UObjectBase* Object = Item ? Item->GetObject() : nullptr;
+			if (Object && Churn.ClassByIndex[Index].IsNone())
+			{
+				Churn.ClassByIndex[Index] = Object->GetClass()->GetFName();
+			}
+		}
+	}
+
+	Churn.StartTime = Churn.FrameStartTime = FPlatformTime::Seconds();
+	Churn.BeginFrameHandle = FCoreDelegates::OnBeginFrame.AddRaw(&Churn, &FMyObjectChurn::OnBeginFrame);
+	Churn.PreGarbageCollectHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddRaw(&Churn, &FMyObjectChurn::OnPreGarbageCollect);
+	Churn.PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddRaw(&Churn, &FMyObjectChurn::OnPostGarbageCollect);
+}
+
+void FMyObjectChurn::Stop()
+{
+	check(IsInGameThread());
+	if (!GMyObjectChurn) { return; }
+
+	FMyObjectChurn& Churn = *GMyObjectChurn;
+	FCoreDelegates::OnBeginFrame.Remove(Churn.BeginFrameHandle);
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(Churn.PreGarbageCollectHandle);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(Churn.PostGarbageCollectHandle);
+	GUObjectArray.RemoveUObjectCreateListener(&Churn);
+	GUObjectArray.RemoveUObjectDeleteListener(&Churn);
+
+	GMyObjectChurn.Reset();
+}
+
+bool FMyObjectChurn::IsRunning()
+{
+	return GMyObjectChurn.IsValid();
+}
+
+void FMyObjectChurn::NotifyUObjectCreated(const UObjectBase* Object, int32 Index)
+{
+	const FName ClassName = Object->GetClass()->GetFName();
+
+	FScopeLock ScopeLock(&Lock);
+	if (Index >= ClassByIndex.Num())
+	{
+		ClassByIndex.SetNum(FMath::Max(Index + 1, ClassByIndex.Num() * 2));
+	}
+	ClassByIndex[Index] = ClassName;
+	++Classes.FindOrAdd(ClassName).Created;
+}
+
+void FMyObjectChurn::NotifyUObjectDeleted(const UObjectBase* Object, int32 Index)
+{
+	// The class may already be destroyed in the same purge, so the name comes from the table.
+	FScopeLock ScopeLock(&Lock);
+	if (!ClassByIndex.IsValidIndex(Index) || ClassByIndex[Index].IsNone()) { return; }
+
+	++Classes.FindOrAdd(ClassByIndex[Index]).Destroyed;
+	ClassByIndex[Index] = NAME_None;
+}
+
+void FMyObjectChurn::OnUObjectArrayShutdown()
+{
+	GUObjectArray.RemoveUObjectCreateListener(this);
+	GUObjectArray.RemoveUObjectDeleteListener(this);
+}
+
+void FMyObjectChurn::OnPreGarbageCollect()
+{
+	++GarbageCollections;
+	bGarbageCollectThisFrame = true;
+	bCollecting = true;
+}
+
+void FMyObjectChurn::OnPostGarbageCollect()
+{
+	bGarbageCollectThisFrame = true;
+	bCollecting = false;
+}
+
+void FMyObjectChurn::OnBeginFrame()
+{
+	const double Now = FPlatformTime::Seconds();
+	const double FrameSeconds = Now - FrameStartTime;
+	FrameStartTime = Now;
+
+	// Incremental reachability and purging spread one collection over several frames.
+	if (bGarbageCollectThisFrame || bCollecting || IsIncrementalPurgePending())
+	{
+		++GCFrames;
+		GCFrameSeconds += FrameSeconds;
+		MaxGCFrameSeconds = FMath::Max(MaxGCFrameSeconds, FrameSeconds);
+	}
+	else
+	{
+		++OtherFrames;
+		OtherFrameSeconds += FrameSeconds;
+		MaxOtherFrameSeconds = FMath::Max(MaxOtherFrameSeconds, FrameSeconds);
+	}
+	bGarbageCollectThisFrame = false;
+}
+
+void FMyObjectChurn::Report(int32 Top, FOutputDevice& Ar)
+{
+	if (!GMyObjectChurn)
+	{
+		Ar.Logf(TEXT("ObjectChurn: not running, start it with Project.GC.Churn.Start"));
+		return;
+	}
+	FMyObjectChurn& Churn = *GMyObjectChurn;
+
+	TArray<TPair<FName, FClassChurn>> Sorted;
+	{
+		FScopeLock ScopeLock(&Churn.Lock);
+		Sorted.Reserve(Churn.Classes.Num());
+		for (const TPair<FName, FClassChurn>& Class : Churn.Classes)
+		{
+			Sorted.Emplace(Class.Key, Class.Value);
+		}
+	}
+	Sorted.Sort([](const TPair<FName, FClassChurn>& A, const TPair<FName, FClassChurn>& B)
+	{
+		return A.Value.Created + A.Value.Destroyed > B.Value.Created + B.Value.Destroyed;
+	});
+
+	const double Minutes = FMath::Max((FPlatformTime::Seconds() - Churn.StartTime) / 60.0, 1.0 / 60.0);
+	FClassChurn Total;
+	for (const TPair<FName, FClassChurn>& Class : Sorted)
+	{
+		Total.Created += Class.Value.Created;
+		Total.Destroyed += Class.Value.Destroyed;
+	}
+
+	const FString ChurnPath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("ObjectChurn.csv"));
+	FString ChurnCsv;
+	if (!IFileManager::Get().FileExists(*ChurnPath))
+	{
+		ChurnCsv = TEXT("Minutes,Class,CreatedPerMinute,DestroyedPerMinute\n");
+	}
+
+	Ar.Logf(TEXT("ObjectChurn: %.1f minutes, %.0f objects created and %.0f destroyed per minute, %d live"),
+		Minutes, Total.Created / Minutes, Total.Destroyed / Minutes, GUObjectArray.GetObjectArrayNumMinusAvailable());
+	Ar.Logf(TEXT("  %-48s %12s %12s"), TEXT("Class"), TEXT("created/min"), TEXT("destroyed/min"));
+	for (int32 Index = 0; Index < FMath::Min(Top, Sorted.Num()); ++Index)
+	{
+		const FString ClassName = Sorted[Index].Key.ToString();
+		const double Created = Sorted[Index].Value.Created / Minutes;
+		const double Destroyed = Sorted[Index].Value.Destroyed / Minutes;
+		Ar.Logf(TEXT("  %-48s %12.1f %12.1f"), *ClassName, Created, Destroyed);
+		ChurnCsv += FString::Printf(TEXT("%.2f,%s,%.2f,%.2f\n"), Minutes, *ClassName, Created, Destroyed);
+	}
+	FFileHelper::SaveStringToFile(ChurnCsv, *ChurnPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	int32 Characters = 0;
+	for (TObjectIterator<AMyBaseCharacter> It; It; ++It)
+	{
+		Characters += It->HasAnyFlags(RF_ClassDefaultObject) ? 0 : 1;
+	}
+
+	const double AvgGCFrameMs = Churn.GCFrameSeconds / FMath::Max<int64>(Churn.GCFrames, 1) * 1000.0;
+	const double AvgOtherFrameMs = Churn.OtherFrameSeconds / FMath::Max<int64>(Churn.OtherFrames, 1) * 1000.0;
+	Ar.Logf(TEXT("ObjectChurn: %lld collections, %lld frames with GC work %.2f ms avg %.2f ms max, other frames %.2f ms avg %.2f ms max, %d characters"),
+		Churn.GarbageCollections, Churn.GCFrames, AvgGCFrameMs, Churn.MaxGCFrameSeconds * 1000.0,
+		AvgOtherFrameMs, Churn.MaxOtherFrameSeconds * 1000.0, Characters);
+
+	const FString GCPath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("GCFrames.csv"));
+	FString GCCsv;
+	if (!IFileManager::Get().FileExists(*GCPath))
+	{
+		GCCsv = TEXT("Minutes,Objects,Collections,GCFrames,AvgGCFrameMs,MaxGCFrameMs,AvgFrameMs,MaxFrameMs,Characters\n");
+	}
+	GCCsv += FString::Printf(TEXT("%.2f,%d,%lld,%lld,%.3f,%.3f,%.3f,%.3f,%d\n"), Minutes, GUObjectArray.GetObjectArrayNumMinusAvailable(),
+		Churn.GarbageCollections, Churn.GCFrames, AvgGCFrameMs, Churn.MaxGCFrameSeconds * 1000.0, AvgOtherFrameMs, Churn.MaxOtherFrameSeconds * 1000.0,
+		Characters);
+	FFileHelper::SaveStringToFile(GCCsv, *GCPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+}
+
+static FAutoConsoleCommandWithOutputDevice CmdMyObjectChurnStart(
+	TEXT("Project.GC.Churn.Start"),
+	TEXT("Starts counting UObjects created and destroyed per class and the length of frames with garbage collection work."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+	{
+		FMyObjectChurn::Start();
+		Ar.Logf(TEXT("ObjectChurn: started"));
+	}));
+
+static FAutoConsoleCommandWithArgsAndOutputDevice CmdMyObjectChurnReport(
+	TEXT("Project.GC.Churn.Report"),
+	TEXT("Logs UObject churn per minute by class and GC frame times since Project.GC.Churn.Start. Arguments: [Top=20]."),
+	FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, FOutputDevice& Ar)
+	{
+		FMyObjectChurn::Report(Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 20, Ar);
+	}));
+
+static FAutoConsoleCommandWithOutputDevice CmdMyObjectChurnStop(
+	TEXT("Project.GC.Churn.Stop"),
+	TEXT("Stops counting UObject churn."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+	{
+		FMyObjectChurn::Stop();
+		Ar.Logf(TEXT("ObjectChurn: stopped"));
+	}));
@@ -0,0 +1,258 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyReplicationGraph.h"
+#include "Project.h"
+#include "ReplicationGraphTypes.h"
+#include "EngineUtils.h"
+#include "Engine/LevelScriptActor.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "GameFramework/Info.h"
+#include "MyBaseCharacter.h"
+#include "MyBaseDoor.h"
+#include "InteractiveInterface.h"
+
+UMyReplicationGraph::UMyReplicationGraph()
+{
+	GridCellSize = 10000.0f;
+	SpatialBiasX = -150000.0f;
+	SpatialBiasY = -200000.0f;
+	DynamicActorFrequencyBuckets = 3;
+	DynamicActorBucketListSize = 12;
+	PlayerStatesPerFrame = 2;
+}
+
+void UMyReplicationGraph::ResetGameWorldState()
+{
+	Super::ResetGameWorldState();
+}
+
+void UMyReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	// Project classes. Everything else falls back to GetMappingPolicy() on first use.
+	ClassRepNodePolicies.Set(AMyBaseCharacter::StaticClass(), EMyClassRepNodeMapping::Spatialize_Dynamic);
+	ClassRepNodePolicies.Set(AMyBaseDoor::StaticClass(), EMyClassRepNodeMapping::Spatialize_Dormancy);
+
+	// The owning connection receives these through its own always relevant node.
+	ClassRepNodePolicies.Set(APlayerController::StaticClass(), EMyClassRepNodeMapping::NotRouted);
+	ClassRepNodePolicies.Set(APlayerState::StaticClass(), EMyClassRepNodeMapping::NotRouted);
+	ClassRepNodePolicies.Set(ALevelScriptActor::StaticClass(), EMyClassRepNodeMapping::NotRouted);
+
+	ClassRepNodePolicies.Set(AGameStateBase::StaticClass(), EMyClassRepNodeMapping::RelevantAllConnections);
+
+	FClassReplicationInfo CharacterInfo;
+	InitClassReplicationInfo(CharacterInfo, AMyBaseCharacter::StaticClass(), true);
+	GlobalActorReplicationInfoMap.SetClassInfo(AMyBaseCharacter::StaticClass(), CharacterInfo);
+
+	FClassReplicationInfo DoorInfo;
+	InitClassReplicationInfo(DoorInfo, AMyBaseDoor::StaticClass(), true);
+	GlobalActorReplicationInfoMap.SetClassInfo(AMyBaseDoor::StaticClass(), DoorInfo);
+
+	// PlayerStates are not spatialized. Other players' are throttled by UMyReplicationGraphNode_PlayerStateFrequencyLimiter
+	// alone, so the class keeps the default period of one frame.
+	FClassReplicationInfo PlayerStateInfo;
+	PlayerStateInfo.SetCullDistanceSquared(0.0f);
+	GlobalActorReplicationInfoMap.SetClassInfo(APlayerState::StaticClass(), PlayerStateInfo);
+}
+
+void UMyReplicationGraph::InitGlobalGraphNodes()
+{
+	// Dynamic actors inside each grid cell are split into frequency buckets once the cell gets crowded,
+	// so a connection only walks a fraction of a busy cell every frame.
+	UReplicationGraphNode_ActorListFrequencyBuckets::DefaultSettings.NumBuckets = DynamicActorFrequencyBuckets;
+	UReplicationGraphNode_ActorListFrequencyBuckets::DefaultSettings.ListSize = DynamicActorBucketListSize;
+
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = GridCellSize;
+	GridNode->SpatialBias = FVector2D(SpatialBiasX, SpatialBiasY);
+	AddGlobalGraphNode(GridNode);
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+
+	UMyReplicationGraphNode_PlayerStateFrequencyLimiter* PlayerStateNode = CreateNewNode<UMyReplicationGraphNode_PlayerStateFrequencyLimiter>();
+	PlayerStateNode->TargetActorsPerFrame = PlayerStatesPerFrame;
+	AddGlobalGraphNode(PlayerStateNode);
+}
+
+void UMyReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	UMyReplicationGraphNode_AlwaysRelevant_ForConnection* OwnerNode = CreateNewNode<UMyReplicationGraphNode_AlwaysRelevant_ForConnection>();
+	AddConnectionGraphNode(OwnerNode, RepGraphConnection);
+}
+
+void UMyReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	switch (GetMappingPolicy(ActorInfo.Class))
+	{
+	case EMyClassRepNodeMapping::NotRouted:
+		break;
+
+	case EMyClassRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+
+	case EMyClassRepNodeMapping::Spatialize_Static:
+		GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+		break;
+
+	case EMyClassRepNodeMapping::Spatialize_Dynamic:
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+		break;
+
+	case EMyClassRepNodeMapping::Spatialize_Dormancy:
+		GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+		break;
+	}
+}
+
+void UMyReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	switch (GetMappingPolicy(ActorInfo.Class))
+	{
+	case EMyClassRepNodeMapping::NotRouted:
+		break;
+
+	case EMyClassRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+
+	case EMyClassRepNodeMapping::Spatialize_Static:
+		GridNode->RemoveActor_Static(ActorInfo);
+		break;
+
+	case EMyClassRepNodeMapping::Spatialize_Dynamic:
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+		break;
+
+	case EMyClassRepNodeMapping::Spatialize_Dormancy:
+		GridNode->RemoveActor_Dormancy(ActorInfo);
+		break;
+	}
+}
+
+EMyClassRepNodeMapping UMyReplicationGraph::GetMappingPolicy(UClass* Class)
+{
+	if (const EMyClassRepNodeMapping* Policy = ClassRepNodePolicies.Get(Class))
+	{
+		return *Policy;
+	}
+
+	const AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject());
+
+	EMyClassRepNodeMapping Policy = EMyClassRepNodeMapping::Spatialize_Dynamic;
+
+	if (!ActorCDO || !ActorCDO->GetIsReplicated() || ActorCDO->bOnlyRelevantToOwner)
+	{
+		// Owner only actors are picked up by the per-connection node through their viewer.
+		Policy = EMyClassRepNodeMapping::NotRouted;
+	}
+	else if (ActorCDO->bAlwaysRelevant || Class->IsChildOf(AInfo::StaticClass()))
+	{
+		Policy = EMyClassRepNodeMapping::RelevantAllConnections;
+	}
+	else if (Class->ImplementsInterface(UInteractiveInterface::StaticClass()))
+	{
+		// Interactables sit still until someone uses them; keep them dormant in the grid.
+		Policy = EMyClassRepNodeMapping::Spatialize_Dormancy;
+	}
+	else if (!ActorCDO->GetRootComponent() || ActorCDO->GetRootComponent()->Mobility == EComponentMobility::Static)
+	{
+		Policy = EMyClassRepNodeMapping::Spatialize_Static;
+	}
+
+	ClassRepNodePolicies.Set(Class, Policy);
+
+	if (Policy != EMyClassRepNodeMapping::NotRouted && !GlobalActorReplicationInfoMap.FindClassInfo(Class))
+	{
+		FClassReplicationInfo ClassInfo;
+		InitClassReplicationInfo(ClassInfo, Class, Policy != EMyClassRepNodeMapping::RelevantAllConnections);
+		GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+	}
+
+	return Policy;
+}
+
+void UMyReplicationGraph::InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, bool bSpatialize) const
+{
+	const AActor* ActorCDO = CastChecked<AActor>(Class->GetDefaultObject());
+
+	if (bSpatialize)
+	{
+		Info.SetCullDistanceSquared(static_cast<float>(ActorCDO->GetNetCullDistanceSquared()));
+	}
+
+	Info.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(ActorCDO->GetNetUpdateFrequency());
+}
+
+void UMyReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	OwnerActorList.Reset();
+
+	for (const FNetViewer& Viewer : Params.Viewers)
+	{
+		OwnerActorList.ConditionalAdd(Viewer.InViewer);
+		OwnerActorList.ConditionalAdd(Viewer.ViewTarget);
+
+		if (const APlayerController* PC = Cast<APlayerController>(Viewer.InViewer))
+		{
+			// The owner's HUD reads its own PlayerState every frame; the frequency limiter leaves it to this node.
+			OwnerActorList.ConditionalAdd(PC->PlayerState);
+			OwnerActorList.ConditionalAdd(PC->GetPawn());
+		}
+	}
+
+	Params.OutGatheredReplicationLists.AddReplicationActorList(OwnerActorList);
+}
+
+void UMyReplicationGraphNode_PlayerStateFrequencyLimiter::PrepareForReplication()
+{
+	// Rebuilt every frame, so players who leave drop out without the list needing to be compacted.
+	PlayerStates.Reset();
+	for (TActorIterator<APlayerState> It(GetWorld()); It; ++It)
+	{
+		if (IsActorValidForReplicationGather(*It))
+		{
+			PlayerStates.Add(*It);
+		}
+	}
+}
+
+void UMyReplicationGraphNode_PlayerStateFrequencyLimiter::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	ConnectionActorList.Reset();
+
+	const int32 PerFrame = FMath::Max(TargetActorsPerFrame, 1);
+	const int32 NumSlices = FMath::Max(FMath::DivideAndRoundUp(PlayerStates.Num(), PerFrame), 1);
+	const int32 First = static_cast<int32>(Params.ReplicationFrameNum % NumSlices) * PerFrame;
+	const int32 Last = FMath::Min(First + PerFrame, PlayerStates.Num());
+
+	for (int32 Index = First; Index < Last; ++Index)
+	{
+		APlayerState* PlayerState = PlayerStates[Index];
+
+		// The connection's own PlayerState is gathered every frame by its always relevant node.
+		const bool bOwnPlayerState = Params.Viewers.ContainsByPredicate([PlayerState](const FNetViewer& Viewer)
+		{
+			const APlayerController* PC = Cast<APlayerController>(Viewer.InViewer);
+			return PC && PC->PlayerState == PlayerState;
+		});
+
+		if (!bOwnPlayerState)
+		{
+			ConnectionActorList.Add(PlayerState);
+		}
+	}
+
+	if (ConnectionActorList.Num() > 0)
+	{
+		Params.OutGatheredReplicationLists.AddReplicationActorList(ConnectionActorList);
+	}
+}
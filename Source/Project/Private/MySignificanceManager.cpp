@@ -0,0 +1,237 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MySignificanceManager.h"
+#include "MyBaseCharacter.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "DrawDebugHelpers.h"
+#include "HAL/IConsoleManager.h"
+
+static int32 GMySignificanceDebug = 0;
+static FAutoConsoleVariableRef CVarMySignificanceDebug(
+	TEXT("Project.Significance.Debug"),
+	GMySignificanceDebug,
+	TEXT("Draws the significance score and level above every character (0 = off, 1 = on)."));
+
+const FName UMySignificanceManager::CharacterTag(TEXT("MyBaseCharacter"));
+
+UMySignificanceManager::UMySignificanceManager()
+{
+	bCreateOnClient = true;
+	bCreateOnServer = true;
+
+	MaxDistance = 6000.0f;
+	OffscreenScale = 0.5f;
+	ViewConeCos = 0.5f;
+	HysteresisMargin = 0.05f;
+
+	Levels.SetNum(static_cast<int32>(EMySignificanceLevel::MAX));
+
+	FMySignificanceLevelSettings& High = Levels[static_cast<int32>(EMySignificanceLevel::High)];
+	High.MinSignificance = 0.6f;
+
+	FMySignificanceLevelSettings& Medium = Levels[static_cast<int32>(EMySignificanceLevel::Medium)];
+	Medium.MinSignificance = 0.3f;
+	Medium.TickInterval = 0.05f;
+	Medium.AnimTickInterval = 0.033f;
+	Medium.NetUpdateFrequencyScale = 0.5f;
+
+	FMySignificanceLevelSettings& Low = Levels[static_cast<int32>(EMySignificanceLevel::Low)];
+	Low.MinSignificance = 0.1f;
+	Low.TickInterval = 0.1f;
+	Low.AnimTickInterval = 0.1f;
+	Low.NetUpdateFrequencyScale = 0.25f;
+	Low.bCosmetics = false;
+
+	FMySignificanceLevelSettings& Lowest = Levels[static_cast<int32>(EMySignificanceLevel::Lowest)];
+	Lowest.MinSignificance = 0.0f;
+	Lowest.TickInterval = 0.25f;
+	Lowest.AnimTickInterval = 0.25f;
+	Lowest.NetUpdateFrequencyScale = 0.1f;
+	Lowest.bCosmetics = false;
+}
+
+void UMySignificanceManager::RegisterCharacter(AMyBaseCharacter* Character)
+{
+	RegisterObject(Character, CharacterTag,
+		[this](FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint)
+		{
+			return CalculateSignificance(ObjectInfo, Viewpoint);
+		},
+		EPostSignificanceType::Sequential,
+		[this](FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal)
+		{
+			PostSignificanceUpdate(ObjectInfo, OldSignificance, Significance, bFinal);
+		});
+}
+
+void UMySignificanceManager::UnregisterCharacter(AMyBaseCharacter* Character)
+{
+	UnregisterObject(Character);
+}
+
+const FMySignificanceLevelSettings& UMySignificanceManager::GetLevelSettings(EMySignificanceLevel Level) const
+{
+	check(Levels.Num() > 0);
+	return Levels[FMath::Min(static_cast<int32>(Level), Levels.Num() - 1)];
+}
+
+void UMySignificanceManager::GetLevelCounts(TArray<int32>& OutCounts) const
+{
+	OutCounts.Init(0, static_cast<int32>(EMySignificanceLevel::MAX));
+
+	for (const FManagedObjectInfo* ObjectInfo : GetManagedObjects(CharacterTag))
+	{
+		if (const AMyBaseCharacter* Character = Cast<AMyBaseCharacter>(ObjectInfo->GetObject()))
+		{
+			++OutCounts[static_cast<int32>(Character->GetSignificanceLevel())];
+		}
+	}
+}
+
+void UMySignificanceManager::Tick(float DeltaTime)
+{
+	UWorld* World = GetWorld();
+	if (!World) { return; }
+
+	// Every player controller in the world is a viewpoint: the local player on a client, every connected player on the server.
+	Viewpoints.Reset();
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* PC = It->Get())
+		{
+			FVector Location;
+			FRotator Rotation;
+			PC->GetPlayerViewPoint(Location, Rotation);
+			Viewpoints.Emplace(Rotation, Location);
+		}
+	}
+
+	// Without anyone watching, keep the last levels instead of dropping everything to zero.
+	if (Viewpoints.Num() == 0) { return; }
+
+	Update(Viewpoints);
+
+	if (GMySignificanceDebug != 0)
+	{
+		DrawDebug();
+	}
+}
+
+ETickableTickType UMySignificanceManager::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Always;
+}
+
+TStatId UMySignificanceManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMySignificanceManager, STATGROUP_Tickables);
+}
+
+float UMySignificanceManager::CalculateSignificance(FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint) const
+{
+	// May run on worker threads; only read from the character here.
+	const AMyBaseCharacter* Character = CastChecked<AMyBaseCharacter>(ObjectInfo->GetObject());
+
+	if (Character->IsLocallyControlled())
+	{
+		return 1.0f;
+	}
+
+	const FVector ToCharacter = Character->GetActorLocation() - Viewpoint.GetLocation();
+	const float Distance = ToCharacter.Size();
+
+	float Significance = 1.0f - FMath::Clamp(Distance / MaxDistance, 0.0f, 1.0f);
+
+	if (Distance > UE_KINDA_SMALL_NUMBER && FVector::DotProduct(Viewpoint.GetRotation().GetForwardVector(), ToCharacter / Distance) < ViewConeCos)
+	{
+		Significance *= OffscreenScale;
+	}
+
+	return Significance;
+}
+
+void UMySignificanceManager::PostSignificanceUpdate(FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal)
+{
+	AMyBaseCharacter* Character = Cast<AMyBaseCharacter>(ObjectInfo->GetObject());
+	if (!Character) { return; }
+
+	if (!bFinal)
+	{
+		Character->SetAnimationSignificance(Significance);
+	}
+
+	// bFinal is sent on unregister; put the character back to full rate.
+	const EMySignificanceLevel Level = bFinal ? EMySignificanceLevel::High : SelectLevel(Significance, Character->GetSignificanceLevel());
+
+	if (Level != Character->GetSignificanceLevel())
+	{
+		Character->ApplySignificance(Level, GetLevelSettings(Level));
+	}
+}
+
+EMySignificanceLevel UMySignificanceManager::SelectLevel(float Significance, EMySignificanceLevel CurrentLevel) const
+{
+	const int32 CurrentIndex = static_cast<int32>(CurrentLevel);
+	const int32 NumLevels = FMath::Min(Levels.Num(), static_cast<int32>(EMySignificanceLevel::MAX));
+
+	for (int32 Index = 0; Index < NumLevels; ++Index)
+	{
+		// Moving up needs the full threshold, staying only needs to be within the margin.
+		float Threshold = Levels[Index].MinSignificance;
+		if (Index == CurrentIndex)
+		{
+			Threshold -= HysteresisMargin;
+		}
+
+		if (Significance >= Threshold)
+		{
+			return static_cast<EMySignificanceLevel>(Index);
+		}
+	}
+
+	return static_cast<EMySignificanceLevel>(FMath::Max(NumLevels - 1, 0));
+}
+
+void UMySignificanceManager::DrawDebug() const
+{
+	static const FColor LevelColors[] = { FColor::Green, FColor::Yellow, FColor::Orange, FColor::Red };
+	static_assert(UE_ARRAY_COUNT(LevelColors) == static_cast<int32>(EMySignificanceLevel::MAX), "One color per significance level");
+
+	const UWorld* World = GetWorld();
+
+	for (const FManagedObjectInfo* ObjectInfo : GetManagedObjects(CharacterTag))
+	{
+		const AMyBaseCharacter* Character = Cast<AMyBaseCharacter>(ObjectInfo->GetObject());
+		if (!Character) { continue; }
+
+		const EMySignificanceLevel Level = Character->GetSignificanceLevel();
+		const FString Text = FString::Printf(TEXT("%s %.2f"), *UEnum::GetDisplayValueAsText(Level).ToString(), ObjectInfo->GetSignificance());
+
+		DrawDebugString(World, Character->GetActorLocation() + FVector(0.0f, 0.0f, 120.0f), Text, nullptr, LevelColors[static_cast<int32>(Level)], 0.0f, true);
+	}
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMySignificanceDump(
+	TEXT("Project.Significance.Dump"),
+	TEXT("Prints how many characters are in each significance level."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		const UMySignificanceManager* Manager = World ? USignificanceManager::Get<UMySignificanceManager>(World) : nullptr;
+		if (!Manager)
+		{
+			Ar.Logf(TEXT("Significance: no UMySignificanceManager in this world"));
+			return;
+		}
+
+		TArray<int32> Counts;
+		Manager->GetLevelCounts(Counts);
+
+		int32 Total = 0;
+		for (int32 Index = 0; Index < Counts.Num(); ++Index)
+		{
+			Ar.Logf(TEXT("Significance: %-8s %d"), *UEnum::GetDisplayValueAsText(static_cast<EMySignificanceLevel>(Index)).ToString(), Counts[Index]);
+			Total += Counts[Index];
+		}
+		Ar.Logf(TEXT("Significance: %d character(s) registered"), Total);
+	}));
@@ -4,7 +4,11 @@
 #include "MyStaminaComponent.h"
 #include "MyBaseMovementComponent.h"
 #include <Net/UnrealNetwork.h>
+#include "Net/Core/PushModel/PushModel.h"
 #include <MyBaseCharacter.h>
+#include "MyNetStatsSubsystem.h"
+#include "MyTimerSubsystem.h"
+#include "MyMemoryTags.h"
 
 
 // Sets default values for this component's properties
@@ -19,14 +23,21 @@ UMyStaminaComponent::UMyStaminaComponent()
 	MaximumStamina = 100.0f;
 	bCanSprint = true;
 	bHasStamina = true;
+	NotifiedStamina = CurrentStamina;
 
-	RegenTime = 1.0f;
+	// Instances copy the tuning from their archetype
+	if (HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+	{
+		Tuning = UMyCharacterTuning::LoadDefault();
+	}
 }
 
 
 // Called when the game starts
 void UMyStaminaComponent::BeginPlay()
 {
+	LLM_SCOPE_BYTAG(Project_Stats);
+
 	Super::BeginPlay();
 
 	if (ACharacter* OwnerCharacterTemp = Cast<ACharacter>(GetOwner()))
@@ -34,12 +45,49 @@ void UMyStaminaComponent::BeginPlay()
 		OwnerCharacter = OwnerCharacterTemp;
 		MyMovementComponent = Cast<UMyBaseMovementComponent>(OwnerCharacter->GetMovementComponent());
 	}	
+
+#if !UE_BUILD_SHIPPING
+	TuningChangedHandle = UMyCharacterTuning::OnTuningChanged.AddUObject(this, &UMyStaminaComponent::OnTuningChanged);
+#endif
+}
+
+void UMyStaminaComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+#if !UE_BUILD_SHIPPING
+	UMyCharacterTuning::OnTuningChanged.Remove(TuningChangedHandle);
+#endif
+
+	Super::EndPlay(EndPlayReason);
+}
+
+#if !UE_BUILD_SHIPPING
+void UMyStaminaComponent::OnTuningChanged(const UMyCharacterTuning* ChangedTuning)
+{
+    /** Drain and fill amounts are read every step; only the timer rate needs the timer set again */
+    if (ChangedTuning == Tuning && IsStaminaTimerActive()) {
+        StartStaminaManipulation();
+    }
+}
+#endif
+
+void UMyStaminaComponent::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	UMyNetStatsSubsystem::RecordReplicatedProperties(this);
+}
+
+bool UMyStaminaComponent::CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack)
+{
+	UMyNetStatsSubsystem::RecordRemoteFunction(this, Function, Parameters);
+
+	return Super::CallRemoteFunction(Function, Parameters, OutParms, Stack);
 }
 
 void UMyStaminaComponent::OnRep_CurrentStamina()
 {
     /** Update local stamina status whenever it is replicated to clients */
-    UpdateStaminaStatus();
+    UpdateStaminaStatus(EMyStatChangeCause::Replicated);
 }
 
 float UMyStaminaComponent::GetCurrentStamina() const
@@ -84,7 +132,7 @@ void UMyStaminaComponent::ServerIncreaseCurrentStamina_Implementation(float Amou
     }
 
     /** Update internal flags and broadcast changes */
-    UpdateStaminaStatus();
+    UpdateStaminaStatus(EMyStatChangeCause::Regen);
 }
 
 void UMyStaminaComponent::ServerDecreaseCurrentStamina_Implementation(float Amount)
@@ -99,7 +147,7 @@ void UMyStaminaComponent::ServerDecreaseCurrentStamina_Implementation(float Amou
     }
 
     /** Update internal flags and broadcast changes */
-    UpdateStaminaStatus();
+    UpdateStaminaStatus(EMyStatChangeCause::Drain);
 }
 
 void UMyStaminaComponent::ServerSetCurrentStamina_Implementation(float Amount)
@@ -113,7 +161,7 @@ void UMyStaminaComponent::ServerSetCurrentStamina_Implementation(float Amount)
     }
 
     /** Update internal flags and broadcast changes */
-    UpdateStaminaStatus();
+    UpdateStaminaStatus(EMyStatChangeCause::Set);
 }
 
 void UMyStaminaComponent::ServerSetMaximumStamina_Implementation(float Amount)
@@ -125,7 +173,7 @@ void UMyStaminaComponent::ServerSetMaximumStamina_Implementation(float Amount)
     MaximumStamina = Amount;
 
     /** Update internal flags and broadcast changes */
-    UpdateStaminaStatus();
+    UpdateStaminaStatus(EMyStatChangeCause::Maximum);
 }
 
 void UMyStaminaComponent::ServerDecreaseMaximumStamina_Implementation(float Amount)
@@ -137,7 +185,7 @@ void UMyStaminaComponent::ServerDecreaseMaximumStamina_Implementation(float Amou
     MaximumStamina -= Amount;
 
     /** Update internal flags and broadcast changes */
-    UpdateStaminaStatus();
+    UpdateStaminaStatus(EMyStatChangeCause::Maximum);
 }
 
 void UMyStaminaComponent::ServerIncreaseMaximumStamina_Implementation(float Amount)
@@ -146,7 +194,7 @@ void UMyStaminaComponent::ServerIncreaseMaximumStamina_Implementation(float Amou
     MaximumStamina += Amount;
 
     /** Update internal flags and broadcast changes */
-    UpdateStaminaStatus();
+    UpdateStaminaStatus(EMyStatChangeCause::Maximum);
 }
 
 float UMyStaminaComponent::GetStaminaPercentage() const
@@ -158,26 +206,39 @@ float UMyStaminaComponent::GetStaminaPercentage() const
     return CurrentStamina / MaximumStamina;
 }
 
-void UMyStaminaComponent::UpdateStaminaStatus()
+void UMyStaminaComponent::UpdateStaminaStatus(EMyStatChangeCause Cause)
 {
+    LLM_SCOPE_BYTAG(Project_Stats);
+
     /** Update flags based on current stamina */
     bHasStamina = HasStamina();
     bCanSprint = CanSprint();
 
+    /** Stamina is push model replicated, so flag it for the next net update */
+    MARK_PROPERTY_DIRTY_FROM_NAME(UMyStaminaComponent, CurrentStamina, this);
+    MARK_PROPERTY_DIRTY_FROM_NAME(UMyStaminaComponent, MaximumStamina, this);
+
     /** Broadcast an event so UI or other systems can react */
-    OnStaminaChanged.Broadcast();
+    const FMyStatChange Change(NotifiedStamina, CurrentStamina, MaximumStamina, Cause);
+    NotifiedStamina = CurrentStamina;
+
+    OnStaminaChangedNative.Broadcast(Change);
+
+    /** Dynamic delegates go through ProcessEvent per listener; skip that when no Blueprint listens */
+    if (OnStaminaChanged.IsBound()) {
+        OnStaminaChanged.Broadcast(Change);
+    }
 }
 
 void UMyStaminaComponent::StartStaminaManipulation()
 {
-    /** Only start the timer if the world exists */
-    if (GetWorld()) {
+    /** Only start the timer if the world has a timer wheel */
+    if (FMyTimerWheel* Timers = UMyTimerSubsystem::GetTimerWheel(this)) {
         /** Set a recurring timer that calls StaminaTick every RegenTime seconds */
-        GetWorld()->GetTimerManager().SetTimer(
+        Timers->SetTimer<&UMyStaminaComponent::StaminaTick>(
             StaminaDrainTimer,
             this,
-            &UMyStaminaComponent::StaminaTick,
-            RegenTime,
+            GetTuning().RegenTime,
             true
         );
     }
@@ -185,10 +246,10 @@ void UMyStaminaComponent::StartStaminaManipulation()
 
 void UMyStaminaComponent::StopStaminaManipulation()
 {
-    /** Only stop the timer if the world exists */
-    if (GetWorld()) {
+    /** Only stop the timer if the world has a timer wheel */
+    if (FMyTimerWheel* Timers = UMyTimerSubsystem::GetTimerWheel(this)) {
         /** Clear the recurring stamina timer */
-        GetWorld()->GetTimerManager().ClearTimer(StaminaDrainTimer);
+        Timers->ClearTimer(StaminaDrainTimer);
     }
 }
 
@@ -220,7 +281,7 @@ void UMyStaminaComponent::StaminaTick()
 	 */
 	else if (bIsSprinting && bHasStamina)
 	{
-		ServerDecreaseCurrentStamina(1.0f);
+		ServerDecreaseCurrentStamina(GetTuning().DrainAmount);
 	}
 	/**
 	 * If the player is not sprinting and stamina is not full, regenerate stamina.
@@ -228,19 +289,23 @@ void UMyStaminaComponent::StaminaTick()
 	 */
 	else if (!bHasFullStamina)
 	{
-		ServerIncreaseCurrentStamina(1.0f);
+		ServerIncreaseCurrentStamina(GetTuning().FillAmount);
 	}
 }
 
 bool UMyStaminaComponent::IsStaminaTimerActive()
 {
-	return GetWorld()->GetTimerManager().IsTimerActive(StaminaDrainTimer);
+	const FMyTimerWheel* Timers = UMyTimerSubsystem::GetTimerWheel(this);
+	return Timers && Timers->IsTimerActive(StaminaDrainTimer);
 }
 
 void UMyStaminaComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(UMyStaminaComponent, CurrentStamina);
-	DOREPLIFETIME(UMyStaminaComponent, MaximumStamina);
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(UMyStaminaComponent, CurrentStamina, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UMyStaminaComponent, MaximumStamina, Params);
 }
\ No newline at end of file
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyStatEvents.h"
+#include "MyHealthComponent.h"
+#include "MyAllocationCounter.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/StrongObjectPtr.h"
+
+namespace MyStatEventBench
+{
+	struct FResult
+	{
+		double Seconds = 0.0;
+		uint64 Allocations = 0;
+	};
+
+	/* Times Broadcasts calls of Broadcast, after one untimed call. */
+	static FResult Measure(int32 Broadcasts, TFunctionRef<void(const FMyStatChange&)> Broadcast)
+	{
+		const FMyStatChange Change(100.0f, 99.0f, 100.0f, EMyStatChangeCause::Damage);
+		Broadcast(Change);
+
+		FResult Result;
+		const uint64 StartAllocations = FMyAllocationCounter::GetThreadAllocations();
+		const double StartTime = FPlatformTime::Seconds();
+		{
+			FMyAllocationCounter::FScope AllocScope;
+			for (int32 Index = 0; Index < Broadcasts; ++Index)
+			{
+				Broadcast(Change);
+			}
+		}
+		Result.Seconds = FPlatformTime::Seconds() - StartTime;
+		Result.Allocations = FMyAllocationCounter::GetThreadAllocations() - StartAllocations;
+		return Result;
+	}
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyStatEventBench(
+	TEXT("Project.Events.Bench"),
+	TEXT("Compares dispatch cost of the native stat change event and its Blueprint (dynamic) version. Arguments: [Listeners] [Broadcasts]."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		using namespace MyStatEventBench;
+
+		const int32 NumListeners = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000;
+		const int32 NumBroadcasts = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 1000;
+
+		if (!FMyAllocationCounter::IsInstalled())
+		{
+			Ar.Logf(ELogVerbosity::Warning, TEXT("EventBench: allocations are not counted without -MyCountAllocations"));
+		}
+
+		// The same listeners are bound to both, like a HUD bound once natively and once in Blueprint.
+		TArray<TStrongObjectPtr<UMyStatEventBenchListener>> Listeners;
+		FMyStatChangedEvent NativeEvent;
+		FOnHealthChanged DynamicEvent;
+		for (int32 Index = 0; Index < NumListeners; ++Index)
+		{
+			UMyStatEventBenchListener* Listener = NewObject<UMyStatEventBenchListener>(GetTransientPackage());
+			Listeners.Emplace(Listener);
+			NativeEvent.AddUObject(Listener, &UMyStatEventBenchListener::OnStatChangedNative);
+			DynamicEvent.AddDynamic(Listener, &UMyStatEventBenchListener::OnStatChangedDynamic);
+		}
+
+		const FResult Native = Measure(NumBroadcasts, [&NativeEvent](const FMyStatChange& Change) { NativeEvent.Broadcast(Change); });
+		const FResult Dynamic = Measure(NumBroadcasts, [&DynamicEvent](const FMyStatChange& Change) { DynamicEvent.Broadcast(Change); });
+
+		const double Calls = static_cast<double>(NumListeners) * NumBroadcasts;
+		const double NativeNs = Native.Seconds * 1.0e9 / Calls;
+		const double DynamicNs = Dynamic.Seconds * 1.0e9 / Calls;
+
+		Ar.Logf(TEXT("EventBench: %d listeners, %d broadcasts"), NumListeners, NumBroadcasts);
+		Ar.Logf(TEXT("  native   %8.3f ms  %6.2f ns per listener  %.2f allocations per broadcast"),
+			Native.Seconds * 1000.0, NativeNs, static_cast<double>(Native.Allocations) / NumBroadcasts);
+		Ar.Logf(TEXT("  dynamic  %8.3f ms  %6.2f ns per listener  %.2f allocations per broadcast"),
+			Dynamic.Seconds * 1000.0, DynamicNs, static_cast<double>(Dynamic.Allocations) / NumBroadcasts);
+		Ar.Logf(TEXT("  dynamic / native: %.1fx"), DynamicNs / FMath::Max(NativeNs, UE_DOUBLE_SMALL_NUMBER));
+
+		const FString FilePath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("EventBench.csv"));
+		FString Csv;
+		if (!IFileManager::Get().FileExists(*FilePath))
+		{
+			Csv = TEXT("Listeners,Broadcasts,NativeNsPerListener,DynamicNsPerListener,NativeAllocations,DynamicAllocations\n");
+		}
+		Csv += FString::Printf(TEXT("%d,%d,%.3f,%.3f,%llu,%llu\n"), NumListeners, NumBroadcasts, NativeNs, DynamicNs, Native.Allocations, Dynamic.Allocations);
+		FFileHelper::SaveStringToFile(Csv, *FilePath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+	}));
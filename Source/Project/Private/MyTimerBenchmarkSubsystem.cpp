@@ -0,0 +1,226 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyTimerBenchmarkSubsystem.h"
+#include "Project.h"
+#include "MyAllocationCounter.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+/* Time given to the timers after the last one should have fired. */
+static constexpr double MyTimerBenchExtraSeconds = 1.0;
+
+namespace MyTimerBench
+{
+	/* Runs Step inside an allocation counting scope and returns its time and allocations. */
+	template<typename StepType>
+	static void Measure(double& OutSeconds, uint64& OutAllocations, StepType&& Step)
+	{
+		const uint64 StartAllocations = FMyAllocationCounter::GetThreadAllocations();
+		const double StartTime = FPlatformTime::Seconds();
+		{
+			FMyAllocationCounter::FScope AllocScope;
+			Step();
+		}
+		OutSeconds = FPlatformTime::Seconds() - StartTime;
+		OutAllocations = FMyAllocationCounter::GetThreadAllocations() - StartAllocations;
+	}
+}
+
+void UMyTimerBenchmarkSubsystem::Deinitialize()
+{
+	Stop();
+
+	Super::Deinitialize();
+}
+
+void UMyTimerBenchmarkSubsystem::StartBenchmark(int32 InCount, float InSeconds, FOutputDevice& Ar)
+{
+	if (IsRunning())
+	{
+		Ar.Logf(TEXT("TimerBench: already running"));
+		return;
+	}
+
+	if (!FMyAllocationCounter::IsInstalled())
+	{
+		Ar.Logf(ELogVerbosity::Warning, TEXT("TimerBench: allocations are not counted without -MyCountAllocations"));
+	}
+
+	Count = InCount;
+	Seconds = FMath::Max(InSeconds, 0.1f);
+	ElapsedSeconds = 0.0;
+	Frames = 0;
+	WheelTickSeconds = TimerManagerTickSeconds = 0.0;
+	MaxWheelTickSeconds = MaxTimerManagerTickSeconds = 0.0;
+
+	Listener = NewObject<UMyTimerBenchListener>(this);
+	Wheel = MakeUnique<FMyTimerWheel>(Count);
+	TimerManager = MakeUnique<FTimerManager>();
+	WheelHandles.Init(FMyTimerHandle(), Count);
+	TimerManagerHandles.Init(FTimerHandle(), Count);
+
+	// Same delays for both, spread over the whole run.
+	FRandomStream Random(Count);
+	Delays.SetNumUninitialized(Count);
+	for (float& Delay : Delays)
+	{
+		Delay = Random.FRandRange(0.001f, Seconds);
+	}
+
+	TArray<int32> All;
+	TArray<int32> Half;
+	All.Reserve(Count);
+	Half.Reserve(Count / 2);
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		All.Add(Index);
+		if (Index % 2 == 1)
+		{
+			Half.Add(Index);
+		}
+	}
+
+	SetResult = SetTimers(All);
+	ClearResult = ClearTimers(Half);
+	ResetResult = SetTimers(Half);
+
+	Ar.Logf(TEXT("TimerBench: %d timers over %.1fs"), Count, Seconds);
+	LogStep(Ar, TEXT("set"), SetResult, All.Num());
+	LogStep(Ar, TEXT("clear"), ClearResult, Half.Num());
+	LogStep(Ar, TEXT("set again"), ResetResult, Half.Num());
+
+	bRunning = true;
+}
+
+UMyTimerBenchmarkSubsystem::FStepResult UMyTimerBenchmarkSubsystem::SetTimers(const TArray<int32>& Indices)
+{
+	FStepResult Result;
+	MyTimerBench::Measure(Result.WheelSeconds, Result.WheelAllocations, [this, &Indices]()
+	{
+		for (const int32 Index : Indices)
+		{
+			Wheel->SetTimer<&UMyTimerBenchListener::OnWheelTimer>(WheelHandles[Index], Listener, Delays[Index], false);
+		}
+	});
+	MyTimerBench::Measure(Result.TimerManagerSeconds, Result.TimerManagerAllocations, [this, &Indices]()
+	{
+		for (const int32 Index : Indices)
+		{
+			TimerManager->SetTimer(TimerManagerHandles[Index], Listener.Get(), &UMyTimerBenchListener::OnTimerManagerTimer, Delays[Index], false);
+		}
+	});
+	return Result;
+}
+
+UMyTimerBenchmarkSubsystem::FStepResult UMyTimerBenchmarkSubsystem::ClearTimers(const TArray<int32>& Indices)
+{
+	FStepResult Result;
+	MyTimerBench::Measure(Result.WheelSeconds, Result.WheelAllocations, [this, &Indices]()
+	{
+		for (const int32 Index : Indices)
+		{
+			Wheel->ClearTimer(WheelHandles[Index]);
+		}
+	});
+	MyTimerBench::Measure(Result.TimerManagerSeconds, Result.TimerManagerAllocations, [this, &Indices]()
+	{
+		for (const int32 Index : Indices)
+		{
+			TimerManager->ClearTimer(TimerManagerHandles[Index]);
+		}
+	});
+	return Result;
+}
+
+void UMyTimerBenchmarkSubsystem::LogStep(FOutputDevice& Ar, const TCHAR* Step, const FStepResult& Result, int32 Operations) const
+{
+	const double PerOperation = 1.0e9 / FMath::Max(Operations, 1);
+	Ar.Logf(TEXT("  %-9s  wheel %7.1f ns/timer %6llu allocations   timer manager %7.1f ns/timer %6llu allocations"), Step,
+		Result.WheelSeconds * PerOperation, Result.WheelAllocations, Result.TimerManagerSeconds * PerOperation, Result.TimerManagerAllocations);
+}
+
+void UMyTimerBenchmarkSubsystem::Tick(float DeltaTime)
+{
+	if (!IsRunning()) { return; }
+
+	double StartTime = FPlatformTime::Seconds();
+	Wheel->Advance(DeltaTime);
+	const double WheelSeconds = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	TimerManager->Tick(DeltaTime);
+	const double TimerManagerSeconds = FPlatformTime::Seconds() - StartTime;
+
+	++Frames;
+	ElapsedSeconds += DeltaTime;
+	WheelTickSeconds += WheelSeconds;
+	TimerManagerTickSeconds += TimerManagerSeconds;
+	MaxWheelTickSeconds = FMath::Max(MaxWheelTickSeconds, WheelSeconds);
+	MaxTimerManagerTickSeconds = FMath::Max(MaxTimerManagerTickSeconds, TimerManagerSeconds);
+
+	const bool bAllFired = Wheel->Num() == 0 && Listener->TimerManagerCalls >= Count;
+	if (bAllFired || ElapsedSeconds > Seconds + MyTimerBenchExtraSeconds)
+	{
+		Report();
+		Stop();
+	}
+}
+
+TStatId UMyTimerBenchmarkSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMyTimerBenchmarkSubsystem, STATGROUP_Tickables);
+}
+
+void UMyTimerBenchmarkSubsystem::Report()
+{
+	const double FrameCount = static_cast<double>(FMath::Max<int64>(Frames, 1));
+	const double WheelMs = WheelTickSeconds / FrameCount * 1000.0;
+	const double TimerManagerMs = TimerManagerTickSeconds / FrameCount * 1000.0;
+
+	UE_LOG(LogProject, Display, TEXT("TimerBench: expiry over %lld frames"), Frames);
+	UE_LOG(LogProject, Display, TEXT("  wheel          %.4f ms/frame (max %.4f)  fired %lld"), WheelMs, MaxWheelTickSeconds * 1000.0, Listener->WheelCalls);
+	UE_LOG(LogProject, Display, TEXT("  timer manager  %.4f ms/frame (max %.4f)  fired %lld"), TimerManagerMs, MaxTimerManagerTickSeconds * 1000.0, Listener->TimerManagerCalls);
+
+	const FString FilePath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("TimerBench.csv"));
+	FString Csv;
+	if (!IFileManager::Get().FileExists(*FilePath))
+	{
+		Csv = TEXT("Timers,Implementation,SetNs,ClearNs,SetAgainNs,SetAllocations,ExpiryMsPerFrame,MaxExpiryMs,Fired\n");
+	}
+	const double PerSet = 1.0e9 / FMath::Max(Count, 1);
+	const double PerHalf = 1.0e9 / FMath::Max(Count / 2, 1);
+	Csv += FString::Printf(TEXT("%d,Wheel,%.2f,%.2f,%.2f,%llu,%.4f,%.4f,%lld\n"), Count,
+		SetResult.WheelSeconds * PerSet, ClearResult.WheelSeconds * PerHalf, ResetResult.WheelSeconds * PerHalf,
+		SetResult.WheelAllocations + ResetResult.WheelAllocations, WheelMs, MaxWheelTickSeconds * 1000.0, Listener->WheelCalls);
+	Csv += FString::Printf(TEXT("%d,TimerManager,%.2f,%.2f,%.2f,%llu,%.4f,%.4f,%lld\n"), Count,
+		SetResult.TimerManagerSeconds * PerSet, ClearResult.TimerManagerSeconds * PerHalf, ResetResult.TimerManagerSeconds * PerHalf,
+		SetResult.TimerManagerAllocations + ResetResult.TimerManagerAllocations, TimerManagerMs, MaxTimerManagerTickSeconds * 1000.0, Listener->TimerManagerCalls);
+	FFileHelper::SaveStringToFile(Csv, *FilePath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+}
+
+void UMyTimerBenchmarkSubsystem::Stop()
+{
+	bRunning = false;
+	Wheel.Reset();
+	TimerManager.Reset();
+	WheelHandles.Empty();
+	TimerManagerHandles.Empty();
+	Delays.Empty();
+	Listener = nullptr;
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMyTimerBench(
+	TEXT("Project.Timers.Bench"),
+	TEXT("Compares setting, clearing and expiring timers on the timer wheel and on FTimerManager. Arguments: [Count] [Seconds]."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UMyTimerBenchmarkSubsystem* Bench = World ? World->GetSubsystem<UMyTimerBenchmarkSubsystem>() : nullptr)
+		{
+			const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 100000;
+			const float Seconds = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 5.0f;
+			Bench->StartBenchmark(FMath::Max(Count, 1), Seconds, Ar);
+		}
+	}));
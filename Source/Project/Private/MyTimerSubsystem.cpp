@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyTimerSubsystem.h"
+#include "Engine/World.h"
+
+bool UMyTimerSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return Super::ShouldCreateSubsystem(Outer) && World && World->IsGameWorld();
+}
+
+void UMyTimerSubsystem::Tick(float DeltaTime)
+{
+	Wheel.Advance(DeltaTime);
+}
+
+TStatId UMyTimerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMyTimerSubsystem, STATGROUP_Tickables);
+}
+
+FMyTimerWheel* UMyTimerSubsystem::GetTimerWheel(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	UMyTimerSubsystem* Timers = World ? World->GetSubsystem<UMyTimerSubsystem>() : nullptr;
+	return Timers ? &Timers->Wheel : nullptr;
+}
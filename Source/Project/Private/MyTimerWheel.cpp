@@ -0,0 +1,237 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyTimerWheel.h"
+
+FMyTimerWheel::FMyTimerWheel(int32 InitialCapacity)
+{
+	for (int32& Head : Slots)
+	{
+		Head = INDEX_NONE;
+	}
+	Reserve(InitialCapacity);
+	ExpiredTimers.Reserve(InitialCapacity);
+}
+
+void FMyTimerWheel::Reserve(int32 NumTimers)
+{
+	Nodes.Reserve(NumTimers);
+}
+
+void FMyTimerWheel::SetTimer(FMyTimerHandle& InOutHandle, UObject* Object, FMyTimerCallback Callback, float Rate, bool bLoop, float FirstDelay)
+{
+	ClearTimer(InOutHandle);
+	if (Rate <= 0.0f || !Object || !Callback) { return; }
+
+	const int32 Index = AllocateNode();
+	FNode& Node = Nodes[Index];
+	Node.Object = Object;
+	Node.Callback = Callback;
+	Node.ExpireTick = CurrentTick + SecondsToTicks(FirstDelay >= 0.0f ? FirstDelay : Rate);
+	Node.IntervalTicks = bLoop ? static_cast<uint32>(SecondsToTicks(Rate)) : 0;
+	Node.State = ENodeState::Scheduled;
+	Insert(Index);
+
+	InOutHandle.Index = static_cast<uint32>(Index);
+	InOutHandle.Generation = Node.Generation;
+}
+
+void FMyTimerWheel::ClearTimer(FMyTimerHandle& InOutHandle)
+{
+	if (const FNode* Node = FindNode(InOutHandle))
+	{
+		const int32 Index = static_cast<int32>(InOutHandle.Index);
+
+		// An expired timer is still in ExpiredTimers; the new generation makes Advance() skip it.
+		if (Node->State == ENodeState::Scheduled)
+		{
+			Unlink(Index);
+		}
+		FreeNode(Index);
+	}
+	InOutHandle.Invalidate();
+}
+
+bool FMyTimerWheel::IsTimerActive(FMyTimerHandle Handle) const
+{
+	return FindNode(Handle) != nullptr;
+}
+
+float FMyTimerWheel::GetTimerRemaining(FMyTimerHandle Handle) const
+{
+	const FNode* Node = FindNode(Handle);
+	if (!Node) { return -1.0f; }
+
+	return static_cast<float>(FMath::Max(Node->ExpireTick * TickSeconds - Time, 0.0));
+}
+
+void FMyTimerWheel::Advance(float DeltaSeconds)
+{
+	Time += FMath::Max(DeltaSeconds, 0.0f);
+	CurrentTick = static_cast<uint64>(Time / TickSeconds);
+
+	while (NextTick <= CurrentTick)
+	{
+		const int32 SlotIndex = static_cast<int32>(NextTick & SlotMask);
+
+		// Level 0 wrapped: bring the next level 1 slot down, and so on up while the levels wrap too.
+		if (SlotIndex == 0)
+		{
+			for (int32 Level = 1; Level < NumLevels; ++Level)
+			{
+				const int32 LevelSlotIndex = static_cast<int32>((NextTick >> (SlotBits * Level)) & SlotMask);
+				Cascade(Level, LevelSlotIndex);
+				if (LevelSlotIndex != 0) { break; }
+			}
+		}
+
+		for (int32 Index = Exchange(Slots[SlotIndex], INDEX_NONE); Index != INDEX_NONE; )
+		{
+			FNode& Node = Nodes[Index];
+			const int32 Next = Node.Next;
+
+			Node.State = ENodeState::Expired;
+			Node.Prev = INDEX_NONE;
+			Node.Next = INDEX_NONE;
+			ExpiredTimers.Add({ Index, Node.Generation });
+
+			Index = Next;
+		}
+
+		++NextTick;
+	}
+
+	// Callbacks may set timers and grow Nodes, so nodes are looked up again after every call.
+	for (int32 ExpiredIndex = 0; ExpiredIndex < ExpiredTimers.Num(); ++ExpiredIndex)
+	{
+		const FExpiredTimer Expired = ExpiredTimers[ExpiredIndex];
+		FNode& Node = Nodes[Expired.Index];
+		if (Node.Generation != Expired.Generation || Node.State != ENodeState::Expired) { continue; }
+
+		UObject* Object = Node.Object.Get();
+		const FMyTimerCallback Callback = Node.Callback;
+		if (!Object)
+		{
+			FreeNode(Expired.Index);
+			continue;
+		}
+
+		if (Node.IntervalTicks > 0)
+		{
+			// Rearm first, so the callback sees an active timer it can clear. Intervals missed in a long frame are skipped.
+			Node.ExpireTick += Node.IntervalTicks;
+			if (Node.ExpireTick <= CurrentTick)
+			{
+				Node.ExpireTick += ((CurrentTick - Node.ExpireTick) / Node.IntervalTicks + 1) * Node.IntervalTicks;
+			}
+			Node.State = ENodeState::Scheduled;
+			Insert(Expired.Index);
+		}
+		else
+		{
+			FreeNode(Expired.Index);
+		}
+
+		Callback(Object);
+	}
+	ExpiredTimers.Reset();
+}
+
+const FMyTimerWheel::FNode* FMyTimerWheel::FindNode(FMyTimerHandle Handle) const
+{
+	if (!Handle.IsValid() || Handle.Index >= static_cast<uint32>(Nodes.Num())) { return nullptr; }
+
+	const FNode& Node = Nodes[Handle.Index];
+	return (Node.Generation == Handle.Generation && Node.State != ENodeState::Free) ? &Node : nullptr;
+}
+
+int32 FMyTimerWheel::AllocateNode()
+{
+	++NumActive;
+
+	if (FreeHead != INDEX_NONE)
+	{
+		const int32 Index = FreeHead;
+		FreeHead = Nodes[Index].Next;
+		Nodes[Index].Next = INDEX_NONE;
+		return Index;
+	}
+	return Nodes.AddDefaulted();
+}
+
+void FMyTimerWheel::FreeNode(int32 Index)
+{
+	--NumActive;
+
+	FNode& Node = Nodes[Index];
+	Node.Object.Reset();
+	Node.Callback = nullptr;
+	Node.State = ENodeState::Free;
+	Node.Prev = INDEX_NONE;
+	Node.Next = FreeHead;
+	FreeHead = Index;
+
+	// Generation 0 marks invalid handles.
+	if (++Node.Generation == 0)
+	{
+		Node.Generation = 1;
+	}
+}
+
+void FMyTimerWheel::Insert(int32 Index)
+{
+	FNode& Node = Nodes[Index];
+
+	// Timers due already go in the slot processed next.
+	const uint64 Delta = Node.ExpireTick > NextTick ? FMath::Min(Node.ExpireTick - NextTick, MaxDelayTicks) : 0;
+	const uint64 SlotTick = NextTick + Delta;
+
+	int32 Level = 0;
+	while (Level < NumLevels - 1 && Delta >= (uint64(1) << (SlotBits * (Level + 1))))
+	{
+		++Level;
+	}
+
+	const int32 Slot = Level * SlotsPerLevel + static_cast<int32>((SlotTick >> (SlotBits * Level)) & SlotMask);
+	Node.Slot = static_cast<uint16>(Slot);
+	Node.Prev = INDEX_NONE;
+	Node.Next = Slots[Slot];
+	if (Node.Next != INDEX_NONE)
+	{
+		Nodes[Node.Next].Prev = Index;
+	}
+	Slots[Slot] = Index;
+}
+
+void FMyTimerWheel::Unlink(int32 Index)
+{
+	FNode& Node = Nodes[Index];
+	if (Node.Prev != INDEX_NONE)
+	{
+		Nodes[Node.Prev].Next = Node.Next;
+	}
+	else
+	{
+		Slots[Node.Slot] = Node.Next;
+	}
+	if (Node.Next != INDEX_NONE)
+	{
+		Nodes[Node.Next].Prev = Node.Prev;
+	}
+	Node.Prev = INDEX_NONE;
+	Node.Next = INDEX_NONE;
+}
+
+void FMyTimerWheel::Cascade(int32 Level, int32 SlotIndex)
+{
+	for (int32 Index = Exchange(Slots[Level * SlotsPerLevel + SlotIndex], INDEX_NONE); Index != INDEX_NONE; )
+	{
+		const int32 Next = Nodes[Index].Next;
+		Insert(Index);
+		Index = Next;
+	}
+}
+
+uint64 FMyTimerWheel::SecondsToTicks(float Seconds)
+{
+	return static_cast<uint64>(FMath::Clamp(FMath::CeilToDouble(Seconds / TickSeconds), 1.0, static_cast<double>(MaxDelayTicks)));
+}
@@ -0,0 +1,654 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MyWorldSnapshotSubsystem.h"
+#include "Project.h"
+#include "MyBaseDoor.h"
+#include "MyBaseGameMode.h"
+#include "MyHealthComponent.h"
+#include "MyStaminaComponent.h"
+#include "MyTimerSubsystem.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerStart.h"
+#include "Hash/CityHash.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+static float GMySnapshotAutosaveSeconds = 0.0f;
+static FAutoConsoleVariableRef CVarMySnapshotAutosaveSeconds(
+	TEXT("Project.Snapshot.AutosaveSeconds"),
+	GMySnapshotAutosaveSeconds,
+	TEXT("Seconds between saves of the \"Autosave\" world snapshot for crash recovery. 0 disables it. Read when the world begins play."));
+
+/* Upper bound on records of one type, so a corrupted count can't ask for a huge allocation. */
+static constexpr uint32 MySnapshotMaxRecords = 1 << 20;
+
+namespace MyWorldSnapshot
+{
+	static uint64 HashString(const FString& String)
+	{
+		return CityHash64(reinterpret_cast<const char*>(*String), String.Len() * sizeof(TCHAR));
+	}
+
+	/* Identifies a placed actor across map loads and PIE sessions. */
+	static uint64 GetActorId(const AActor* Actor)
+	{
+		return HashString(UWorld::RemovePIEPrefix(Actor->GetPathName()));
+	}
+
+	template<typename RecordType>
+	static void WriteRecords(TArray<uint8>& OutData, const TArray<RecordType>& Records)
+	{
+		OutData.Append(reinterpret_cast<const uint8*>(Records.GetData()), Records.Num() * sizeof(RecordType));
+	}
+
+	/* Reads Count records of RecordSize bytes each; bytes beyond sizeof(RecordType) are skipped, missing ones stay zero. */
+	template<typename RecordType>
+	static const uint8* ReadRecords(const uint8* Data, uint32 Count, uint32 RecordSize, TArray<RecordType>& OutRecords)
+	{
+		const uint32 CopySize = FMath::Min<uint32>(RecordSize, sizeof(RecordType));
+		OutRecords.SetNumZeroed(Count);
+		for (RecordType& Record : OutRecords)
+		{
+			FMemory::Memcpy(&Record, Data, CopySize);
+			Data += RecordSize;
+		}
+		return Data;
+	}
+
+	static bool IsValidStat(float Value, float Maximum)
+	{
+		return FMath::IsFinite(Value) && FMath::IsFinite(Maximum) && Value >= 0.0f && Maximum >= 0.0f && Value <= Maximum;
+	}
+}
+
+void FMyWorldSnapshot::Serialize(TArray<uint8>& OutData) const
+{
+	FMySnapshotHeader Header;
+	Header.DoorRecordSize = sizeof(FMySnapshotDoor);
+	Header.PlayerRecordSize = sizeof(FMySnapshotPlayer);
+	Header.SpawnRecordSize = sizeof(FMySnapshotSpawn);
+	Header.NumDoors = Doors.Num();
+	Header.NumPlayers = Players.Num();
+	Header.NumSpawns = Spawns.Num();
+	Header.MapId = MapId;
+
+	OutData.Reset(static_cast<int32>(sizeof(FMySnapshotHeader) + Doors.Num() * sizeof(FMySnapshotDoor) + Players.Num() * sizeof(FMySnapshotPlayer) + Spawns.Num() * sizeof(FMySnapshotSpawn)));
+	OutData.AddZeroed(sizeof(FMySnapshotHeader));
+	MyWorldSnapshot::WriteRecords(OutData, Doors);
+	MyWorldSnapshot::WriteRecords(OutData, Players);
+	MyWorldSnapshot::WriteRecords(OutData, Spawns);
+
+	Header.PayloadCrc = FCrc::MemCrc32(OutData.GetData() + sizeof(FMySnapshotHeader), OutData.Num() - static_cast<int32>(sizeof(FMySnapshotHeader)));
+	FMemory::Memcpy(OutData.GetData(), &Header, sizeof(FMySnapshotHeader));
+}
+
+bool FMyWorldSnapshot::Parse(const uint8* Data, int64 Size, FMyWorldSnapshot& OutSnapshot, FString& OutError)
+{
+	OutSnapshot = FMyWorldSnapshot();
+
+	// The first fields are the same in every version.
+	FMySnapshotHeader Header;
+	if (!Data || Size < static_cast<int64>(offsetof(FMySnapshotHeader, DoorRecordSize)))
+	{
+		OutError = TEXT("too small for a header");
+		return false;
+	}
+	FMemory::Memcpy(&Header, Data, offsetof(FMySnapshotHeader, DoorRecordSize));
+
+	if (Header.Magic != FMySnapshotHeader::MagicValue)
+	{
+		OutError = TEXT("not a world snapshot");
+		return false;
+	}
+	if (Header.Version == 0 || Header.Version > FMySnapshotHeader::CurrentVersion)
+	{
+		OutError = FString::Printf(TEXT("version %u, this build reads up to %u"), Header.Version, FMySnapshotHeader::CurrentVersion);
+		return false;
+	}
+	if (Header.HeaderSize < FMySnapshotHeader::Version1Size || Size < Header.HeaderSize)
+	{
+		OutError = TEXT("bad header size");
+		return false;
+	}
+
+	// A later version's header is longer; read the part this build knows and skip the rest.
+	FMemory::Memcpy(&Header, Data, FMath::Min<uint32>(Header.HeaderSize, sizeof(FMySnapshotHeader)));
+
+	if (Header.Reserved != 0)
+	{
+		OutError = TEXT("bad reserved field");
+		return false;
+	}
+	if (Header.DoorRecordSize == 0 || Header.PlayerRecordSize == 0 || Header.SpawnRecordSize == 0)
+	{
+		OutError = TEXT("bad record size");
+		return false;
+	}
+	if (Header.NumDoors > MySnapshotMaxRecords || Header.NumPlayers > MySnapshotMaxRecords || Header.NumSpawns > MySnapshotMaxRecords)
+	{
+		OutError = TEXT("too many records");
+		return false;
+	}
+
+	// 64 bit: at most 3 * 2^20 records of up to 64 KiB each.
+	const uint64 PayloadSize = uint64(Header.NumDoors) * Header.DoorRecordSize + uint64(Header.NumPlayers) * Header.PlayerRecordSize + uint64(Header.NumSpawns) * Header.SpawnRecordSize;
+	if (uint64(Size) != Header.HeaderSize + PayloadSize)
+	{
+		OutError = TEXT("size does not match the record counts");
+		return false;
+	}
+
+	const uint8* Payload = Data + Header.HeaderSize;
+	if (FCrc::MemCrc32(Payload, static_cast<int32>(PayloadSize)) != Header.PayloadCrc)
+	{
+		OutError = TEXT("checksum mismatch");
+		return false;
+	}
+
+	OutSnapshot.MapId = Header.MapId;
+	Payload = MyWorldSnapshot::ReadRecords(Payload, Header.NumDoors, Header.DoorRecordSize, OutSnapshot.Doors);
+	Payload = MyWorldSnapshot::ReadRecords(Payload, Header.NumPlayers, Header.PlayerRecordSize, OutSnapshot.Players);
+	MyWorldSnapshot::ReadRecords(Payload, Header.NumSpawns, Header.SpawnRecordSize, OutSnapshot.Spawns);
+
+	if (!OutSnapshot.IsValid())
+	{
+		OutSnapshot = FMyWorldSnapshot();
+		OutError = TEXT("values out of range");
+		return false;
+	}
+	return true;
+}
+
+bool FMyWorldSnapshot::IsValid() const
+{
+	for (const FMySnapshotDoor& Door : Doors)
+	{
+		if (!FMath::IsFinite(Door.Pitch) || !FMath::IsFinite(Door.Yaw) || !FMath::IsFinite(Door.Roll) || Door.bIsOpen > 1)
+		{
+			return false;
+		}
+	}
+	for (const FMySnapshotPlayer& Player : Players)
+	{
+		if (!MyWorldSnapshot::IsValidStat(Player.Health, Player.MaximumHealth) || !MyWorldSnapshot::IsValidStat(Player.Stamina, Player.MaximumStamina))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool UMyWorldSnapshotSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return Super::ShouldCreateSubsystem(Outer) && World && World->IsGameWorld();
+}
+
+void UMyWorldSnapshotSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (InWorld.GetNetMode() == NM_Client) { return; }
+
+	FString RestoreName;
+	if (FParse::Value(FCommandLine::Get(), TEXT("MySnapshotRestore="), RestoreName))
+	{
+		LoadSnapshot(RestoreName);
+	}
+
+	if (GMySnapshotAutosaveSeconds > 0.0f)
+	{
+		if (FMyTimerWheel* Timers = UMyTimerSubsystem::GetTimerWheel(this))
+		{
+			Timers->SetTimer<&UMyWorldSnapshotSubsystem::Autosave>(AutosaveTimer, this, GMySnapshotAutosaveSeconds, true);
+		}
+	}
+}
+
+void UMyWorldSnapshotSubsystem::Deinitialize()
+{
+	if (FMyTimerWheel* Timers = UMyTimerSubsystem::GetTimerWheel(this))
+	{
+		Timers->ClearTimer(AutosaveTimer);
+	}
+	WriteTask.Wait();
+	PendingPlayers.Empty();
+
+	Super::Deinitialize();
+}
+
+FString UMyWorldSnapshotSubsystem::GetSnapshotPath(const FString& Name)
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Snapshots"), Name + TEXT(".snap"));
+}
+
+uint64 UMyWorldSnapshotSubsystem::GetMapId() const
+{
+	return MyWorldSnapshot::HashString(UWorld::RemovePIEPrefix(GetWorld()->GetOutermost()->GetName()));
+}
+
+void UMyWorldSnapshotSubsystem::CaptureSnapshot(FMyWorldSnapshot& OutSnapshot) const
+{
+	UWorld* World = GetWorld();
+	OutSnapshot.MapId = GetMapId();
+
+	for (TActorIterator<AMyBaseDoor> It(World); It; ++It)
+	{
+		const FRotator Rotation = It->GetDoorRotation();
+		FMySnapshotDoor& Door = OutSnapshot.Doors.AddDefaulted_GetRef();
+		Door.ActorId = MyWorldSnapshot::GetActorId(*It);
+		Door.Pitch = static_cast<float>(Rotation.Pitch);
+		Door.Yaw = static_cast<float>(Rotation.Yaw);
+		Door.Roll = static_cast<float>(Rotation.Roll);
+		Door.bIsOpen = It->bIsOpen ? 1 : 0;
+	}
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		const APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+		const UMyHealthComponent* Health = Pawn ? Pawn->FindComponentByClass<UMyHealthComponent>() : nullptr;
+		const UMyStaminaComponent* Stamina = Pawn ? Pawn->FindComponentByClass<UMyStaminaComponent>() : nullptr;
+		const uint64 PlayerId = AMyBaseGameMode::GetPersistentPlayerId(PlayerController);
+		if (!Health || !Stamina || PlayerId == 0) { continue; }
+
+		FMySnapshotPlayer& Player = OutSnapshot.Players.AddDefaulted_GetRef();
+		Player.PlayerId = PlayerId;
+		Player.MaximumHealth = Health->GetCurrentMaximumHealth();
+		Player.Health = FMath::Clamp(Health->GetCurrentHealth(), 0.0f, Player.MaximumHealth);
+		Player.MaximumStamina = Stamina->GetMaximumStamina();
+		Player.Stamina = FMath::Clamp(Stamina->GetCurrentStamina(), 0.0f, Player.MaximumStamina);
+	}
+
+	if (const AMyBaseGameMode* GameMode = World->GetAuthGameMode<AMyBaseGameMode>())
+	{
+		for (const TPair<TWeakObjectPtr<AActor>, uint64>& Occupant : GameMode->GetSpawnOccupants())
+		{
+			if (const AActor* PlayerStart = Occupant.Key.Get())
+			{
+				FMySnapshotSpawn& Spawn = OutSnapshot.Spawns.AddDefaulted_GetRef();
+				Spawn.ActorId = MyWorldSnapshot::GetActorId(PlayerStart);
+				Spawn.OccupantId = Occupant.Value;
+			}
+		}
+	}
+}
+
+void UMyWorldSnapshotSubsystem::SaveSnapshot(const FString& Name)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(UMyWorldSnapshotSubsystem::SaveSnapshot, ProjectChannel);
+	const double StartTime = FPlatformTime::Seconds();
+
+	FMyWorldSnapshot Snapshot;
+	CaptureSnapshot(Snapshot);
+
+	TArray<uint8> Data;
+	Snapshot.Serialize(Data);
+
+	UE_LOG(LogProject, Display, TEXT("Snapshot: captured '%s' (%d doors, %d players, %d spawns, %d bytes) in %.3f ms"),
+		*Name, Snapshot.Doors.Num(), Snapshot.Players.Num(), Snapshot.Spawns.Num(), Data.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	// Written next to the snapshot and moved over it, so a crash mid-write keeps the previous one.
+	const FString Path = GetSnapshotPath(Name);
+	WriteTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Path, Data = MoveTemp(Data)]()
+	{
+		const double WriteStartTime = FPlatformTime::Seconds();
+		const FString TempPath = Path + TEXT(".tmp");
+		if (!FFileHelper::SaveArrayToFile(Data, *TempPath) || !IFileManager::Get().Move(*Path, *TempPath, true, true))
+		{
+			UE_LOG(LogProject, Error, TEXT("Snapshot: failed to write %s"), *Path);
+			return;
+		}
+		UE_LOG(LogProject, Display, TEXT("Snapshot: wrote %s in %.3f ms"), *Path, (FPlatformTime::Seconds() - WriteStartTime) * 1000.0);
+	}, UE::Tasks::Prerequisites(WriteTask));
+}
+
+bool UMyWorldSnapshotSubsystem::LoadSnapshot(const FString& Name)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(UMyWorldSnapshotSubsystem::LoadSnapshot, ProjectChannel);
+
+	// A save of the same name may still be on its way to disk.
+	WriteTask.Wait();
+
+	const double StartTime = FPlatformTime::Seconds();
+	const FString Path = GetSnapshotPath(Name);
+
+	TUniquePtr<IMappedFileHandle> MappedFile(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	TUniquePtr<IMappedFileRegion> MappedRegion(MappedFile && MappedFile->GetFileSize() > 0 ? MappedFile->MapRegion(0, MappedFile->GetFileSize()) : nullptr);
+	if (!MappedRegion)
+	{
+		UE_LOG(LogProject, Warning, TEXT("Snapshot: could not map %s"), *Path);
+		return false;
+	}
+
+	FMyWorldSnapshot Snapshot;
+	FString Error;
+	const bool bParsed = FMyWorldSnapshot::Parse(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize(), Snapshot, Error);
+
+	// The region has to go before the file.
+	MappedRegion.Reset();
+	MappedFile.Reset();
+
+	if (!bParsed)
+	{
+		UE_LOG(LogProject, Warning, TEXT("Snapshot: rejected %s: %s"), *Path, *Error);
+		return false;
+	}
+	if (Snapshot.MapId != GetMapId())
+	{
+		UE_LOG(LogProject, Warning, TEXT("Snapshot: %s was taken on another map"), *Path);
+		return false;
+	}
+
+	ApplySnapshot(Snapshot);
+
+	UE_LOG(LogProject, Display, TEXT("Snapshot: restored '%s' (%d doors, %d players, %d spawns) in %.3f ms"),
+		*Name, Snapshot.Doors.Num(), Snapshot.Players.Num(), Snapshot.Spawns.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	return true;
+}
+
+void UMyWorldSnapshotSubsystem::ApplySnapshot(const FMyWorldSnapshot& Snapshot)
+{
+	UWorld* World = GetWorld();
+
+	TMap<uint64, const FMySnapshotDoor*> Doors;
+	Doors.Reserve(Snapshot.Doors.Num());
+	for (const FMySnapshotDoor& Door : Snapshot.Doors)
+	{
+		Doors.Add(Door.ActorId, &Door);
+	}
+	for (TActorIterator<AMyBaseDoor> It(World); It; ++It)
+	{
+		if (const FMySnapshotDoor* const* Door = Doors.Find(MyWorldSnapshot::GetActorId(*It)))
+		{
+			It->RestoreState((*Door)->bIsOpen != 0, FRotator((*Door)->Pitch, (*Door)->Yaw, (*Door)->Roll));
+		}
+	}
+
+	// Players in the game now get their state straight away, the others when they next spawn.
+	PendingPlayers.Reset();
+	PendingPlayers.Reserve(Snapshot.Players.Num());
+	for (const FMySnapshotPlayer& Player : Snapshot.Players)
+	{
+		PendingPlayers.Add(Player.PlayerId, Player);
+	}
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		ApplyPendingPlayerState(It->Get());
+	}
+
+	if (AMyBaseGameMode* GameMode = World->GetAuthGameMode<AMyBaseGameMode>())
+	{
+		TMap<uint64, uint64> Occupants;
+		Occupants.Reserve(Snapshot.Spawns.Num());
+		for (const FMySnapshotSpawn& Spawn : Snapshot.Spawns)
+		{
+			Occupants.Add(Spawn.ActorId, Spawn.OccupantId);
+		}
+
+		// Players who have a pawn stay where they are; the others start at their old player start when they come back.
+		TSet<uint64> PlayersInGame;
+		for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+		{
+			if (It->Get() && It->Get()->GetPawn())
+			{
+				PlayersInGame.Add(AMyBaseGameMode::GetPersistentPlayerId(It->Get()));
+			}
+		}
+
+		GameMode->ClearSpawnOccupants();
+		for (TActorIterator<APlayerStart> It(World); It; ++It)
+		{
+			if (const uint64* OccupantId = Occupants.Find(MyWorldSnapshot::GetActorId(*It)))
+			{
+				GameMode->RestoreSpawnOccupant(*It, *OccupantId, !PlayersInGame.Contains(*OccupantId));
+			}
+		}
+	}
+}
+
+void UMyWorldSnapshotSubsystem::ApplyPendingPlayerState(APlayerController* PlayerController)
+{
+	if (PendingPlayers.Num() == 0) { return; }
+
+	const uint64 PlayerId = AMyBaseGameMode::GetPersistentPlayerId(PlayerController);
+	if (const FMySnapshotPlayer* Player = PendingPlayers.Find(PlayerId))
+	{
+		if (ApplyPlayerState(PlayerController, *Player))
+		{
+			PendingPlayers.Remove(PlayerId);
+		}
+	}
+}
+
+bool UMyWorldSnapshotSubsystem::ApplyPlayerState(APlayerController* PlayerController, const FMySnapshotPlayer& Player)
+{
+	const APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+	UMyHealthComponent* Health = Pawn ? Pawn->FindComponentByClass<UMyHealthComponent>() : nullptr;
+	UMyStaminaComponent* Stamina = Pawn ? Pawn->FindComponentByClass<UMyStaminaComponent>() : nullptr;
+	if (!Health || !Stamina) { return false; }
+
+	// Maximum first, the current value is clamped against it.
+	Health->ServerSetCurrentMaximumHealth(Player.MaximumHealth);
+	Health->ServerSetCurrentHealth(Player.Health);
+	Stamina->ServerSetMaximumStamina(Player.MaximumStamina);
+	Stamina->ServerSetCurrentStamina(Player.Stamina);
+	return true;
+}
+
+void UMyWorldSnapshotSubsystem::Autosave()
+{
+	SaveSnapshot(TEXT("Autosave"));
+}
+
+namespace MyWorldSnapshot
+{
+	/* A snapshot with Count records of each type and random valid values. */
+	static void MakeRandomSnapshot(FRandomStream& Random, int32 Count, FMyWorldSnapshot& OutSnapshot)
+	{
+		OutSnapshot.MapId = (uint64(Random.GetUnsignedInt()) << 32) | Random.GetUnsignedInt();
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			FMySnapshotDoor& Door = OutSnapshot.Doors.AddDefaulted_GetRef();
+			Door.ActorId = (uint64(Random.GetUnsignedInt()) << 32) | Random.GetUnsignedInt();
+			Door.Yaw = Random.FRandRange(0.0f, 90.0f);
+			Door.bIsOpen = Random.RandRange(0, 1);
+
+			FMySnapshotPlayer& Player = OutSnapshot.Players.AddDefaulted_GetRef();
+			Player.PlayerId = (uint64(Random.GetUnsignedInt()) << 32) | Random.GetUnsignedInt();
+			Player.MaximumHealth = Random.FRandRange(1.0f, 200.0f);
+			Player.Health = Random.FRandRange(0.0f, Player.MaximumHealth);
+			Player.MaximumStamina = Random.FRandRange(1.0f, 200.0f);
+			Player.Stamina = Random.FRandRange(0.0f, Player.MaximumStamina);
+
+			FMySnapshotSpawn& Spawn = OutSnapshot.Spawns.AddDefaulted_GetRef();
+			Spawn.ActorId = (uint64(Random.GetUnsignedInt()) << 32) | Random.GetUnsignedInt();
+			Spawn.OccupantId = Player.PlayerId;
+		}
+	}
+
+	/* Corrupts Data the way a torn write, a bad disk or a hostile file would. */
+	static void Mutate(FRandomStream& Random, TArray<uint8>& Data)
+	{
+		switch (Random.RandRange(0, 5))
+		{
+		case 0: // flip a bit
+			if (Data.Num() > 0) { Data[Random.RandRange(0, Data.Num() - 1)] ^= uint8(1 << Random.RandRange(0, 7)); }
+			break;
+		case 1: // random byte
+			if (Data.Num() > 0) { Data[Random.RandRange(0, Data.Num() - 1)] = uint8(Random.RandRange(0, 255)); }
+			break;
+		case 2: // truncate
+			Data.SetNum(Random.RandRange(0, Data.Num()));
+			break;
+		case 3: // append garbage
+			for (int32 Count = Random.RandRange(1, 64); Count > 0; --Count) { Data.Add(uint8(Random.RandRange(0, 255))); }
+			break;
+		case 4: // random 32 bit value in the header (counts, sizes, version)
+			if (Data.Num() >= static_cast<int32>(sizeof(FMySnapshotHeader)))
+			{
+				const uint32 Value = Random.GetUnsignedInt();
+				FMemory::Memcpy(Data.GetData() + Random.RandRange(0, static_cast<int32>(sizeof(FMySnapshotHeader) / 4) - 1) * 4, &Value, sizeof(Value));
+			}
+			break;
+		default: // random float in the payload
+			if (Data.Num() >= static_cast<int32>(sizeof(FMySnapshotHeader) + 4))
+			{
+				const float Values[] = { -1.0f, 1.0e30f, std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity() };
+				const int32 Offset = Random.RandRange(static_cast<int32>(sizeof(FMySnapshotHeader)), Data.Num() - 4);
+				FMemory::Memcpy(Data.GetData() + Offset, &Values[Random.RandRange(0, static_cast<int32>(UE_ARRAY_COUNT(Values)) - 1)], sizeof(float));
+			}
+			break;
+		}
+	}
+
+	/* Recomputes the checksum, so mutations get past it and reach the rest of the validation. */
+	static void FixChecksum(TArray<uint8>& Data)
+	{
+		if (Data.Num() < static_cast<int32>(sizeof(FMySnapshotHeader))) { return; }
+
+		uint16 HeaderSize = 0;
+		FMemory::Memcpy(&HeaderSize, Data.GetData() + offsetof(FMySnapshotHeader, HeaderSize), sizeof(HeaderSize));
+		const int32 PayloadStart = FMath::Clamp<int32>(HeaderSize, sizeof(FMySnapshotHeader), Data.Num());
+
+		const uint32 Crc = FCrc::MemCrc32(Data.GetData() + PayloadStart, Data.Num() - PayloadStart);
+		FMemory::Memcpy(Data.GetData() + offsetof(FMySnapshotHeader, PayloadCrc), &Crc, sizeof(Crc));
+	}
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMySnapshotSave(
+	TEXT("Project.Snapshot.Save"),
+	TEXT("Saves the world's doors, player health and stamina and player start holders. Arguments: [Name=Default]."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		UMyWorldSnapshotSubsystem* Snapshots = World ? World->GetSubsystem<UMyWorldSnapshotSubsystem>() : nullptr;
+		if (!Snapshots || World->GetNetMode() == NM_Client)
+		{
+			Ar.Logf(TEXT("Snapshot: needs a standalone game or a server"));
+			return;
+		}
+		Snapshots->SaveSnapshot(Args.Num() > 0 ? Args[0] : TEXT("Default"));
+	}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMySnapshotLoad(
+	TEXT("Project.Snapshot.Load"),
+	TEXT("Restores a saved world snapshot in place. Arguments: [Name=Default]."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		UMyWorldSnapshotSubsystem* Snapshots = World ? World->GetSubsystem<UMyWorldSnapshotSubsystem>() : nullptr;
+		if (!Snapshots || World->GetNetMode() == NM_Client)
+		{
+			Ar.Logf(TEXT("Snapshot: needs a standalone game or a server"));
+			return;
+		}
+		Snapshots->LoadSnapshot(Args.Num() > 0 ? Args[0] : TEXT("Default"));
+	}));
+
+static FAutoConsoleCommandWithOutputDevice CmdMySnapshotFuzz(
+	TEXT("Project.Snapshot.Fuzz"),
+	TEXT("Feeds corrupted snapshots to the reader and checks that whatever it accepts writes back byte for byte and that it ")
+	TEXT("rejects every truncated or oversized file. Arguments: [Iterations=100000] [Seed=0]."),
+	FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, FOutputDevice& Ar)
+	{
+		const int32 Iterations = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100000;
+		FRandomStream Random(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 0);
+
+		FMyWorldSnapshot Original;
+		MyWorldSnapshot::MakeRandomSnapshot(Random, 16, Original);
+		TArray<uint8> OriginalData;
+		Original.Serialize(OriginalData);
+
+		// The unmodified data has to come back exactly.
+		FMyWorldSnapshot RoundTrip;
+		FString Error;
+		TArray<uint8> RoundTripData;
+		if (FMyWorldSnapshot::Parse(OriginalData.GetData(), OriginalData.Num(), RoundTrip, Error))
+		{
+			RoundTrip.Serialize(RoundTripData);
+		}
+		if (RoundTripData != OriginalData)
+		{
+			UE_LOG(LogProject, Error, TEXT("SnapshotFuzz: FAILED, round trip changed the snapshot (%s)"), *Error);
+			return;
+		}
+
+		// The header counts stay those of the original, so any other length is wrong, checksum fixed or not.
+		int64 AcceptedBadSize = 0;
+		TArray<uint8> Data;
+		FMyWorldSnapshot Snapshot;
+		for (int32 Size = 0; Size < OriginalData.Num(); ++Size)
+		{
+			Data = OriginalData;
+			Data.SetNum(Size);
+			AcceptedBadSize += FMyWorldSnapshot::Parse(Data.GetData(), Data.Num(), Snapshot, Error) ? 1 : 0;
+			MyWorldSnapshot::FixChecksum(Data);
+			AcceptedBadSize += FMyWorldSnapshot::Parse(Data.GetData(), Data.Num(), Snapshot, Error) ? 1 : 0;
+		}
+
+		int64 Accepted = 0;
+		int64 Rejected = 0;
+		int64 NotRoundTrip = 0;
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			Data = OriginalData;
+			for (int32 Mutations = Random.RandRange(1, 4); Mutations > 0; --Mutations)
+			{
+				MyWorldSnapshot::Mutate(Random, Data);
+			}
+			if (Random.FRand() < 0.5f)
+			{
+				MyWorldSnapshot::FixChecksum(Data);
+			}
+
+			if (FMyWorldSnapshot::Parse(Data.GetData(), Data.Num(), Snapshot, Error))
+			{
+				++Accepted;
+
+				// Whatever the reader takes in, it has to take in whole: writing it back gives the same bytes, unless
+				// the file has another header or record size than this build, which the writer doesn't keep.
+				const FMySnapshotHeader* Header = reinterpret_cast<const FMySnapshotHeader*>(Data.GetData());
+				const bool bCurrentLayout = Header->HeaderSize == sizeof(FMySnapshotHeader) && Header->DoorRecordSize == sizeof(FMySnapshotDoor) && Header->PlayerRecordSize == sizeof(FMySnapshotPlayer)
+					&& Header->SpawnRecordSize == sizeof(FMySnapshotSpawn);
+				Snapshot.Serialize(RoundTripData);
+				NotRoundTrip += bCurrentLayout && RoundTripData != Data ? 1 : 0;
+			}
+			else
+			{
+				++Rejected;
+			}
+
+			// Cutting the original short or padding it never makes it acceptable, whatever the checksum says.
+			Data = OriginalData;
+			if (Random.RandRange(0, 1) == 0)
+			{
+				Data.SetNum(Random.RandRange(0, Data.Num() - 1));
+			}
+			else
+			{
+				for (int32 Count = Random.RandRange(1, 64); Count > 0; --Count) { Data.Add(uint8(Random.RandRange(0, 255))); }
+			}
+			MyWorldSnapshot::FixChecksum(Data);
+			AcceptedBadSize += FMyWorldSnapshot::Parse(Data.GetData(), Data.Num(), Snapshot, Error) ? 1 : 0;
+		}
+
+		const double Seconds = FPlatformTime::Seconds() - StartTime;
+		if (NotRoundTrip > 0 || AcceptedBadSize > 0)
+		{
+			UE_LOG(LogProject, Error, TEXT("SnapshotFuzz: FAILED, %lld accepted snapshots wrote back different bytes, %lld truncated or oversized ones were accepted"),
+				NotRoundTrip, AcceptedBadSize);
+			return;
+		}
+		Ar.Logf(TEXT("SnapshotFuzz: PASSED, %d corrupted snapshots, %lld rejected, %lld accepted and written back unchanged, %.2f us per iteration"),
+			Iterations, Rejected, Accepted, Seconds / Iterations * 1.0e6);
+	}));
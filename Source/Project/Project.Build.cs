@@ -15,14 +15,25 @@ public class Project : ModuleRules
 			"InputCore",
 			"EnhancedInput",
 			"AIModule",
+			"NavigationSystem",
 			"StateTreeModule",
 			"GameplayStateTreeModule",
 			"UMG",
-			"Slate"
+			"Slate",
+			"NetCore",
+			"ReplicationGraph",
+			"SignificanceManager",
+			"AnimationBudgetAllocator",
+			"MassEntity",
+			"Mover",
+			"NetworkPrediction"
 		});
 
 		PrivateDependencyModuleNames.AddRange(new string[] { });
 
+		// Iris replication and the net serializers in MyNetSerializers.h
+		SetupIrisSupport(Target);
+
 		PublicIncludePaths.AddRange(new string[] {
 			"Project",
 		});
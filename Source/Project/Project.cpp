@@ -5,4 +5,6 @@
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Project, "Project" );
 
-DEFINE_LOG_CATEGORY(LogProject)
\ No newline at end of file
+DEFINE_LOG_CATEGORY(LogProject)
+
+UE_TRACE_CHANNEL_DEFINE(ProjectChannel);
\ No newline at end of file
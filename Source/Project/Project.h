@@ -3,6 +3,10 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Trace/Trace.h"
 
 /** Main log category used across the project */
-DECLARE_LOG_CATEGORY_EXTERN(LogProject, Log, All);
\ No newline at end of file
+DECLARE_LOG_CATEGORY_EXTERN(LogProject, Log, All);
+
+/** Trace channel "project" for project CPU scopes, switched on at startup with the hitch channels */
+UE_TRACE_CHANNEL_EXTERN(ProjectChannel, PROJECT_API);
\ No newline at end of file
@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * FMyAllocationCounter
+ *
+ * Counts heap allocations made on the current thread while a counting scope is open.
+ *
+ * Started with -MyCountAllocations, the project wraps GMalloc at startup in a proxy that forwards every call and,
+ * inside a scope, counts Malloc and Realloc calls that allocate. The proxy stays installed until exit because blocks
+ * allocated through it may still be freed later; outside a scope it only adds a thread local check per allocation.
+ * Without the switch nothing is counted and IsInstalled() is false.
+ */
+class PROJECT_API FMyAllocationCounter
+{
+public:
+	/* True when the game was started with -MyCountAllocations. */
+	static bool IsInstalled();
+
+	/* Returns the number of allocations counted on this thread since start up. */
+	static uint64 GetThreadAllocations();
+
+	/** Counts allocations on this thread while alive. Scopes nest. */
+	struct PROJECT_API FScope
+	{
+		FScope();
+		~FScope();
+	};
+
+	/** Stops counting on this thread while alive, for work inside a counted scope that should not count. */
+	struct PROJECT_API FPause
+	{
+		FPause();
+		~FPause();
+
+	private:
+		int32 SavedDepth;
+	};
+};
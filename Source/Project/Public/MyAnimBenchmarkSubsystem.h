@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MyAnimBenchmarkSubsystem.generated.h"
+
+class AMyBaseCharacter;
+
+/**
+ * UMyAnimBenchmarkSubsystem
+ *
+ * Animation cost benchmark, started with Project.Anim.Bench <Count> [Seconds].
+ *
+ * Spawns Count characters around the first player (or the world origin) and runs two phases of Seconds each:
+ * - Parallel: the normal setup. Measures game thread time spent ticking character meshes.
+ * - Serial: a.ParallelAnimEvaluation and a.ParallelAnimUpdate off, so the work normally done on task
+ *   threads runs inside the mesh tick. The difference to the parallel phase is the worker thread cost.
+ *   The budget allocator throttles the heavier serial ticks harder, so the phases run different numbers of
+ *   mesh ticks; they are compared per mesh tick and scaled to the parallel phase's tick count.
+ *
+ * Results are logged and appended to Saved/Profiling/AnimBench.csv together with the budget state,
+ * so runs with a.Budget.Enabled 0 and 1 can be compared. Works with -nullrhi; spawned meshes keep
+ * animating while not rendered.
+ */
+UCLASS()
+class PROJECT_API UMyAnimBenchmarkSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/* Spawns Count characters and starts the benchmark. */
+	void StartBenchmark(int32 Count, float PhaseSeconds, FOutputDevice& Ar);
+
+	bool IsRunning() const { return Phase != EPhase::Idle; }
+
+	/* True while a measured phase runs; UMyBudgetedMeshComponent of this world then reports its tick times. */
+	bool IsRecordingMeshTicks() const { return Phase == EPhase::Parallel || Phase == EPhase::Serial; }
+
+	/* Adds the game thread time of one mesh tick to the running phase. */
+	void RecordMeshTick(double Seconds)
+	{
+		MeshTickSeconds += Seconds;
+		++NumMeshTicks;
+	}
+
+private:
+	enum class EPhase : uint8
+	{
+		Idle,
+		Warmup,
+		Parallel,
+		Serial
+	};
+
+	/* Moves on to NewPhase and resets the per-phase counters. */
+	void EnterPhase(EPhase NewPhase);
+
+	/* Stores the results of the phase that just ended. */
+	void FinishPhase();
+
+	/* Logs and writes the results, restores the animation settings and destroys the spawned characters. */
+	void Finish();
+
+	/* Sets a.ParallelAnimEvaluation and a.ParallelAnimUpdate. */
+	void SetParallelAnimation(bool bParallel);
+
+	EPhase Phase = EPhase::Idle;
+	double PhaseStartTime = 0.0;
+	float PhaseSeconds = 10.0f;
+	int64 PhaseFrames = 0;
+	double PhaseFrameSeconds = 0.0;
+
+	/* Game thread time of this world's mesh ticks in the running phase. */
+	double MeshTickSeconds = 0.0;
+	int64 NumMeshTicks = 0;
+
+	/* Per frame averages of the finished phases, in milliseconds. */
+	double ParallelGameThreadMs = 0.0;
+	double ParallelFrameMs = 0.0;
+	double ParallelTicksPerFrame = 0.0;
+	double SerialGameThreadMs = 0.0;
+	double SerialFrameMs = 0.0;
+	double SerialTicksPerFrame = 0.0;
+
+	/* Animation settings to restore when the benchmark ends. */
+	int32 SavedParallelEvaluation = 1;
+	int32 SavedParallelUpdate = 1;
+
+	TArray<TWeakObjectPtr<AMyBaseCharacter>> SpawnedCharacters;
+};
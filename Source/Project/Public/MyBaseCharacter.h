@@ -5,7 +5,7 @@
 #include <MyStaminaComponent.h>
 #include "GameFramework/Character.h"
 #include "InputActionValue.h"
-#include "MyBaseWidget.h"  
+#include "MySignificanceManager.h"
 #include "MyBaseCharacter.generated.h"
 
 class UMyBaseMovementComponent;
@@ -23,64 +23,71 @@ public:
 
 protected:
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
     /** Camera boom positioning the camera behind the character */
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components", meta = (AllowPrivateAccess = "true"))
-    USpringArmComponent* CameraBoom;
+    TObjectPtr<USpringArmComponent> CameraBoom;
 
     /** Follow camera */
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components", meta = (AllowPrivateAccess = "true"))
-    UCameraComponent* FollowCamera;
+    TObjectPtr<UCameraComponent> FollowCamera;
 
     /** Custom Movement Component */
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Custom Movement", meta = (AllowPrivateAccess = "true"))
-    UMyBaseMovementComponent* MyMovement;
+    TObjectPtr<UMyBaseMovementComponent> MyMovement;
 
     /** Input Actions */
     UPROPERTY(EditAnywhere, Category = "Input")
-    UInputAction* JumpAction;
+    TObjectPtr<UInputAction> JumpAction;
 
     UPROPERTY(EditAnywhere, Category = "Input")
-    UInputAction* MoveAction;
+    TObjectPtr<UInputAction> MoveAction;
 
     UPROPERTY(EditAnywhere, Category = "Input")
-    UInputAction* LookAction;
+    TObjectPtr<UInputAction> LookAction;
 
     UPROPERTY(EditAnywhere, Category = "Input")
-    UInputAction* ChangePerspectiveAction;
+    TObjectPtr<UInputAction> ChangePerspectiveAction;
 
     UPROPERTY(EditAnywhere, Category = "Input")
-    UInputAction* SprintAction;
+    TObjectPtr<UInputAction> SprintAction;
 
     UPROPERTY(EditAnywhere, Category = "Input")
-    UInputAction* CrouchAction;
+    TObjectPtr<UInputAction> CrouchAction;
 
     UPROPERTY(EditAnywhere, Category = "Input")
-    UInputAction* InteractAction;
+    TObjectPtr<UInputAction> InteractAction;
 
     // Health component
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Health")
-    UMyHealthComponent* MyHealthComponent;
+    TObjectPtr<UMyHealthComponent> MyHealthComponent;
 
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stamina")
-    UMyStaminaComponent* MyStaminaComponent;
-
-    // Your widget class to spawn
-    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "UI")
-    TSubclassOf<UMyBaseWidget> WidgetClass;
-
-    // The instance of the widget
-    UPROPERTY()
-    UMyBaseWidget* WidgetInstance;
+    TObjectPtr<UMyStaminaComponent> MyStaminaComponent;
 
 
 public:
     virtual void Tick(float DeltaTime) override;
     virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
+
+    /* Feeds changed replicated properties into the network cost accounting. */
+    virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+    /* Feeds outgoing RPCs into the network cost accounting. */
+    virtual bool CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack) override;
     
     /* Returns a pointer to this character's custom movement component for direct access to movement functions and properties. */
     UMyBaseMovementComponent* GetMyBaseMovementComponent();
 
+    /* Applies the tick, animation, net update and cosmetic settings of a significance level. Called by UMySignificanceManager. */
+    void ApplySignificance(EMySignificanceLevel Level, const FMySignificanceLevelSettings& Settings);
+
+    /* Passes the raw significance score on to the animation budget allocator. Called by UMySignificanceManager every update. */
+    void SetAnimationSignificance(float Significance);
+
+    /* Returns the significance level this character is currently throttled to. */
+    EMySignificanceLevel GetSignificanceLevel() const { return SignificanceLevel; }
+
     /* The distance at which the character interacts with the object in first person. 
     When in ThirdPerson it also adds on the CameraDistance. */
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interaction")
@@ -98,6 +105,9 @@ public:
     void StartCrouching();
     /* Stops crouching (tells server we want to uncrouch). */
     void StopCrouching();
+    /* Client input handler: triggers interaction trace and calls server. Public for scripted input in load tests. */
+    UFUNCTION()
+    void OnInteract();
     /* Toggles between first-person and third-person camera. */
     void OnChangePerspective();
     /* Tracks whether the player is in third-person view (client-side only). */
@@ -110,7 +120,13 @@ protected:
     /* Server RPC: performs interaction with a target actor. */
     UFUNCTION(Server, Reliable)
     void Server_Interact(AActor* TargetActor);
-    /* Client input handler: triggers interaction trace and calls server. */
-    UFUNCTION()
-    void OnInteract();
+
+private:
+    /* Significance level currently applied. Characters start at full rate. */
+    EMySignificanceLevel SignificanceLevel = EMySignificanceLevel::High;
+
+    /* Settings from the class defaults that significance levels scale or switch off. */
+    float DefaultNetUpdateFrequency = 0.0f;
+    EVisibilityBasedAnimTickOption DefaultVisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+    bool bDefaultCastShadow = true;
 };
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "InteractiveInterface.h"
+#include "MyTimerWheel.h"
 #include "MyBaseDoor.generated.h"
 
 /**
@@ -36,13 +37,19 @@ public:
     /** Called every frame */
     virtual void Tick(float DeltaTime) override;
 
+    /** Feeds changed replicated properties into the network cost accounting */
+    virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
+    /** Feeds outgoing RPCs into the network cost accounting */
+    virtual bool CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack) override;
+
     /** The static mesh representing the door */
     UPROPERTY(VisibleAnywhere)
-    UStaticMeshComponent* DoorMesh;
+    TObjectPtr<UStaticMeshComponent> DoorMesh;
 
     /** The static mesh representing the doorframe. */
     UPROPERTY(VisibleAnywhere)
-    UStaticMeshComponent* DoorFrameMesh;
+    TObjectPtr<UStaticMeshComponent> DoorFrameMesh;
 
 
     /** The rotation of the door when closed */
@@ -80,7 +87,16 @@ public:
     UFUNCTION(Server, Reliable)
     void Server_ToggleDoor();
 
+    /** Current rotation of the door mesh relative to the frame; mid-swing while the door moves */
+    FRotator GetDoorRotation() const;
+
+    /**
+     * Puts the door back into a saved state: open or closed, with the mesh at DoorRotation.
+     * A door saved mid-swing keeps swinging towards its target. Server only.
+     */
+    void RestoreState(bool bOpen, const FRotator& DoorRotation);
+
 private:
-    /** Timer handle for door rotation updates */
-    FTimerHandle DoorTimerHandle;
+    /** Timer handle for door rotation updates, on the world's UMyTimerSubsystem */
+    FMyTimerHandle DoorTimerHandle;
 };
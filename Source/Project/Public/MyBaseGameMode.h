@@ -17,9 +17,35 @@ class PROJECT_API AMyBaseGameMode : public AGameMode
 public: 
 	AMyBaseGameMode(); 
 
-	/* Get a valid spawn location and rotation for a new player or respawn. */
-	FTransform GetSpawnPoint();
+	/* Releases the player start the leaving player held. */
+	virtual void Logout(AController* Exiting) override;
+
+	/* Get a valid spawn location and rotation for a new player or respawn, at a random player start, or at the start
+	 * a restored snapshot gave the player. The start is recorded as occupied by PlayerController's player. */
+	FTransform GetSpawnPoint(APlayerController* PlayerController = nullptr);
 
 	/* Respawn the pawn controlled by the given PlayerController. */
 	void RespawnActor(APlayerController* PlayerController);
+
+	/* Returns an id for Controller's player that survives reconnects and server restarts, made from the unique net id
+	 * (or the player name without one). 0 without a player state. */
+	static uint64 GetPersistentPlayerId(const AController* Controller);
+
+	/* Player starts and the persistent id of the player that last spawned at each. Saved in world snapshots. */
+	const TMap<TWeakObjectPtr<AActor>, uint64>& GetSpawnOccupants() const { return SpawnOccupants; }
+
+	/* Makes PlayerId the holder of PlayerStart, releasing whatever the player held before. */
+	void SetSpawnOccupant(AActor* PlayerStart, uint64 PlayerId);
+
+	/* Makes PlayerId the holder of PlayerStart from a restored snapshot. With bSpawnThere the player's next spawn is at
+	 * that start instead of a random one. */
+	void RestoreSpawnOccupant(AActor* PlayerStart, uint64 PlayerId, bool bSpawnThere);
+
+	void ClearSpawnOccupants() { SpawnOccupants.Reset(); RestoredSpawns.Reset(); }
+
+private:
+	TMap<TWeakObjectPtr<AActor>, uint64> SpawnOccupants;
+
+	/* Players whose next spawn is at the start they held in a restored snapshot. */
+	TSet<uint64> RestoredSpawns;
 };
\ No newline at end of file
@@ -3,9 +3,26 @@
 #include "CoreMinimal.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/Character.h"
+#include "MyMoveRecording.h"
+#include "MyCharacterTuning.h"
 #include "MyBaseMovementComponent.generated.h"
 
 class ACharacter;
+struct FMyBatchedMoveInput;
+struct FMyBatchedMoveResult;
+
+/**
+ * Movement inputs sent to the server with every move, one bit each, in the order they are written.
+ * Append new inputs before Num and never reorder; the bit count sent with the move keeps older builds readable.
+ */
+enum class EMyMoveInput : uint8
+{
+    Jump,
+    Crouch,
+    Sprint,
+
+    Num
+};
 
 /**
  * 
@@ -23,9 +40,15 @@ class PROJECT_API UMyBaseMovementComponent : public UCharacterMovementComponent
 
         typedef FSavedMove_Character Super;
 
+        /** The move recorder reads the saved values. */
+        friend class UMyBaseMovementComponent;
+
         /** Whether the player wanted to sprint at this frame (1-bit flag). */
         uint8 Saved_bWantsToSprint : 1;
 
+        /** Whether the character was crouched when this move started. Only used by the move recorder. */
+        uint8 Saved_bStartCrouched : 1;
+
         /**
          * Determines if two saved moves can be combined into one.
          * Used for network efficiency  if two moves are identical (same inputs/flags),
@@ -36,13 +59,6 @@ class PROJECT_API UMyBaseMovementComponent : public UCharacterMovementComponent
         /** Resets this saved move back to its default state. */
         virtual void Clear() override;
 
-        /**
-         * Returns compressed flags representing this moves state.
-         * Unreal packs common actions (jumping, crouching, etc.) into a byte,
-         * and here we extend that to include sprinting.
-         */
-        virtual uint8 GetCompressedFlags() const override;
-
         /**
          * Records data for this move (called when move is created on the client).
          * Saves acceleration, delta time, and custom flags such as sprinting.
@@ -54,6 +70,22 @@ class PROJECT_API UMyBaseMovementComponent : public UCharacterMovementComponent
          * Applies saved custom state (e.g., whether sprint was pressed).
          */
         virtual void PrepMoveFor(ACharacter* C) override;
+
+        /**
+         * Called after this move has been performed.
+         * Hands first time moves (not replays after a correction) to the move recorder when it is running.
+         */
+        virtual void PostUpdate(ACharacter* C, EPostUpdateMode PostUpdateMode) override;
+
+        /**
+         * Folds an older pending move into this one.
+         * The older move was already recorded, so the recorder replaces it with this one.
+         */
+        virtual void CombineWith(const FSavedMove_Character* OldMove, ACharacter* InCharacter, APlayerController* PC, const FVector& OldStartLocation) override;
+
+    public:
+        /** Returns the inputs of this move as EMyMoveInput bits. */
+        uint16 GetInputs() const;
     };
 
 
@@ -65,22 +97,89 @@ class PROJECT_API UMyBaseMovementComponent : public UCharacterMovementComponent
         /** Constructor: forwards to parent constructor. */
         FNetworkPredictionData_Client_MyData(const UCharacterMovementComponent& ClientMovement);
 
+        /** Releases every pointer to a pooled move before the pool goes away. */
+        virtual ~FNetworkPredictionData_Client_MyData();
+
         typedef FNetworkPredictionData_Client_Character Super;
 
-        /** Allocates a new FSavedMove_MyMove (instead of default FSavedMove_Character). */
+        /**
+         * Allocates a new FSavedMove_MyMove (instead of default FSavedMove_Character).
+         * The first call allocates MovePool and puts all of it in FreeMoves, where CreateSavedMove() takes moves
+         * from and FreeMove() returns them to. Only when every pooled move is in use does it fall back to the heap.
+         */
         virtual FSavedMovePtr AllocateNewMove() override;
+
+    private:
+        /** Every saved move of this client, allocated at once by the first AllocateNewMove(). */
+        TUniquePtr<FSavedMove_MyMove[]> MovePool;
     };
 
+    // One move as sent to the server by ServerMovePacked.
+    // Inputs travel as a packed EMyMoveInput bitfield instead of the compressed flags byte, horizontal
+    // acceleration as size and direction, and the pending and old moves as differences to the new move.
+    class FCharacterNetworkMoveData_MyData : public FCharacterNetworkMoveData
+    {
+    public:
+        typedef FCharacterNetworkMoveData Super;
+
+        /** EMyMoveInput bits of this move. */
+        uint16 Inputs = 0;
+
+        bool HasInput(EMyMoveInput Input) const;
+
+        /** Copies the saved move, including its inputs. */
+        virtual void ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType) override;
+
+        /** Writes or reads the move on its own. */
+        virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType) override;
+
+        /**
+         * Writes or reads the move. With a Reference (the new move of the same packet, already read) the time stamp,
+         * acceleration, control rotation and inputs are written relative to it.
+         */
+        bool SerializeRelative(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType, const FCharacterNetworkMoveData_MyData* Reference);
+    };
+
+    // Holds the new, pending and old move of one ServerMovePacked call.
+    class FCharacterNetworkMoveDataContainer_MyData : public FCharacterNetworkMoveDataContainer
+    {
+    public:
+        typedef FCharacterNetworkMoveDataContainer Super;
+
+        /** Points the container at our move data. */
+        FCharacterNetworkMoveDataContainer_MyData();
+
+        /** Same layout as the engine container, with the pending and old moves relative to the new move. */
+        virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap) override;
+
+    private:
+        FCharacterNetworkMoveData_MyData MyMoveData[3];
+    };
+
+    /** Move data of every ServerMovePacked call this component sends or receives. */
+    FCharacterNetworkMoveDataContainer_MyData MyNetworkMoveDataContainer;
+
     /** Runtime flag  true if the player wants to sprint (safe for client/server use). */
     bool Safe_bWantsToSprint;
 
-    /** Max speed while sprinting. */
-    UPROPERTY(EditDefaultsOnly)
-    float SprintSpeed;
+    /** Shared tuning with the walk, sprint and crouch speeds, DA_CharacterTuning by default; the defaults of FMyCharacterTuningValues without one. */
+    UPROPERTY(EditDefaultsOnly, Category = "Character Movement: Tuning")
+    TObjectPtr<UMyCharacterTuning> Tuning;
+
+    /** True while UMyBatchedMovementSubsystem moves this component instead of its own tick. */
+    bool bBatchedMovement;
+
+    /** Moves recorded since StartRecording(), null when not recording. */
+    TUniquePtr<FMyMoveRecording> MoveRecording;
+
+    /** Start state of a recorded move that was combined into the next one. */
+    TOptional<FMyRecordedMove> CombinedMoveStart;
 
-    /** Max speed while walking. */
-    UPROPERTY(EditDefaultsOnly)
-    float WalkSpeed;
+    /** Adds a performed saved move to MoveRecording. */
+    void RecordMove(const FSavedMove_MyMove& Move);
+
+    /** Removes the recorded move with this time stamp if it was the last one, keeping its start state. */
+    void DropRecordedMove(float TimeStamp);
 
 public:
     /** Default constructor  sets initial values. */
@@ -92,12 +191,43 @@ public:
      */
     virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
 
-protected:
+    /** Corrections received by locally controlled characters since start up. */
+    static int64 NumClientCorrections;
+
+    /** Saved moves allocated on the heap because a client's move pool was used up, since start up. */
+    static int64 NumHeapAllocatedMoves;
+
+    /** Counts the allocations of a locally controlled character's tick on a client for Project.Movement.AllocTest. */
+    virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+    /** Sends the moves; the RPC itself is left out of the allocation count. */
+    virtual void ServerMovePacked_ClientSend(const FCharacterServerMovePackedBits& PackedBits) override;
+
+    /** Counts the allocations of receiving and performing moves on the server for Project.Movement.AllocTest. */
+    virtual void ServerMovePacked_ServerReceive(const FCharacterServerMovePackedBits& PackedBits) override;
+
+    /** Counts the allocations of acks and corrections on the client for Project.Movement.AllocTest. */
+    virtual void MoveResponsePacked_ClientReceive(const FCharacterMoveResponsePackedBits& PackedBits) override;
+
+    /** Counts the correction and records its size in UMyMovementTelemetrySubsystem, then applies it as usual. */
+    virtual void ClientAdjustPosition_Implementation(float TimeStamp, FVector NewLoc, FVector NewVel, UPrimitiveComponent* NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode, TOptional<FRotator> OptionalRotation = TOptional<FRotator>()) override;
+
+    /** Server side: records every correction the client gets and its size in UMyMovementTelemetrySubsystem. */
+    virtual bool ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientWorldLocation, const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+
     /**
-     * Updates state based on compressed flags received from the client.
-     * Called on the server to apply sprinting/jumping/etc. from the clients input.
+     * Smooths a simulated proxy towards a new server position.
+     * On clients the smoothing distances come from the adaptive settings of the connection, and updates that
+     * are clamped or snap are recorded in UMyMovementTelemetrySubsystem.
      */
-    virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+    virtual void SmoothCorrection(const FVector& OldLocation, const FQuat& OldRotation, const FVector& NewLocation, const FQuat& NewRotation) override;
+
+protected:
+    /** Registers with UMyBatchedMovementSubsystem. */
+    virtual void BeginPlay() override;
+
+    /** Unregisters from UMyBatchedMovementSubsystem. */
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
     /**
      * Called every time movement is updated.
@@ -105,6 +235,22 @@ protected:
      */
     virtual void OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity) override;
 
+    /**
+     * Performs a single move received from the client on the server.
+     * Applies the sprint input from the move data and records the move and its payload size in the network cost
+     * accounting before simulating it.
+     */
+    virtual void ServerMove_PerformMovement(const FCharacterNetworkMoveData& MoveData) override;
+
+    /**
+     * Rounds horizontal acceleration to the size and direction steps FCharacterNetworkMoveData_MyData sends,
+     * so client and server simulate the same value.
+     */
+    virtual FVector RoundAcceleration(FVector InAccel) const override;
+
+    /** Stretches the interval between moves sent to the server on poor connections when adaptive mode is on. */
+    virtual float GetClientNetSendDeltaTime(const APlayerController* PC, const FNetworkPredictionData_Client_Character* ClientData, const FSavedMovePtr& NewMove) const override;
+
 public:
     /** Activates sprinting (sets the flag so saved moves will capture it). */
     void StartSprinting();
@@ -115,9 +261,68 @@ public:
     /* Returns the Safe_bWantsToSprint flag */
     bool IsSprinting() const;
 
+    /** Returns the tuning values this component uses. */
+    const FMyCharacterTuningValues& GetTuning() const { return UMyCharacterTuning::Get(Tuning); }
+
     /** Activates crouching (sets the flag so saved moves will capture it). */
     void StartCrouching();
 
     /** Deactivates crouching (resets the flag). */
     void StopCrouching();
+
+    /**
+     * Whether UMyBatchedMovementSubsystem can move this character.
+     * True for characters without a player that walk or fall on static ground, on the server or in standalone.
+     */
+    bool CanUseBatchedMovement() const;
+
+    /** Switches between the batched path and this component's own tick. */
+    void SetBatchedMovement(bool bEnable);
+
+    /** Returns the bBatchedMovement flag */
+    bool IsBatchedMovement() const;
+
+    /**
+     * Game thread part before a batched move.
+     * Applies crouch changes and consumes input like PerformMovement, then copies everything the move needs.
+     */
+    void GatherBatchedMove(float DeltaTime, FMyBatchedMoveInput& OutInput);
+
+    /**
+     * Game thread part after a batched move.
+     * Moves the capsule, updates floor and movement mode and runs OnMovementUpdated so sprint speed is applied.
+     */
+    void ApplyBatchedMove(const FMyBatchedMoveInput& Input, const FMyBatchedMoveResult& Result);
+
+    /**
+     * Runs the stock PerformMovement for a gathered move, writes where it ended to OutResult and puts the
+     * component back into the gathered state, for Project.Movement.Batch.Verify. Call between GatherBatchedMove
+     * and ApplyBatchedMove. Events the move fires, such as Landed, are not undone.
+     */
+    void RunReferenceMove(const FMyBatchedMoveInput& Input, FMyBatchedMoveResult& OutResult);
+
+    /** Starts recording the moves this locally controlled character sends to the server. */
+    void StartRecording();
+
+    /** Stops recording and writes the moves to FilePath. Returns the number of moves written, or -1 on failure. */
+    int32 StopRecording(const FString& FilePath);
+
+    /* Returns whether moves are being recorded */
+    bool IsRecording() const;
+
+    /**
+     * Runs a recorded client move through the server movement path (MoveAutonomous), as ServerMove would.
+     * With bResync the character is first put in the state the client started the move from, so each move is
+     * checked on its own; without it the server simulation runs on freely from the first move.
+     * Returns true if the server would have sent a correction for this move.
+     */
+    bool ReplayRecordedMove(const FMyRecordedMove& Move, bool bResync, float& OutDivergence, uint64& OutCycles);
+
+    /**
+     * Serializes Moves the way ServerMovePacked sends them, once with the engine's move data and once with
+     * FCharacterNetworkMoveData_MyData, as single moves and as new plus pending move pairs.
+     * Logs bytes per ServerMove for both, checks that our moves read back unchanged and appends the results to
+     * Saved/Profiling/MoveBandwidth.csv. Run with Project.Movement.MoveBandwidth.
+     */
+    static void MeasureMoveBandwidth(const TArray<FMyRecordedMove>& Moves, const FString& Label, FOutputDevice& Ar);
 };
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include <EnhancedInputSubsystems.h>
 #include "MyBasePlayerController.generated.h"
 
+class UMyBaseWidget;
+
 UCLASS()
 class PROJECT_API AMyBasePlayerController : public APlayerController
 {
@@ -15,15 +17,39 @@ public:
 
     virtual void BeginPlay() override;
 
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
     UFUNCTION(Server, Reliable)
     void ServerSpawnPlayer(APlayerController* PlayerController);
 
+    /** Feeds outgoing RPCs into the network cost accounting. */
+    virtual bool CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack) override;
+
+    /** Returns the HUD of a local player, null on the server for remote players. */
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "UI")
+    UMyBaseWidget* GetHUDWidget() const { return HUDWidget; }
+
 protected:
     /** Input Mapping Contexts */
     UPROPERTY(EditAnywhere, Category = "Input|Input Mappings")
-    TArray<UInputMappingContext*> DefaultMappingContexts;
+    TArray<TObjectPtr<UInputMappingContext>> DefaultMappingContexts;
 
     /** Input mapping context setup */
     virtual void SetupInputComponent() override;
 
+    /** HUD widget class, created once for a local player in BeginPlay. */
+    UPROPERTY(EditAnywhere, Category = "UI")
+    TSubclassOf<UMyBaseWidget> HUDWidgetClass;
+
+private:
+    /**
+     * The HUD lives as long as the controller. Its view-model rebinds to every new pawn,
+     * so respawning does not create widgets.
+     */
+    UPROPERTY(Transient)
+    TObjectPtr<UMyBaseWidget> HUDWidget;
+
+    /** Creates HUDWidget and adds it to the viewport. */
+    void CreateHUDWidget();
+
 };
\ No newline at end of file
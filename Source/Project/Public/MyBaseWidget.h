@@ -9,6 +9,8 @@
 #include "Components/CanvasPanelSlot.h"
 #include "MyBaseWidget.generated.h"
 
+class UMyHUDViewModel;
+
 /**
  * UMyBaseWidget
  *
@@ -18,7 +20,8 @@
  * Responsibilities:
  * - Update the health bar percentage when the player's health changes.
  * - Optionally change the health bar color based on percentage thresholds.
- * - Respond to health changes via a delegate binding.
+ * - Read health and stamina from a UMyHUDViewModel once per frame, and only touch the bars
+ *   when the shown value or color band changes.
  */
 UCLASS()
 class PROJECT_API UMyBaseWidget : public UUserWidget
@@ -40,22 +43,18 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Stamina")
 	void UpdateStaminaBar(float Percent);
 
-	/**
-	 * Handler function bound to the OnHealthChanged delegate of UMyHealthComponent.
-	 *
-	 * This function is called whenever the owning character's health changes.
-	 * It fetches the latest health percentage and updates the health bar accordingly.
-	 *
-	 * This allows the widget to automatically reflect health changes in real-time.
-	 */
-	UFUNCTION()
-	void OnHealthChangedHandler();
-
-	UFUNCTION()
-	void OnStaminaChangedHandler();
+	/* Returns the view-model of the owning player's health and stamina. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "HUD")
+	UMyHUDViewModel* GetViewModel() const { return ViewModel; }
 
 protected:
 
+	virtual void NativeConstruct() override;
+	virtual void NativeDestruct() override;
+
+	/* Applies the health and stamina changes of this frame. */
+	virtual void NativeTick(const FGeometry& MyGeometry, float InDeltaTime) override;
+
 	/**
 	 * HealthBar
 	 *
@@ -66,8 +65,18 @@ protected:
 	 * This is the UI element that visually displays the player's current health.
 	 */
 	UPROPERTY(meta = (BindWidget))
-	UProgressBar* HealthBar;
+	TObjectPtr<UProgressBar> HealthBar;
 
 	UPROPERTY(meta = (BindWidget))
-	UProgressBar* StaminaBar;
+	TObjectPtr<UProgressBar> StaminaBar;
+
+private:
+
+	UPROPERTY(Transient)
+	TObjectPtr<UMyHUDViewModel> ViewModel;
+
+	/* What the bars show, in 1/MyHUDPercentSteps steps, and the health color band; INDEX_NONE before the first update. */
+	int32 ShownHealthSteps = INDEX_NONE;
+	int32 ShownHealthBand = INDEX_NONE;
+	int32 ShownStaminaSteps = INDEX_NONE;
 };
@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CollisionQueryParams.h"
+#include "Engine/HitResult.h"
+#include "MyBatchedMovementSubsystem.generated.h"
+
+class UMyBaseMovementComponent;
+
+/**
+ * Everything one batched move needs, copied from the movement component on the game thread.
+ * Simulating a move reads nothing else, so moves can run on any thread and in any order.
+ */
+struct FMyBatchedMoveInput
+{
+	float DeltaTime = 0.0f;
+
+	FVector Location = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+	FVector Acceleration = FVector::ZeroVector;
+	bool bFalling = false;
+
+	/* Velocity asked for by path following, used instead of Acceleration when set. */
+	FVector RequestedVelocity = FVector::ZeroVector;
+	float RequestedSpeed = 0.0f;
+	bool bHasRequestedVelocity = false;
+
+	float MaxSpeed = 0.0f;
+	float MaxAcceleration = 0.0f;
+	float BrakingDeceleration = 0.0f;
+	float GroundFriction = 0.0f;
+	float BrakingFriction = 0.0f;
+	float AirControl = 0.0f;
+	float GravityZ = 0.0f;
+	float TerminalVelocity = 0.0f;
+	float MaxStepHeight = 0.0f;
+	float WalkableFloorZ = 0.0f;
+
+	float CapsuleRadius = 0.0f;
+	float CapsuleHalfHeight = 0.0f;
+	ECollisionChannel CollisionChannel = ECC_Pawn;
+	FCollisionQueryParams QueryParams;
+	FCollisionResponseParams ResponseParams;
+};
+
+/** Outcome of one batched move, applied to the movement component on the game thread. */
+struct FMyBatchedMoveResult
+{
+	FVector Location = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+	bool bFalling = false;
+
+	/* Was falling and touched a walkable floor this move. */
+	bool bLanded = false;
+
+	bool bWalkableFloor = false;
+	float FloorDistance = 0.0f;
+	FHitResult FloorHit;
+};
+
+/**
+ * UMyBatchedMovementSubsystem
+ *
+ * Moves every non player controlled character in one batch instead of one movement component tick each.
+ *
+ * Once per frame, on the game thread, each eligible UMyBaseMovementComponent copies its state and input
+ * into an FMyBatchedMoveInput (crouch changes happen here). Velocity integration, the collision sweeps and
+ * the floor checks of all characters then run in a ParallelFor. The world is not changed while the batch
+ * runs, so the scene queries only read. Results are applied back on the game thread, where
+ * OnMovementUpdated() runs so sprinting and crouching behave as in the normal path.
+ *
+ * Only walking and falling on static ground are batched. Characters that are player controlled, jumping,
+ * using root motion or standing on a moving base use their own tick again until that changes.
+ * Every move starts from last frame's positions of the other characters, so characters that walk into each
+ * other can overlap by up to one frame of movement.
+ *
+ * The moves are a simplified reimplementation of the character movement component, so the batch is off by
+ * default (Project.Movement.Batch.Enabled). Runs on the server or in standalone. Project.Movement.Batch.Stats
+ * shows the cost, Project.Movement.Batch.Verify compares every batched move with the stock
+ * UCharacterMovementComponent move from the same state.
+ */
+UCLASS()
+class PROJECT_API UMyBatchedMovementSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/* Called by movement components in BeginPlay and EndPlay. */
+	void Register(UMyBaseMovementComponent* Component);
+	void Unregister(UMyBaseMovementComponent* Component);
+
+	/* Runs one move. Thread safe as long as nothing changes the world while it runs. */
+	static void SimulateMove(const UWorld& World, const FMyBatchedMoveInput& Input, FMyBatchedMoveResult& OutResult);
+
+	/* Compares the moves of the next Frames batches with the stock movement component's. */
+	void StartVerify(int32 Frames);
+
+	/* Logs how many characters were batched and the time spent on each step last frame. */
+	void DumpStats(FOutputDevice& Ar) const;
+
+private:
+	/* Logs the result of the verify run. */
+	void FinishVerify();
+
+	TArray<TWeakObjectPtr<UMyBaseMovementComponent>> Components;
+
+	/* Per frame batch, kept to avoid reallocating. */
+	TArray<UMyBaseMovementComponent*> BatchComponents;
+	TArray<FMyBatchedMoveInput> BatchInputs;
+	TArray<FMyBatchedMoveResult> BatchResults;
+	TArray<FMyBatchedMoveResult> VerifyResults;
+
+	int32 NumBatched = 0;
+	double LastGatherSeconds = 0.0;
+	double LastSimulateSeconds = 0.0;
+	double LastApplySeconds = 0.0;
+
+	int32 VerifyFramesLeft = 0;
+	int64 VerifyMoves = 0;
+	int64 VerifyMismatches = 0;
+	double VerifySumError = 0.0;
+	double VerifyMaxError = 0.0;
+	double VerifyMaxVelocityError = 0.0;
+};
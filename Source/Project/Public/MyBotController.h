@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "MyNavQuerySubsystem.h"
+#include "MyBotController.generated.h"
+
+class AMyBaseCharacter;
+class UStateTree;
+class UStateTreeAIComponent;
+
+/**
+ * AMyBotController
+ *
+ * Server-side controller of an AMyBaseCharacter bot, driven by the BotStateTree.
+ *
+ * The StateTree component never ticks on its own. The controller registers with the world's UMyBotSubsystem on
+ * possess, which evaluates the trees of all bots under a shared per-frame budget, most significant bots first.
+ * Spawn bots with Project.Bots.Spawn [Count].
+ *
+ * Without a BotStateTree asset the bot runs a built-in behaviour under the same budget, made of the same actions
+ * as the Project|Bot tasks: wander to random navmesh locations, sprinting while stamina lasts, now and then
+ * walk to the closest closed door and open it, or crouch for a moment.
+ */
+UCLASS()
+class PROJECT_API AMyBotController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+	AMyBotController(const FObjectInitializer& ObjectInitializer);
+
+	/* Runs one evaluation of the StateTree, or of the built-in behaviour without one, covering DeltaTime. Called by UMyBotSubsystem. */
+	void TickBehaviour(float DeltaTime);
+
+	/* The StateTree asset; UMyBotSubsystem::GetStateTree() loads it. Without it the built-in behaviour runs. */
+	const TSoftObjectPtr<UStateTree>& GetBotStateTree() const { return BotStateTree; }
+
+	/* Whether the bot has a pawn and a running StateTree or built-in behaviour to evaluate. */
+	bool IsBehaviourRunning() const;
+
+	UStateTreeAIComponent* GetStateTreeComponent() const { return StateTreeComponent; }
+
+protected:
+	virtual void OnPossess(APawn* InPawn) override;
+	virtual void OnUnPossess() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/**
+	 * Behaviour of the bot. The Project|Bot tasks and conditions cover moving, sprinting, crouching, stamina
+	 * and doors.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "AI")
+	TSoftObjectPtr<UStateTree> BotStateTree;
+
+private:
+	enum class EActivity : uint8
+	{
+		Idle,
+		Wander,
+		OpenDoor,
+		Crouch,
+	};
+
+	/* One step of the built-in behaviour. */
+	void TickBuiltInBehaviour(float DeltaTime);
+
+	/* Queues a path to Destination and moves along it once it arrives. Returns false when there is no path. */
+	bool StartMoveTo(const FVector& Destination);
+
+	/* Follows the path requested by StartMoveTo(). Returns false while still on the way. */
+	bool UpdateMoveTo(bool& bOutArrived);
+
+	/* Sprints while moving and stamina lasts, like Bot Sprint. */
+	void UpdateSprint(AMyBaseCharacter* Character);
+
+	/* Stops moving, sprinting and crouching. */
+	void StopBuiltInBehaviour();
+
+	UPROPERTY(VisibleAnywhere, Category = "AI")
+	TObjectPtr<UStateTreeAIComponent> StateTreeComponent;
+
+	/* Built-in behaviour state, used when there is no BotStateTree. */
+	bool bBuiltInBehaviour = false;
+	EActivity Activity = EActivity::Idle;
+	float ActivityTime = 0.0f;
+	float ActivityDuration = 0.0f;
+	FVector MoveDestination = FVector::ZeroVector;
+	FMyNavQueryHandle PathQuery;
+	bool bMoving = false;
+	bool bSprinting = false;
+	bool bCrouching = false;
+	TWeakObjectPtr<AActor> DoorTarget;
+};
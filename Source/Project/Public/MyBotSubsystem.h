@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MySignificanceManager.h"
+#include "MyBotSubsystem.generated.h"
+
+class AMyBaseCharacter;
+class AMyBotController;
+class UStateTree;
+
+/**
+ * UMyBotSubsystem
+ *
+ * Time-slices the StateTree evaluation of every AMyBotController under one per-frame budget,
+ * Project.Bots.BudgetMs, so the number of bots doesn't decide the server frame time.
+ *
+ * Every frame each bot's priority is the time since its last evaluation scaled by the weight of its
+ * significance level, and bots are evaluated in priority order until the budget is spent. Bots near players
+ * are evaluated every frame while the budget allows; distant ones wait longer but age into the front of the
+ * queue, so nobody starves. A skipped bot catches up with the whole elapsed time on its next evaluation.
+ * At least one bot is evaluated per frame whatever the budget.
+ *
+ * Bots keep moving, sprinting and draining stamina between evaluations; only decisions are deferred.
+ * Runs on the server or in standalone. Use Project.Bots.Spawn to add bots and Project.Bots.Stats to see the cost.
+ */
+UCLASS()
+class PROJECT_API UMyBotSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/* Starts evaluating Bot's behaviour. Called from AMyBotController::OnPossess(). */
+	void RegisterBot(AMyBotController* Bot);
+
+	/* Stops evaluating Bot's behaviour. Safe to call while bots are being evaluated. */
+	void UnregisterBot(AMyBotController* Bot);
+
+	/* Returns Bot's StateTree, or null when its asset is unset or doesn't load. Each asset is loaded once per world,
+	 * the default bot's in Initialize(), so a missing asset isn't looked for again on every spawn. */
+	UStateTree* GetStateTree(const AMyBotController* Bot);
+
+	/* Spawns Count bot characters within Radius of Center. Fails with an error on Ar, spawning nothing, when the world has no navmesh. */
+	bool SpawnBots(int32 Count, const FVector& Center, float Radius, FOutputDevice& Ar);
+
+	/* Destroys every bot spawned by SpawnBots(). */
+	void ClearBots();
+
+	/* Logs the bot count, last frame's cost and the average time between evaluations per significance level since the last call. */
+	void DumpStats(FOutputDevice& Ar);
+
+private:
+	struct FBot
+	{
+		TWeakObjectPtr<AMyBotController> Controller;
+		EMySignificanceLevel Level = EMySignificanceLevel::High;
+		float WaitTime = 0.0f;
+		float Priority = 0.0f;
+	};
+
+	/* Returns the class spawned for bots. */
+	UClass* GetCharacterClass();
+
+	UPROPERTY(Transient)
+	TObjectPtr<UClass> CharacterClass;
+
+	/* StateTree assets by path, null for those that didn't load. */
+	UPROPERTY(Transient)
+	TMap<FSoftObjectPath, TObjectPtr<UStateTree>> StateTrees;
+
+	TArray<FBot> Bots;
+	TArray<TWeakObjectPtr<AMyBaseCharacter>> SpawnedBots;
+
+	int32 LastNumEvaluated = 0;
+	double LastEvaluateSeconds = 0.0;
+	double MaxEvaluateSeconds = 0.0;
+
+	/* Evaluations and summed wait times per significance level since the last DumpStats(). */
+	int64 LevelEvaluations[static_cast<int32>(EMySignificanceLevel::MAX)] = {};
+	double LevelWaitTime[static_cast<int32>(EMySignificanceLevel::MAX)] = {};
+};
@@ -0,0 +1,271 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StateTreeTaskBase.h"
+#include "StateTreeConditionBase.h"
+#include "MyNavQuerySubsystem.h"
+#include "MyBotTasks.generated.h"
+
+class AAIController;
+class AMyBaseCharacter;
+class UMyStaminaComponent;
+
+/**
+ * StateTree nodes of the AMyBotController bots, listed under Project|Bot.
+ *
+ * The Character context binds to the tree's context actor, so set the schema's Context Actor Class to
+ * BP_BaseCharacter. Everything runs on the server; movement, stamina and doors replicate as for players.
+ */
+
+/* Actions shared by the tasks and the built-in behaviour of AMyBotController. */
+namespace MyBot
+{
+	/* Returns the closest actor implementing IInteractiveInterface within Radius of Character, or null. */
+	PROJECT_API AActor* FindInteractable(const AMyBaseCharacter* Character, float Radius, bool bOnlyClosedDoors);
+
+	/* Interacts with Target as AMyBaseCharacter::Server_Interact does. Returns false when Target is further than MaxDistance. */
+	PROJECT_API bool Interact(AMyBaseCharacter* Character, AActor* Target, float MaxDistance);
+
+	/* Picks a random reachable navmesh location within Radius of Character. Returns false without a navmesh. */
+	PROJECT_API bool GetRandomLocation(const AMyBaseCharacter* Character, float Radius, FVector& OutLocation);
+}
+
+USTRUCT()
+struct FMyBotSprintTaskInstanceData
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Context")
+	TObjectPtr<AMyBaseCharacter> Character = nullptr;
+
+	/** Stamina fraction the bot needs to start sprinting. */
+	UPROPERTY(EditAnywhere, Category = "Parameter", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float StartStaminaPercent = 0.6f;
+
+	/** Stamina fraction at which the bot stops sprinting and the task succeeds. */
+	UPROPERTY(EditAnywhere, Category = "Parameter", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float StopStaminaPercent = 0.2f;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UMyStaminaComponent> Stamina = nullptr;
+};
+
+/**
+ * Sprints while the state is active. Fails when the bot is too tired to start and succeeds once stamina
+ * runs down to StopStaminaPercent, so the tree can move on to a resting state.
+ */
+USTRUCT(meta = (DisplayName = "Bot Sprint", Category = "Project|Bot"))
+struct PROJECT_API FMyBotSprintTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	using FInstanceDataType = FMyBotSprintTaskInstanceData;
+
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+	virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+};
+
+USTRUCT()
+struct FMyBotCrouchTaskInstanceData
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Context")
+	TObjectPtr<AMyBaseCharacter> Character = nullptr;
+
+	/** How long to stay crouched before the task succeeds. 0 crouches until the state is left. */
+	UPROPERTY(EditAnywhere, Category = "Parameter", meta = (ClampMin = "0.0"))
+	float Duration = 0.0f;
+
+	float ElapsedTime = 0.0f;
+};
+
+/**
+ * Crouches while the state is active.
+ */
+USTRUCT(meta = (DisplayName = "Bot Crouch", Category = "Project|Bot"))
+struct PROJECT_API FMyBotCrouchTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	using FInstanceDataType = FMyBotCrouchTaskInstanceData;
+
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+	virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+};
+
+USTRUCT()
+struct FMyBotFindInteractableTaskInstanceData
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Context")
+	TObjectPtr<AMyBaseCharacter> Character = nullptr;
+
+	/** How far around the bot to look. */
+	UPROPERTY(EditAnywhere, Category = "Parameter", meta = (ClampMin = "0.0"))
+	float SearchRadius = 1500.0f;
+
+	/** Ignore doors that are already open. */
+	UPROPERTY(EditAnywhere, Category = "Parameter")
+	bool bOnlyClosedDoors = true;
+
+	/** Closest actor implementing IInteractiveInterface. */
+	UPROPERTY(EditAnywhere, Category = "Output")
+	TObjectPtr<AActor> Target = nullptr;
+
+	/** Location of Target, for the Move To task. */
+	UPROPERTY(EditAnywhere, Category = "Output")
+	FVector TargetLocation = FVector::ZeroVector;
+};
+
+/**
+ * Finds the closest interactable (an AMyBaseDoor in practice) around the bot. Succeeds with Target set, fails
+ * when there is none in range.
+ */
+USTRUCT(meta = (DisplayName = "Bot Find Interactable", Category = "Project|Bot"))
+struct PROJECT_API FMyBotFindInteractableTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	using FInstanceDataType = FMyBotFindInteractableTaskInstanceData;
+
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+};
+
+USTRUCT()
+struct FMyBotInteractTaskInstanceData
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Context")
+	TObjectPtr<AMyBaseCharacter> Character = nullptr;
+
+	/** Actor to interact with, usually bound to the output of Bot Find Interactable. */
+	UPROPERTY(EditAnywhere, Category = "Input")
+	TObjectPtr<AActor> Target = nullptr;
+
+	/** How close the bot has to be to Target. */
+	UPROPERTY(EditAnywhere, Category = "Parameter", meta = (ClampMin = "0.0"))
+	float MaxDistance = 200.0f;
+};
+
+/**
+ * Interacts with Target through IInteractiveInterface, as AMyBaseCharacter::Server_Interact does for players.
+ * Fails when Target is missing or out of reach.
+ */
+USTRUCT(meta = (DisplayName = "Bot Interact", Category = "Project|Bot"))
+struct PROJECT_API FMyBotInteractTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	using FInstanceDataType = FMyBotInteractTaskInstanceData;
+
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+};
+
+USTRUCT()
+struct FMyBotRandomLocationTaskInstanceData
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Context")
+	TObjectPtr<AMyBaseCharacter> Character = nullptr;
+
+	/** How far from the bot the location may be. */
+	UPROPERTY(EditAnywhere, Category = "Parameter", meta = (ClampMin = "0.0"))
+	float Radius = 2000.0f;
+
+	/** Reachable location on the navmesh, for the Move To task. */
+	UPROPERTY(EditAnywhere, Category = "Output")
+	FVector Location = FVector::ZeroVector;
+};
+
+/**
+ * Picks a random reachable location around the bot to wander to. Fails without a navmesh.
+ */
+USTRUCT(meta = (DisplayName = "Bot Random Location", Category = "Project|Bot"))
+struct PROJECT_API FMyBotRandomLocationTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	using FInstanceDataType = FMyBotRandomLocationTaskInstanceData;
+
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+};
+
+USTRUCT()
+struct FMyBotMoveToTaskInstanceData
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Context")
+	TObjectPtr<AAIController> AIController = nullptr;
+
+	/** Where to go, usually bound to the output of Bot Random Location or Bot Find Interactable. */
+	UPROPERTY(EditAnywhere, Category = "Input")
+	FVector Destination = FVector::ZeroVector;
+
+	/** How close to Destination counts as arrived. */
+	UPROPERTY(EditAnywhere, Category = "Parameter", meta = (ClampMin = "0.0"))
+	float AcceptanceRadius = 50.0f;
+
+	FMyNavQueryHandle PathQuery;
+	bool bMoving = false;
+};
+
+/**
+ * Moves to Destination on a path from UMyNavQuerySubsystem instead of a synchronous path query, so bots
+ * deciding to move in the same frame don't cause a pathfinding spike. Succeeds on arrival, fails without a path.
+ */
+USTRUCT(meta = (DisplayName = "Bot Move To", Category = "Project|Bot"))
+struct PROJECT_API FMyBotMoveToTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	using FInstanceDataType = FMyBotMoveToTaskInstanceData;
+
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+	virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+};
+
+USTRUCT()
+struct FMyBotStaminaConditionInstanceData
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Context")
+	TObjectPtr<AMyBaseCharacter> Character = nullptr;
+
+	/** Stamina fraction the bot needs for the condition to pass. */
+	UPROPERTY(EditAnywhere, Category = "Parameter", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float MinStaminaPercent = 0.5f;
+};
+
+/**
+ * Passes when the bot has at least MinStaminaPercent stamina.
+ */
+USTRUCT(meta = (DisplayName = "Bot Has Stamina", Category = "Project|Bot"))
+struct PROJECT_API FMyBotStaminaCondition : public FStateTreeConditionCommonBase
+{
+	GENERATED_BODY()
+
+	using FInstanceDataType = FMyBotStaminaConditionInstanceData;
+
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+	virtual bool TestCondition(FStateTreeExecutionContext& Context) const override;
+
+	UPROPERTY(EditAnywhere, Category = "Parameter")
+	bool bInvert = false;
+};
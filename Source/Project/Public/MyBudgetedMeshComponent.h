@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "MyBudgetedMeshComponent.generated.h"
+
+/**
+ * UMyBudgetedMeshComponent
+ *
+ * Character mesh that is ticked by the animation budget allocator.
+ * The allocator caps the total animation time per frame (a.Budget.BudgetMs) and, once over budget, skips
+ * and interpolates the least significant meshes first.
+ *
+ * Significance is not calculated by the allocator; UMySignificanceManager passes it in through
+ * AMyBaseCharacter so the same score drives animation and the rest of the character's throttling.
+ * Meshes of locally controlled characters are taken out of the allocator and tick normally; they go back in
+ * when the character stops being locally controlled.
+ *
+ * On a dedicated server (Project.Anim.ServerStalePoses 1) the mesh does not tick at all and its pose
+ * stays stale. Code that needs bones calls EnsurePoseEvaluated(), which evaluates the pose at most once per
+ * frame. GetSocketTransformOnRewoundComponent() also moves the component back to where it was at a given time
+ * using a short history of component transforms; only the component is rewound, not the pose.
+ * Project.Anim.RewindSockets shows how far that puts sockets from their current place.
+ */
+UCLASS(ClassGroup = (Rendering), meta = (BlueprintSpawnableComponent))
+class PROJECT_API UMyBudgetedMeshComponent : public USkeletalMeshComponentBudgeted
+{
+	GENERATED_BODY()
+
+public:
+	UMyBudgetedMeshComponent(const FObjectInitializer& ObjectInitializer);
+
+	virtual void BeginPlay() override;
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/* Passes Significance to the animation budget allocator, or takes the mesh out of it while locally controlled. Does nothing if the allocator is disabled. */
+	void SetBudgetSignificance(float Significance, bool bLocallyControlled);
+
+	/* Returns true if this mesh is currently managed by an enabled animation budget allocator. */
+	bool IsBudgeted() const;
+
+	/** Keep animating while not rendered. Used by the headless benchmark; the budget still applies. */
+	bool bTickEvenIfNotRendered = false;
+
+	/* Returns true if this mesh only evaluates its pose on demand (dedicated server). */
+	bool UsesStalePoses() const { return bStalePoses; }
+
+	/* Evaluates the pose if it is stale. Evaluates at most once per frame; does nothing if the mesh ticks normally. */
+	void EnsurePoseEvaluated();
+
+	/**
+	 * Returns the world transform of a socket or bone in the current pose, on the component placed where it was at
+	 * Timestamp (world time in seconds). This is a component-only rewind: bone transforms are not kept, so a socket
+	 * that moves relative to the component (a swinging arm) is where the current pose has it. Good enough for
+	 * sockets that follow the capsule, not for lag compensated hits on limbs. The history is only recorded with
+	 * stale poses; otherwise this is the current socket transform.
+	 */
+	FTransform GetSocketTransformOnRewoundComponent(FName SocketName, double Timestamp);
+
+	/* Returns the component to world transform at Timestamp, interpolated from the transform history. */
+	FTransform GetComponentTransformAtTime(double Timestamp) const;
+
+	/* Number of on demand pose evaluations of this mesh. */
+	int64 GetNumOnDemandEvaluations() const { return NumOnDemandEvaluations; }
+
+protected:
+	virtual void OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport) override;
+
+private:
+	/** Component transform at a point in time. */
+	struct FTransformSample
+	{
+		double Time = 0.0;
+		FTransform Transform;
+	};
+
+	/* Ring buffer of recent component transforms, only recorded while using stale poses. */
+	static constexpr int32 MaxTransformSamples = 32;
+	FTransformSample TransformHistory[MaxTransformSamples];
+	int32 TransformHistoryHead = 0;
+	int32 TransformHistoryNum = 0;
+
+	bool bStalePoses = false;
+	int64 NumOnDemandEvaluations = 0;
+	uint64 LastPoseFrame = 0;
+	double LastPoseTime = 0.0;
+};
@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "MyCharacterTuning.generated.h"
+
+class UMyCharacterTuning;
+
+/**
+ * Balancing values of one character archetype, packed together so systems that walk many characters read
+ * them from one cache line.
+ */
+USTRUCT(BlueprintType)
+struct PROJECT_API FMyCharacterTuningValues
+{
+	GENERATED_BODY()
+
+	/** Max speed while walking. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement", meta = (ClampMin = "0", ForceUnits = "cm/s"))
+	float WalkSpeed = 250.0f;
+
+	/** Max speed while sprinting. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement", meta = (ClampMin = "0", ForceUnits = "cm/s"))
+	float SprintSpeed = 500.0f;
+
+	/** Max speed while crouched. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement", meta = (ClampMin = "0", ForceUnits = "cm/s"))
+	float CrouchSpeed = 250.0f;
+
+	/** Seconds between stamina drain or regeneration steps. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Stamina", meta = (ClampMin = "0.01", ForceUnits = "s"))
+	float RegenTime = 1.0f;
+
+	/** Stamina taken every RegenTime while sprinting. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Stamina", meta = (ClampMin = "0"))
+	float DrainAmount = 1.0f;
+
+	/** Stamina given back every RegenTime while not sprinting. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Stamina", meta = (ClampMin = "0"))
+	float FillAmount = 1.0f;
+
+	/** Used by components without a tuning asset. */
+	static const FMyCharacterTuningValues Default;
+};
+
+static_assert(sizeof(FMyCharacterTuningValues) == 6 * sizeof(float), "FMyCharacterTuningValues should stay plain floats");
+
+#if !UE_BUILD_SHIPPING
+DECLARE_MULTICAST_DELEGATE_OneParam(FMyOnCharacterTuningChanged, const UMyCharacterTuning*);
+#endif
+
+/**
+ * UMyCharacterTuning
+ *
+ * Tuning of one character archetype, shared read-only by every UMyBaseMovementComponent, UMyStaminaComponent
+ * and UMyMoverWalkingMode that references it. The asset is loaded once with the first Blueprint that references it,
+ * so characters carry a pointer instead of their own copy, and balancing changes are content changes.
+ * Components start out with DA_CharacterTuning (LoadDefault()); a Blueprint can point them at another asset.
+ *
+ * Components read the values when they use them, so edits apply to running characters: in the editor through
+ * the details panel, in development builds with Project.Tuning.Set <Asset> <Field> <Value>.
+ * Project.Tuning.Dump lists the loaded assets.
+ */
+UCLASS(BlueprintType, Const)
+class PROJECT_API UMyCharacterTuning : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tuning", meta = (ShowOnlyInnerProperties))
+	FMyCharacterTuningValues Values;
+
+	/* Loads DA_CharacterTuning, the tuning components start out with. Call it from constructors only, for the class default object and archetypes; instances copy the pointer from their archetype. */
+	static UMyCharacterTuning* LoadDefault();
+
+	/* Returns the values of Tuning, or the defaults without one. */
+	static const FMyCharacterTuningValues& Get(const UMyCharacterTuning* Tuning)
+	{
+		return Tuning ? Tuning->Values : FMyCharacterTuningValues::Default;
+	}
+
+#if !UE_BUILD_SHIPPING
+	/* Broadcast after the values of a tuning asset were changed at runtime. */
+	static FMyOnCharacterTuningChanged OnTuningChanged;
+#endif
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+};
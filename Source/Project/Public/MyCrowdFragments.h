@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "MyCrowdFragments.generated.h"
+
+/**
+ * Fragments of the ambient crowd entities managed by UMyCrowdSubsystem.
+ * Each one is stored in its own array per archetype chunk, so processors only touch the data they read.
+ */
+
+/** Where the entity is and which way it faces. */
+USTRUCT()
+struct FMyCrowdTransformFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FVector Location = FVector::ZeroVector;
+	float Yaw = 0.0f;
+};
+
+/** How fast and in which direction the entity walks. */
+USTRUCT()
+struct FMyCrowdVelocityFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FVector Velocity = FVector::ZeroVector;
+};
+
+/** Area the entity wanders in. */
+USTRUCT()
+struct FMyCrowdWanderFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FVector Home = FVector::ZeroVector;
+	float Radius = 1000.0f;
+};
+
+/**
+ * Health and stamina of the entity.
+ * Absolute values are kept so they can be written back to UMyHealthComponent and UMyStaminaComponent
+ * when the entity turns into an actor.
+ */
+USTRUCT()
+struct FMyCrowdVitalsFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	float Health = 100.0f;
+	float MaximumHealth = 100.0f;
+	float Stamina = 100.0f;
+	float MaximumStamina = 100.0f;
+
+	float GetHealthFraction() const { return MaximumHealth > 0.0f ? Health / MaximumHealth : 0.0f; }
+};
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "MassEntityQuery.h"
+#include "MyCrowdMovementProcessor.generated.h"
+
+/**
+ * UMyCrowdMovementProcessor
+ *
+ * Moves ambient crowd entities, regenerates their stamina and finds the ones that came close
+ * enough to a viewer to be turned into actors. Chunks are processed in parallel.
+ *
+ * Not registered with the processing phases; UMyCrowdSubsystem runs it once per frame after
+ * filling in ViewerLocations, then reads EntitiesToSwapIn on the game thread.
+ */
+UCLASS()
+class PROJECT_API UMyCrowdMovementProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	UMyCrowdMovementProcessor();
+
+	/** Locations of every player pawn, set by the subsystem before each run. */
+	TArray<FVector> ViewerLocations;
+
+	/** Entities closer than this to any viewer, horizontally, are reported in EntitiesToSwapIn. */
+	float SwapInDistance = 3000.0f;
+
+	/** Stamina regenerated per second, matching UMyStaminaComponent's regen. */
+	float StaminaRegenPerSecond = 1.0f;
+
+	/** Entities that should become actors, filled while running. */
+	TArray<FMassEntityHandle> EntitiesToSwapIn;
+
+protected:
+	virtual void ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager) override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+	FMassEntityQuery EntityQuery;
+
+	/* Guards EntitiesToSwapIn while chunks run in parallel. */
+	FCriticalSection SwapInLock;
+};
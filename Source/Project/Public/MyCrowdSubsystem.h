@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MassEntityTypes.h"
+#include "MyCrowdSubsystem.generated.h"
+
+class AMyBaseCharacter;
+class UMyCrowdMovementProcessor;
+struct FMassEntityManager;
+
+/**
+ * UMyCrowdSubsystem
+ *
+ * Level of detail tier for ambient characters.
+ *
+ * Far away characters exist only as Mass entities (see MyCrowdFragments.h) that are moved in parallel by
+ * UMyCrowdMovementProcessor. When an entity comes within Project.Crowd.SwapInDistance of a player it is
+ * replaced by a full AMyBaseCharacter, and when that character is further than Project.Crowd.SwapOutDistance
+ * from every player it goes back to being an entity. Health and stamina are carried over both ways.
+ *
+ * Entities walk flat and keep the height they were created at, which is projected to the navmesh (or the first
+ * surface below without one); a swapped in character is put on the ground below its entity and possessed by an
+ * AAIController that walks it to random reachable points of its wander area.
+ *
+ * Players get close enough to swap a character in long before they can interact with it, so anything
+ * that can be interacted with is always an actor.
+ *
+ * Runs on the server or in standalone; clients only ever see the replicated actors.
+ * Use Project.Crowd.Spawn to populate a map and Project.Crowd.Stats to see the cost.
+ */
+UCLASS()
+class PROJECT_API UMyCrowdSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/* Creates Count crowd entities wandering within Radius of Center. */
+	void SpawnCrowd(int32 Count, const FVector& Center, float Radius);
+
+	/* Destroys every crowd entity and crowd actor. */
+	void ClearCrowd();
+
+	/* Logs entity and actor counts and the time spent on the crowd last frame. */
+	void DumpStats(FOutputDevice& Ar) const;
+
+private:
+	/** A crowd character that currently exists as an actor. */
+	struct FCrowdActor
+	{
+		TWeakObjectPtr<AMyBaseCharacter> Character;
+		FVector Home = FVector::ZeroVector;
+		float Radius = 0.0f;
+		double SwapInTime = 0.0;
+	};
+
+	/* Returns the entity manager of this world. */
+	FMassEntityManager& GetEntityManager() const;
+
+	/* Replaces an entity with an actor. */
+	void SwapIn(FMassEntityHandle Entity);
+
+	/* Replaces an actor with an entity. */
+	void SwapOut(const FCrowdActor& CrowdActor);
+
+	/* Sends an idle crowd character to a random reachable point of its wander area. */
+	void Wander(const FCrowdActor& CrowdActor) const;
+
+	/* Moves InOutLocation down or up onto the navmesh, or onto the first surface below. False if neither was found. */
+	bool ProjectToGround(FVector& InOutLocation) const;
+
+	/* Creates one entity with the given state. */
+	FMassEntityHandle CreateEntity(const FVector& Location, float Yaw, const FVector& Velocity, const FVector& Home, float Radius, float Health, float MaximumHealth, float Stamina, float MaximumStamina);
+
+	/* Returns the class spawned for swapped in characters. */
+	UClass* GetCharacterClass();
+
+	UPROPERTY(Transient)
+	TObjectPtr<UMyCrowdMovementProcessor> MovementProcessor;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UClass> CharacterClass;
+
+	FMassArchetypeHandle CrowdArchetype;
+
+	TArray<FCrowdActor> CrowdActors;
+
+	int32 NumEntities = 0;
+	double LastProcessSeconds = 0.0;
+	double LastSwapSeconds = 0.0;
+};
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "MyStatEvents.h"
+#include "MyHUDViewModel.generated.h"
+
+class APawn;
+class APlayerController;
+class UMyHealthComponent;
+class UMyStaminaComponent;
+
+/**
+ * UMyHUDViewModel
+ *
+ * Health and stamina of a player's current pawn for the HUD.
+ *
+ * Follows the possessed pawn of one player controller and keeps direct references to its health and stamina
+ * components, rebinding their change events whenever the controller gets a new pawn. Change events only store the
+ * latest value; the HUD reads them once per frame with ConsumeHealth() / ConsumeStamina(), so any number of changes
+ * in a frame cost one widget update.
+ */
+UCLASS()
+class PROJECT_API UMyHUDViewModel : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/* Starts following PlayerController's pawn. */
+	void Initialize(APlayerController* PlayerController);
+
+	/* Stops following the pawn and unbinds from its components. */
+	void Deinitialize();
+
+	/**
+	 * Returns true if health changed since the last call, with the latest health in OutPercent.
+	 * Also true right after binding a pawn, so the HUD starts from its values.
+	 */
+	bool ConsumeHealth(float& OutPercent);
+
+	/* Like ConsumeHealth(), for stamina. */
+	bool ConsumeStamina(float& OutPercent);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "HUD")
+	float GetHealthPercent() const { return HealthPercent; }
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "HUD")
+	float GetStaminaPercent() const { return StaminaPercent; }
+
+private:
+	/* Unbinds from the current components and binds to Pawn's, if it has any. */
+	void BindPawn(APawn* Pawn);
+
+	void UnbindPawn();
+
+	void OnNewPawn(APawn* Pawn);
+
+	void OnHealthChanged(const FMyStatChange& Change);
+
+	void OnStaminaChanged(const FMyStatChange& Change);
+
+	TWeakObjectPtr<APlayerController> PlayerController;
+	TWeakObjectPtr<UMyHealthComponent> HealthComponent;
+	TWeakObjectPtr<UMyStaminaComponent> StaminaComponent;
+
+	FDelegateHandle NewPawnHandle;
+	FDelegateHandle HealthChangedHandle;
+	FDelegateHandle StaminaChangedHandle;
+
+	float HealthPercent = 0.0f;
+	float StaminaPercent = 0.0f;
+	bool bHealthChanged = false;
+	bool bStaminaChanged = false;
+};
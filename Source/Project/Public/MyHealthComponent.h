@@ -4,9 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "MyNetSerializers.h"
+#include "MyStatEvents.h"
 #include "MyHealthComponent.generated.h"
 
-DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnHealthChanged);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnHealthChanged, const FMyStatChange&, Change);
 
 UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
 class PROJECT_API UMyHealthComponent : public UActorComponent
@@ -17,15 +19,22 @@ public:
 	// Sets default values for this component's properties
 	UMyHealthComponent();
 
+	/* Feeds changed replicated properties into the network cost accounting. */
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
+	/* Feeds outgoing RPCs into the network cost accounting. */
+	virtual bool CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack) override;
+
 private:
+	/* Health values are sent quantized to 1/100; the server keeps full precision. */
 	UPROPERTY(Replicated)
-	float BaseCurrentHealth;
+	FMyQuantizedFloat BaseCurrentHealth;
 
 	UPROPERTY(ReplicatedUsing = OnRep_CurrentHealth)
-	float CurrentHealth;
+	FMyQuantizedFloat CurrentHealth;
 
 	UPROPERTY(Replicated)
-	float CurrentMaximumHealth;
+	FMyQuantizedFloat CurrentMaximumHealth;
 
 	UPROPERTY(Replicated)
 	bool bIsActorDead;
@@ -33,13 +42,28 @@ private:
 	UPROPERTY(Replicated)
 	bool bIsActorHealable;
 
+	/* Health last sent to listeners, the old value of the next change event. */
+	float NotifiedHealth;
+
 	UFUNCTION()
 	void OnRep_CurrentHealth();
 
+	/* Marks every replicated health property dirty for push model replication. */
+	void MarkReplicatedStateDirty();
+
 public:
 
 	/*=========================== Delegates ===============================*/
 
+	/**
+	 * Native health change event, broadcast by UpdateHealthStatus() with the old and new health, delta and cause.
+	 * C++ listeners bind here.
+	 */
+	FMyStatChangedEvent OnHealthChangedNative;
+
+	/**
+	 * Blueprint version of OnHealthChangedNative, only broadcast while something is bound.
+	 */
 	UPROPERTY(BlueprintAssignable, Category = "Health|Event")
 	FOnHealthChanged OnHealthChanged;
 
@@ -307,11 +331,14 @@ public:
 	 * Updates the internal health status of the actor.
 	 *
 	 * This function checks whether the actor is dead and updates the bIsActorDead flag.
-	 * It also broadcasts the OnHealthChanged event for any listeners (e.g., UI, gameplay systems).
+	 * It also broadcasts OnHealthChangedNative and OnHealthChanged for any listeners (e.g., UI, gameplay systems),
+	 * with the health from the previous call as the old value.
 	 *
 	 * Typically called automatically by server-authoritative modifier functions after a health change.
 	 * Can also be called manually if you modify health directly.
+	 *
+	 * @param Cause Why health changed, passed on to the listeners.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Health|Status")
-	void UpdateHealthStatus();
+	void UpdateHealthStatus(EMyStatChangeCause Cause = EMyStatChangeCause::Unknown);
 };
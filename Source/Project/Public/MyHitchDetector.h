@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * FMyHitchDetector
+ *
+ * On in game builds with trace, never in the editor. Times every frame and, when one takes longer than
+ * Project.Hitch.ThresholdMs while a game world is playing, writes the trace tail, the last few seconds of frames and
+ * bookmarks, to Saved/Profiling/Hitches/Hitch_<time>.utrace, with the project counters of that moment next to it in
+ * a .txt and a row in Saved/Profiling/Hitches.csv. Open the .utrace in Unreal Insights and look left of the "Hitch"
+ * bookmark.
+ *
+ * The rolling buffer is the engine's trace tail, a fixed-size ring (-tracetailmb=N, 4 MB by default) kept even
+ * without a trace connection, so memory stays bounded however long the game runs. The channels in
+ * Project.Hitch.Channels are switched on at startup. By default these are frame, bookmark and project, a handful of
+ * events per frame; with one time read per frame that is all the detector costs while nothing hitches. Project scopes
+ * that are known to hitch, such as respawns, HUD creation and snapshots, are on the project channel
+ * (ProjectChannel, TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL). The engine writes a scope on a channel only while the
+ * cpu channel is on as well, so add cpu to see them and everything else that ran inside a hitch. It traces every
+ * engine scope of every frame, which costs game thread time and shortens the seconds the tail covers; add it only
+ * while hunting a hitch, and leave project on so the project scopes stay in. To measure the cost on a
+ * target, compare "stat unit" game thread times of a run with Project.Hitch.Channels set empty against the
+ * default, and again with cpu added.
+ *
+ * Writing a dump is itself slow, so dumps are at least Project.Hitch.CooldownSeconds apart and stop after
+ * Project.Hitch.MaxDumps. Project.Hitch.Dump writes one right away.
+ */
+class PROJECT_API FMyHitchDetector
+{
+public:
+	/* Starts timing frames. Called once at the end of engine init, does nothing in the editor. */
+	static void Start();
+
+	/* Writes a dump now, regardless of the cooldown and the dump count. Returns false if trace is compiled out. */
+	static bool Dump(const TCHAR* Reason, double FrameSeconds, FOutputDevice& Ar);
+
+	/* Appends the project counters of the moment to Out, one "Name: value" per line. */
+	static void GetCounters(FString& Out);
+
+private:
+	void OnBeginFrame();
+
+	/* True when some world is a game world that has begun play; loading and travel frames are not hitches. */
+	static bool HasGameWorld();
+
+	double FrameStartTime = 0.0;
+	double LastDumpTime = -DBL_MAX;
+	int32 NumDumps = 0;
+};
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "HAL/PlatformProcess.h"
+#include "MyLoadTestSubsystem.generated.h"
+
+/**
+ * UMyLoadTestSubsystem
+ *
+ * Server load test with real clients, started on a dedicated or listen server with
+ * Project.LoadTest.Start [Clients] [StepClients] [StepSeconds] [Profile].
+ *
+ * Clients are headless child processes (-game -nullrhi) of the same executable, or of
+ * Project.LoadTest.ClientExecutable, connecting to this server over the normal net driver on 127.0.0.1.
+ * They are launched StepClients at a time. Once a step's clients are connected the server is measured for
+ * StepSeconds: tick time (frame time without the idle wait for the tick rate), bandwidth per connection in
+ * and out, and movement corrections per connection per minute from UMyMovementTelemetrySubsystem. Then the next
+ * step is launched, until Clients are connected. Results are logged and appended to Saved/Profiling/LoadTest.csv.
+ *
+ * The profile (None, Good, Average, Bad) sets packet lag, jitter and loss on the server's outgoing packets and,
+ * through -PktLag, -PktLagVariance and -PktLoss, on the clients' outgoing packets. Needs a build with net
+ * emulation (not Shipping).
+ *
+ * With -MyLoadTestClient on the command line a client drives its own AMyBaseCharacter: it walks in circles,
+ * sprints and crouches on a schedule, interacts every few seconds and asks for a respawn every half minute.
+ * Project.LoadTest.Stop ends the test and closes the clients.
+ */
+UCLASS()
+class PROJECT_API UMyLoadTestSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/* Starts ramping up to MaxClients clients, StepClients at a time. */
+	void StartLoadTest(int32 MaxClients, int32 StepClients, float StepSeconds, const FString& ProfileName, FOutputDevice& Ar);
+
+	/* Ends the test, closes the client processes and resets the packet simulation. */
+	void Stop();
+
+	bool IsRunning() const { return bRunning; }
+
+private:
+	enum class EStepPhase : uint8
+	{
+		/* Waiting for the step's clients to connect. */
+		Connecting,
+		Measuring
+	};
+
+	/* Launches Count more client processes. */
+	void LaunchClients(int32 Count);
+
+	/* Starts the measurement window of the current step. */
+	void BeginMeasuring();
+
+	/* Logs and writes the current step. */
+	void ReportStep();
+
+	/* Applies the profile's packet simulation to the server's net driver. */
+	void ApplyServerProfile(int32 InProfileIndex);
+
+	/* Scripted input of a -MyLoadTestClient client. */
+	void DriveClient(float DeltaTime);
+
+	int32 GetNumConnections() const;
+
+	bool bRunning = false;
+	int32 MaxClients = 0;
+	int32 StepClients = 0;
+	float StepSeconds = 0.0f;
+	int32 ProfileIndex = 0;
+
+	TArray<FProcHandle> ClientProcesses;
+
+	EStepPhase StepPhase = EStepPhase::Connecting;
+	double PhaseStartTime = 0.0;
+	double LastFrameTime = 0.0;
+	int64 StepFrames = 0;
+	double StepTickSeconds = 0.0;
+	double MaxTickSeconds = 0.0;
+	uint64 StepStartInBytes = 0;
+	uint64 StepStartOutBytes = 0;
+	int64 StepStartCorrections = 0;
+
+	/* Client side. */
+	bool bScriptedClient = false;
+	double ClientTime = 0.0;
+	double NextInteractTime = 0.0;
+	double NextRespawnTime = 0.0;
+	bool bClientSprinting = false;
+	bool bClientCrouching = false;
+};
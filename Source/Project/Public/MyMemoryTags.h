@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+/**
+ * Low-Level Memory tracker tags of the project, all under "Project".
+ *
+ * Code that allocates on behalf of a subsystem opens the tag's scope, LLM_SCOPE_BYTAG(Project_Doors), and every
+ * allocation inside it is counted under that tag. Spawning a character counts the actor and its components under
+ * Characters; later allocations of the movement component, the stat components and so on under their own tags.
+ *
+ * Tracking needs a build with LLM (not Shipping) started with -LLM. Project.Memory.Tags prints the current size
+ * and peak of every project tag; Project.Memory.Budgets "Characters=64,UI=8" sets budgets in MB, and a tag going
+ * over its budget logs a warning. -LLMCSV writes the tags to the usual LLM CSV as well.
+ */
+LLM_DECLARE_TAG_API(Project, PROJECT_API);
+
+/** Character actors and their components, spawning and per-frame character logic. */
+LLM_DECLARE_TAG_API(Project_Characters, PROJECT_API);
+
+/** Client prediction data, saved moves, server move processing and move recordings. */
+LLM_DECLARE_TAG_API(Project_Movement, PROJECT_API);
+
+/** Health and stamina components and their change events. */
+LLM_DECLARE_TAG_API(Project_Stats, PROJECT_API);
+
+/** Doors. */
+LLM_DECLARE_TAG_API(Project_Doors, PROJECT_API);
+
+/** Interaction requests and their handling. */
+LLM_DECLARE_TAG_API(Project_Interaction, PROJECT_API);
+
+/** HUD widgets and the HUD view-model. */
+LLM_DECLARE_TAG_API(Project_UI, PROJECT_API);
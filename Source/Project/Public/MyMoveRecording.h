@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * One client move as recorded from FSavedMove_MyMove after it was performed.
+ * Holds the input the server receives (time stamp, delta time, acceleration, compressed flags, EMyMoveInput bits
+ * with sprint, control rotation) and the client's state before and after the move to compare against.
+ */
+struct FMyRecordedMove
+{
+	float TimeStamp = 0.0f;
+	float DeltaTime = 0.0f;
+	FVector3f Acceleration = FVector3f::ZeroVector;
+	uint8 CompressedFlags = 0;
+	uint16 Inputs = 0;
+	bool bStartCrouched = false;
+	uint8 StartMovementMode = 0;
+	uint8 EndMovementMode = 0;
+
+	FVector3f StartLocation = FVector3f::ZeroVector;
+	FVector3f StartVelocity = FVector3f::ZeroVector;
+	FRotator3f StartRotation = FRotator3f::ZeroRotator;
+	FRotator3f ControlRotation = FRotator3f::ZeroRotator;
+
+	FVector3f EndLocation = FVector3f::ZeroVector;
+	FVector3f EndVelocity = FVector3f::ZeroVector;
+
+	friend FArchive& operator<<(FArchive& Ar, FMyRecordedMove& Move);
+};
+
+/**
+ * FMyMoveRecording
+ *
+ * A client's move stream and the file format it is stored in.
+ *
+ * File layout: magic, format version, map name, character class path, move count, then the moves
+ * (about 100 bytes each, little endian floats). Version is bumped whenever FMyRecordedMove changes.
+ *
+ * Recorded with Project.Movement.Record.Start / Stop on a client, replayed through the server movement path
+ * with Project.Movement.Replay (see MyMoveRecording.cpp).
+ */
+struct FMyMoveRecording
+{
+	static constexpr uint32 Magic = 0x524D594D; // "MYMR"
+	static constexpr uint32 Version = 2;
+
+	FString MapName;
+	FString CharacterClassPath;
+	TArray<FMyRecordedMove> Moves;
+
+	/* Directory recordings are saved to and loaded from when given a bare file name. */
+	static FString GetDirectory();
+
+	bool SaveToFile(const FString& FilePath) const;
+	bool LoadFromFile(const FString& FilePath);
+};
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MyAllocationCounter.h"
+#include "MyMovementAllocTestSubsystem.generated.h"
+
+/** Parts of the networked movement path counted by Project.Movement.AllocTest. */
+enum class EMyMovementAllocPath : uint8
+{
+	/** Client: the locally controlled character's tick, which moves it and saves, combines and sends moves. */
+	ClientMove,
+	/** Client: acks and corrections received from the server. */
+	ClientAck,
+	/** Server: moves received from a client and performed. */
+	ServerMove,
+
+	Num
+};
+
+/**
+ * UMyMovementAllocTestSubsystem
+ *
+ * Checks that the networked movement path allocates nothing once warmed up, started with
+ * Project.Movement.AllocTest [Frames] [WarmupFrames].
+ *
+ * Needs -MyCountAllocations for FMyAllocationCounter and refuses to start without it. Drives the local player's
+ * character with scripted input (walking in circles, sprint toggled every 2s, crouch every 5s) and counts the heap
+ * allocations of each EMyMovementAllocPath per frame. The warmup frames fill the saved move pool and other caches and
+ * are not counted. Sending the ServerMove RPC is not counted,
+ * the net driver's bunches and packets are not part of the movement path.
+ *
+ * Run it on a client for the client paths and on the server, while clients move, for the server path. The test passes
+ * when no path allocated during the measured frames and no saved move came from the heap; a failure is logged as an
+ * error. Results are appended to Saved/Profiling/MovementAllocTest.csv.
+ */
+UCLASS()
+class PROJECT_API UMyMovementAllocTestSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void StartTest(int32 Frames, int32 WarmupFrames, FOutputDevice& Ar);
+
+	bool IsRunning() const { return Phase != EPhase::Idle; }
+
+	/** Counts the allocations made while alive towards Path of the test running in WorldContextObject's world. */
+	class PROJECT_API FScope
+	{
+	public:
+		FScope(const UObject* WorldContextObject, EMyMovementAllocPath Path);
+		~FScope();
+
+	private:
+		UMyMovementAllocTestSubsystem* Test = nullptr;
+		EMyMovementAllocPath Path = EMyMovementAllocPath::Num;
+		uint64 StartAllocations = 0;
+		TOptional<FMyAllocationCounter::FScope> CounterScope;
+	};
+
+private:
+	enum class EPhase : uint8
+	{
+		Idle,
+		Warmup,
+		Measure
+	};
+
+	struct FPathStats
+	{
+		int64 Calls = 0;
+		uint64 FrameAllocations = 0;
+		uint64 Allocations = 0;
+		uint64 MaxFrameAllocations = 0;
+		int32 FramesWithAllocations = 0;
+	};
+
+	/* Gives the local player's character this frame's scripted input. */
+	void DriveScriptedInput();
+
+	/* Adds the allocations of the frame that just ended to the totals. */
+	void EndFrame();
+
+	void Stop();
+
+	/* Logs and writes the results. */
+	void Report();
+
+	/* Tests running in any world; scopes are free while there are none. */
+	static int32 NumRunning;
+
+	EPhase Phase = EPhase::Idle;
+	int32 Frames = 0;
+	int32 WarmupFrames = 0;
+	int32 PhaseFrames = 0;
+	double StartTime = 0.0;
+	int64 StartHeapAllocatedMoves = 0;
+
+	FPathStats Paths[static_cast<int32>(EMyMovementAllocPath::Num)];
+};
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MyMovementTelemetrySubsystem.generated.h"
+
+class APlayerController;
+
+/**
+ * Counts corrections by size in cm.
+ * Bucket i holds corrections up to BucketLimits[i]; the last bucket holds everything larger.
+ */
+struct FMyCorrectionHistogram
+{
+	static constexpr int32 NumBuckets = 8;
+	static constexpr float BucketLimits[NumBuckets - 1] = { 1.0f, 5.0f, 10.0f, 25.0f, 50.0f, 100.0f, 200.0f };
+
+	int64 Buckets[NumBuckets] = {};
+
+	void Add(float Magnitude);
+
+	/* One line, e.g. "<1:3 <5:10 ... >200:0". */
+	FString ToString() const;
+};
+
+/** Corrections, smoothing and measured network conditions of one connection. */
+struct FMyConnectionTelemetry
+{
+	TWeakObjectPtr<const APlayerController> PlayerController;
+	FString Name;
+
+	/** Corrections the server sent (on the server) or received (on a client). */
+	int64 Corrections = 0;
+	float MaxCorrection = 0.0f;
+	FMyCorrectionHistogram Histogram;
+
+	/** Client only: rollbacks of the local player's Mover character. Mover reconciles without a correction size, so they are not in the histogram. */
+	int64 Rollbacks = 0;
+
+	/** Client only: simulated proxy updates that were smoothed over a clamped distance or snapped into place. */
+	int64 SmoothingClamps = 0;
+	int64 SmoothingSnaps = 0;
+
+	/** Round trip time and its variation in ms; RoundTripMs is negative until the first sample. */
+	float RoundTripMs = -1.0f;
+	float JitterMs = 0.0f;
+	float LastLagMs = -1.0f;
+};
+
+/** Connection dependent movement settings picked by the adaptive mode. */
+struct FMyAdaptiveMoveSettings
+{
+	float MaxSmoothNetUpdateDist = 92.0f;
+	float NoSmoothNetUpdateDist = 140.0f;
+
+	/** Multiplier for the interval between moves the client sends to the server. */
+	float SendDeltaTimeScale = 1.0f;
+};
+
+/**
+ * UMyMovementTelemetrySubsystem
+ *
+ * Network movement correction telemetry and adaptive smoothing.
+ *
+ * On the server every correction sent to a client is counted per client together with its size. On a client the
+ * corrections it receives are counted the same way, next to the rollbacks of a Mover character (AMyMoverCharacter),
+ * which the client decides on itself and the server never sees, as are updates of other characters whose smoothing was clamped
+ * (further than MaxSmoothNetUpdateDist) or skipped (further than NoSmoothNetUpdateDist, the character snaps).
+ *
+ * Once a second the round trip time of every connection is sampled and its jitter is tracked as the smoothed
+ * difference between samples. With Project.Movement.Adaptive on (off by default), a client uses its own connection's numbers to widen
+ * the smoothing distances and send moves less often as the connection gets worse: fewer visible snaps of other
+ * characters, and fewer, larger ServerMoves for the server to check and correct.
+ *
+ * Read with Project.Movement.Telemetry.Dump, clear with Project.Movement.Telemetry.Reset.
+ */
+UCLASS()
+class PROJECT_API UMyMovementTelemetrySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Records a correction of Magnitude cm: on the server one sent to PlayerController's client,
+	 * on a client one received by the local player. Ignored for characters without a player.
+	 */
+	void RecordCorrection(const APlayerController* PlayerController, float Magnitude);
+
+	/* Records a rollback of the local player's Mover character on a client. Ignored without a player. */
+	void RecordRollback(const APlayerController* PlayerController);
+
+	/* Records a simulated proxy update that moved the character Distance cm, judged against the smoothing distances in use. */
+	void RecordSmoothing(float Distance, float MaxSmoothNetUpdateDist, float NoSmoothNetUpdateDist);
+
+	/* Returns the settings for the local player's connection; the defaults when adaptive mode is off or on the server. */
+	const FMyAdaptiveMoveSettings& GetAdaptiveSettings() const { return AdaptiveSettings; }
+
+	/* Returns the corrections and Mover rollbacks of all connections since the last Reset(). */
+	int64 GetTotalCorrections() const;
+
+	void Reset();
+
+	void Dump(FOutputDevice& Ar) const;
+
+private:
+	/* Returns the entry for PlayerController, adding it on first use. */
+	FMyConnectionTelemetry& FindOrAddConnection(const APlayerController* PlayerController);
+
+	/* Samples the round trip time of every connection and updates the adaptive settings. */
+	void SampleConnections();
+
+	/* Picks the adaptive settings for the given connection. */
+	void UpdateAdaptiveSettings(const FMyConnectionTelemetry& Connection);
+
+	TArray<FMyConnectionTelemetry> Connections;
+
+	FMyAdaptiveMoveSettings AdaptiveSettings;
+
+	double LastSampleTime = 0.0;
+};
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MyMoverBenchmarkSubsystem.generated.h"
+
+/**
+ * UMyMoverBenchmarkSubsystem
+ *
+ * Compares the two movement backends, started with Project.Mover.Bench <Count> [Seconds].
+ *
+ * Spawns Count AMyBaseCharacter and then Count AMyMoverCharacter around the first player (or the world origin)
+ * and drives both with the same scripted input: walking in circles, sprint toggled every 2s, crouch every 5s.
+ * After a short warmup each backend is measured for Seconds.
+ *
+ * Reports frame time (the game thread under -nullrhi). The pawns are driven on the authority, where neither
+ * backend predicts or corrects anything, so corrections are not part of the comparison. Compare them in a real
+ * session with clients on Project.Mover.PlayerPawn: Project.Movement.Telemetry.Dump on a client lists the Mover
+ * rollbacks of its connection next to the corrections of the character backend.
+ * Results are appended to Saved/Profiling/MoverBench.csv.
+ */
+UCLASS()
+class PROJECT_API UMyMoverBenchmarkSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void StartBenchmark(int32 Count, float PhaseSeconds, FOutputDevice& Ar);
+
+	bool IsRunning() const { return Phase != EPhase::Idle; }
+
+private:
+	enum class EPhase : uint8
+	{
+		Idle,
+		CharacterWarmup,
+		Character,
+		MoverWarmup,
+		Mover
+	};
+
+	/* Spawns the pawns of one backend. */
+	void SpawnPawns(UClass* PawnClass);
+
+	/* Destroys the spawned pawns. */
+	void DestroyPawns();
+
+	/* Gives every spawned pawn this frame's scripted input. */
+	void DriveScriptedInput();
+
+	void EnterPhase(EPhase NewPhase);
+
+	/* Logs and writes the results of a measured phase. */
+	void ReportPhase(const TCHAR* Backend);
+
+	EPhase Phase = EPhase::Idle;
+	int32 Count = 0;
+	float PhaseSeconds = 10.0f;
+	double PhaseStartTime = 0.0;
+	double LastFrameTime = 0.0;
+	int64 PhaseFrames = 0;
+	double PhaseFrameSeconds = 0.0;
+
+	FVector Origin = FVector::ZeroVector;
+	TArray<TWeakObjectPtr<APawn>> SpawnedPawns;
+};
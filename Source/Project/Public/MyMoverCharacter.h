@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Pawn.h"
+#include "MoverSimulationTypes.h"
+#include "InputActionValue.h"
+#include "MyMoverCharacter.generated.h"
+
+class UCapsuleComponent;
+class USkeletalMeshComponent;
+class USpringArmComponent;
+class UCameraComponent;
+class UInputAction;
+class UMyMoverComponent;
+
+/**
+ * AMyMoverCharacter
+ *
+ * Alternate movement backend: a pawn moved by the Mover plugin instead of UMyBaseMovementComponent.
+ *
+ * Sprint and crouch are sent as FMyMoverInputs and come back as FMyMoverSpeedState instead of compressed
+ * flag bits in a saved move. The simulation runs at the Network Prediction fixed tick rate.
+ * Crouching only changes speed on this backend; the capsule keeps its size.
+ *
+ * Players get this pawn when Project.Mover.PlayerPawn is 1. Project.Mover.Bench compares it with
+ * AMyBaseCharacter.
+ */
+UCLASS()
+class PROJECT_API AMyMoverCharacter : public APawn, public IMoverInputProducerInterface
+{
+	GENERATED_BODY()
+
+public:
+	AMyMoverCharacter();
+
+	virtual void Tick(float DeltaTime) override;
+	virtual void SetupPlayerInputComponent(UInputComponent* PlayerInputComponent) override;
+
+	/* Same meaning as on UMyBaseMovementComponent. */
+	void StartSprinting();
+	void StopSprinting();
+	void StartCrouching();
+	void StopCrouching();
+
+	bool IsSprinting() const { return bWantsToSprint; }
+
+	UMyMoverComponent* GetMoverComponent() const { return MoverComponent; }
+
+protected:
+	/** Entry point for input production. Called once per simulation frame. */
+	virtual void ProduceInput_Implementation(int32 SimTimeMs, FMoverInputCmdContext& InputCmdResult) override;
+
+	void Move(const FInputActionValue& Value);
+	void Look(const FInputActionValue& Value);
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	TObjectPtr<UCapsuleComponent> CapsuleComponent;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	TObjectPtr<USkeletalMeshComponent> Mesh;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	TObjectPtr<USpringArmComponent> CameraBoom;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	TObjectPtr<UCameraComponent> FollowCamera;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	TObjectPtr<UMyMoverComponent> MoverComponent;
+
+	UPROPERTY(EditAnywhere, Category = "Input")
+	TObjectPtr<UInputAction> MoveAction;
+
+	UPROPERTY(EditAnywhere, Category = "Input")
+	TObjectPtr<UInputAction> LookAction;
+
+	UPROPERTY(EditAnywhere, Category = "Input")
+	TObjectPtr<UInputAction> SprintAction;
+
+	UPROPERTY(EditAnywhere, Category = "Input")
+	TObjectPtr<UInputAction> CrouchAction;
+
+private:
+	/* Movement input of the last frame. Simulation frames don't line up with game frames, so it is kept until replaced. */
+	FVector CachedMoveInput = FVector::ZeroVector;
+
+	bool bWantsToSprint = false;
+	bool bWantsToCrouch = false;
+};
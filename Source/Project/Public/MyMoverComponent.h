@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MoverComponent.h"
+#include "MyCharacterTuning.h"
+#include "MyMoverComponent.generated.h"
+
+/**
+ * UMyMoverComponent
+ *
+ * Mover component of AMyMoverCharacter, the alternate movement backend to UMyBaseMovementComponent.
+ *
+ * Sets up walking (UMyMoverWalkingMode) and falling modes and keeps FMyMoverSpeedState in the sync state
+ * from one frame to the next. The simulation runs on the Network Prediction fixed tick set in DefaultEngine.ini.
+ * Rollbacks on the owning client are counted per connection by UMyMovementTelemetrySubsystem, next to the
+ * corrections of the character backend.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class PROJECT_API UMyMoverComponent : public UMoverComponent
+{
+	GENERATED_BODY()
+
+public:
+	UMyMoverComponent();
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/* Sets the shared MaxSpeed to the fastest stance speed of the walking mode's tuning. */
+	void UpdateMaxSpeed();
+
+#if !UE_BUILD_SHIPPING
+	/* Updates MaxSpeed when the walking mode's tuning changed at runtime. */
+	void OnTuningChanged(const UMyCharacterTuning* ChangedTuning);
+
+	FDelegateHandle TuningChangedHandle;
+#endif
+
+	UFUNCTION()
+	void OnRollback(const FMoverTimeStep& CurrentTimeStep, const FMoverTimeStep& PreviousTimeStep);
+};
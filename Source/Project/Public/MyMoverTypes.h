@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MoverTypes.h"
+#include "MyMoverTypes.generated.h"
+
+/**
+ * FMyMoverInputs
+ *
+ * Sprint and crouch input of AMyMoverCharacter, sent with every input command next to FCharacterDefaultInputs.
+ * The Mover counterpart of the EMyMoveInput bits UMyBaseMovementComponent sends with its moves.
+ */
+USTRUCT(BlueprintType)
+struct PROJECT_API FMyMoverInputs : public FMoverDataStructBase
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadWrite, Category = "Mover")
+	bool bWantsToSprint = false;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Mover")
+	bool bWantsToCrouch = false;
+
+	virtual FMoverDataStructBase* Clone() const override;
+	virtual bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess) override;
+	virtual UScriptStruct* GetScriptStruct() const override { return StaticStruct(); }
+	virtual void ToString(FAnsiStringBuilderBase& Out) const override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FMyMoverInputs> : public TStructOpsTypeTraitsBase2<FMyMoverInputs>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithCopy = true
+	};
+};
+
+/**
+ * FMyMoverSpeedState
+ *
+ * Sprint and crouch state of AMyMoverCharacter, part of its sync state.
+ * Written every simulation tick by UMyMoverWalkingMode from FMyMoverInputs and persisted between frames, so a
+ * mispredicted stance is reconciled like any other state. The speeds themselves are not part of the state:
+ * UMyMoverWalkingMode reads them from its UMyCharacterTuning, which server and client share.
+ */
+USTRUCT(BlueprintType)
+struct PROJECT_API FMyMoverSpeedState : public FMoverDataStructBase
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Mover")
+	bool bIsSprinting = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Mover")
+	bool bIsCrouching = false;
+
+	virtual FMoverDataStructBase* Clone() const override;
+	virtual bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess) override;
+	virtual UScriptStruct* GetScriptStruct() const override { return StaticStruct(); }
+	virtual void ToString(FAnsiStringBuilderBase& Out) const override;
+	virtual bool ShouldReconcile(const FMoverDataStructBase& AuthorityState) const override;
+	virtual void Interpolate(const FMoverDataStructBase& From, const FMoverDataStructBase& To, float Pct) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FMyMoverSpeedState> : public TStructOpsTypeTraitsBase2<FMyMoverSpeedState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithCopy = true
+	};
+};
@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DefaultMovementSet/Modes/WalkingMode.h"
+#include "MyCharacterTuning.h"
+#include "MyMoverWalkingMode.generated.h"
+
+/**
+ * UMyMoverWalkingMode
+ *
+ * Walking mode of AMyMoverCharacter, with its speeds from the same UMyCharacterTuning as UMyBaseMovementComponent.
+ *
+ * The stock walking mode accelerates up to the shared MaxSpeed, which UMyMoverComponent sets to the fastest
+ * stance speed. This mode limits the result to the speed of the current stance, braking down to it at
+ * BrakingDeceleration when sprint is released, and writes FMyMoverSpeedState every tick from FMyMoverInputs.
+ */
+UCLASS()
+class PROJECT_API UMyMoverWalkingMode : public UWalkingMode
+{
+	GENERATED_BODY()
+
+public:
+	UMyMoverWalkingMode(const FObjectInitializer& ObjectInitializer);
+
+	/** Shared tuning with the walk, sprint and crouch speeds, DA_CharacterTuning by default; the defaults of FMyCharacterTuningValues without one. */
+	UPROPERTY(EditDefaultsOnly, Category = "Speeds")
+	TObjectPtr<UMyCharacterTuning> Tuning;
+
+	/** How fast the character slows down to a lower stance speed. */
+	UPROPERTY(EditDefaultsOnly, Category = "Speeds")
+	float BrakingDeceleration = 900.0f;
+
+	/* Returns the values of Tuning, or the defaults without one. */
+	const FMyCharacterTuningValues& GetTuning() const { return UMyCharacterTuning::Get(Tuning); }
+
+	/* Returns the fastest of the stance speeds. */
+	float GetMaxStanceSpeed() const { return FMath::Max3(GetTuning().WalkSpeed, GetTuning().SprintSpeed, GetTuning().CrouchSpeed); }
+
+protected:
+	virtual void OnGenerateMove(const FMoverTickStartData& StartState, const FMoverTimeStep& TimeStep, FProposedMove& OutProposedMove) const override;
+	virtual void OnSimulationTick(const FSimulationTickParams& Params, FMoverTickEndData& OutputState) override;
+};
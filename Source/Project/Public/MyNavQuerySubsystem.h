@@ -0,0 +1,208 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NavigationData.h"
+#include "Tasks/Task.h"
+#include "MyNavQuerySubsystem.generated.h"
+
+/** Identifies one path or raycast request. Ids are never reused within a world. */
+struct FMyNavQueryHandle
+{
+	uint32 Id = 0;
+
+	bool IsValid() const { return Id != 0; }
+	void Invalidate() { Id = 0; }
+};
+
+enum class EMyNavQueryStatus : uint8
+{
+	/** Queued or being computed. */
+	Pending,
+	/** Done; for paths a (possibly partial) path was found. */
+	Succeeded,
+	/** Done without a path, or no navigation data. */
+	Failed,
+	/** Unknown, cancelled, already consumed or expired. */
+	Invalid
+};
+
+/**
+ * UMyNavQuerySubsystem
+ *
+ * Batched asynchronous navigation queries for AI, so that many agents asking for paths in the same frame
+ * don't each run a synchronous query on the game thread.
+ *
+ * Requests are queued and, at the end of the frame, up to Project.Nav.MaxPathsPerFrame paths and
+ * Project.Nav.MaxRaycastsPerFrame raycasts are handed to one task that runs them in parallel on worker
+ * threads. The batch is collected at the start of the next frame, before the navigation system ticks and
+ * can change the navmesh, so results arrive one frame after the request at best. Whatever is over the caps
+ * waits for later frames in request order.
+ *
+ * Path requests whose start and goal fall in the same cells (Project.Nav.StartCellSize and GoalCellSize) share
+ * one query, whether they are queued, being computed or were finished within Project.Nav.CacheSeconds.
+ * Every requester gets its own copy of the path to follow: the navmesh path itself, with its polygons, nav link
+ * flags and query data, registered with the navigation data so that it is invalidated and repathed like a path
+ * from the navigation system.
+ *
+ * Results are polled with the handle and consumed by the first successful Get. Unclaimed results expire.
+ * Project.Nav.Stats prints queue depths, sharing, batch cost and request latency.
+ */
+UCLASS()
+class PROJECT_API UMyNavQuerySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/* Queues a path from Start to End on the navigation data of Querier's agent (the default navmesh without one). */
+	FMyNavQueryHandle RequestPath(const AActor* Querier, const FVector& Start, const FVector& End);
+
+	/* Queues a navmesh raycast from Start to End. */
+	FMyNavQueryHandle RequestRaycast(const AActor* Querier, const FVector& Start, const FVector& End);
+
+	/* Returns the status of a path request. On success OutPath is set, ready for AAIController::RequestMove, and the request is released. */
+	EMyNavQueryStatus GetPathResult(FMyNavQueryHandle Handle, FNavPathSharedPtr& OutPath);
+
+	/* Returns the status of a raycast request. When done, bOutHit and OutHitLocation are set and the request is released. */
+	EMyNavQueryStatus GetRaycastResult(FMyNavQueryHandle Handle, bool& bOutHit, FVector& OutHitLocation);
+
+	/* Drops a request; its result is thrown away. */
+	void CancelQuery(FMyNavQueryHandle& InOutHandle);
+
+	/* Logs queue depths and the metrics since the last call. */
+	void DumpStats(FOutputDevice& Ar);
+
+	/* Returns the subsystem of WorldContextObject's world, or null outside game worlds. */
+	static UMyNavQuerySubsystem* Get(const UObject* WorldContextObject);
+
+private:
+	/** Start and goal cells on one navigation data; requests with the same key share a path. */
+	struct FPathKey
+	{
+		const ANavigationData* NavData = nullptr;
+		FIntVector Start;
+		FIntVector End;
+
+		bool operator==(const FPathKey& Other) const { return NavData == Other.NavData && Start == Other.Start && End == Other.End; }
+		friend uint32 GetTypeHash(const FPathKey& Key) { return HashCombine(HashCombine(PointerHash(Key.NavData), GetTypeHash(Key.Start)), GetTypeHash(Key.End)); }
+	};
+
+	/** A computed path, shared by every request that used it. Nobody follows it; requesters get copies. */
+	struct FPathResult
+	{
+		FNavPathSharedPtr Path;
+		bool bPartial = false;
+	};
+
+	/** One path query and the requests waiting for it. Worker threads only write the result fields. */
+	struct FPathJob
+	{
+		FPathKey Key;
+		const ANavigationData* NavData = nullptr;
+		FSharedConstNavQueryFilter Filter;
+		FNavAgentProperties AgentProperties;
+		FVector Start = FVector::ZeroVector;
+		FVector End = FVector::ZeroVector;
+		TArray<uint32, TInlineAllocator<4>> Tickets;
+
+		FNavPathSharedPtr Path;
+		bool bSuccess = false;
+		bool bPartial = false;
+	};
+
+	struct FRaycastJob
+	{
+		const ANavigationData* NavData = nullptr;
+		FSharedConstNavQueryFilter Filter;
+		FVector Start = FVector::ZeroVector;
+		FVector End = FVector::ZeroVector;
+		uint32 Ticket = 0;
+
+		FVector HitLocation = FVector::ZeroVector;
+		bool bHit = false;
+	};
+
+	/** The state of one request, from queuing until its result is read. */
+	struct FTicket
+	{
+		EMyNavQueryStatus Status = EMyNavQueryStatus::Pending;
+		bool bPath = true;
+		double RequestTime = 0.0;
+		uint64 RequestFrame = 0;
+		double ResolveTime = 0.0;
+
+		/* Becomes the owner in the query data of the path handed out, for repaths. */
+		TWeakObjectPtr<const AActor> Querier;
+		TSharedPtr<const FPathResult> Path;
+		FVector HitLocation = FVector::ZeroVector;
+		bool bHit = false;
+	};
+
+	struct FCachedPath
+	{
+		TSharedPtr<const FPathResult> Path;
+		double Time = 0.0;
+	};
+
+	/* Finds the navigation data for Querier's agent, with its agent properties. */
+	const ANavigationData* FindNavData(const AActor* Querier, const FVector& Start, FNavAgentProperties& OutAgentProperties) const;
+
+	FPathKey MakePathKey(const ANavigationData* NavData, const FVector& Start, const FVector& End) const;
+
+	/* Creates a pending ticket and returns its id. */
+	uint32 AddTicket(bool bPath);
+
+	/* Marks a ticket done and records its latency. */
+	void ResolveTicket(FTicket& Ticket, EMyNavQueryStatus Status);
+
+	/* Moves up to the per-frame caps of queued jobs into a batch and starts it on the worker threads. */
+	void LaunchBatch();
+
+	/* Waits for the running batch and hands its results to the tickets. */
+	void CompleteBatch();
+
+	/* Completes the batch before the navigation system ticks. */
+	void OnWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+
+	TMap<uint32, FTicket> Tickets;
+	uint32 NextTicketId = 1;
+
+	TArray<FPathJob> QueuedPaths;
+	TMap<FPathKey, int32> QueuedPathIndices;
+	TArray<FRaycastJob> QueuedRaycasts;
+
+	/* The batch on the worker threads. Only touched by the game thread while BatchTask is not running. */
+	TArray<FPathJob> BatchPaths;
+	TMap<FPathKey, int32> BatchPathIndices;
+	TArray<FRaycastJob> BatchRaycasts;
+	UE::Tasks::FTask BatchTask;
+	double BatchSeconds = 0.0;
+
+	TMap<FPathKey, FCachedPath> PathCache;
+
+	FDelegateHandle WorldTickStartHandle;
+
+	/* Metrics since the last DumpStats(). */
+	int64 NumPathRequests = 0;
+	int64 NumRaycastRequests = 0;
+	int64 NumSharedPaths = 0;
+	int64 NumComputedPaths = 0;
+	int64 NumComputedRaycasts = 0;
+	int64 NumResolved = 0;
+	double TotalLatency = 0.0;
+	double MaxLatency = 0.0;
+	uint64 TotalLatencyFrames = 0;
+	uint64 MaxLatencyFrames = 0;
+	int64 NumBatches = 0;
+	double TotalBatchSeconds = 0.0;
+	double MaxBatchSeconds = 0.0;
+	double MaxWaitSeconds = 0.0;
+};
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Iris/Serialization/NetSerializer.h"
+#include "MyNetSerializers.generated.h"
+
+/**
+ * FMyQuantizedFloat
+ *
+ * A float that keeps full precision on the authority but is sent over the network
+ * as a variable length fixed point number with 1/100 resolution.
+ *
+ * Stats between 0 and 100 cost at most 20 bits instead of 32 under Iris, which sends a 5 bit
+ * length and then only the significant bits. The legacy path uses SerializeIntPacked, which writes
+ * whole bytes of 7 value bits each: values below 81.92 cost 16 bits and a full 100.00 costs 24.
+ * Serialized by NetSerialize() on the legacy path and by FMyQuantizedFloatNetSerializer under Iris.
+ */
+USTRUCT(BlueprintType)
+struct PROJECT_API FMyQuantizedFloat
+{
+	GENERATED_BODY()
+
+	/** Number of quantization steps per unit. */
+	static constexpr float Scale = 100.0f;
+
+	FMyQuantizedFloat() = default;
+	explicit FMyQuantizedFloat(float InValue) : Value(InValue) {}
+
+	float Get() const { return Value; }
+	operator float() const { return Value; }
+
+	FMyQuantizedFloat& operator=(float InValue) { Value = InValue; return *this; }
+	FMyQuantizedFloat& operator+=(float Amount) { Value += Amount; return *this; }
+	FMyQuantizedFloat& operator-=(float Amount) { Value -= Amount; return *this; }
+
+	bool operator==(const FMyQuantizedFloat& Other) const { return Value == Other.Value; }
+	bool operator!=(const FMyQuantizedFloat& Other) const { return Value != Other.Value; }
+
+	/* Converts a value to its zig-zag encoded fixed point representation. */
+	static uint32 Quantize(float InValue);
+
+	/* Converts a zig-zag encoded fixed point value back to a float. */
+	static float Dequantize(uint32 Quantized);
+
+	/* Legacy replication path. */
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Value")
+	float Value = 0.0f;
+};
+
+template<>
+struct TStructOpsTypeTraits<FMyQuantizedFloat> : public TStructOpsTypeTraitsBase2<FMyQuantizedFloat>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithNetSharedSerialization = true,
+		WithIdenticalViaEquality = true,
+	};
+};
+
+USTRUCT()
+struct FMyQuantizedFloatNetSerializerConfig : public FNetSerializerConfig
+{
+	GENERATED_BODY()
+};
+
+namespace UE::Net
+{
+	UE_NET_DECLARE_SERIALIZER(FMyQuantizedFloatNetSerializer, PROJECT_API);
+}
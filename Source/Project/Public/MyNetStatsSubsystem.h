@@ -0,0 +1,213 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "MyNetStatsSubsystem.generated.h"
+
+class UNetConnection;
+class UCharacterMovementComponent;
+class FCharacterNetworkMoveData;
+
+/** What kind of traffic an accounting entry describes. */
+enum class EMyNetStatKind : uint8
+{
+	Property,
+	RPC,
+	Move
+};
+
+/**
+ * Identifies one accounting row: a class, a property/RPC/move name and the connection it was sent on.
+ */
+struct FMyNetStatKey
+{
+	FName ClassName;
+	FName EntryName;
+	EMyNetStatKind Kind = EMyNetStatKind::Property;
+	TObjectKey<UNetConnection> Connection;
+
+	bool operator==(const FMyNetStatKey& Other) const
+	{
+		return ClassName == Other.ClassName && EntryName == Other.EntryName && Kind == Other.Kind && Connection == Other.Connection;
+	}
+
+	friend uint32 GetTypeHash(const FMyNetStatKey& Key)
+	{
+		uint32 Hash = HashCombine(GetTypeHash(Key.ClassName), GetTypeHash(Key.EntryName));
+		Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(Key.Kind)));
+		return HashCombine(Hash, GetTypeHash(Key.Connection));
+	}
+};
+
+/**
+ * Accumulated cost of one accounting row.
+ * Sizes are payload bits only; bunch and packet headers are not included.
+ */
+struct FMyNetStatEntry
+{
+	/** Totals since the stats were last reset. */
+	int64 TotalBits = 0;
+	int64 TotalCount = 0;
+
+	/** Totals for the window that is currently being collected. */
+	int64 WindowBits = 0;
+	int64 WindowCount = 0;
+
+	/** Rates computed when the last window was closed. */
+	float BytesPerSecond = 0.0f;
+	float CountPerSecond = 0.0f;
+};
+
+/**
+ * UMyNetStatsSubsystem
+ *
+ * Per-class, per-property and per-RPC network cost accounting.
+ *
+ * Replicated properties are sampled from PreReplication() on the server, remote functions are sampled
+ * from CallRemoteFunction() on the sending side and character moves are sampled when the server performs them.
+ * Every sample is attributed to the connection it travels on, and rates are rolled once per second.
+ * Client to server RPCs other than moves have no receive hook on the server, so they are not itemized there;
+ * instead the server takes the bytes it received on each connection (whole packets) as the client to server total.
+ *
+ * Collection is disabled by default; enable it with Project.Net.Stats.Enable 1.
+ * Use Project.Net.Stats.Dump, Project.Net.Stats.Csv and Project.Net.Stats.CheckBudget to read the results.
+ *
+ * For automated runs, start the server with -MyNetBudgetCheck=<Seconds>: collection is switched on, and after that
+ * many seconds of play (with clients connected, e.g. -MyLoadTestClient ones) the last one second window is checked
+ * against both budgets and the server exits with code 0 if every connection is within it, 1 if one is over or none was
+ * measured. Leave enough seconds for the clients to join so their initial replication is not in the window.
+ *
+ * Also hosts the replication benchmark (Project.Net.Bench.Run), which measures net flush CPU time and
+ * outgoing bandwidth of a session so legacy and Iris replication can be compared on the same script.
+ */
+UCLASS()
+class PROJECT_API UMyNetStatsSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/* Returns the subsystem for the world of the given object if collection is enabled, otherwise nullptr. */
+	static UMyNetStatsSubsystem* GetIfEnabled(const UObject* WorldContextObject);
+
+	/**
+	 * Records every replicated property of Object that changed since the last call.
+	 * Call from PreReplication() of replicated actors and components.
+	 */
+	static void RecordReplicatedProperties(const UObject* Object);
+
+	/**
+	 * Records an outgoing remote function call and the size of its parameters.
+	 * Call from CallRemoteFunction() before forwarding to Super.
+	 */
+	static void RecordRemoteFunction(const UObject* Object, const UFunction* Function, const void* Parameters);
+
+	/**
+	 * Records a character move received by the server.
+	 * Call from ServerMove_PerformMovement().
+	 */
+	static void RecordServerMove(const UCharacterMovementComponent* MovementComponent, FName EntryName, int64 PayloadBits);
+
+	/* Adds a sample to the row identified by Key. */
+	void Record(const FMyNetStatKey& Key, int64 PayloadBits);
+
+	/* Clears every row and every property shadow. */
+	void Reset();
+
+	/* Logs every row sorted by bytes per second. */
+	void Dump(FOutputDevice& Ar) const;
+
+	/* Writes every row to Saved/Profiling/NetStats/<Prefix>-<timestamp>.csv and returns the file path. */
+	FString WriteCsv(const FString& Prefix) const;
+
+	/**
+	 * Checks the per-connection bytes per second sent to clients against Project.Net.Stats.BudgetBytesPerSecond,
+	 * and the bytes per second received from them against Project.Net.Stats.UpBudgetBytesPerSecond.
+	 * Logs an error for every connection over either budget.
+	 *
+	 * @return True if every connection is within budget, false if one is over or there are none.
+	 */
+	bool CheckBudget(FOutputDevice& Ar) const;
+
+	/* Returns total bytes per second sent on the given connection during the last window. */
+	float GetConnectionBytesPerSecond(const UNetConnection* Connection) const;
+
+	/* Returns the estimated payload size of a single property value in bits. */
+	static int64 EstimatePropertyBits(const FProperty* Property, const void* ValuePtr);
+
+	/* Starts measuring net flush time and outgoing bandwidth. Reports automatically after Duration seconds if Duration > 0. */
+	void StartBenchmark(const FString& Label, float Duration);
+
+	/**
+	 * Logs the benchmark results and appends them to Saved/Profiling/NetStats/ReplicationBench.csv.
+	 * Rows are tagged with the label and with the replication system in use (Legacy or Iris).
+	 */
+	void ReportBenchmark(FOutputDevice& Ar);
+
+	bool IsBenchmarkRunning() const { return Bench.StartTime > 0.0; }
+
+private:
+	/** Last replicated values of one object, used to find out which properties changed. */
+	struct FShadowState
+	{
+		const UClass* Class = nullptr;
+		TArray<const FProperty*> Properties;
+		TArray<uint8, TAlignedHeapAllocator<16>> Buffer;
+
+		~FShadowState();
+	};
+
+	/* Collects the connections Actor is currently replicated to. */
+	void GatherConnections(const AActor* Actor, TArray<UNetConnection*, TInlineAllocator<16>>& OutConnections) const;
+
+	/* Closes the current window and computes per second rates. */
+	void RollWindow();
+
+	/* Returns a readable name for a connection. */
+	FString GetConnectionName(const TObjectKey<UNetConnection>& Connection) const;
+
+	/* Benchmark hooks; the time between them is the replication and net flush part of the frame. */
+	void OnWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+	void OnPostTickFlush();
+
+	/** Accumulated results of the running replication benchmark. */
+	struct FBenchState
+	{
+		FString Label;
+		double StartTime = 0.0;
+		double Duration = 0.0;
+		double FlushStartTime = 0.0;
+		double TotalFlushSeconds = 0.0;
+		double MaxFlushSeconds = 0.0;
+		int64 Frames = 0;
+		uint64 StartOutBytes = 0;
+		uint64 StartOutPackets = 0;
+		int32 MaxConnections = 0;
+	};
+
+	FBenchState Bench;
+
+	FDelegateHandle PostActorTickHandle;
+	FDelegateHandle PostTickFlushHandle;
+
+	TMap<FMyNetStatKey, FMyNetStatEntry> Entries;
+
+	TMap<TObjectKey<UObject>, TUniquePtr<FShadowState>> Shadows;
+
+	TMap<TObjectKey<UNetConnection>, FString> ConnectionNames;
+
+	/** Bytes per second the server received on each client connection during the last window, packet headers included. */
+	TMap<TObjectKey<UNetConnection>, float> ReceivedBytesPerSecond;
+
+	double WindowStartTime = 0.0;
+
+	/* When -MyNetBudgetCheck runs CheckBudget() and exits; 0 when not set. */
+	double BudgetCheckTime = 0.0;
+};
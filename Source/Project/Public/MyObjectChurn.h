@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/UObjectArray.h"
+
+/**
+ * FMyObjectChurn
+ *
+ * Counts UObjects created and destroyed per class, and how long frames with garbage collection work take, between
+ * Project.GC.Churn.Start and Project.GC.Churn.Stop. Project.GC.Churn.Report [Top] logs the classes with the most
+ * churn per minute and appends them to Saved/Profiling/ObjectChurn.csv, and the GC frame times to GCFrames.csv.
+ *
+ * Objects are counted through the UObject array listeners, so nothing is added to object creation or destruction
+ * while the report isn't running. While it runs, creation and destruction take a lock and the class of every live
+ * object is kept by object index (one FName each), so destroyed objects are counted under the class they were
+ * created with.
+ */
+class PROJECT_API FMyObjectChurn final : public FUObjectArray::FUObjectCreateListener, public FUObjectArray::FUObjectDeleteListener
+{
+public:
+	/* Starts counting from zero. Call from the game thread. */
+	static void Start();
+
+	/* Stops counting and frees the per-object table. */
+	static void Stop();
+
+	static bool IsRunning();
+
+	/* Logs the Top classes by churn and the GC frame times since Start(), and appends them to the CSV files. */
+	static void Report(int32 Top, FOutputDevice& Ar);
+
+	virtual void NotifyUObjectCreated(const UObjectBase* Object, int32 Index) override;
+	virtual void NotifyUObjectDeleted(const UObjectBase* Object, int32 Index) override;
+	virtual void OnUObjectArrayShutdown() override;
+
+private:
+	struct FClassChurn
+	{
+		int64 Created = 0;
+		int64 Destroyed = 0;
+	};
+
+	void OnBeginFrame();
+	void OnPreGarbageCollect();
+	void OnPostGarbageCollect();
+
+	FCriticalSection Lock;
+
+	TMap<FName, FClassChurn> Classes;
+
+	/* Class of the object at each object index, NAME_None for free indices. */
+	TArray<FName> ClassByIndex;
+
+	double StartTime = 0.0;
+
+	/* Frames that ran reachability analysis, gathering or purging, and the others. */
+	double FrameStartTime = 0.0;
+	bool bGarbageCollectThisFrame = false;
+	bool bCollecting = false;
+	int64 GarbageCollections = 0;
+	int64 GCFrames = 0;
+	double GCFrameSeconds = 0.0;
+	double MaxGCFrameSeconds = 0.0;
+	int64 OtherFrames = 0;
+	double OtherFrameSeconds = 0.0;
+	double MaxOtherFrameSeconds = 0.0;
+
+	FDelegateHandle BeginFrameHandle;
+	FDelegateHandle PreGarbageCollectHandle;
+	FDelegateHandle PostGarbageCollectHandle;
+};
@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "MyReplicationGraph.generated.h"
+
+class UReplicationGraphNode_GridSpatialization2D;
+class UReplicationGraphNode_ActorList;
+class UMyReplicationGraphNode_AlwaysRelevant_ForConnection;
+class APlayerState;
+
+/** How actors of a class are routed into the graph. */
+enum class EMyClassRepNodeMapping : uint32
+{
+	/** Not routed to a node; something else (e.g. a per-connection node) takes care of it. */
+	NotRouted,
+	/** Routed to the always relevant node, replicated to every connection. */
+	RelevantAllConnections,
+	/** Spatialized and assumed never to move. */
+	Spatialize_Static,
+	/** Spatialized and expected to move every frame. */
+	Spatialize_Dynamic,
+	/** Spatialized as static while dormant and as dynamic while awake. */
+	Spatialize_Dormancy,
+};
+
+/**
+ * UMyReplicationGraph
+ *
+ * Replication graph for this project.
+ * - AMyBaseCharacter and other moving pawns live in a spatialized grid, so each connection only
+ *   gathers actors from the cells around its viewers.
+ * - AMyBaseDoor and other IInteractiveInterface actors are routed through the dormancy aware part of
+ *   the grid, so closed or open doors cost nothing until they are flushed.
+ * - The PlayerController, PlayerState and view target of a connection are always relevant to it, and its
+ *   own PlayerState replicates every frame. PlayerStates of other players go through a frequency limited
+ *   node that hands each connection PlayerStatesPerFrame of them per frame, in turns.
+ * - Game state and other always relevant actors are gathered once for every connection.
+ *
+ * Enabled through ReplicationDriverClassName in DefaultEngine.ini. Only used by the legacy replication
+ * path; with net.Iris.UseIrisReplication=1 the Iris filters in DefaultEngine.ini take its place.
+ */
+UCLASS(Transient, Config = Engine)
+class PROJECT_API UMyReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	UMyReplicationGraph();
+
+	virtual void ResetGameWorldState() override;
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+
+	/** Size of a single grid cell in world units. */
+	UPROPERTY(Config)
+	float GridCellSize;
+
+	/** Lowest X coordinate expected in the map; the grid starts here. */
+	UPROPERTY(Config)
+	float SpatialBiasX;
+
+	/** Lowest Y coordinate expected in the map; the grid starts here. */
+	UPROPERTY(Config)
+	float SpatialBiasY;
+
+	/** Number of frequency buckets dynamic actors in a cell are split into. */
+	UPROPERTY(Config)
+	int32 DynamicActorFrequencyBuckets;
+
+	/** Actor count a cell must reach before its dynamic actors are split into buckets. */
+	UPROPERTY(Config)
+	int32 DynamicActorBucketListSize;
+
+	/** Maximum number of other players' PlayerStates sent to a connection per frame. */
+	UPROPERTY(Config)
+	int32 PlayerStatesPerFrame;
+
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_GridSpatialization2D> GridNode;
+
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_ActorList> AlwaysRelevantNode;
+
+private:
+	/* Returns how actors of Class are routed, deriving and caching a policy from the CDO if none was set. */
+	EMyClassRepNodeMapping GetMappingPolicy(UClass* Class);
+
+	/* Fills in the replication period and cull distance of Class from its default object. */
+	void InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, bool bSpatialize) const;
+
+	TClassMap<EMyClassRepNodeMapping> ClassRepNodePolicies;
+};
+
+/**
+ * UMyReplicationGraphNode_AlwaysRelevant_ForConnection
+ *
+ * Per-connection node that always gathers the connection's PlayerController, PlayerState,
+ * pawn and view target, regardless of where they are in the grid.
+ */
+UCLASS()
+class PROJECT_API UMyReplicationGraphNode_AlwaysRelevant_ForConnection : public UReplicationGraphNode_AlwaysRelevant_ForConnection
+{
+	GENERATED_BODY()
+
+public:
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+private:
+	FActorRepListRefView OwnerActorList;
+};
+
+/**
+ * UMyReplicationGraphNode_PlayerStateFrequencyLimiter
+ *
+ * Global node that gives each connection TargetActorsPerFrame PlayerStates per frame, taking turns through all of
+ * them like the engine's UReplicationGraphNode_PlayerStateFrequencyLimiter. It skips the connection's own
+ * PlayerState, which UMyReplicationGraphNode_AlwaysRelevant_ForConnection gathers every frame, so no PlayerState
+ * is gathered twice for a connection.
+ */
+UCLASS()
+class PROJECT_API UMyReplicationGraphNode_PlayerStateFrequencyLimiter : public UReplicationGraphNode
+{
+	GENERATED_BODY()
+
+public:
+	/* PlayerStates are found by iterating the world, not routed to the node. */
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo) override { }
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound = true) override { return false; }
+	virtual void NotifyResetAllNetworkActors() override { }
+
+	virtual void PrepareForReplication() override;
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+	/** PlayerStates given to a connection per frame. */
+	int32 TargetActorsPerFrame = 2;
+
+private:
+	/** Every PlayerState that can replicate this frame. */
+	TArray<APlayerState*> PlayerStates;
+
+	/** This frame's turn for the connection being gathered. */
+	FActorRepListRefView ConnectionActorList;
+};
@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SignificanceManager.h"
+#include "Tickable.h"
+#include "MySignificanceManager.generated.h"
+
+class AMyBaseCharacter;
+
+/** Significance buckets a character can be in, from most to least significant. */
+UENUM(BlueprintType)
+enum class EMySignificanceLevel : uint8
+{
+	High,
+	Medium,
+	Low,
+	Lowest,
+	MAX UMETA(Hidden)
+};
+
+/**
+ * What a character is allowed to do while it is in a significance level.
+ */
+USTRUCT(BlueprintType)
+struct FMySignificanceLevelSettings
+{
+	GENERATED_BODY()
+
+	/** Lowest significance that still belongs to this level. */
+	UPROPERTY(EditAnywhere, Category = "Significance")
+	float MinSignificance = 0.0f;
+
+	/** Tick interval of the actor and its components. 0 ticks every frame. */
+	UPROPERTY(EditAnywhere, Category = "Significance")
+	float TickInterval = 0.0f;
+
+	/** Tick interval of the skeletal mesh, which drives the animation update rate. 0 ticks every frame. */
+	UPROPERTY(EditAnywhere, Category = "Significance")
+	float AnimTickInterval = 0.0f;
+
+	/** Scale applied to the character's default net update frequency on the server. */
+	UPROPERTY(EditAnywhere, Category = "Significance")
+	float NetUpdateFrequencyScale = 1.0f;
+
+	/** Whether cosmetic work (shadows, anim while off screen) is allowed. */
+	UPROPERTY(EditAnywhere, Category = "Significance")
+	bool bCosmetics = true;
+};
+
+/**
+ * UMySignificanceManager
+ *
+ * Scores every AMyBaseCharacter by distance to the closest viewpoint, whether it is in front of that
+ * viewpoint and whether it is controlled by a local player, then throttles the character to match.
+ *
+ * Viewpoints are the views of every player controller in the world, so on a client only the local
+ * player counts while on the server each connected player does.
+ * Levels only drop once the score falls HysteresisMargin below the level's threshold, so characters
+ * sitting on a boundary don't flip settings every frame.
+ *
+ * Enabled through SignificanceManagerClassName in DefaultEngine.ini.
+ * Project.Significance.Debug 1 draws each character's score and level, Project.Significance.Dump prints level counts.
+ */
+UCLASS()
+class PROJECT_API UMySignificanceManager : public USignificanceManager, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UMySignificanceManager();
+
+	static const FName CharacterTag;
+
+	/* Starts scoring Character. Called from AMyBaseCharacter::BeginPlay(). */
+	void RegisterCharacter(AMyBaseCharacter* Character);
+
+	/* Stops scoring Character. Called from AMyBaseCharacter::EndPlay(). */
+	void UnregisterCharacter(AMyBaseCharacter* Character);
+
+	/* Returns the settings for Level. */
+	const FMySignificanceLevelSettings& GetLevelSettings(EMySignificanceLevel Level) const;
+
+	/* Fills OutCounts with how many registered characters are in each level, indexed by EMySignificanceLevel. */
+	void GetLevelCounts(TArray<int32>& OutCounts) const;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	virtual TStatId GetStatId() const override;
+
+	/** Distance at which a character reaches zero significance. */
+	UPROPERTY(Config)
+	float MaxDistance;
+
+	/** Significance multiplier for characters behind or outside the view cone of a viewpoint. */
+	UPROPERTY(Config)
+	float OffscreenScale;
+
+	/** Cosine of the half angle of the view cone. */
+	UPROPERTY(Config)
+	float ViewConeCos;
+
+	/** How far below a level's threshold the score has to fall before a character drops a level. */
+	UPROPERTY(Config)
+	float HysteresisMargin;
+
+	/** Settings per level, indexed by EMySignificanceLevel. Missing levels use the last entry. */
+	UPROPERTY(Config)
+	TArray<FMySignificanceLevelSettings> Levels;
+
+private:
+	/* Significance function: 1 for local players, otherwise distance and view based. */
+	float CalculateSignificance(FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint) const;
+
+	/* Post significance function: picks a level with hysteresis and applies it to the character. */
+	void PostSignificanceUpdate(FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal);
+
+	/* Picks the level for Significance given the level the character is currently in. */
+	EMySignificanceLevel SelectLevel(float Significance, EMySignificanceLevel CurrentLevel) const;
+
+	/* Draws the score and level above every registered character. */
+	void DrawDebug() const;
+
+	TArray<FTransform> Viewpoints;
+};
@@ -5,9 +5,13 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "MyBaseMovementComponent.h"
+#include "MyCharacterTuning.h"
+#include "MyNetSerializers.h"
+#include "MyStatEvents.h"
+#include "MyTimerWheel.h"
 #include "MyStaminaComponent.generated.h"
 
-DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnStaminaChanged);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnStaminaChanged, const FMyStatChange&, Change);
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class PROJECT_API UMyStaminaComponent : public UActorComponent
@@ -18,23 +22,32 @@ public:
 	// Sets default values for this component's properties
 	UMyStaminaComponent();
 
+	/* Feeds changed replicated properties into the network cost accounting. */
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
+	/* Feeds outgoing RPCs into the network cost accounting. */
+	virtual bool CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack) override;
+
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
 
     /**
      * Current stamina value. Replicates to clients whenever it changes via OnRep_CurrentStamina.
+     * Sent quantized to 1/100.
      */
     UPROPERTY(ReplicatedUsing = OnRep_CurrentStamina)
-    float CurrentStamina;
+    FMyQuantizedFloat CurrentStamina;
 
     /**
      * Maximum stamina value. Replicated to clients.
      */
     UPROPERTY(Replicated)
-    float MaximumStamina;
+    FMyQuantizedFloat MaximumStamina;
 
     /**
      * Indicates whether the player currently has any stamina left.
@@ -48,6 +61,11 @@ private:
     UPROPERTY()
     bool bCanSprint;
 
+    /**
+     * Stamina last sent to listeners, the old value of the next change event.
+     */
+    float NotifiedStamina;
+
     /**
      * Called when CurrentStamina is replicated to update clients.
      */
@@ -55,27 +73,31 @@ private:
     void OnRep_CurrentStamina();
 
     /**
-    * The time it takes for the stamina to decrease/increase.
+    * Shared tuning with RegenTime (time between stamina steps), DrainAmount and FillAmount, DA_CharacterTuning by default.
+    * The defaults of FMyCharacterTuningValues are used without one.
     */
-    UPROPERTY(EditDefaultsOnly, Category = "Stamina|Timer")
-    float RegenTime;
+    UPROPERTY(EditDefaultsOnly, Category = "Stamina|Tuning")
+    TObjectPtr<UMyCharacterTuning> Tuning;
 
+#if !UE_BUILD_SHIPPING
     /**
-    * The DrainAmount is how much Stamina will decrease after the RegenTime float value.
+    * Restarts a running stamina timer when RegenTime of our tuning changed.
     */
-    UPROPERTY(EditDefaultsOnly, Category = "Stamina|Timer")
-    float DrainAmount;
+    void OnTuningChanged(const UMyCharacterTuning* ChangedTuning);
 
-    /**
-    * The FillAmount is how much Stamina will be increased after the RegenTime float value.
-    */
-    UPROPERTY(EditDefaultsOnly, Category = "Stamina|Timer")
-    float FillAmount;
+    FDelegateHandle TuningChangedHandle;
+#endif
 
 public:
 
     /**
-     * Event triggered whenever stamina changes. Can be bound in Blueprint.
+     * Native event triggered whenever stamina changes, with the old and new stamina, delta and cause.
+     * C++ listeners bind here.
+     */
+    FMyStatChangedEvent OnStaminaChangedNative;
+
+    /**
+     * Blueprint version of OnStaminaChangedNative, only broadcast while something is bound.
      */
     UPROPERTY(BlueprintAssignable, Category = "Stamina|Event")
     FOnStaminaChanged OnStaminaChanged;
@@ -104,6 +126,11 @@ public:
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Stamina|Query")
     bool CanSprint() const;
 
+    /**
+     * Returns the tuning values this component uses.
+     */
+    const FMyCharacterTuningValues& GetTuning() const { return UMyCharacterTuning::Get(Tuning); }
+
     /**
      * Returns true if the player's stamina is full.
      */
@@ -153,15 +180,17 @@ public:
     float GetStaminaPercentage() const;
 
     /**
-     * Updates bHasStamina and bCanSprint based on current stamina values.
+     * Updates bHasStamina and bCanSprint based on current stamina values
+     * and broadcasts the change, with Cause, to OnStaminaChangedNative and OnStaminaChanged.
      */
     UFUNCTION(BlueprintCallable, Category = "Stamina|Status")
-    void UpdateStaminaStatus();
+    void UpdateStaminaStatus(EMyStatChangeCause Cause = EMyStatChangeCause::Unknown);
 
     /**
      * Timer handle used to repeatedly call StaminaTick() for stamina manipulation.
+     * Runs on the world's UMyTimerSubsystem.
      */
-    FTimerHandle StaminaDrainTimer;
+    FMyTimerHandle StaminaDrainTimer;
 
     /**
      * Starts the stamina manipulation timer (draining or regenerating stamina).
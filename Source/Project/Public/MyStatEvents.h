@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "MyStatEvents.generated.h"
+
+/** Why a health or stamina value changed. */
+UENUM(BlueprintType)
+enum class EMyStatChangeCause : uint8
+{
+	/* Changed from outside the component, e.g. UpdateHealthStatus() called from a Blueprint. */
+	Unknown,
+	Damage,
+	Heal,
+	/* Stamina spent while sprinting. */
+	Drain,
+	/* Stamina recovered while not sprinting. */
+	Regen,
+	/* Set to a value, including death. */
+	Set,
+	/* The maximum (or base) value changed; the current value may have been clamped to it. */
+	Maximum,
+	/* A client received a new value from the server. */
+	Replicated
+};
+
+/** One change of a health or stamina value, sent to listeners of the component's change events. */
+USTRUCT(BlueprintType)
+struct PROJECT_API FMyStatChange
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Stat")
+	float OldValue = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Stat")
+	float NewValue = 0.0f;
+
+	/* NewValue - OldValue; negative for damage and drain. */
+	UPROPERTY(BlueprintReadOnly, Category = "Stat")
+	float Delta = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Stat")
+	float MaximumValue = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Stat")
+	EMyStatChangeCause Cause = EMyStatChangeCause::Unknown;
+
+	FMyStatChange() = default;
+
+	FMyStatChange(float InOldValue, float InNewValue, float InMaximumValue, EMyStatChangeCause InCause)
+		: OldValue(InOldValue)
+		, NewValue(InNewValue)
+		, Delta(InNewValue - InOldValue)
+		, MaximumValue(InMaximumValue)
+		, Cause(InCause)
+	{
+	}
+
+	/* Returns NewValue as a fraction of MaximumValue, 0 when there is no maximum. */
+	float GetPercentage() const
+	{
+		return MaximumValue > 0.0f ? NewValue / MaximumValue : 0.0f;
+	}
+};
+
+/**
+ * Native change event of health and stamina. Bound with AddUObject / AddRaw / AddLambda and called directly,
+ * without the reflection (ProcessEvent) every dynamic delegate listener costs.
+ */
+DECLARE_MULTICAST_DELEGATE_OneParam(FMyStatChangedEvent, const FMyStatChange& /* Change */);
+
+/**
+ * Listener for Project.Events.Bench, bound once natively and once dynamically.
+ */
+UCLASS(Transient)
+class PROJECT_API UMyStatEventBenchListener : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	void OnStatChangedNative(const FMyStatChange& Change) { Sum += Change.Delta; }
+
+	UFUNCTION()
+	void OnStatChangedDynamic(const FMyStatChange& Change) { Sum += Change.Delta; }
+
+	/* Keeps the handlers from being optimized away. */
+	float Sum = 0.0f;
+};
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TimerManager.h"
+#include "MyTimerWheel.h"
+#include "MyTimerBenchmarkSubsystem.generated.h"
+
+/**
+ * Target of the timers of Project.Timers.Bench.
+ */
+UCLASS(Transient)
+class PROJECT_API UMyTimerBenchListener : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	void OnWheelTimer() { ++WheelCalls; }
+	void OnTimerManagerTimer() { ++TimerManagerCalls; }
+
+	int64 WheelCalls = 0;
+	int64 TimerManagerCalls = 0;
+};
+
+/**
+ * UMyTimerBenchmarkSubsystem
+ *
+ * Compares FMyTimerWheel with FTimerManager, started with Project.Timers.Bench [Count] [Seconds].
+ *
+ * Sets Count one-shot timers on a private wheel and a private timer manager with the same random delays up to
+ * Seconds, clears every second one and sets those again, timing each step and counting its allocations (with
+ * -MyCountAllocations, zero otherwise). Then both are advanced every frame until all timers fired, timing the
+ * per-frame expiry work.
+ * Results are appended to Saved/Profiling/TimerBench.csv.
+ */
+UCLASS()
+class PROJECT_API UMyTimerBenchmarkSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void StartBenchmark(int32 Count, float Seconds, FOutputDevice& Ar);
+
+	bool IsRunning() const { return bRunning; }
+
+private:
+	/* Time and allocations of one step for both timer implementations. */
+	struct FStepResult
+	{
+		double WheelSeconds = 0.0;
+		double TimerManagerSeconds = 0.0;
+		uint64 WheelAllocations = 0;
+		uint64 TimerManagerAllocations = 0;
+	};
+
+	/* Sets the timers of Indices on both. */
+	FStepResult SetTimers(const TArray<int32>& Indices);
+
+	/* Clears the timers of Indices on both. */
+	FStepResult ClearTimers(const TArray<int32>& Indices);
+
+	void LogStep(FOutputDevice& Ar, const TCHAR* Step, const FStepResult& Result, int32 Operations) const;
+
+	/* Logs and writes the results once all timers fired. */
+	void Report();
+
+	void Stop();
+
+	bool bRunning = false;
+	int32 Count = 0;
+	float Seconds = 0.0f;
+	double ElapsedSeconds = 0.0;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UMyTimerBenchListener> Listener;
+
+	TUniquePtr<FMyTimerWheel> Wheel;
+	TUniquePtr<FTimerManager> TimerManager;
+	TArray<FMyTimerHandle> WheelHandles;
+	TArray<FTimerHandle> TimerManagerHandles;
+	TArray<float> Delays;
+
+	/* Setting all timers, clearing half of them, setting that half again. */
+	FStepResult SetResult;
+	FStepResult ClearResult;
+	FStepResult ResetResult;
+
+	int64 Frames = 0;
+	double WheelTickSeconds = 0.0;
+	double TimerManagerTickSeconds = 0.0;
+	double MaxWheelTickSeconds = 0.0;
+	double MaxTimerManagerTickSeconds = 0.0;
+};
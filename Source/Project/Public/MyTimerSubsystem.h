@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MyTimerWheel.h"
+#include "MyTimerSubsystem.generated.h"
+
+/**
+ * UMyTimerSubsystem
+ *
+ * The world's gameplay timers on an FMyTimerWheel, advanced once per frame with the world's (dilated) delta time
+ * and not while the game is paused, like FTimerManager.
+ *
+ * Usage: UMyTimerSubsystem::GetTimerWheel(this)->SetTimer<&UMyClass::Method>(Handle, this, Rate, bLoop);
+ */
+UCLASS()
+class PROJECT_API UMyTimerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	FMyTimerWheel& GetWheel() { return Wheel; }
+
+	/* Returns the timer wheel of WorldContextObject's world, or null outside game worlds. */
+	static FMyTimerWheel* GetTimerWheel(const UObject* WorldContextObject);
+
+private:
+	FMyTimerWheel Wheel;
+};
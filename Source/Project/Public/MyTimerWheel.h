@@ -0,0 +1,166 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+/**
+ * Handle to a timer of FMyTimerWheel.
+ * The generation makes a handle go stale when its timer expires or is cleared, even if the timer's slot is reused.
+ */
+struct FMyTimerHandle
+{
+	bool IsValid() const { return Generation != 0; }
+
+	void Invalidate()
+	{
+		Index = 0;
+		Generation = 0;
+	}
+
+	bool operator==(const FMyTimerHandle& Other) const { return Index == Other.Index && Generation == Other.Generation; }
+	bool operator!=(const FMyTimerHandle& Other) const { return !(*this == Other); }
+
+private:
+	friend class FMyTimerWheel;
+
+	uint32 Index = 0;
+	uint32 Generation = 0;
+};
+
+/* Called with the object a timer was set for. */
+using FMyTimerCallback = void (*)(UObject* Object);
+
+/* Gets the class of a timer method, void (ClassType::*)(). */
+template<typename MethodType>
+struct TMyTimerMethodTraits;
+
+template<typename InClassType>
+struct TMyTimerMethodTraits<void (InClassType::*)()>
+{
+	using ClassType = InClassType;
+};
+
+/**
+ * FMyTimerWheel
+ *
+ * Hierarchical timing wheel: 4 levels of 256 slots over 1 ms ticks, so timers reach about 49 days ahead.
+ *
+ * A timer sits in a doubly linked list of the slot it expires in, so setting and clearing are O(1). Advancing walks
+ * the ticks of the frame; whenever a level wraps the next higher slot is brought down a level. Everything that expired
+ * during a frame is collected first and called afterwards in expiry order, so callbacks can set and clear timers freely.
+ * A looping timer that falls behind fires once per Advance(), not once per missed interval.
+ *
+ * Timers live in a node array reused through a free list, and callbacks are a function pointer plus a weak object
+ * pointer, so setting a timer allocates nothing once the array has grown to the number of live timers (see Reserve()).
+ * A timer whose object was destroyed is dropped when it expires.
+ */
+class PROJECT_API FMyTimerWheel
+{
+public:
+	/* Seconds per tick; the resolution of timers. */
+	static constexpr double TickSeconds = 0.001;
+
+	explicit FMyTimerWheel(int32 InitialCapacity = 256);
+
+	/* Allocates nodes for NumTimers live timers. */
+	void Reserve(int32 NumTimers);
+
+	/**
+	 * Sets a timer calling Method on Object after FirstDelay seconds (Rate if negative), then every Rate seconds if bLoop.
+	 * Clears the timer InOutHandle refers to first, like FTimerManager::SetTimer(); a Rate of 0 or less only clears.
+	 */
+	template<auto Method>
+	void SetTimer(FMyTimerHandle& InOutHandle, typename TMyTimerMethodTraits<decltype(Method)>::ClassType* Object, float Rate, bool bLoop, float FirstDelay = -1.0f)
+	{
+		using ClassType = typename TMyTimerMethodTraits<decltype(Method)>::ClassType;
+		SetTimer(InOutHandle, Object, [](UObject* Target) { (static_cast<ClassType*>(Target)->*Method)(); }, Rate, bLoop, FirstDelay);
+	}
+
+	void SetTimer(FMyTimerHandle& InOutHandle, UObject* Object, FMyTimerCallback Callback, float Rate, bool bLoop, float FirstDelay = -1.0f);
+
+	/* Clears the timer if it is still active and invalidates the handle. */
+	void ClearTimer(FMyTimerHandle& InOutHandle);
+
+	bool IsTimerActive(FMyTimerHandle Handle) const;
+
+	/* Returns the seconds until the timer expires next, or -1 if it is not active. */
+	float GetTimerRemaining(FMyTimerHandle Handle) const;
+
+	/* Moves time forward and calls every timer that expired. */
+	void Advance(float DeltaSeconds);
+
+	/* Returns the number of active timers. */
+	int32 Num() const { return NumActive; }
+
+	/* Returns the number of timers the node array holds without growing. */
+	int32 GetCapacity() const { return Nodes.Max(); }
+
+private:
+	static constexpr int32 SlotBits = 8;
+	static constexpr int32 SlotsPerLevel = 1 << SlotBits;
+	static constexpr int32 NumLevels = 4;
+	static constexpr uint64 SlotMask = SlotsPerLevel - 1;
+	static constexpr uint64 MaxDelayTicks = (uint64(1) << (SlotBits * NumLevels)) - 1;
+
+	enum class ENodeState : uint8
+	{
+		Free,
+		/* In a slot list. */
+		Scheduled,
+		/* Collected by Advance() and waiting to be called. */
+		Expired
+	};
+
+	struct FNode
+	{
+		TWeakObjectPtr<UObject> Object;
+		FMyTimerCallback Callback = nullptr;
+		uint64 ExpireTick = 0;
+		/* 0 for timers that don't loop. */
+		uint32 IntervalTicks = 0;
+		uint32 Generation = 1;
+		/* Links in the slot list; Next also links the free list. */
+		int32 Prev = INDEX_NONE;
+		int32 Next = INDEX_NONE;
+		uint16 Slot = 0;
+		ENodeState State = ENodeState::Free;
+	};
+
+	struct FExpiredTimer
+	{
+		int32 Index;
+		uint32 Generation;
+	};
+
+	/* Returns the node of an active timer, or null. */
+	const FNode* FindNode(FMyTimerHandle Handle) const;
+
+	int32 AllocateNode();
+	void FreeNode(int32 Index);
+
+	/* Links a node into the slot of its ExpireTick relative to NextTick. */
+	void Insert(int32 Index);
+	void Unlink(int32 Index);
+
+	/* Re-inserts every timer of a slot above level 0, which moves them down at least one level. */
+	void Cascade(int32 Level, int32 SlotIndex);
+
+	static uint64 SecondsToTicks(float Seconds);
+
+	TArray<FNode> Nodes;
+	int32 FreeHead = INDEX_NONE;
+	int32 NumActive = 0;
+
+	/* Head node of each slot's list, level after level. */
+	int32 Slots[NumLevels * SlotsPerLevel];
+
+	/* Expired timers of the current Advance(), kept to reuse its allocation. */
+	TArray<FExpiredTimer> ExpiredTimers;
+
+	double Time = 0.0;
+	/* The tick Time is in, and the next tick whose slot has not been processed. */
+	uint64 CurrentTick = 0;
+	uint64 NextTick = 0;
+};
@@ -0,0 +1,164 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+#include "MyTimerWheel.h"
+#include "MyWorldSnapshotSubsystem.generated.h"
+
+/**
+ * On-disk layout of a world snapshot: an FMySnapshotHeader followed by the door, player and spawn records,
+ * all plain little-endian data.
+ *
+ * Version history:
+ *   1 - Doors, player health and stamina, player start holders.
+ *
+ * The header stores its own size and the size of each record type, so a reader skips fields it doesn't know and
+ * zero-fills fields the file doesn't have. New fields are only ever appended to the header or a record and bump
+ * the version; a header is never smaller than Version1Size.
+ */
+struct FMySnapshotHeader
+{
+	static constexpr uint32 MagicValue = 0x5357594D; // "MYWS"
+	static constexpr uint16 CurrentVersion = 1;
+
+	/** Size of the version 1 header, the smallest a reader accepts. */
+	static constexpr uint16 Version1Size = 40;
+
+	uint32 Magic = MagicValue;
+	uint16 Version = CurrentVersion;
+	uint16 HeaderSize = sizeof(FMySnapshotHeader);
+	uint16 DoorRecordSize = 0;
+	uint16 PlayerRecordSize = 0;
+	uint16 SpawnRecordSize = 0;
+	/** Always zero; a reader rejects anything else, so a later version can give it a meaning. */
+	uint16 Reserved = 0;
+	uint32 NumDoors = 0;
+	uint32 NumPlayers = 0;
+	uint32 NumSpawns = 0;
+
+	/** CRC32 of everything after the header. */
+	uint32 PayloadCrc = 0;
+
+	/** Hash of the map the snapshot was taken on. */
+	uint64 MapId = 0;
+};
+
+/** An AMyBaseDoor, identified by the hash of its path without PIE prefix. */
+struct FMySnapshotDoor
+{
+	uint64 ActorId = 0;
+	float Pitch = 0.0f;
+	float Yaw = 0.0f;
+	float Roll = 0.0f;
+	uint8 bIsOpen = 0;
+	uint8 Padding[3] = {};
+};
+
+/** Health and stamina of a player, identified by AMyBaseGameMode::GetPersistentPlayerId(). */
+struct FMySnapshotPlayer
+{
+	uint64 PlayerId = 0;
+	float Health = 0.0f;
+	float MaximumHealth = 0.0f;
+	float Stamina = 0.0f;
+	float MaximumStamina = 0.0f;
+};
+
+/** A player start and the player that last spawned at it; that player starts there again when they come back after a restore. */
+struct FMySnapshotSpawn
+{
+	uint64 ActorId = 0;
+	uint64 OccupantId = 0;
+};
+
+static_assert(sizeof(FMySnapshotHeader) == 40 && sizeof(FMySnapshotDoor) == 24 && sizeof(FMySnapshotPlayer) == 24 && sizeof(FMySnapshotSpawn) == 16, "Snapshot records are written as they are in memory");
+static_assert(PLATFORM_LITTLE_ENDIAN, "Snapshot records are written as they are in memory");
+
+/**
+ * Gameplay state of a world, as written to and read from a snapshot file.
+ */
+struct PROJECT_API FMyWorldSnapshot
+{
+	uint64 MapId = 0;
+	TArray<FMySnapshotDoor> Doors;
+	TArray<FMySnapshotPlayer> Players;
+	TArray<FMySnapshotSpawn> Spawns;
+
+	/* Writes the snapshot to OutData in the current version. */
+	void Serialize(TArray<uint8>& OutData) const;
+
+	/* Reads a snapshot of any known version from Data. Rejects anything malformed, with the reason in OutError. */
+	static bool Parse(const uint8* Data, int64 Size, FMyWorldSnapshot& OutSnapshot, FString& OutError);
+
+	/* Whether every value is one the game can restore: finite, non-negative, current values within their maximum. */
+	bool IsValid() const;
+};
+
+/**
+ * UMyWorldSnapshotSubsystem
+ *
+ * Saves and restores the gameplay state of a world, so a round reset or a crashed server doesn't have to
+ * reload the map and rebuild the state from scratch.
+ *
+ * A snapshot holds every door's open state and angle, every player's health and stamina and which player last
+ * spawned at which player start. Saving copies that state into a small buffer on the game thread and writes it on a worker
+ * thread to a temporary file that then replaces Saved/Snapshots/<Name>.snap, so a crash mid-write leaves the
+ * previous snapshot intact. Restoring memory-maps the file, validates it and applies it to the existing actors
+ * in one pass over the doors and player starts; nothing is spawned or constructed. Players that are not in the
+ * game yet get their health and stamina back when AMyBaseGameMode next spawns them, at the player start they last
+ * spawned at.
+ *
+ * Server or standalone only. Project.Snapshot.Save / Load [Name] save and restore by hand,
+ * Project.Snapshot.AutosaveSeconds saves to "Autosave" periodically, -MySnapshotRestore=<Name> restores when
+ * the world begins play and Project.Snapshot.Fuzz checks that whatever the reader accepts writes back byte for
+ * byte and that it rejects truncated or oversized files.
+ */
+UCLASS()
+class PROJECT_API UMyWorldSnapshotSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	/* Captures the world's state and writes it asynchronously to the snapshot Name. */
+	void SaveSnapshot(const FString& Name);
+
+	/* Restores the snapshot Name. Returns false if it is missing, malformed or from another map. */
+	bool LoadSnapshot(const FString& Name);
+
+	/* Applies restored health and stamina to PlayerController's pawn, if the last restored snapshot had them. */
+	void ApplyPendingPlayerState(APlayerController* PlayerController);
+
+	/* Copies the world's current state into OutSnapshot. */
+	void CaptureSnapshot(FMyWorldSnapshot& OutSnapshot) const;
+
+	/* Applies Snapshot to the world. */
+	void ApplySnapshot(const FMyWorldSnapshot& Snapshot);
+
+	/* Returns the path of the snapshot Name. */
+	static FString GetSnapshotPath(const FString& Name);
+
+private:
+	/* Returns the hash identifying the current map. */
+	uint64 GetMapId() const;
+
+	/* Saves the "Autosave" snapshot. Called by the autosave timer. */
+	void Autosave();
+
+	/* Applies the health and stamina of Player to PlayerController's pawn. */
+	static bool ApplyPlayerState(APlayerController* PlayerController, const FMySnapshotPlayer& Player);
+
+	/* The write that is in flight; the next write waits for it. */
+	UE::Tasks::FTask WriteTask;
+
+	/* Restored player state of players without a pawn yet, by persistent player id. */
+	TMap<uint64, FMySnapshotPlayer> PendingPlayers;
+
+	FMyTimerHandle AutosaveTimer;
+};